@@ -0,0 +1,510 @@
+/**
+ * @file adjacency_cache.c
+ * @purpose A preprocessed binary cache of an adjacency input file
+ */
+
+/* Feature test macros ***************************************************************************/
+#define _POSIX_C_SOURCE (200809L)
+
+/* Includes **************************************************************************************/
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "results.h"
+#include "common.h"
+#include "config.h"
+#include "file_format.h"
+#include "adjacency_matrix.h"
+#include "adjacency_file.h"
+#include "adjacency_cache.h"
+
+
+/* Constants *************************************************************************************/
+/* The cache's path is the input file's, with this suffix */
+#define ADJACENCY_CACHE_SUFFIX ".cache"
+/* The cache is first written to a temporary file, with this suffix */
+#define ADJACENCY_CACHE_TEMP_SUFFIX ".cache.tmp"
+
+#define ADJACENCY_CACHE_MAGIC ("CLSTRCCH")
+#define ADJACENCY_CACHE_VERSION (1)
+/* Written in the host's byte order, a cache of another byte order differs */
+#define ADJACENCY_CACHE_BYTE_ORDER (0x01020304)
+
+/* Each section begins at a multiple of the alignment, a cache line */
+#define ADJACENCY_CACHE_ALIGNMENT (64)
+
+
+/* Macros ****************************************************************************************/
+#define ADJACENCY_CACHE_ALIGN_UP(position) \
+    (((position) + ADJACENCY_CACHE_ALIGNMENT - 1) & ~(uint64_t)(ADJACENCY_CACHE_ALIGNMENT - 1))
+
+
+/* Structs ***************************************************************************************/
+/* The cache file's header. A section's offset is 0 if it is missing */
+typedef struct adjacency_cache_file_header_s {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t order;
+    uint32_t width;
+    int64_t n;
+    int64_t M;
+    /* The count of all of the rows' columns */
+    int64_t cells;
+    /* The input file's size and modification time */
+    int64_t input_size;
+    int64_t input_mtime;
+    uint64_t vertices_offset;
+    uint64_t neighbors_offset;
+    uint64_t neighbors_div_M_offset;
+    uint64_t offsets_offset;
+    uint64_t columns_offset;
+    uint64_t size;
+} adjacency_cache_file_header_t;
+
+/* An adjacency_cache_t and its mapping, allocated at once */
+typedef struct adjacency_cache_header_s {
+    adjacency_cache_t cache;
+    void *mapping;
+    size_t mapping_size;
+} adjacency_cache_header_t;
+
+
+/* Functions Declarations ***********************************************************************/
+/**
+ * @purpose Get the path of an input file's cache
+ * @param path The input file's path
+ * @param suffix The cache's suffix
+ *
+ * @return The cache's path, to be freed, or NULL if out of memory
+ */
+static
+char *
+adjacency_cache_get_path(const char *path, const char *suffix);
+
+/**
+ * @purpose Check a section lies within the cache and is aligned
+ * @param header The cache file's header
+ * @param offset The section's offset
+ * @param size The section's size
+ *
+ * @return TRUE if valid
+ */
+static
+bool_t
+adjacency_cache_is_valid_section(const adjacency_cache_file_header_t *header,
+                                 uint64_t offset,
+                                 uint64_t size);
+
+/**
+ * @purpose Pad the cache up to a section's offset, and write the section
+ * @param file The cache
+ * @param position The position written so far, set to the section's end
+ * @param offset The section's offset
+ * @param data The section
+ * @param size The section's size
+ *
+ * @return One of result_t values
+ */
+static
+result_t
+adjacency_cache_write_section(FILE *file,
+                              uint64_t *position,
+                              uint64_t offset,
+                              const void *data,
+                              size_t size);
+
+
+/* Functions ************************************************************************************/
+static
+char *
+adjacency_cache_get_path(const char *path, const char *suffix)
+{
+    char *cache_path = NULL;
+
+    cache_path = (char *)malloc(strlen(path) + strlen(suffix) + 1);
+    if (NULL != cache_path) {
+        (void)strcpy(cache_path, path);
+        (void)strcat(cache_path, suffix);
+    }
+
+    return cache_path;
+}
+
+static
+bool_t
+adjacency_cache_is_valid_section(const adjacency_cache_file_header_t *header,
+                                 uint64_t offset,
+                                 uint64_t size)
+{
+    return (sizeof(*header) <= offset) &&
+           (0 == offset % ADJACENCY_CACHE_ALIGNMENT) &&
+           (offset <= header->size) &&
+           (size <= header->size - offset);
+}
+
+static
+result_t
+adjacency_cache_write_section(FILE *file,
+                              uint64_t *position,
+                              uint64_t offset,
+                              const void *data,
+                              size_t size)
+{
+    result_t result = E__UNKNOWN;
+    const unsigned char padding[ADJACENCY_CACHE_ALIGNMENT] = {0};
+
+    /* 1. Pad */
+    if (offset - *position != fwrite(padding, 1, offset - *position, file)) {
+        result = E__FWRITE_ERROR;
+        goto l_cleanup;
+    }
+
+    /* 2. Write */
+    if ((0 != size) && (1 != fwrite(data, size, 1, file))) {
+        result = E__FWRITE_ERROR;
+        goto l_cleanup;
+    }
+    *position = offset + size;
+
+    result = E__SUCCESS;
+l_cleanup:
+
+    return result;
+}
+
+result_t
+ADJACENCY_CACHE_open(const char *path, adjacency_cache_t **cache_out)
+{
+    result_t result = E__UNKNOWN;
+    adjacency_cache_header_t *header = NULL;
+    const adjacency_cache_file_header_t *file_header = NULL;
+    const unsigned char *data = NULL;
+    struct stat input_status;
+    struct stat status;
+    char *cache_path = NULL;
+    void *mapping = MAP_FAILED;
+    const uint64_t *offsets = NULL;
+    uint64_t n = 0;
+    uint64_t i = 0;
+    int fd = -1;
+
+    /* 0. Input validation */
+    if ((NULL == path) || (NULL == cache_out)) {
+        result = E__NULL_ARGUMENT;
+        goto l_cleanup;
+    }
+
+    /* 1. Open the cache, only a regular file has one */
+    if ((0 == strcmp(path, ADJACENCY_FILE_STDIN)) ||
+        (0 != stat(path, &input_status)) ||
+        (!S_ISREG(input_status.st_mode))) {
+        result = E__FOPEN_ERROR;
+        goto l_cleanup;
+    }
+
+    cache_path = adjacency_cache_get_path(path, ADJACENCY_CACHE_SUFFIX);
+    if (NULL == cache_path) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+
+    fd = open(cache_path, O_RDONLY);
+    if (-1 == fd) {
+        result = E__FOPEN_ERROR;
+        goto l_cleanup;
+    }
+
+    if ((0 != fstat(fd, &status)) ||
+        ((off_t)sizeof(*file_header) > status.st_size)) {
+        result = E__FREAD_ERROR;
+        goto l_cleanup;
+    }
+
+    /* 2. Map */
+    mapping = mmap(NULL, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (MAP_FAILED == mapping) {
+        result = E__MMAP_ERROR;
+        goto l_cleanup;
+    }
+    data = (const unsigned char *)mapping;
+    file_header = (const adjacency_cache_file_header_t *)mapping;
+
+    /* 3. The cache must be of this version, input and order */
+    if ((0 != memcmp(file_header->magic,
+                     ADJACENCY_CACHE_MAGIC,
+                     sizeof(file_header->magic))) ||
+        (ADJACENCY_CACHE_VERSION != file_header->version) ||
+        (ADJACENCY_CACHE_BYTE_ORDER != file_header->byte_order) ||
+        (ADJACENCY_ORDER != file_header->order) ||
+        (FILE_WIDTH_MAX <= file_header->width) ||
+        ((int64_t)input_status.st_size != file_header->input_size) ||
+        ((int64_t)input_status.st_mtime != file_header->input_mtime) ||
+        ((uint64_t)status.st_size != file_header->size)) {
+        result = E__INVALID_VALUE;
+        goto l_cleanup;
+    }
+
+    /* 4. Its sections must lie within it */
+    n = (uint64_t)file_header->n;
+    if ((0 > file_header->n) || (INT_MAX <= file_header->n) ||
+        (0 > file_header->cells) ||
+        ((ADJACENCY_ORDER_INPUT != ADJACENCY_ORDER) &&
+         (!adjacency_cache_is_valid_section(file_header,
+                                            file_header->vertices_offset,
+                                            n * sizeof(int)))) ||
+        (!adjacency_cache_is_valid_section(file_header,
+                                           file_header->neighbors_offset,
+                                           n * sizeof(int))) ||
+        (!adjacency_cache_is_valid_section(file_header,
+                                           file_header->neighbors_div_M_offset,
+                                           n * sizeof(double))) ||
+        (!adjacency_cache_is_valid_section(file_header,
+                                           file_header->offsets_offset,
+                                           (n + 1) * sizeof(uint64_t))) ||
+        (!adjacency_cache_is_valid_section(file_header,
+                                           file_header->columns_offset,
+                                           (uint64_t)file_header->cells * sizeof(int)))) {
+        result = E__INVALID_VALUE;
+        goto l_cleanup;
+    }
+
+    /* 4.1. Its rows must lie within the columns */
+    offsets = (const uint64_t *)&data[file_header->offsets_offset];
+    for (i = 0 ; i < n ; ++i) {
+        if (offsets[i] > offsets[i + 1]) {
+            result = E__INVALID_VALUE;
+            goto l_cleanup;
+        }
+    }
+    if ((uint64_t)file_header->cells != offsets[n]) {
+        result = E__INVALID_VALUE;
+        goto l_cleanup;
+    }
+
+    /* 5. Attach */
+    header = (adjacency_cache_header_t *)malloc(sizeof(*header));
+    if (NULL == header) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+    (void)memset(header, 0, sizeof(*header));
+
+    header->mapping = mapping;
+    header->mapping_size = (size_t)status.st_size;
+    mapping = MAP_FAILED;
+
+    header->cache.n = (int)file_header->n;
+    header->cache.M = file_header->M;
+    header->cache.width = (file_width_t)file_header->width;
+    if (ADJACENCY_ORDER_INPUT != ADJACENCY_ORDER) {
+        header->cache.vertices = (const int *)&data[file_header->vertices_offset];
+    }
+    header->cache.neighbors = (const int *)&data[file_header->neighbors_offset];
+    header->cache.neighbors_div_M =
+        (const double *)&data[file_header->neighbors_div_M_offset];
+    header->cache.offsets = offsets;
+    header->cache.columns = (const int *)&data[file_header->columns_offset];
+
+    /* Success */
+    *cache_out = &header->cache;
+
+    result = E__SUCCESS;
+l_cleanup:
+    if (MAP_FAILED != mapping) {
+        (void)munmap(mapping, (size_t)status.st_size);
+    }
+    if (-1 != fd) {
+        (void)close(fd);
+    }
+    FREE_SAFE(cache_path);
+
+    return result;
+}
+
+result_t
+ADJACENCY_CACHE_write(const char *path,
+                      const struct adjacency_s *adj,
+                      const size_t *offsets,
+                      const int *columns,
+                      const int *lengths)
+{
+    result_t result = E__UNKNOWN;
+    adjacency_cache_file_header_t header;
+    struct stat input_status;
+    char *cache_path = NULL;
+    char *temp_path = NULL;
+    FILE *file = NULL;
+    bool_t is_created = FALSE;
+    uint64_t position = 0;
+    uint64_t offset = 0;
+    int i = 0;
+
+    /* 0. Input validation */
+    if ((NULL == path) || (NULL == adj) || (NULL == offsets) ||
+        (NULL == columns) || (NULL == lengths)) {
+        result = E__NULL_ARGUMENT;
+        goto l_cleanup;
+    }
+
+    /* 1. Lay the sections out. A stream's contents are gone, it isn't cached */
+    if ((0 == strcmp(path, ADJACENCY_FILE_STDIN)) ||
+        (0 != stat(path, &input_status)) ||
+        (!S_ISREG(input_status.st_mode))) {
+        result = E__FOPEN_ERROR;
+        goto l_cleanup;
+    }
+
+    (void)memset(&header, 0, sizeof(header));
+    (void)memcpy(header.magic, ADJACENCY_CACHE_MAGIC, sizeof(header.magic));
+    header.version = ADJACENCY_CACHE_VERSION;
+    header.byte_order = ADJACENCY_CACHE_BYTE_ORDER;
+    header.order = ADJACENCY_ORDER;
+    header.width = (uint32_t)adj->width;
+    header.n = adj->n;
+    header.M = adj->M;
+    for (i = 0 ; i < adj->n ; ++i) {
+        header.cells += lengths[i];
+    }
+    header.input_size = (int64_t)input_status.st_size;
+    header.input_mtime = (int64_t)input_status.st_mtime;
+
+    position = ADJACENCY_CACHE_ALIGN_UP(sizeof(header));
+    if (NULL != adj->vertices) {
+        header.vertices_offset = position;
+        position = ADJACENCY_CACHE_ALIGN_UP(position + adj->n * sizeof(int));
+    }
+    header.neighbors_offset = position;
+    position = ADJACENCY_CACHE_ALIGN_UP(position + adj->n * sizeof(int));
+    header.neighbors_div_M_offset = position;
+    position = ADJACENCY_CACHE_ALIGN_UP(position + adj->n * sizeof(double));
+    header.offsets_offset = position;
+    position = ADJACENCY_CACHE_ALIGN_UP(position +
+                                        ((uint64_t)adj->n + 1) * sizeof(uint64_t));
+    header.columns_offset = position;
+    header.size = position + (uint64_t)header.cells * sizeof(int);
+
+    /* 2. Write to the temporary file */
+    cache_path = adjacency_cache_get_path(path, ADJACENCY_CACHE_SUFFIX);
+    temp_path = adjacency_cache_get_path(path, ADJACENCY_CACHE_TEMP_SUFFIX);
+    if ((NULL == cache_path) || (NULL == temp_path)) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+
+    file = fopen(temp_path, "wb");
+    if (NULL == file) {
+        result = E__FOPEN_ERROR;
+        goto l_cleanup;
+    }
+    is_created = TRUE;
+
+    position = 0;
+    result = adjacency_cache_write_section(file, &position, 0, &header, sizeof(header));
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+
+    if (NULL != adj->vertices) {
+        result = adjacency_cache_write_section(file,
+                                               &position,
+                                               header.vertices_offset,
+                                               adj->vertices,
+                                               adj->n * sizeof(int));
+        if (E__SUCCESS != result) {
+            goto l_cleanup;
+        }
+    }
+
+    result = adjacency_cache_write_section(file,
+                                           &position,
+                                           header.neighbors_offset,
+                                           adj->neighbors,
+                                           adj->n * sizeof(int));
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+
+    result = adjacency_cache_write_section(file,
+                                           &position,
+                                           header.neighbors_div_M_offset,
+                                           adj->neighbors_div_M,
+                                           adj->n * sizeof(double));
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+
+    /* 2.1. The rows' offsets, without the gaps of their dropped columns */
+    offset = 0;
+    for (i = 0 ; i <= adj->n ; ++i) {
+        result = adjacency_cache_write_section(file,
+                                               &position,
+                                               (0 == i) ? header.offsets_offset : position,
+                                               &offset,
+                                               sizeof(offset));
+        if (E__SUCCESS != result) {
+            goto l_cleanup;
+        }
+        if (i < adj->n) {
+            offset += (uint64_t)lengths[i];
+        }
+    }
+
+    for (i = 0 ; i < adj->n ; ++i) {
+        result = adjacency_cache_write_section(file,
+                                               &position,
+                                               (0 == i) ? header.columns_offset : position,
+                                               &columns[offsets[i]],
+                                               lengths[i] * sizeof(int));
+        if (E__SUCCESS != result) {
+            goto l_cleanup;
+        }
+    }
+
+    /* 3. Replace the previous cache */
+    if (0 != fclose(file)) {
+        file = NULL;
+        result = E__FWRITE_ERROR;
+        goto l_cleanup;
+    }
+    file = NULL;
+
+    if (0 != rename(temp_path, cache_path)) {
+        result = E__FWRITE_ERROR;
+        goto l_cleanup;
+    }
+
+    result = E__SUCCESS;
+l_cleanup:
+    FCLOSE_SAFE(file);
+    if ((E__SUCCESS != result) && is_created) {
+        (void)remove(temp_path);
+    }
+    FREE_SAFE(temp_path);
+    FREE_SAFE(cache_path);
+
+    return result;
+}
+
+void
+ADJACENCY_CACHE_close(adjacency_cache_t *cache)
+{
+    adjacency_cache_header_t *header = (adjacency_cache_header_t *)cache;
+
+    if (NULL == cache) {
+        return;
+    }
+
+    if (NULL != header->mapping) {
+        (void)munmap(header->mapping, header->mapping_size);
+    }
+    FREE_SAFE(header);
+}
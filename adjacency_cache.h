@@ -0,0 +1,97 @@
+/**
+ * @file adjacency_cache.h
+ * @purpose A preprocessed binary cache of an adjacency input file.
+ *          It holds the adjacency as it is built by ADJACENCY_MATRIX_open:
+ *          the vertices' order, the degrees, k/M, and the relabeled, sorted
+ *          and unique rows. Its sections are aligned, so it is used straight
+ *          out of its mapping
+ */
+#ifndef __ADJACENCY_CACHE_H__
+#define __ADJACENCY_CACHE_H__
+
+/* Includes **************************************************************************************/
+#include <stddef.h>
+#include <stdint.h>
+
+#include "results.h"
+#include "common.h"
+#include "file_format.h"
+
+
+/* Structs ***************************************************************************************/
+/* See adjacency_matrix.h */
+struct adjacency_s;
+
+/**
+ * @brief An attached cache. The arrays point into its mapping
+ * @param n The vertices count
+ * @param M The total neighbors count
+ * @param width The input file's width
+ * @param vertices Mapping array from vertice index to its input index, or
+ *                 NULL if the input's order was kept
+ * @param neighbors Mapping array from vertice index to its neighbors count
+ * @param neighbors_div_M Mapping array from vertice index to k/M
+ * @param offsets The rows' columns: row i's are columns[offsets[i]] to
+ *                columns[offsets[i + 1]]
+ * @param columns The rows' columns, ascending within each row
+ */
+typedef struct adjacency_cache_s {
+    int n;
+    int64_t M;
+    file_width_t width;
+    const int *vertices;
+    const int *neighbors;
+    const double *neighbors_div_M;
+    const uint64_t *offsets;
+    const int *columns;
+} adjacency_cache_t;
+
+
+/* Functions Declarations ************************************************************************/
+/*
+ * @purpose Attach to the cache of an input file, without copying it
+ *
+ * @param path The input file's path, the cache's path is <path>.cache
+ * @param cache_out The attached cache
+ *
+ * @return One of result_t values. Fails if the cache is missing, of another
+ *         version, or was built from another input or with another order
+ *
+ * @remark cache_out must be closed using ADJACENCY_CACHE_close
+ */
+result_t
+ADJACENCY_CACHE_open(const char *path, adjacency_cache_t **cache_out);
+
+/*
+ * @purpose Write the cache of an input file
+ *
+ * @param path The input file's path, the cache's path is <path>.cache
+ * @param adj The built adjacency, its neighbors in its vertices' order
+ * @param offsets Row i's columns begin at columns[offsets[i]]
+ * @param columns The rows' columns, ascending within each row
+ * @param lengths The count of each row's columns
+ *
+ * @return One of result_t values
+ *
+ * @remark The cache is written to a temporary file, which replaces the
+ *         previous cache only once it is complete
+ */
+result_t
+ADJACENCY_CACHE_write(const char *path,
+                      const struct adjacency_s *adj,
+                      const size_t *offsets,
+                      const int *columns,
+                      const int *lengths);
+
+/**
+ * @purpose Detach from a cache
+ *
+ * @param cache The cache to close
+ *
+ * @remark Safe to call with NULL
+ */
+void
+ADJACENCY_CACHE_close(adjacency_cache_t *cache);
+
+
+#endif /* __ADJACENCY_CACHE_H__ */
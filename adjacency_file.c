@@ -0,0 +1,890 @@
+/**
+ * @file adjacency_file.c
+ * @purpose The rows of an adjacency input file, mapped to memory
+ */
+
+/* Feature test macros ***************************************************************************/
+#define _POSIX_C_SOURCE (200809L)
+
+/* Includes **************************************************************************************/
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include "results.h"
+#include "common.h"
+#include "config.h"
+#include "file_format.h"
+#include "stream_vbyte.h"
+#include "adjacency_file.h"
+#include "adjacency_text.h"
+
+
+/* Constants *************************************************************************************/
+/* The row index sidecar's path is the file's, with this suffix */
+#define ADJACENCY_FILE_INDEX_SUFFIX ".idx"
+
+#define ADJACENCY_FILE_INDEX_MAGIC ("CLSTRIDX")
+#define ADJACENCY_FILE_INDEX_VERSION (1)
+
+/* The size a stream is read to at first. It is doubled whenever filled */
+#define ADJACENCY_FILE_STREAM_BUFFER_SIZE (1 << 24)
+
+
+/* Structs ***************************************************************************************/
+/* An adjacency_file_t and its mapping, allocated at once */
+typedef struct adjacency_file_header_s {
+    adjacency_file_t file;
+    void *mapping;
+    size_t mapping_size;
+    /* The file's modification time, which its row index must match */
+    int64_t mtime;
+    /* The rows of a text file, parsed to memory */
+    int *columns;
+    /* The contents of a stream, read to memory */
+    unsigned char *buffer;
+} adjacency_file_header_t;
+
+/*
+ * The row index sidecar's header. It is followed by n + 1 positions: the
+ * position of each row's IDs within the file, then the position the last
+ * row ends at. A row's degree follows from its position and the next's
+ */
+typedef struct adjacency_file_index_s {
+    char magic[8];
+    uint32_t version;
+    uint32_t width;
+    int64_t n;
+    int64_t size;
+    int64_t mtime;
+} adjacency_file_index_t;
+
+
+/* Functions Declarations ***********************************************************************/
+/**
+ * @purpose Get a count out of the file's data, 32 or 64-bit by its width
+ * @param data The count's position
+ * @param width The file's width
+ *
+ * @return The count
+ */
+static
+int64_t
+adjacency_file_get_count(const unsigned char *data, file_width_t width);
+
+/**
+ * @purpose Map the file to memory, or read it if it is a stream
+ * @param header The file's header, whose mapping or buffer is set
+ * @param path The file's path
+ *
+ * @return One of result_t values
+ */
+static
+result_t
+adjacency_file_map(adjacency_file_header_t *header, const char *path);
+
+/**
+ * @purpose Read a stream to memory, until its end, by reads as large as the
+ *          buffer's room
+ * @param header The file's header, whose buffer is set
+ * @param fd The stream
+ *
+ * @return One of result_t values
+ */
+static
+result_t
+adjacency_file_read_stream(adjacency_file_header_t *header, int fd);
+
+/**
+ * @purpose Read the file's width and n, and allocate its rows' index
+ * @param file The mapped file
+ * @param position_out The position the first row starts at
+ *
+ * @return One of result_t values
+ */
+static
+result_t
+adjacency_file_read_header(adjacency_file_t *file, size_t *position_out);
+
+/**
+ * @purpose Validate the file's counts, indexing each row's position
+ * @param file The mapped file
+ * @param position The position the first row starts at
+ *
+ * @return One of result_t values
+ */
+static
+result_t
+adjacency_file_index_rows(adjacency_file_t *file, size_t position);
+
+/**
+ * @purpose Validate a compressed file's blocks, indexing each row's position
+ * @param file The mapped file
+ * @param position The position the blocks' rows count starts at
+ *
+ * @return One of result_t values
+ */
+static
+result_t
+adjacency_file_index_blocks(adjacency_file_t *file, size_t position);
+
+/**
+ * @purpose Decode a compressed file's row
+ * @param file The opened file
+ * @param row The row's index
+ * @param columns Buffer of at least degrees[row] entries
+ *
+ * @return One of result_t values. E__INVALID_ROW_INDEX if an ID isn't a
+ *         valid vertex index
+ */
+static
+result_t
+adjacency_file_decode_row(const adjacency_file_t *file, int row, int *columns);
+
+/**
+ * @purpose Get the path of a file's row index sidecar
+ * @param path The file's path
+ *
+ * @return The sidecar's path, to be freed, or NULL if out of memory
+ */
+static
+char *
+adjacency_file_get_index_path(const char *path);
+
+/**
+ * @purpose Read the rows' index from the file's sidecar, instead of hopping
+ *          over the whole file
+ * @param header The file, whose header was read
+ * @param path The file's path
+ *
+ * @return One of result_t values. Fails if the sidecar is missing, invalid,
+ *         or doesn't match the file's size and modification time
+ */
+static
+result_t
+adjacency_file_read_index(adjacency_file_header_t *header, const char *path);
+
+/**
+ * @purpose Write the rows' index to the file's sidecar. A failure is ignored,
+ *          the index is only missed by the next open
+ * @param header The indexed file
+ * @param path The file's path
+ */
+static
+void
+adjacency_file_write_index(const adjacency_file_header_t *header,
+                           const char *path);
+
+
+/* Functions ************************************************************************************/
+static
+int64_t
+adjacency_file_get_count(const unsigned char *data, file_width_t width)
+{
+    int32_t count = 0;
+    int64_t wide_count = 0;
+
+    /* The counts of a wide file aren't aligned */
+    if (FILE_WIDTH_LEGACY == width) {
+        (void)memcpy(&count, data, sizeof(count));
+        return count;
+    }
+
+    (void)memcpy(&wide_count, data, sizeof(wide_count));
+    return wide_count;
+}
+
+static
+result_t
+adjacency_file_map(adjacency_file_header_t *header, const char *path)
+{
+    result_t result = E__UNKNOWN;
+    struct stat status;
+    void *mapping = NULL;
+    int fd = -1;
+
+    /* 1. Open and get the file's size */
+    fd = (0 == strcmp(path, ADJACENCY_FILE_STDIN)) ? STDIN_FILENO : open(path, O_RDONLY);
+    if (-1 == fd) {
+        result = E__FOPEN_ERROR;
+        goto l_cleanup;
+    }
+
+    if (0 != fstat(fd, &status)) {
+        result = E__FOPEN_ERROR;
+        goto l_cleanup;
+    }
+
+    /* 1.1. A stream has no size, it is read until its end. stdin may be a
+     *      redirected file, which is mapped, but has no path of its own */
+    header->file.is_stream = (STDIN_FILENO == fd) || (!S_ISREG(status.st_mode));
+    if (!S_ISREG(status.st_mode)) {
+        result = adjacency_file_read_stream(header, fd);
+        goto l_cleanup;
+    }
+
+    /* 2. An empty file can't be mapped, nor is it valid */
+    if (0 >= status.st_size) {
+        result = E__FREAD_ERROR;
+        goto l_cleanup;
+    }
+
+    /* 3. Map */
+    mapping = mmap(NULL, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (MAP_FAILED == mapping) {
+        result = E__MMAP_ERROR;
+        goto l_cleanup;
+    }
+    (void)posix_madvise(mapping, (size_t)status.st_size, POSIX_MADV_WILLNEED);
+
+    header->mapping = mapping;
+    header->mapping_size = (size_t)status.st_size;
+    header->mtime = (int64_t)status.st_mtime;
+    header->file.data = (const unsigned char *)mapping;
+    header->file.size = (size_t)status.st_size;
+
+    result = E__SUCCESS;
+l_cleanup:
+    if ((-1 != fd) && (STDIN_FILENO != fd)) {
+        (void)close(fd);
+    }
+
+    return result;
+}
+
+static
+result_t
+adjacency_file_read_stream(adjacency_file_header_t *header, int fd)
+{
+    result_t result = E__UNKNOWN;
+    unsigned char *buffer = NULL;
+    unsigned char *larger = NULL;
+    size_t capacity = ADJACENCY_FILE_STREAM_BUFFER_SIZE;
+    size_t size = 0;
+    ssize_t result_read = 0;
+
+    buffer = (unsigned char *)malloc(capacity);
+    if (NULL == buffer) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+
+    /* 1. Read whatever is available, until the writer closes the stream */
+    for (;;) {
+        if (capacity == size) {
+            larger = (unsigned char *)realloc(buffer, 2 * capacity);
+            if (NULL == larger) {
+                result = E__MALLOC_ERROR;
+                goto l_cleanup;
+            }
+            buffer = larger;
+            capacity *= 2;
+        }
+
+        result_read = read(fd, &buffer[size], capacity - size);
+        if (0 == result_read) {
+            break;
+        }
+        if (0 > result_read) {
+            if (EINTR == errno) {
+                continue;
+            }
+            result = E__FREAD_ERROR;
+            goto l_cleanup;
+        }
+        size += (size_t)result_read;
+    }
+
+    /* 2. An empty stream isn't valid, as an empty file */
+    if (0 == size) {
+        result = E__FREAD_ERROR;
+        goto l_cleanup;
+    }
+
+    header->buffer = buffer;
+    buffer = NULL;
+    header->file.data = header->buffer;
+    header->file.size = size;
+
+    result = E__SUCCESS;
+l_cleanup:
+    FREE_SAFE(buffer);
+
+    return result;
+}
+
+static
+result_t
+adjacency_file_read_header(adjacency_file_t *file, size_t *position_out)
+{
+    result_t result = E__UNKNOWN;
+    size_t position = 0;
+    int64_t count = 0;
+    int32_t marker = 0;
+
+    /* 1. A legacy file starts with n, a wide file with its marker */
+    if (sizeof(marker) > file->size) {
+        result = E__FREAD_ERROR;
+        goto l_cleanup;
+    }
+    (void)memcpy(&marker, file->data, sizeof(marker));
+    position = sizeof(marker);
+
+    if (0 <= marker) {
+        file->width = FILE_WIDTH_LEGACY;
+        count = marker;
+    } else {
+        /* A compressed file's IDs are 32-bit, its counts are 64-bit */
+        if (FILE_FORMAT_COMPRESSED_MARKER == marker) {
+            file->is_compressed = TRUE;
+            marker = FILE_FORMAT_MARKER(FILE_WIDTH_32);
+        }
+
+        file->width = FILE_FORMAT_WIDTH(marker);
+        if (FILE_WIDTH_MAX == file->width) {
+            result = E__INVALID_VALUE;
+            goto l_cleanup;
+        }
+
+        if (sizeof(count) > file->size - position) {
+            result = E__FREAD_ERROR;
+            goto l_cleanup;
+        }
+        count = adjacency_file_get_count(&file->data[position], file->width);
+        position += sizeof(count);
+    }
+
+    /* 2. The vertices are indexed by int */
+    if ((0 > count) || (INT_MAX <= count)) {
+        result = E__INVALID_SIZE;
+        goto l_cleanup;
+    }
+    file->n = (int)count;
+
+    /* 3. Allocations */
+    file->degrees = (int *)malloc(sizeof(*file->degrees) * MAX(file->n, 1));
+    if (NULL == file->degrees) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+
+    file->positions = (size_t *)malloc(sizeof(*file->positions) * MAX(file->n, 1));
+    if (NULL == file->positions) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+
+    *position_out = position;
+
+    result = E__SUCCESS;
+l_cleanup:
+
+    return result;
+}
+
+static
+result_t
+adjacency_file_index_rows(adjacency_file_t *file, size_t position)
+{
+    result_t result = E__UNKNOWN;
+    size_t count_size = FILE_FORMAT_COUNT_SIZE(file->width);
+    size_t id_size = FILE_FORMAT_ID_SIZE(file->width);
+    int64_t count = 0;
+    int i = 0;
+
+    /* 1. Hop from each row's count to the next */
+    for (i = 0 ; i < file->n ; ++i) {
+        if (count_size > file->size - position) {
+            result = E__FREAD_ERROR;
+            goto l_cleanup;
+        }
+        count = adjacency_file_get_count(&file->data[position], file->width);
+        position += count_size;
+
+        if ((0 > count) || (file->n < count)) {
+            result = E__INVALID_SIZE;
+            goto l_cleanup;
+        }
+
+        if ((size_t)count > (file->size - position) / id_size) {
+            result = E__FREAD_ERROR;
+            goto l_cleanup;
+        }
+
+        file->degrees[i] = (int)count;
+        file->positions[i] = position;
+        file->M += count;
+        position += (size_t)count * id_size;
+    }
+
+    result = E__SUCCESS;
+l_cleanup:
+
+    return result;
+}
+
+static
+result_t
+adjacency_file_index_blocks(adjacency_file_t *file, size_t position)
+{
+    result_t result = E__UNKNOWN;
+    const size_t count_size = sizeof(int64_t);
+    const unsigned char *blocks = NULL;
+    uint32_t *block_degrees = NULL;
+    int64_t block_rows = 0;
+    int64_t blocks_count = 0;
+    int64_t block_start = 0;
+    int64_t block_end = 0;
+    size_t stream_size = 0;
+    size_t rows = 0;
+    size_t r = 0;
+    int64_t b = 0;
+    int i = 0;
+
+    /* 1. The blocks' rows count, and their positions */
+    if (count_size > file->size - position) {
+        result = E__FREAD_ERROR;
+        goto l_cleanup;
+    }
+    block_rows = adjacency_file_get_count(&file->data[position], FILE_WIDTH_32);
+    position += count_size;
+
+    if ((0 >= block_rows) || (INT_MAX < block_rows)) {
+        result = E__INVALID_SIZE;
+        goto l_cleanup;
+    }
+
+    blocks_count = (file->n + block_rows - 1) / block_rows;
+    if ((size_t)blocks_count + 1 > (file->size - position) / count_size) {
+        result = E__FREAD_ERROR;
+        goto l_cleanup;
+    }
+    blocks = &file->data[position];
+    position += ((size_t)blocks_count + 1) * count_size;
+
+    block_degrees = (uint32_t *)malloc(sizeof(*block_degrees) *
+                                       (size_t)MAX(MIN(block_rows, file->n), 1));
+    if (NULL == block_degrees) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+
+    /* 2. Each block follows the previous, and its rows fill it exactly */
+    for (b = 0 ; b < blocks_count ; ++b) {
+        block_start = adjacency_file_get_count(&blocks[b * count_size], FILE_WIDTH_32);
+        block_end = adjacency_file_get_count(&blocks[(b + 1) * count_size], FILE_WIDTH_32);
+        if (((int64_t)position != block_start) ||
+            (block_end < block_start) ||
+            ((int64_t)file->size < block_end)) {
+            result = E__FREAD_ERROR;
+            goto l_cleanup;
+        }
+
+        /* 2.1. The rows' counts */
+        rows = (size_t)MIN(block_rows, file->n - b * block_rows);
+        if ((STREAM_VBYTE_CONTROL_SIZE(rows) > (size_t)block_end - position) ||
+            (STREAM_VBYTE_get_data_size(&file->data[position], rows) >
+             (size_t)block_end - position - STREAM_VBYTE_CONTROL_SIZE(rows))) {
+            result = E__FREAD_ERROR;
+            goto l_cleanup;
+        }
+        position += STREAM_VBYTE_decode(&file->data[position],
+                                        file->size - position,
+                                        rows,
+                                        block_degrees);
+
+        /* 2.2. Hop from each row's stream to the next */
+        for (r = 0 ; r < rows ; ++r, ++i) {
+            if ((uint32_t)file->n < block_degrees[r]) {
+                result = E__INVALID_SIZE;
+                goto l_cleanup;
+            }
+
+            stream_size = STREAM_VBYTE_CONTROL_SIZE(block_degrees[r]);
+            if (stream_size > (size_t)block_end - position) {
+                result = E__FREAD_ERROR;
+                goto l_cleanup;
+            }
+            stream_size += STREAM_VBYTE_get_data_size(&file->data[position],
+                                                      block_degrees[r]);
+            if (stream_size > (size_t)block_end - position) {
+                result = E__FREAD_ERROR;
+                goto l_cleanup;
+            }
+
+            file->degrees[i] = (int)block_degrees[r];
+            file->positions[i] = position;
+            file->M += block_degrees[r];
+            position += stream_size;
+        }
+
+        if ((int64_t)position != block_end) {
+            result = E__INVALID_VALUE;
+            goto l_cleanup;
+        }
+    }
+
+    result = E__SUCCESS;
+l_cleanup:
+    FREE_SAFE(block_degrees);
+
+    return result;
+}
+
+static
+result_t
+adjacency_file_decode_row(const adjacency_file_t *file, int row, int *columns)
+{
+    result_t result = E__UNKNOWN;
+    uint32_t *gaps = (uint32_t *)columns;
+    uint32_t column = 0;
+    int k = 0;
+
+    /* 1. Decode the gaps in place */
+    (void)STREAM_VBYTE_decode(&file->data[file->positions[row]],
+                              file->size - file->positions[row],
+                              (size_t)file->degrees[row],
+                              gaps);
+
+    /* 2. Sum them up. A sum that wraps around is caught as descending */
+    for (k = 0 ; k < file->degrees[row] ; ++k) {
+        column = (0 == k) ? gaps[k] : (uint32_t)columns[k - 1] + gaps[k];
+        if (((uint32_t)file->n <= column) ||
+            ((0 < k) && ((uint32_t)columns[k - 1] > column))) {
+            result = E__INVALID_ROW_INDEX;
+            goto l_cleanup;
+        }
+        columns[k] = (int)column;
+    }
+
+    result = E__SUCCESS;
+l_cleanup:
+
+    return result;
+}
+
+static
+char *
+adjacency_file_get_index_path(const char *path)
+{
+    char *index_path = NULL;
+
+    index_path = (char *)malloc(strlen(path) + sizeof(ADJACENCY_FILE_INDEX_SUFFIX));
+    if (NULL != index_path) {
+        (void)strcpy(index_path, path);
+        (void)strcat(index_path, ADJACENCY_FILE_INDEX_SUFFIX);
+    }
+
+    return index_path;
+}
+
+static
+result_t
+adjacency_file_read_index(adjacency_file_header_t *header, const char *path)
+{
+    result_t result = E__UNKNOWN;
+    adjacency_file_t *file = &header->file;
+    adjacency_file_index_t index;
+    size_t count_size = FILE_FORMAT_COUNT_SIZE(file->width);
+    size_t id_size = FILE_FORMAT_ID_SIZE(file->width);
+    uint64_t *positions = NULL;
+    char *index_path = NULL;
+    FILE *index_file = NULL;
+    uint64_t end = 0;
+    int i = 0;
+
+    /* 1. Open the sidecar */
+    index_path = adjacency_file_get_index_path(path);
+    if (NULL == index_path) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+
+    index_file = fopen(index_path, "rb");
+    if (NULL == index_file) {
+        result = E__FOPEN_ERROR;
+        goto l_cleanup;
+    }
+
+    /* 2. It must index this very file */
+    if (1 != fread(&index, sizeof(index), 1, index_file)) {
+        result = E__FREAD_ERROR;
+        goto l_cleanup;
+    }
+
+    if ((0 != memcmp(index.magic, ADJACENCY_FILE_INDEX_MAGIC, sizeof(index.magic))) ||
+        (ADJACENCY_FILE_INDEX_VERSION != index.version) ||
+        ((uint32_t)file->width != index.width) ||
+        (file->n != index.n) ||
+        ((int64_t)file->size != index.size) ||
+        (header->mtime != index.mtime)) {
+        result = E__INVALID_VALUE;
+        goto l_cleanup;
+    }
+
+    /* 3. Read the positions */
+    positions = (uint64_t *)malloc(sizeof(*positions) * ((size_t)file->n + 1));
+    if (NULL == positions) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+
+    if ((size_t)file->n + 1 != fread(positions,
+                                     sizeof(*positions),
+                                     (size_t)file->n + 1,
+                                     index_file)) {
+        result = E__FREAD_ERROR;
+        goto l_cleanup;
+    }
+
+    /* 4. Derive the degrees, every row must lie within the file */
+    file->M = 0;
+    for (i = 0 ; i < file->n ; ++i) {
+        end = (i + 1 < file->n) ? positions[i + 1] - count_size : positions[file->n];
+        if ((positions[i] < count_size) ||
+            (end < positions[i]) ||
+            (end > file->size) ||
+            (0 != (end - positions[i]) % id_size) ||
+            ((uint64_t)file->n < (end - positions[i]) / id_size)) {
+            result = E__INVALID_VALUE;
+            goto l_cleanup;
+        }
+
+        file->positions[i] = (size_t)positions[i];
+        file->degrees[i] = (int)((end - positions[i]) / id_size);
+        file->M += file->degrees[i];
+    }
+
+    result = E__SUCCESS;
+l_cleanup:
+    FCLOSE_SAFE(index_file);
+    FREE_SAFE(index_path);
+    FREE_SAFE(positions);
+
+    return result;
+}
+
+static
+void
+adjacency_file_write_index(const adjacency_file_header_t *header,
+                           const char *path)
+{
+    const adjacency_file_t *file = &header->file;
+    adjacency_file_index_t index;
+    uint64_t position = 0;
+    char *index_path = NULL;
+    FILE *index_file = NULL;
+    bool_t is_written = FALSE;
+    int i = 0;
+
+    /* 1. Open the sidecar */
+    index_path = adjacency_file_get_index_path(path);
+    if (NULL == index_path) {
+        goto l_cleanup;
+    }
+
+    index_file = fopen(index_path, "wb");
+    if (NULL == index_file) {
+        goto l_cleanup;
+    }
+
+    /* 2. Write the header */
+    (void)memset(&index, 0, sizeof(index));
+    (void)memcpy(index.magic, ADJACENCY_FILE_INDEX_MAGIC, sizeof(index.magic));
+    index.version = ADJACENCY_FILE_INDEX_VERSION;
+    index.width = (uint32_t)file->width;
+    index.n = file->n;
+    index.size = (int64_t)file->size;
+    index.mtime = header->mtime;
+    if (1 != fwrite(&index, sizeof(index), 1, index_file)) {
+        goto l_cleanup;
+    }
+
+    /* 3. Write the positions, and where the last row ends */
+    for (i = 0 ; i < file->n ; ++i) {
+        position = file->positions[i];
+        if (1 != fwrite(&position, sizeof(position), 1, index_file)) {
+            goto l_cleanup;
+        }
+    }
+
+    position = (0 == file->n) ?
+               file->size :
+               file->positions[file->n - 1] +
+               (size_t)file->degrees[file->n - 1] * FILE_FORMAT_ID_SIZE(file->width);
+    if (1 != fwrite(&position, sizeof(position), 1, index_file)) {
+        goto l_cleanup;
+    }
+
+    is_written = TRUE;
+l_cleanup:
+    FCLOSE_SAFE(index_file);
+    /* A partial sidecar would only be rejected, but is removed anyway */
+    if ((!is_written) && (NULL != index_path)) {
+        (void)remove(index_path);
+    }
+    FREE_SAFE(index_path);
+}
+
+result_t
+ADJACENCY_FILE_open(const char *path, adjacency_file_t **file_out)
+{
+    result_t result = E__UNKNOWN;
+    adjacency_file_header_t *header = NULL;
+    adjacency_text_format_t format = ADJACENCY_TEXT_get_format(path);
+    size_t position = 0;
+
+    /* 0. Input validation */
+    if ((NULL == path) || (NULL == file_out)) {
+        result = E__NULL_ARGUMENT;
+        goto l_cleanup;
+    }
+
+    /* 1. Allocate */
+    header = (adjacency_file_header_t *)malloc(sizeof(*header));
+    if (NULL == header) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+    (void)memset(header, 0, sizeof(*header));
+
+    /* 2. Map */
+    result = adjacency_file_map(header, path);
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+
+    /* 2.1. A text file is parsed to memory, then its text is released */
+    if (ADJACENCY_TEXT_FORMAT_NONE != format) {
+        result = ADJACENCY_TEXT_parse(header->file.data,
+                                      header->file.size,
+                                      format,
+                                      &header->file,
+                                      &header->columns);
+        if (E__SUCCESS != result) {
+            goto l_cleanup;
+        }
+
+        if (NULL != header->mapping) {
+            (void)munmap(header->mapping, header->mapping_size);
+            header->mapping = NULL;
+        }
+        FREE_SAFE(header->buffer);
+        goto l_success;
+    }
+
+    /* 3. Read the header */
+    result = adjacency_file_read_header(&header->file, &position);
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+
+    /* 4. Validate and index the rows, unless the sidecar indexes them.
+     *    A compressed file's blocks index it, and a stream has no sidecar */
+    if (header->file.is_compressed) {
+        result = adjacency_file_index_blocks(&header->file, position);
+        if (E__SUCCESS != result) {
+            goto l_cleanup;
+        }
+    } else if ((!ADJACENCY_FILE_INDEX_SIDECAR) ||
+               header->file.is_stream ||
+               (E__SUCCESS != adjacency_file_read_index(header, path))) {
+        result = adjacency_file_index_rows(&header->file, position);
+        if (E__SUCCESS != result) {
+            goto l_cleanup;
+        }
+
+        if (ADJACENCY_FILE_INDEX_SIDECAR && (!header->file.is_stream)) {
+            adjacency_file_write_index(header, path);
+        }
+    }
+
+l_success:
+    /* Success */
+    *file_out = &header->file;
+
+    result = E__SUCCESS;
+l_cleanup:
+    if ((E__SUCCESS != result) && (NULL != header)) {
+        ADJACENCY_FILE_close(&header->file);
+    }
+
+    return result;
+}
+
+result_t
+ADJACENCY_FILE_read_row(const adjacency_file_t *file, int row, int *columns)
+{
+    result_t result = E__UNKNOWN;
+    const unsigned char *ids = NULL;
+    int64_t wide_id = 0;
+    int k = 0;
+
+    /* 0. Input validation */
+    if ((NULL == file) || (NULL == columns)) {
+        result = E__NULL_ARGUMENT;
+        goto l_cleanup;
+    }
+
+    if ((0 > row) || (file->n <= row)) {
+        result = E__INVALID_ROW_INDEX;
+        goto l_cleanup;
+    }
+
+    if (file->is_compressed) {
+        result = adjacency_file_decode_row(file, row, columns);
+        goto l_cleanup;
+    }
+
+    ids = &file->data[file->positions[row]];
+
+    /* 1. 32-bit IDs are copied as they are, 64-bit IDs are narrowed */
+    if (FILE_WIDTH_64 != file->width) {
+        (void)memcpy(columns, ids, file->degrees[row] * sizeof(*columns));
+    } else {
+        for (k = 0 ; k < file->degrees[row] ; ++k) {
+            (void)memcpy(&wide_id, &ids[k * sizeof(wide_id)], sizeof(wide_id));
+            columns[k] = ((0 > wide_id) || (file->n <= wide_id)) ? -1 : (int)wide_id;
+        }
+    }
+
+    /* 2. Validate */
+    for (k = 0 ; k < file->degrees[row] ; ++k) {
+        if ((0 > columns[k]) || (file->n <= columns[k])) {
+            result = E__INVALID_ROW_INDEX;
+            goto l_cleanup;
+        }
+    }
+
+    result = E__SUCCESS;
+l_cleanup:
+
+    return result;
+}
+
+void
+ADJACENCY_FILE_close(adjacency_file_t *file)
+{
+    adjacency_file_header_t *header = (adjacency_file_header_t *)file;
+
+    if (NULL == file) {
+        return;
+    }
+
+    if (NULL != header->mapping) {
+        (void)munmap(header->mapping, header->mapping_size);
+    }
+    FREE_SAFE(header->buffer);
+    FREE_SAFE(header->columns);
+    FREE_SAFE(file->positions);
+    FREE_SAFE(file->degrees);
+    FREE_SAFE(header);
+}
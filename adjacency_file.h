@@ -0,0 +1,95 @@
+/**
+ * @file adjacency_file.h
+ * @purpose The rows of an adjacency input file, mapped to memory.
+ *          The file is validated in one pass over its counts, which indexes
+ *          where each row's vertex IDs begin. The IDs themselves are decoded,
+ *          and validated, only when their row is read.
+ *          A stream, stdin or a pipe, can't be mapped. It is read to memory
+ *          in a single pass instead
+ */
+#ifndef __ADJACENCY_FILE_H__
+#define __ADJACENCY_FILE_H__
+
+/* Includes **************************************************************************************/
+#include <stddef.h>
+#include <stdint.h>
+
+#include "results.h"
+#include "common.h"
+#include "file_format.h"
+
+
+/* Constants *************************************************************************************/
+/* The path that stands for stdin */
+#define ADJACENCY_FILE_STDIN ("-")
+
+
+/* Structs ***************************************************************************************/
+/**
+ * @brief An opened adjacency file
+ * @param n The vertices count
+ * @param M The total neighbors count
+ * @param width The file's width
+ * @param is_compressed Whether the file is compressed, its width is then
+ *                      FILE_WIDTH_32
+ * @param is_stream Whether the file is stdin or a pipe, which has no path to
+ *                  keep a sidecar or a cache next to
+ * @param degrees Mapping array from vertice index to its neighbors count
+ * @param positions Mapping array from vertice index to the position of its
+ *                  IDs within data, or of their stream if compressed
+ * @param data The file's contents
+ * @param size The file's size
+ */
+typedef struct adjacency_file_s {
+    int n;
+    int64_t M;
+    file_width_t width;
+    bool_t is_compressed;
+    bool_t is_stream;
+    int *degrees;
+    size_t *positions;
+    const unsigned char *data;
+    size_t size;
+} adjacency_file_t;
+
+
+/* Functions Declarations ************************************************************************/
+/*
+ * @purpose Map an adjacency file and index its rows
+ *
+ * @param path The path to the adjacency file, a pipe, or ADJACENCY_FILE_STDIN
+ * @param file_out The opened file
+ *
+ * @return One of result_t values
+ *
+ * @remark file_out must be closed using ADJACENCY_FILE_close
+ */
+result_t
+ADJACENCY_FILE_open(const char *path, adjacency_file_t **file_out);
+
+/*
+ * @purpose Decode a row's vertex IDs
+ *
+ * @param file The opened file
+ * @param row The row's index
+ * @param columns Buffer of at least degrees[row] entries, the IDs are
+ *                written to in the file's order
+ *
+ * @return One of result_t values. E__INVALID_ROW_INDEX if an ID isn't a
+ *         valid vertex index
+ */
+result_t
+ADJACENCY_FILE_read_row(const adjacency_file_t *file, int row, int *columns);
+
+/**
+ * @purpose Unmap an adjacency file
+ *
+ * @param file The file to close
+ *
+ * @remark Safe to call with NULL
+ */
+void
+ADJACENCY_FILE_close(adjacency_file_t *file);
+
+
+#endif /* __ADJACENCY_FILE_H__ */
@@ -1,112 +1,681 @@
 /**
  * @file adjacency_matrix.c
- * @purpose 
+ * @purpose
  */
 
+/* Feature test macros ***************************************************************************/
+#define _POSIX_C_SOURCE (200809L)
+
 /* Includes **************************************************************************************/
 #include <stddef.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 #include <stdint.h>
+#include <pthread.h>
+#include <unistd.h>
 
 #include "matrix.h"
 #include "common.h"
 #include "adjacency_matrix.h"
+#include "adjacency_file.h"
+#include "adjacency_cache.h"
 #include "config.h"
 #include "debug.h"
 #include "spmat_list.h"
 
+/* Constants *************************************************************************************/
+/* A thread builds at least this many cells, smaller inputs use less threads */
+#define ADJACENCY_MATRIX_MIN_CELLS_PER_THREAD (1 << 16)
+
+
+/* Structs ***************************************************************************************/
+/* A vertex and its sort key, to order the vertices by */
+typedef struct adjacency_vertex_key_s {
+    int key;
+    int vertex;
+} adjacency_vertex_key_t;
+
+/* The input's rows, relabeled, sorted and unique.
+ * Row i's columns are columns[offsets[i]] to columns[offsets[i] + lengths[i]] */
+typedef struct adjacency_rows_s {
+    size_t *offsets;
+    int *columns;
+    int *lengths;
+} adjacency_rows_t;
+
+/* A range of rows a thread reads, relabels and sorts */
+typedef struct adjacency_rows_worker_s {
+    const adjacency_file_t *file;
+    /* Mapping array from vertice index to its input index, or NULL */
+    const int *vertices;
+    /* Mapping array from input index to its vertice index, or NULL */
+    const int *labels;
+    /* The rows' columns, row i's begin at offsets[i] */
+    const size_t *offsets;
+    int *columns;
+    /* Set to the count of each row's unique columns */
+    int *lengths;
+    int begin;
+    int end;
+    pthread_t thread;
+    result_t result;
+} adjacency_rows_worker_t;
+
+
 /* Functions Declarations ***********************************************************************/
 /**
- * @purpose read neighbors of a node from input file
- * @param file - path of input file
- * @param prev_vector adj- adjecancy matrix to be made
- * @param matrix - matrix to be made
- * @param line index - index of the line to be updates
- * @param tmp_buffer - temporary buffer to hold values
+ * @purpose calculate ki/M
+ * @param adj- adjacency matrix
+ */
+static
+void
+adjacency_matrix_calculate_neighbors_div_M(adjacency_t *adj);
+
+/**
+ * @purpose Order vertices by ascending key, then by ascending index
+ * @see qsort
+ */
+static
+int
+adjacency_matrix_compare_keys(const void *key1, const void *key2);
+
+/**
+ * @purpose Order columns ascending
+ * @see qsort
+ */
+static
+int
+adjacency_matrix_compare_columns(const void *column1, const void *column2);
+
+/**
+ * @purpose Order the vertices by descending degree, so the hubs, which most
+ *          rows access, are close to each other
+ * @param adj The adjacency, whose neighbors are the input's degrees
+ * @param keys A n-sized temp buffer
+ * @param order Set to the input index of each ordered vertex
+ */
+static
+void
+adjacency_matrix_order_by_degree(const adjacency_t *adj,
+                                 adjacency_vertex_key_t *keys,
+                                 int *order);
+
+/**
+ * @purpose Order the vertices by reverse Cuthill-McKee: a breadth-first
+ *          search from a lowest degree vertex of each component, visiting
+ *          each vertex's neighbors by ascending degree. Neighbors get close
+ *          indexes, which narrows the matrix's band
+ * @param adj The adjacency, whose neighbors are the input's degrees
+ * @param file The input file
+ * @param keys A n-sized temp buffer
+ * @param order Set to the input index of each ordered vertex
+ *
  * @return One of result_t values
+ */
+static
+result_t
+adjacency_matrix_order_by_rcm(const adjacency_t *adj,
+                              const adjacency_file_t *file,
+                              adjacency_vertex_key_t *keys,
+                              int *order);
+
+/**
+ * @purpose Order the vertices accordingly to ADJACENCY_ORDER
+ * @param adj The adjacency, whose neighbors are the input's degrees. Its
+ *            vertices are set to the ordered vertices' input indexes, or
+ *            left NULL if the input's order is kept
+ * @param file The input file
  *
+ * @return One of result_t values
  */
 static
 result_t
-adjacency_matrix_read_neighbors_line(FILE * file,
-                                     adjacency_t *adj,
-                                     matrix_t *matrix,
-                                     int line_index,
-                                     double *tmp_buffer);
+adjacency_matrix_order(adjacency_t *adj, const adjacency_file_t *file);
 
 /**
- * @purpose calculate ki/M
- * @param adj- adjacency matrix
+ * @purpose Read a range of rows, relabel their columns, and sort them
+ * @param worker The range, its result is set
+ *
+ * @return One of result_t values
  */
 static
-void
-adjacency_matrix_calculate_neighbors_div_M(adjacency_t *adj);
+result_t
+adjacency_matrix_build_rows(adjacency_rows_worker_t *worker);
+
+/**
+ * @purpose adjacency_matrix_build_rows as a thread's routine
+ * @param worker The range
+ *
+ * @return NULL
+ */
+static
+void *
+adjacency_matrix_build_rows_thread(void *worker);
+
+/**
+ * @purpose Get the count of threads that build the rows
+ * @param adj The adjacency
+ *
+ * @return ADJACENCY_LOADER_THREADS, or the online CPUs if it is 0, no more
+ *         than the cells call for
+ */
+static
+int
+adjacency_matrix_get_threads_count(const adjacency_t *adj);
+
+/**
+ * @purpose Add the input's rows to the matrix in the adjacency's order,
+ *          relabeling their columns. Each row is set by its columns, so the
+ *          matrix is built in O(n + nnz). The rows are read, relabeled and
+ *          sorted by threads over disjoint ranges, then added in order
+ * @param adj The ordered adjacency
+ * @param file The input file
+ * @param matrix The matrix
+ * @param rows Set to the rows added, to be freed by the caller
+ *
+ * @return One of result_t values
+ */
+static
+result_t
+adjacency_matrix_add_rows(adjacency_t *adj,
+                          const adjacency_file_t *file,
+                          matrix_t *matrix,
+                          adjacency_rows_t *rows);
+
+/**
+ * @purpose Attach the adjacency to the input's cache, and build the matrix
+ *          out of the cached rows
+ * @param path The input file's path
+ * @param adj The adjacency, its arrays are set to the cache's
+ * @param matrix_out The matrix
+ *
+ * @return One of result_t values. Fails if there is no valid cache
+ */
+static
+result_t
+adjacency_matrix_attach_cache(const char *path,
+                              adjacency_t *adj,
+                              matrix_t **matrix_out);
 
 
 
 /* Functions ************************************************************************************/
+static
+int
+adjacency_matrix_compare_keys(const void *key1, const void *key2)
+{
+    const adjacency_vertex_key_t *first = (const adjacency_vertex_key_t *)key1;
+    const adjacency_vertex_key_t *second = (const adjacency_vertex_key_t *)key2;
+
+    if (first->key != second->key) {
+        return (first->key > second->key) ? 1 : -1;
+    }
+
+    return (first->vertex > second->vertex) - (first->vertex < second->vertex);
+}
+
+static
+int
+adjacency_matrix_compare_columns(const void *column1, const void *column2)
+{
+    int first = *(const int *)column1;
+    int second = *(const int *)column2;
+
+    return (first > second) - (first < second);
+}
+
+static
+void
+adjacency_matrix_order_by_degree(const adjacency_t *adj,
+                                 adjacency_vertex_key_t *keys,
+                                 int *order)
+{
+    int i = 0;
+
+    for (i = 0 ; i < adj->n ; ++i) {
+        keys[i].key = -adj->neighbors[i];
+        keys[i].vertex = i;
+    }
+    qsort(keys, (size_t)adj->n, sizeof(*keys), adjacency_matrix_compare_keys);
+
+    for (i = 0 ; i < adj->n ; ++i) {
+        order[i] = keys[i].vertex;
+    }
+}
+
 static
 result_t
-adjacency_matrix_read_neighbors_line(FILE *file,
-                                     adjacency_t *adj,
-                                     matrix_t *matrix,
-                                     int line_index,
-                                     double *tmp_neighbors_buffer)
+adjacency_matrix_order_by_rcm(const adjacency_t *adj,
+                              const adjacency_file_t *file,
+                              adjacency_vertex_key_t *keys,
+                              int *order)
 {
     result_t result = E__UNKNOWN;
-    size_t result_fread = 0;
-    int number_of_edges = 0;
+    adjacency_vertex_key_t *neighbors = NULL;
+    int *columns = NULL;
+    bool_t *is_visited = NULL;
+    int neighbors_count = 0;
+    int head = 0;
+    int tail = 0;
+    int start = 0;
+    int vertex = 0;
     int i = 0;
-    int current_edge = 0;
-
-    /* 1. Read number of edges n */
-    result_fread = fread((void *)&number_of_edges,
-                         1,
-                         sizeof(number_of_edges),
-                         file);
-    if (1 > result_fread) {
-        result = E__FREAD_ERROR;
-        goto l_cleanup;
-    }
-
-    /* 2. Save number of neighbors */
-    adj->neighbors[line_index] = number_of_edges;
-    adj->M += number_of_edges;
-
-    /* 3. Zero the neighbors buffer */
-    (void)memset(tmp_neighbors_buffer,
-                 0,
-                 sizeof(*tmp_neighbors_buffer) * adj->n);
-
-    /* 4. Read all edges */
-    for (i = 0 ; i < number_of_edges ; ++i) {
-        /* 4.1. Read current edge */
-        result_fread = fread((void *)&current_edge,
-                             1,
-                             sizeof(current_edge),
-                             file);
-        if (1 > result_fread) {
-            result = E__FREAD_ERROR;
+    int k = 0;
+
+    is_visited = (bool_t *)calloc(MAX(adj->n, 1), sizeof(*is_visited));
+    if (NULL == is_visited) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+
+    neighbors = (adjacency_vertex_key_t *)malloc(MAX(adj->n, 1) *
+                                                 sizeof(*neighbors));
+    if (NULL == neighbors) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+
+    columns = (int *)malloc(MAX(adj->n, 1) * sizeof(*columns));
+    if (NULL == columns) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+
+    /* 1. The vertices by ascending degree, each component's search starts
+     *    at its first unvisited one */
+    for (i = 0 ; i < adj->n ; ++i) {
+        keys[i].key = adj->neighbors[i];
+        keys[i].vertex = i;
+    }
+    qsort(keys, (size_t)adj->n, sizeof(*keys), adjacency_matrix_compare_keys);
+
+    /* 2. Breadth-first search, the queue is the order itself */
+    for (start = 0 ; start < adj->n ; ++start) {
+        if (is_visited[keys[start].vertex]) {
+            continue;
+        }
+        is_visited[keys[start].vertex] = TRUE;
+        order[tail] = keys[start].vertex;
+        ++tail;
+
+        for ( ; head < tail ; ++head) {
+            /* 2.1. Queue the unvisited neighbors by ascending degree */
+            vertex = order[head];
+            result = ADJACENCY_FILE_read_row(file, vertex, columns);
+            if (E__SUCCESS != result) {
+                goto l_cleanup;
+            }
+
+            neighbors_count = 0;
+            for (k = 0 ; k < file->degrees[vertex] ; ++k) {
+                if (!is_visited[columns[k]]) {
+                    is_visited[columns[k]] = TRUE;
+                    neighbors[neighbors_count].key = adj->neighbors[columns[k]];
+                    neighbors[neighbors_count].vertex = columns[k];
+                    ++neighbors_count;
+                }
+            }
+            qsort(neighbors,
+                  (size_t)neighbors_count,
+                  sizeof(*neighbors),
+                  adjacency_matrix_compare_keys);
+            for (k = 0 ; k < neighbors_count ; ++k) {
+                order[tail] = neighbors[k].vertex;
+                ++tail;
+            }
+        }
+    }
+
+    /* 3. Reverse */
+    for (i = 0 ; i < adj->n / 2 ; ++i) {
+        vertex = order[i];
+        order[i] = order[adj->n - 1 - i];
+        order[adj->n - 1 - i] = vertex;
+    }
+
+    result = E__SUCCESS;
+l_cleanup:
+    FREE_SAFE(columns);
+    FREE_SAFE(neighbors);
+    FREE_SAFE(is_visited);
+
+    return result;
+}
+
+static
+result_t
+adjacency_matrix_order(adjacency_t *adj, const adjacency_file_t *file)
+{
+    result_t result = E__UNKNOWN;
+    adjacency_vertex_key_t *keys = NULL;
+    int *vertices = NULL;
+
+    /* 1. Nothing to do if the input's order is kept */
+    if (ADJACENCY_ORDER_INPUT == ADJACENCY_ORDER) {
+        result = E__SUCCESS;
+        goto l_cleanup;
+    }
+
+    vertices = (int *)malloc(MAX(adj->n, 1) * sizeof(*vertices));
+    if (NULL == vertices) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+
+    keys = (adjacency_vertex_key_t *)malloc(MAX(adj->n, 1) * sizeof(*keys));
+    if (NULL == keys) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+
+    /* 2. Order */
+    switch (ADJACENCY_ORDER)
+    {
+    case ADJACENCY_ORDER_DEGREE:
+        adjacency_matrix_order_by_degree(adj, keys, vertices);
+        break;
+    case ADJACENCY_ORDER_RCM:
+        result = adjacency_matrix_order_by_rcm(adj, file, keys, vertices);
+        if (E__SUCCESS != result) {
             goto l_cleanup;
         }
+        break;
+    default:
+        result = E__INVALID_VALUE;
+        goto l_cleanup;
+    }
 
-        /* 4.2. Assign 1 to edge */
-        tmp_neighbors_buffer[current_edge] = 1.0;
+    adj->vertices = vertices;
+    vertices = NULL;
+
+    result = E__SUCCESS;
+l_cleanup:
+    FREE_SAFE(keys);
+    FREE_SAFE(vertices);
+
+    return result;
+}
+
+static
+result_t
+adjacency_matrix_build_rows(adjacency_rows_worker_t *worker)
+{
+    result_t result = E__UNKNOWN;
+    const adjacency_file_t *file = worker->file;
+    int *columns = NULL;
+    bool_t is_sorted = TRUE;
+    int length = 0;
+    int vertex = 0;
+    int i = 0;
+    int k = 0;
+
+    for (i = worker->begin ; i < worker->end ; ++i) {
+        vertex = (NULL != worker->vertices) ? worker->vertices[i] : i;
+        columns = &worker->columns[worker->offsets[i]];
+
+        /* 1. Read and relabel the row */
+        result = ADJACENCY_FILE_read_row(file, vertex, columns);
+        if (E__SUCCESS != result) {
+            goto l_cleanup;
+        }
+
+        is_sorted = TRUE;
+        for (k = 0 ; k < file->degrees[vertex] ; ++k) {
+            if (NULL != worker->labels) {
+                columns[k] = worker->labels[columns[k]];
+            }
+            if ((0 < k) && (columns[k - 1] >= columns[k])) {
+                is_sorted = FALSE;
+            }
+        }
+
+        /* 2. Sort, and drop repeated columns, unless the row is ascending */
+        length = file->degrees[vertex];
+        if (!is_sorted) {
+            qsort(columns,
+                  (size_t)length,
+                  sizeof(*columns),
+                  adjacency_matrix_compare_columns);
+
+            length = 0;
+            for (k = 0 ; k < file->degrees[vertex] ; ++k) {
+                if ((0 == length) || (columns[length - 1] != columns[k])) {
+                    columns[length] = columns[k];
+                    ++length;
+                }
+            }
+        }
+        worker->lengths[i] = length;
+    }
+
+    result = E__SUCCESS;
+l_cleanup:
+    worker->result = result;
+
+    return result;
+}
+
+static
+void *
+adjacency_matrix_build_rows_thread(void *worker)
+{
+    (void)adjacency_matrix_build_rows((adjacency_rows_worker_t *)worker);
+
+    return NULL;
+}
+
+static
+int
+adjacency_matrix_get_threads_count(const adjacency_t *adj)
+{
+    long threads_count = ADJACENCY_LOADER_THREADS;
+
+    if (0 >= threads_count) {
+        threads_count = sysconf(_SC_NPROCESSORS_ONLN);
+    }
+
+    if (adj->M / ADJACENCY_MATRIX_MIN_CELLS_PER_THREAD + 1 < threads_count) {
+        threads_count = (long)(adj->M / ADJACENCY_MATRIX_MIN_CELLS_PER_THREAD + 1);
+    }
+
+    return (int)MAX(threads_count, 1);
+}
+
+static
+result_t
+adjacency_matrix_add_rows(adjacency_t *adj,
+                          const adjacency_file_t *file,
+                          matrix_t *matrix,
+                          adjacency_rows_t *rows)
+{
+    result_t result = E__UNKNOWN;
+    adjacency_rows_worker_t *workers = NULL;
+    size_t *offsets = NULL;
+    int *columns = NULL;
+    int *lengths = NULL;
+    int *labels = NULL;
+    int threads_count = adjacency_matrix_get_threads_count(adj);
+    int started_count = 0;
+    int vertex = 0;
+    int i = 0;
+    int t = 0;
+
+    /* 1. Allocations */
+    offsets = (size_t *)malloc(((size_t)adj->n + 1) * sizeof(*offsets));
+    rows->offsets = offsets;
+    if (NULL == offsets) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+
+    columns = (int *)malloc((size_t)MAX(adj->M, 1) * sizeof(*columns));
+    rows->columns = columns;
+    if (NULL == columns) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+
+    lengths = (int *)malloc(MAX(adj->n, 1) * sizeof(*lengths));
+    rows->lengths = lengths;
+    if (NULL == lengths) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+
+    workers = (adjacency_rows_worker_t *)malloc(threads_count * sizeof(*workers));
+    if (NULL == workers) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+
+    /* 2. Map each input vertex to its new label */
+    if (NULL != adj->vertices) {
+        labels = (int *)malloc(MAX(adj->n, 1) * sizeof(*labels));
+        if (NULL == labels) {
+            result = E__MALLOC_ERROR;
+            goto l_cleanup;
+        }
+        for (i = 0 ; i < adj->n ; ++i) {
+            labels[adj->vertices[i]] = i;
+        }
+    }
+
+    /* 3. Each row's columns begin after the previous row's, in the new order */
+    offsets[0] = 0;
+    for (i = 0 ; i < adj->n ; ++i) {
+        vertex = (NULL != adj->vertices) ? adj->vertices[i] : i;
+        offsets[i + 1] = offsets[i] + (size_t)file->degrees[vertex];
+    }
+
+    /* 4. Split the rows into ranges of about the same cells count */
+    i = 0;
+    for (t = 0 ; t < threads_count ; ++t) {
+        workers[t].file = file;
+        workers[t].vertices = adj->vertices;
+        workers[t].labels = labels;
+        workers[t].offsets = offsets;
+        workers[t].columns = columns;
+        workers[t].lengths = lengths;
+        workers[t].begin = i;
+        while ((i < adj->n) &&
+               (offsets[i] < (size_t)(adj->M / threads_count) * (t + 1))) {
+            ++i;
+        }
+        workers[t].end = (threads_count - 1 == t) ? adj->n : i;
+        workers[t].result = E__UNKNOWN;
+    }
+
+    /* 5. Build the ranges, the first one on this thread. A range whose
+     *    thread can't be started is built here as well */
+    for (t = 1 ; t < threads_count ; ++t) {
+        if (0 != pthread_create(&workers[t].thread,
+                                NULL,
+                                adjacency_matrix_build_rows_thread,
+                                &workers[t])) {
+            break;
+        }
+        ++started_count;
+    }
+
+    (void)adjacency_matrix_build_rows(&workers[0]);
+    for (t = started_count + 1 ; t < threads_count ; ++t) {
+        (void)adjacency_matrix_build_rows(&workers[t]);
+    }
+
+    for (t = 1 ; t <= started_count ; ++t) {
+        (void)pthread_join(workers[t].thread, NULL);
     }
 
-    /* 4. Set row in matrix */
-    result = MATRIX_ADD_ROW(matrix,
-                            tmp_neighbors_buffer,
-                            line_index);
+    for (t = 0 ; t < threads_count ; ++t) {
+        if (E__SUCCESS != workers[t].result) {
+            result = workers[t].result;
+            goto l_cleanup;
+        }
+    }
+
+    /* 6. Set the rows in matrix */
+    for (i = 0 ; i < adj->n ; ++i) {
+        result = MATRIX_ADD_PATTERN_ROW(matrix, &columns[offsets[i]], lengths[i], i);
+        if (E__SUCCESS != result) {
+            goto l_cleanup;
+        }
+    }
+
+    /* 7. The degrees follow their vertices */
+    if (NULL != adj->vertices) {
+        for (i = 0 ; i < adj->n ; ++i) {
+            labels[i] = adj->neighbors[adj->vertices[i]];
+        }
+        (void)memcpy(adj->neighbors, labels, adj->n * sizeof(*labels));
+    }
+
+    result = E__SUCCESS;
+l_cleanup:
+    FREE_SAFE(labels);
+    FREE_SAFE(workers);
+
+    return result;
+}
+
+static
+result_t
+adjacency_matrix_attach_cache(const char *path,
+                              adjacency_t *adj,
+                              matrix_t **matrix_out)
+{
+    result_t result = E__UNKNOWN;
+    adjacency_cache_t *cache = NULL;
+    matrix_t *matrix = NULL;
+    int i = 0;
+
+    /* 1. Attach */
+    result = ADJACENCY_CACHE_open(path, &cache);
     if (E__SUCCESS != result) {
         goto l_cleanup;
     }
-    
+
+    /* 2. Build the matrix out of the cached rows, which are set as they are.
+     *    The backend validates each row, so a corrupted cache fails here */
+    result = MATRIX_create_matrix(cache->n, MOD_MATRIX_TYPE, &matrix);
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+
+    for (i = 0 ; i < cache->n ; ++i) {
+        if ((uint64_t)cache->n < cache->offsets[i + 1] - cache->offsets[i]) {
+            result = E__INVALID_VALUE;
+            goto l_cleanup;
+        }
+
+        result = MATRIX_ADD_PATTERN_ROW(matrix,
+                                        &cache->columns[cache->offsets[i]],
+                                        (int)(cache->offsets[i + 1] - cache->offsets[i]),
+                                        i);
+        if (E__SUCCESS != result) {
+            goto l_cleanup;
+        }
+    }
+
+    /* 3. The adjacency's arrays are the cache's */
+    adj->n = cache->n;
+    adj->M = cache->M;
+    adj->width = cache->width;
+    adj->neighbors = (int *)cache->neighbors;
+    adj->neighbors_div_M = (double *)cache->neighbors_div_M;
+    adj->vertices = (int *)cache->vertices;
+    adj->cache = cache;
+    cache = NULL;
+
+    /* Success */
+    *matrix_out = matrix;
 
     result = E__SUCCESS;
 l_cleanup:
+    if (E__SUCCESS != result) {
+        MATRIX_FREE_SAFE(matrix);
+    }
+    ADJACENCY_CACHE_close(cache);
 
     return result;
 }
@@ -119,11 +688,8 @@ ADJACENCY_MATRIX_open(const char *path,
     result_t result = E__UNKNOWN;
     adjacency_t *adj = NULL;
     matrix_t *matrix = NULL;
-    int matrix_n = 0 ;
-    FILE *file = NULL;
-    size_t result_fread = 0;
-    double *tmp_neighbors_buffer = NULL;
-    int i = 0;
+    adjacency_file_t *file = NULL;
+    adjacency_rows_t rows = {NULL, NULL, NULL};
 
     /* 1. Allocate adj adj */
     adj = (adjacency_t *)malloc(sizeof(*adj));
@@ -133,67 +699,66 @@ ADJACENCY_MATRIX_open(const char *path,
     }
     (void)memset(adj, 0, sizeof(*adj));
 
-    /* 2. Open adj file */
-    file = fopen(path, "rb");
-    if (NULL == file) {
-        result = E__FOPEN_ERROR;
-        goto l_cleanup;
-    }
-
-    /* 3. Read adj n */
-    result_fread = fread((void *)&matrix_n, 1, sizeof(matrix_n), file);
-    if (1 > result_fread) {
-        result = E__FREAD_ERROR;
-        goto l_cleanup;
+    /* 1.1. Attach to the input's cache, if it was built */
+    if (ADJACENCY_CACHE &&
+        (E__SUCCESS == adjacency_matrix_attach_cache(path, adj, &matrix))) {
+        goto l_success;
     }
 
-    /* 4. Allocations */
-    /* 4.1. Allocate adj */
-    result = MATRIX_create_matrix(matrix_n,
-                                  MATRIX_TYPE_SPMAT_LIST,
-                                  &matrix);
+    /* 2. Map adj file, validating and indexing its rows */
+    result = ADJACENCY_FILE_open(path, &file);
     if (E__SUCCESS != result) {
         goto l_cleanup;
     }
 
-    /* 4.2. Allocate neighbors array */
-    adj->n = matrix_n;
-    adj->neighbors = (int *)malloc(sizeof(*(adj->neighbors)) * matrix_n);
+    adj->n = file->n;
+    adj->M = file->M;
+    adj->width = file->width;
+
+    /* 3. Allocations */
+    /* 3.1. Allocate neighbors array, the degrees are reordered later */
+    adj->neighbors = (int *)malloc(sizeof(*(adj->neighbors)) * MAX(adj->n, 1));
     if (NULL == adj->neighbors) {
         result = E__MALLOC_ERROR;
         goto l_cleanup;
     }
+    (void)memcpy(adj->neighbors, file->degrees, sizeof(*(adj->neighbors)) * adj->n);
 
     adj->neighbors_div_M = (double *)malloc(sizeof(*(adj->neighbors_div_M)) *
-                                         matrix_n);
+                                            MAX(adj->n, 1));
     if (NULL == adj->neighbors_div_M) {
         result = E__MALLOC_ERROR;
         goto l_cleanup;
     }
 
-    /* 5. Initialize each line */
-    /* 5.1. Allocate temporary neighbors buffer */
-    tmp_neighbors_buffer = (double *)malloc(sizeof(*tmp_neighbors_buffer) *
-                                            matrix_n);
-    if (NULL == tmp_neighbors_buffer) {
-        result = E__MALLOC_ERROR;
+    /* 4. Order the vertices */
+    result = adjacency_matrix_order(adj, file);
+    if (E__SUCCESS != result) {
         goto l_cleanup;
     }
 
-    for (i = 0 ; i < matrix_n ; ++i) {
-        result = adjacency_matrix_read_neighbors_line(file,
-                                                      adj,
-                                                      matrix,
-                                                      i,
-                                                      tmp_neighbors_buffer);
-        if (E__SUCCESS != result) {
-            goto l_cleanup;
-        }
+    /* 5. Build the matrix in the vertices' order */
+    result = MATRIX_create_matrix(adj->n,
+                                  MOD_MATRIX_TYPE,
+                                  &matrix);
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+
+    result = adjacency_matrix_add_rows(adj, file, matrix, &rows);
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
     }
 
     /* 6. Calculate neighbosr div M for optimization */
     adjacency_matrix_calculate_neighbors_div_M(adj);
 
+    /* 7. Cache the adjacency for the next runs. A failure only misses it */
+    if (ADJACENCY_CACHE) {
+        (void)ADJACENCY_CACHE_write(path, adj, rows.offsets, rows.columns, rows.lengths);
+    }
+
+l_success:
     /* Success */
     *adj_out = adj;
     *matrix_out = matrix;
@@ -202,9 +767,12 @@ ADJACENCY_MATRIX_open(const char *path,
 l_cleanup:
     if (E__SUCCESS != result) {
         ADJACENCY_MATRIX_free(adj);
+        MATRIX_FREE_SAFE(matrix);
     }
-    FCLOSE_SAFE(file);
-    FREE_SAFE(tmp_neighbors_buffer);
+    ADJACENCY_FILE_close(file);
+    FREE_SAFE(rows.lengths);
+    FREE_SAFE(rows.columns);
+    FREE_SAFE(rows.offsets);
 
     return result;
 }
@@ -212,6 +780,20 @@ l_cleanup:
 void
 ADJACENCY_MATRIX_free(adjacency_t *adj)
 {
+    if (NULL == adj) {
+        return;
+    }
+
+    /* The arrays of an attached cache are its own */
+    if (NULL != adj->cache) {
+        ADJACENCY_CACHE_close(adj->cache);
+        adj->cache = NULL;
+        adj->vertices = NULL;
+        adj->neighbors_div_M = NULL;
+        adj->neighbors = NULL;
+    }
+
+    FREE_SAFE(adj->vertices);
     FREE_SAFE(adj->neighbors_div_M);
     FREE_SAFE(adj->neighbors);
     adj->n = 0;
@@ -227,6 +809,6 @@ adjacency_matrix_calculate_neighbors_div_M(adjacency_t *adj)
     int i = 0;
 
     for (i = 0 ; i < adj->n ; ++i) {
-        adj->neighbors_div_M[i] = (double)adj->neighbors[i] / adj->M;
+        adj->neighbors_div_M[i] = (double)adj->neighbors[i] / (double)adj->M;
     }
 }
@@ -10,24 +10,50 @@
 #include "results.h"
 #include "common.h"
 #include "matrix.h"
+#include "file_format.h"
 
 
 /* Macros ****************************************************************************************/
 /* Number of elements on the adjacency_matrix */
 
 
+/* Enums *****************************************************************************************/
+/* The order the vertices are relabeled to after they are read */
+typedef enum adjacency_order_e {
+    /* Keep the input's order */
+    ADJACENCY_ORDER_INPUT = 0,
+    /* Descending degree, the hubs first */
+    ADJACENCY_ORDER_DEGREE,
+    /* Reverse Cuthill-McKee, narrowing the matrix's band */
+    ADJACENCY_ORDER_RCM,
+
+    ADJACENCY_ORDER_MAX
+} adjacency_order_t;
+
+
 /* Structs ***************************************************************************************/
+/* See adjacency_cache.h */
+struct adjacency_cache_s;
+
 /**
  * @brief The adjacency data
  * @param neighbors neighbors buffer length
  * @param neighbors Mapping array from vertice index to its neighbors count
  * @param M The total neighbors count (equals edges count times 2)
+ * @param vertices Mapping array from vertice index to its index in the input
+ *                 file, or NULL if the input's order was kept
+ * @param width The input file's width, the output is written with
+ * @param cache The cache the arrays are mapped from, or NULL if they are
+ *              allocated
  */
 typedef struct adjacency_s {
     int n;
     int *neighbors;
     double *neighbors_div_M;
-    int M;
+    int64_t M;
+    int *vertices;
+    file_width_t width;
+    struct adjacency_cache_s *cache;
 } adjacency_t;
 
 
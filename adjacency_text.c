@@ -0,0 +1,1063 @@
+/**
+ * @file adjacency_text.c
+ * @purpose Parse a text graph into the rows of an adjacency file
+ */
+
+/* Feature test macros ***************************************************************************/
+#define _POSIX_C_SOURCE (200809L)
+
+/* Includes **************************************************************************************/
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "results.h"
+#include "common.h"
+#include "config.h"
+#include "file_format.h"
+#include "adjacency_file.h"
+#include "adjacency_text.h"
+
+
+/* Constants *************************************************************************************/
+/* The least text a parsing thread is started for */
+#define ADJACENCY_TEXT_MIN_BYTES_PER_THREAD (1 << 20)
+
+/* The least cells a sorting thread is started for */
+#define ADJACENCY_TEXT_MIN_CELLS_PER_THREAD (1 << 16)
+
+/* Rows up to this length are insertion sorted, longer rows by qsort */
+#define ADJACENCY_TEXT_INSERTION_SORT_MAX (32)
+
+/* The edges a parsing thread has room for at first */
+#define ADJACENCY_TEXT_INITIAL_EDGES (1024)
+
+/* The largest vertex ID, so that the vertices count is a valid n */
+#define ADJACENCY_TEXT_MAX_ID (INT_MAX - 2)
+
+#define ADJACENCY_TEXT_MATRIX_MARKET_BANNER ("%%MatrixMarket")
+#define ADJACENCY_TEXT_MATRIX_MARKET_COORDINATE ("coordinate")
+
+
+/* Macros ****************************************************************************************/
+#define ADJACENCY_TEXT_IS_DIGIT(c) (('0' <= (c)) && ('9' >= (c)))
+#define ADJACENCY_TEXT_IS_BLANK(c) ((' ' == (c)) || ('\t' == (c)) || ('\r' == (c)))
+
+/* The flags of a METIS header's fmt, one a decimal digit */
+#define ADJACENCY_TEXT_METIS_HAS_EDGE_WEIGHTS(fmt) (0 != (fmt) % 10)
+#define ADJACENCY_TEXT_METIS_HAS_VERTEX_WEIGHTS(fmt) (0 != ((fmt) / 10) % 10)
+#define ADJACENCY_TEXT_METIS_HAS_VERTEX_SIZES(fmt) (0 != ((fmt) / 100) % 10)
+
+
+/* Enums *****************************************************************************************/
+typedef enum adjacency_text_stage_e {
+    /* Count the vertices' lines of a METIS graph */
+    ADJACENCY_TEXT_STAGE_COUNT_LINES = 0,
+    /* Parse the lines' edges */
+    ADJACENCY_TEXT_STAGE_PARSE,
+    /* Sort each row, and drop its repeated IDs */
+    ADJACENCY_TEXT_STAGE_SORT,
+} adjacency_text_stage_t;
+
+
+/* Structs ***************************************************************************************/
+/* The text, as its header describes it. Shared by the threads */
+typedef struct adjacency_text_s {
+    adjacency_text_format_t format;
+    /* The lines that follow the header */
+    const unsigned char *body;
+    const unsigned char *end;
+    /* The vertices count. An edge list's is only known once it is parsed */
+    int64_t n;
+    /* The first vertex's ID */
+    int64_t base;
+    /* A METIS line's leading values, which aren't neighbors */
+    int metis_skipped;
+    /* Whether a METIS line's neighbors are each followed by its weight */
+    bool_t metis_has_weights;
+    /* The rows being sorted: row i's IDs begin at columns[offsets[i]] */
+    adjacency_file_t *file;
+    const size_t *offsets;
+    int *columns;
+} adjacency_text_t;
+
+/* The work of a thread, at one of the stages */
+typedef struct adjacency_text_worker_s {
+    const adjacency_text_t *text;
+    adjacency_text_stage_t stage;
+    /* The lines to count or parse */
+    const unsigned char *begin;
+    const unsigned char *end;
+    /* A METIS graph's vertex of the first line, and the count of lines */
+    int64_t first_vertex;
+    int64_t lines_count;
+    /* The parsed edges, as pairs of IDs, and the largest ID */
+    int *edges;
+    size_t edges_count;
+    size_t edges_capacity;
+    int64_t max_id;
+    /* The rows to sort */
+    int begin_row;
+    int end_row;
+    pthread_t thread;
+    result_t result;
+} adjacency_text_worker_t;
+
+/* A text format, by its file's extension */
+typedef struct adjacency_text_extension_s {
+    const char *extension;
+    adjacency_text_format_t format;
+} adjacency_text_extension_t;
+
+
+/* Globals ***************************************************************************************/
+static const adjacency_text_extension_t adjacency_text_extensions[] = {
+    {".el", ADJACENCY_TEXT_FORMAT_EDGE_LIST},
+    {".edges", ADJACENCY_TEXT_FORMAT_EDGE_LIST},
+    {".txt", ADJACENCY_TEXT_FORMAT_EDGE_LIST},
+    {".graph", ADJACENCY_TEXT_FORMAT_METIS},
+    {".metis", ADJACENCY_TEXT_FORMAT_METIS},
+    {".mtx", ADJACENCY_TEXT_FORMAT_MATRIX_MARKET},
+};
+
+
+/* Functions Declarations ************************************************************************/
+/**
+ * @purpose Compare two columns, for qsort
+ * @param a The first column
+ * @param b The second column
+ *
+ * @return Negative, zero or positive as a is less than, equal to or greater than b
+ */
+static
+int
+adjacency_text_compare_columns(const void *a, const void *b);
+
+/**
+ * @purpose Get the count of threads to split work between
+ * @param work The work's size
+ * @param min_work The least work a thread is started for
+ *
+ * @return The threads count, at least 1
+ */
+static
+int
+adjacency_text_get_threads_count(size_t work, size_t min_work);
+
+/**
+ * @purpose Find the end of a line
+ * @param line The line
+ * @param end The text's end
+ *
+ * @return The line's newline, or end if it is the last line
+ */
+static
+const unsigned char *
+adjacency_text_get_line_end(const unsigned char *line, const unsigned char *end);
+
+/**
+ * @purpose Skip blanks, but newlines
+ * @param cursor The position to skip from
+ * @param end The line's end
+ *
+ * @return The first position that isn't blank
+ */
+static
+const unsigned char *
+adjacency_text_skip_blanks(const unsigned char *cursor, const unsigned char *end);
+
+/**
+ * @purpose Check whether a line is a comment, by the text's format
+ * @param line The line
+ * @param end The line's end
+ * @param format The text's format
+ *
+ * @return TRUE if the line is a comment
+ */
+static
+bool_t
+adjacency_text_is_comment(const unsigned char *line,
+                          const unsigned char *end,
+                          adjacency_text_format_t format);
+
+/**
+ * @purpose Parse a non-negative decimal number, delimited by blanks
+ * @param cursor The position to parse from, moved past the number
+ * @param end The line's end
+ * @param value_out The number, any above INT_MAX is parsed as INT_MAX + 1
+ *
+ * @return TRUE if a number was parsed
+ */
+static
+bool_t
+adjacency_text_parse_number(const unsigned char **cursor,
+                            const unsigned char *end,
+                            int64_t *value_out);
+
+/**
+ * @purpose Check whether a line holds a word
+ * @param line The line
+ * @param end The line's end
+ * @param word The word
+ *
+ * @return TRUE if the word is found within the line
+ */
+static
+bool_t
+adjacency_text_has_word(const unsigned char *line,
+                        const unsigned char *end,
+                        const char *word);
+
+/**
+ * @purpose Parse the text's header, if its format has one
+ * @param text The text, whose format, body and end are set. Its header's
+ *             details are set
+ *
+ * @return One of result_t values
+ */
+static
+result_t
+adjacency_text_parse_header(adjacency_text_t *text);
+
+/**
+ * @purpose Add an edge to a thread's edges
+ * @param worker The thread's work
+ * @param u The edge's first ID, by the text's base
+ * @param v The edge's second ID, by the text's base
+ *
+ * @return One of result_t values. E__INVALID_ROW_INDEX if an ID isn't a
+ *         valid vertex
+ */
+static
+result_t
+adjacency_text_add_edge(adjacency_text_worker_t *worker, int64_t u, int64_t v);
+
+/**
+ * @purpose Parse a METIS vertex's line
+ * @param worker The thread's work
+ * @param line The line
+ * @param end The line's end
+ * @param vertex The line's vertex
+ *
+ * @return One of result_t values
+ */
+static
+result_t
+adjacency_text_parse_metis_line(adjacency_text_worker_t *worker,
+                                const unsigned char *line,
+                                const unsigned char *end,
+                                int64_t vertex);
+
+/**
+ * @purpose Count or parse a thread's lines, by its stage
+ * @param worker The thread's work
+ *
+ * @return One of result_t values
+ */
+static
+result_t
+adjacency_text_parse_lines(adjacency_text_worker_t *worker);
+
+/**
+ * @purpose Sort a thread's rows, dropping their repeated IDs
+ * @param worker The thread's work
+ *
+ * @return One of result_t values
+ */
+static
+result_t
+adjacency_text_sort_rows(adjacency_text_worker_t *worker);
+
+/**
+ * @purpose Do a thread's work, by its stage
+ * @param worker The thread's work, whose result is set
+ *
+ * @return One of result_t values
+ */
+static
+result_t
+adjacency_text_work(adjacency_text_worker_t *worker);
+
+/**
+ * @purpose pthread start routine of adjacency_text_work
+ * @param worker The thread's work
+ *
+ * @return NULL, the result is set in worker
+ */
+static
+void *
+adjacency_text_work_thread(void *worker);
+
+/**
+ * @purpose Do the threads' work, the first on this thread. Work whose thread
+ *          can't be started is done here as well
+ * @param workers The threads' work
+ * @param workers_count The threads count
+ *
+ * @return One of result_t values, the first failure of the threads'
+ */
+static
+result_t
+adjacency_text_run(adjacency_text_worker_t *workers, int workers_count);
+
+/**
+ * @purpose Split the text's body between threads, on lines' ends
+ * @param text The text
+ * @param workers The threads' work, whose lines are set
+ * @param workers_count The threads count
+ */
+static
+void
+adjacency_text_split_lines(const adjacency_text_t *text,
+                           adjacency_text_worker_t *workers,
+                           int workers_count);
+
+/**
+ * @purpose Build the rows out of the parsed edges, each edge both ways, and
+ *          sort them by threads
+ * @param text The parsed text
+ * @param workers The parsing threads' work, whose edges are freed
+ * @param workers_count The parsing threads count
+ * @param file The file whose rows are set
+ * @param columns_out The rows' IDs
+ *
+ * @return One of result_t values
+ */
+static
+result_t
+adjacency_text_build_rows(adjacency_text_t *text,
+                          adjacency_text_worker_t *workers,
+                          int workers_count,
+                          adjacency_file_t *file,
+                          int **columns_out);
+
+
+/* Functions *************************************************************************************/
+static
+int
+adjacency_text_compare_columns(const void *a, const void *b)
+{
+    int column_a = *(const int *)a;
+    int column_b = *(const int *)b;
+
+    return (column_a > column_b) - (column_a < column_b);
+}
+
+static
+int
+adjacency_text_get_threads_count(size_t work, size_t min_work)
+{
+    long threads_count = ADJACENCY_LOADER_THREADS;
+
+    if (0 >= threads_count) {
+        threads_count = sysconf(_SC_NPROCESSORS_ONLN);
+    }
+
+    if ((long)(work / min_work) + 1 < threads_count) {
+        threads_count = (long)(work / min_work) + 1;
+    }
+
+    return (int)MAX(threads_count, 1);
+}
+
+static
+const unsigned char *
+adjacency_text_get_line_end(const unsigned char *line, const unsigned char *end)
+{
+    const unsigned char *line_end = NULL;
+
+    line_end = (const unsigned char *)memchr(line, '\n', (size_t)(end - line));
+
+    return (NULL != line_end) ? line_end : end;
+}
+
+static
+const unsigned char *
+adjacency_text_skip_blanks(const unsigned char *cursor, const unsigned char *end)
+{
+    while ((cursor < end) && ADJACENCY_TEXT_IS_BLANK(*cursor)) {
+        ++cursor;
+    }
+
+    return cursor;
+}
+
+static
+bool_t
+adjacency_text_is_comment(const unsigned char *line,
+                          const unsigned char *end,
+                          adjacency_text_format_t format)
+{
+    line = adjacency_text_skip_blanks(line, end);
+    if (line == end) {
+        return FALSE;
+    }
+
+    return ('%' == *line) ||
+           ((ADJACENCY_TEXT_FORMAT_EDGE_LIST == format) && ('#' == *line));
+}
+
+static
+bool_t
+adjacency_text_parse_number(const unsigned char **cursor,
+                            const unsigned char *end,
+                            int64_t *value_out)
+{
+    const unsigned char *position = adjacency_text_skip_blanks(*cursor, end);
+    int64_t value = 0;
+
+    if ((position == end) || (!ADJACENCY_TEXT_IS_DIGIT(*position))) {
+        return FALSE;
+    }
+
+    for ( ; (position < end) && ADJACENCY_TEXT_IS_DIGIT(*position) ; ++position) {
+        value = (INT_MAX < value) ? value : value * 10 + (*position - '0');
+    }
+
+    if ((position < end) && (!ADJACENCY_TEXT_IS_BLANK(*position))) {
+        return FALSE;
+    }
+
+    *cursor = position;
+    *value_out = MIN(value, (int64_t)INT_MAX + 1);
+
+    return TRUE;
+}
+
+static
+bool_t
+adjacency_text_has_word(const unsigned char *line,
+                        const unsigned char *end,
+                        const char *word)
+{
+    size_t length = strlen(word);
+
+    for ( ; (size_t)(end - line) >= length ; ++line) {
+        if (0 == memcmp(line, word, length)) {
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+static
+result_t
+adjacency_text_parse_header(adjacency_text_t *text)
+{
+    result_t result = E__UNKNOWN;
+    const unsigned char *line = text->body;
+    const unsigned char *line_end = NULL;
+    const unsigned char *cursor = NULL;
+    int64_t values[4] = {0};
+    int values_count = 0;
+    int64_t fmt = 0;
+    int64_t ncon = 1;
+
+    /* 1. An edge list has no header, and its IDs are 0-based */
+    if (ADJACENCY_TEXT_FORMAT_EDGE_LIST == text->format) {
+        text->n = ADJACENCY_TEXT_MAX_ID + 1;
+        text->base = 0;
+
+        result = E__SUCCESS;
+        goto l_cleanup;
+    }
+
+    /* 2. A Matrix Market file starts with its banner */
+    if (ADJACENCY_TEXT_FORMAT_MATRIX_MARKET == text->format) {
+        line_end = adjacency_text_get_line_end(line, text->end);
+        if ((!adjacency_text_has_word(line, line_end, ADJACENCY_TEXT_MATRIX_MARKET_BANNER)) ||
+            (!adjacency_text_has_word(line, line_end, ADJACENCY_TEXT_MATRIX_MARKET_COORDINATE))) {
+            result = E__INVALID_VALUE;
+            goto l_cleanup;
+        }
+        line = (line_end < text->end) ? line_end + 1 : text->end;
+    }
+
+    /* 3. The header is the first line that isn't a comment or blank */
+    for ( ; line < text->end ; line = (line_end < text->end) ? line_end + 1 : text->end) {
+        line_end = adjacency_text_get_line_end(line, text->end);
+        if ((!adjacency_text_is_comment(line, line_end, text->format)) &&
+            (adjacency_text_skip_blanks(line, line_end) != line_end)) {
+            break;
+        }
+    }
+
+    if (line == text->end) {
+        result = E__INVALID_VALUE;
+        goto l_cleanup;
+    }
+
+    cursor = line;
+    while ((values_count < (int)(sizeof(values) / sizeof(values[0]))) &&
+           adjacency_text_parse_number(&cursor, line_end, &values[values_count])) {
+        ++values_count;
+    }
+    if (adjacency_text_skip_blanks(cursor, line_end) != line_end) {
+        result = E__INVALID_VALUE;
+        goto l_cleanup;
+    }
+    text->body = (line_end < text->end) ? line_end + 1 : text->end;
+    text->base = 1;
+    text->n = values[0];
+
+    /* 4. Matrix Market's is "rows columns entries", of a square matrix */
+    if (ADJACENCY_TEXT_FORMAT_MATRIX_MARKET == text->format) {
+        if ((3 != values_count) || (values[0] != values[1])) {
+            result = E__INVALID_SIZE;
+            goto l_cleanup;
+        }
+    }
+
+    /* 5. METIS's is "n m [fmt [ncon]]". fmt's digits flag the vertices'
+     *    sizes, the vertices' weights and the edges' weights */
+    if (ADJACENCY_TEXT_FORMAT_METIS == text->format) {
+        if (2 > values_count) {
+            result = E__INVALID_SIZE;
+            goto l_cleanup;
+        }
+        fmt = (2 < values_count) ? values[2] : 0;
+        ncon = (3 < values_count) ? values[3] : 1;
+
+        text->metis_skipped = (ADJACENCY_TEXT_METIS_HAS_VERTEX_SIZES(fmt) ? 1 : 0) +
+                              (ADJACENCY_TEXT_METIS_HAS_VERTEX_WEIGHTS(fmt) ? (int)MIN(ncon, INT_MAX - 1) : 0);
+        text->metis_has_weights = ADJACENCY_TEXT_METIS_HAS_EDGE_WEIGHTS(fmt);
+    }
+
+    if (ADJACENCY_TEXT_MAX_ID + 1 < text->n) {
+        result = E__INVALID_SIZE;
+        goto l_cleanup;
+    }
+
+    result = E__SUCCESS;
+l_cleanup:
+
+    return result;
+}
+
+static
+result_t
+adjacency_text_add_edge(adjacency_text_worker_t *worker, int64_t u, int64_t v)
+{
+    result_t result = E__UNKNOWN;
+    const adjacency_text_t *text = worker->text;
+    int *edges = NULL;
+
+    /* 1. Both IDs must be vertices */
+    u -= text->base;
+    v -= text->base;
+    if ((0 > u) || (text->n <= u) || (0 > v) || (text->n <= v)) {
+        result = E__INVALID_ROW_INDEX;
+        goto l_cleanup;
+    }
+
+    /* 2. Make room */
+    if (worker->edges_count == worker->edges_capacity) {
+        edges = (int *)realloc(worker->edges,
+                               2 * sizeof(*edges) * MAX(2 * worker->edges_capacity,
+                                                        ADJACENCY_TEXT_INITIAL_EDGES));
+        if (NULL == edges) {
+            result = E__MALLOC_ERROR;
+            goto l_cleanup;
+        }
+        worker->edges = edges;
+        worker->edges_capacity = MAX(2 * worker->edges_capacity, ADJACENCY_TEXT_INITIAL_EDGES);
+    }
+
+    /* 3. Add */
+    worker->edges[2 * worker->edges_count] = (int)u;
+    worker->edges[2 * worker->edges_count + 1] = (int)v;
+    ++worker->edges_count;
+    worker->max_id = MAX(worker->max_id, MAX(u, v));
+
+    result = E__SUCCESS;
+l_cleanup:
+
+    return result;
+}
+
+static
+result_t
+adjacency_text_parse_metis_line(adjacency_text_worker_t *worker,
+                                const unsigned char *line,
+                                const unsigned char *end,
+                                int64_t vertex)
+{
+    result_t result = E__UNKNOWN;
+    const adjacency_text_t *text = worker->text;
+    int64_t neighbor = 0;
+    int64_t weight = 0;
+    int k = 0;
+
+    /* 1. Skip the vertex's size and weights */
+    for (k = 0 ; k < text->metis_skipped ; ++k) {
+        if (!adjacency_text_parse_number(&line, end, &weight)) {
+            result = E__INVALID_VALUE;
+            goto l_cleanup;
+        }
+    }
+
+    /* 2. The neighbors, each followed by its weight if weighted */
+    while (adjacency_text_skip_blanks(line, end) != end) {
+        if ((!adjacency_text_parse_number(&line, end, &neighbor)) ||
+            (text->metis_has_weights &&
+             (!adjacency_text_parse_number(&line, end, &weight)))) {
+            result = E__INVALID_VALUE;
+            goto l_cleanup;
+        }
+
+        /* Lines past the n'th are only blank */
+        if (text->n <= vertex) {
+            result = E__INVALID_SIZE;
+            goto l_cleanup;
+        }
+
+        result = adjacency_text_add_edge(worker, vertex + text->base, neighbor);
+        if (E__SUCCESS != result) {
+            goto l_cleanup;
+        }
+    }
+
+    result = E__SUCCESS;
+l_cleanup:
+
+    return result;
+}
+
+static
+result_t
+adjacency_text_parse_lines(adjacency_text_worker_t *worker)
+{
+    result_t result = E__UNKNOWN;
+    const adjacency_text_format_t format = worker->text->format;
+    const unsigned char *line = NULL;
+    const unsigned char *line_end = NULL;
+    const unsigned char *cursor = NULL;
+    int64_t vertex = worker->first_vertex;
+    int64_t u = 0;
+    int64_t v = 0;
+
+    for (line = worker->begin ; line < worker->end ; line = line_end + 1) {
+        line_end = adjacency_text_get_line_end(line, worker->end);
+
+        if (adjacency_text_is_comment(line, line_end, format)) {
+            /* Skipped */
+        } else if (ADJACENCY_TEXT_FORMAT_METIS == format) {
+            /* Every other line is a vertex's, even if blank */
+            if (ADJACENCY_TEXT_STAGE_PARSE == worker->stage) {
+                result = adjacency_text_parse_metis_line(worker, line, line_end, vertex);
+                if (E__SUCCESS != result) {
+                    goto l_cleanup;
+                }
+            }
+            ++vertex;
+        } else if (adjacency_text_skip_blanks(line, line_end) != line_end) {
+            /* An edge's line, whose IDs may be followed by its weight */
+            cursor = line;
+            if ((!adjacency_text_parse_number(&cursor, line_end, &u)) ||
+                (!adjacency_text_parse_number(&cursor, line_end, &v))) {
+                result = E__INVALID_VALUE;
+                goto l_cleanup;
+            }
+
+            result = adjacency_text_add_edge(worker, u, v);
+            if (E__SUCCESS != result) {
+                goto l_cleanup;
+            }
+        }
+
+        if (line_end == worker->end) {
+            break;
+        }
+    }
+    worker->lines_count = vertex - worker->first_vertex;
+
+    result = E__SUCCESS;
+l_cleanup:
+
+    return result;
+}
+
+static
+result_t
+adjacency_text_sort_rows(adjacency_text_worker_t *worker)
+{
+    const adjacency_text_t *text = worker->text;
+    int *columns = NULL;
+    size_t length = 0;
+    size_t unique = 0;
+    size_t k = 0;
+    size_t j = 0;
+    int column = 0;
+    int i = 0;
+
+    for (i = worker->begin_row ; i < worker->end_row ; ++i) {
+        columns = &text->columns[text->offsets[i]];
+        length = text->offsets[i + 1] - text->offsets[i];
+        if (ADJACENCY_TEXT_INSERTION_SORT_MAX >= length) {
+            for (k = 1 ; k < length ; ++k) {
+                column = columns[k];
+                for (j = k ; (0 < j) && (columns[j - 1] > column) ; --j) {
+                    columns[j] = columns[j - 1];
+                }
+                columns[j] = column;
+            }
+        } else {
+            qsort(columns, length, sizeof(*columns), adjacency_text_compare_columns);
+        }
+
+        unique = 0;
+        for (k = 0 ; k < length ; ++k) {
+            if ((0 == unique) || (columns[unique - 1] != columns[k])) {
+                columns[unique] = columns[k];
+                ++unique;
+            }
+        }
+
+        text->file->degrees[i] = (int)unique;
+        text->file->positions[i] = text->offsets[i] * sizeof(*columns);
+    }
+
+    return E__SUCCESS;
+}
+
+static
+result_t
+adjacency_text_work(adjacency_text_worker_t *worker)
+{
+    worker->result = (ADJACENCY_TEXT_STAGE_SORT == worker->stage) ?
+                     adjacency_text_sort_rows(worker) :
+                     adjacency_text_parse_lines(worker);
+
+    return worker->result;
+}
+
+static
+void *
+adjacency_text_work_thread(void *worker)
+{
+    (void)adjacency_text_work((adjacency_text_worker_t *)worker);
+
+    return NULL;
+}
+
+static
+result_t
+adjacency_text_run(adjacency_text_worker_t *workers, int workers_count)
+{
+    int started_count = 0;
+    int t = 0;
+
+    for (t = 1 ; t < workers_count ; ++t) {
+        if (0 != pthread_create(&workers[t].thread,
+                                NULL,
+                                adjacency_text_work_thread,
+                                &workers[t])) {
+            break;
+        }
+        ++started_count;
+    }
+
+    (void)adjacency_text_work(&workers[0]);
+    for (t = started_count + 1 ; t < workers_count ; ++t) {
+        (void)adjacency_text_work(&workers[t]);
+    }
+
+    for (t = 1 ; t <= started_count ; ++t) {
+        (void)pthread_join(workers[t].thread, NULL);
+    }
+
+    for (t = 0 ; t < workers_count ; ++t) {
+        if (E__SUCCESS != workers[t].result) {
+            return workers[t].result;
+        }
+    }
+
+    return E__SUCCESS;
+}
+
+static
+void
+adjacency_text_split_lines(const adjacency_text_t *text,
+                           adjacency_text_worker_t *workers,
+                           int workers_count)
+{
+    size_t size = (size_t)(text->end - text->body);
+    const unsigned char *begin = text->body;
+    const unsigned char *split = NULL;
+    int t = 0;
+
+    for (t = 0 ; t < workers_count ; ++t) {
+        workers[t].text = text;
+        workers[t].begin = begin;
+
+        /* Each thread's lines end on the first newline past its share */
+        split = (workers_count - 1 == t) ?
+                text->end :
+                text->body + size / (size_t)workers_count * (size_t)(t + 1);
+        if (split < begin) {
+            split = begin;
+        }
+        if (split < text->end) {
+            split = adjacency_text_get_line_end(split, text->end);
+            split = (split < text->end) ? split + 1 : text->end;
+        }
+
+        workers[t].end = split;
+        begin = split;
+    }
+}
+
+static
+result_t
+adjacency_text_build_rows(adjacency_text_t *text,
+                          adjacency_text_worker_t *workers,
+                          int workers_count,
+                          adjacency_file_t *file,
+                          int **columns_out)
+{
+    result_t result = E__UNKNOWN;
+    adjacency_text_worker_t *sorters = NULL;
+    size_t *offsets = NULL;
+    int *columns = NULL;
+    const int *edges = NULL;
+    int sorters_count = 0;
+    int64_t max_id = -1;
+    size_t e = 0;
+    int t = 0;
+    int i = 0;
+
+    /* 1. An edge list's vertices are up to its largest ID */
+    if (ADJACENCY_TEXT_FORMAT_EDGE_LIST == text->format) {
+        for (t = 0 ; t < workers_count ; ++t) {
+            if (0 < workers[t].edges_count) {
+                max_id = MAX(max_id, workers[t].max_id);
+            }
+        }
+        text->n = max_id + 1;
+    }
+    file->n = (int)text->n;
+
+    /* 2. Allocations */
+    file->degrees = (int *)malloc(sizeof(*file->degrees) * MAX(file->n, 1));
+    if (NULL == file->degrees) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+
+    file->positions = (size_t *)malloc(sizeof(*file->positions) * MAX(file->n, 1));
+    if (NULL == file->positions) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+
+    offsets = (size_t *)calloc((size_t)file->n + 1, sizeof(*offsets));
+    if (NULL == offsets) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+
+    /* 3. Count each row's IDs, each edge both ways, then where each begins */
+    for (t = 0 ; t < workers_count ; ++t) {
+        edges = workers[t].edges;
+        for (e = 0 ; e < workers[t].edges_count ; ++e) {
+            ++offsets[edges[2 * e] + 1];
+            if (edges[2 * e] != edges[2 * e + 1]) {
+                ++offsets[edges[2 * e + 1] + 1];
+            }
+        }
+    }
+
+    for (i = 0 ; i < file->n ; ++i) {
+        offsets[i + 1] += offsets[i];
+        file->positions[i] = offsets[i];
+    }
+
+    columns = (int *)malloc(sizeof(*columns) * MAX(offsets[file->n], 1));
+    if (NULL == columns) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+
+    /* 4. Fill the rows, the positions are the rows' ends meanwhile */
+    for (t = 0 ; t < workers_count ; ++t) {
+        edges = workers[t].edges;
+        for (e = 0 ; e < workers[t].edges_count ; ++e) {
+            columns[file->positions[edges[2 * e]]++] = edges[2 * e + 1];
+            if (edges[2 * e] != edges[2 * e + 1]) {
+                columns[file->positions[edges[2 * e + 1]]++] = edges[2 * e];
+            }
+        }
+        FREE_SAFE(workers[t].edges);
+    }
+
+    /* 5. Sort the rows, split into ranges of about the same cells count */
+    sorters_count = adjacency_text_get_threads_count(offsets[file->n],
+                                                     ADJACENCY_TEXT_MIN_CELLS_PER_THREAD);
+    sorters = (adjacency_text_worker_t *)calloc((size_t)sorters_count, sizeof(*sorters));
+    if (NULL == sorters) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+
+    text->file = file;
+    text->offsets = offsets;
+    text->columns = columns;
+
+    i = 0;
+    for (t = 0 ; t < sorters_count ; ++t) {
+        sorters[t].text = text;
+        sorters[t].stage = ADJACENCY_TEXT_STAGE_SORT;
+        sorters[t].begin_row = i;
+        while ((i < file->n) &&
+               (offsets[i] < offsets[file->n] / (size_t)sorters_count * (size_t)(t + 1))) {
+            ++i;
+        }
+        sorters[t].end_row = (sorters_count - 1 == t) ? file->n : i;
+    }
+
+    result = adjacency_text_run(sorters, sorters_count);
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+
+    /* 6. The rows are a 32-bit file's */
+    file->M = 0;
+    for (i = 0 ; i < file->n ; ++i) {
+        file->M += file->degrees[i];
+    }
+    file->width = FILE_WIDTH_32;
+    file->data = (const unsigned char *)columns;
+    file->size = offsets[file->n] * sizeof(*columns);
+
+    /* Success */
+    *columns_out = columns;
+    columns = NULL;
+
+    result = E__SUCCESS;
+l_cleanup:
+    FREE_SAFE(sorters);
+    FREE_SAFE(columns);
+    FREE_SAFE(offsets);
+
+    return result;
+}
+
+adjacency_text_format_t
+ADJACENCY_TEXT_get_format(const char *path)
+{
+    size_t length = 0;
+    size_t extension_length = 0;
+    size_t i = 0;
+
+    if (NULL == path) {
+        return ADJACENCY_TEXT_FORMAT_NONE;
+    }
+
+    length = strlen(path);
+    for (i = 0 ; i < sizeof(adjacency_text_extensions) / sizeof(adjacency_text_extensions[0]) ; ++i) {
+        extension_length = strlen(adjacency_text_extensions[i].extension);
+        if ((length > extension_length) &&
+            (0 == strcmp(&path[length - extension_length], adjacency_text_extensions[i].extension))) {
+            return adjacency_text_extensions[i].format;
+        }
+    }
+
+    return ADJACENCY_TEXT_FORMAT_NONE;
+}
+
+result_t
+ADJACENCY_TEXT_parse(const unsigned char *text,
+                     size_t size,
+                     adjacency_text_format_t format,
+                     adjacency_file_t *file,
+                     int **columns_out)
+{
+    result_t result = E__UNKNOWN;
+    adjacency_text_t parsed;
+    adjacency_text_worker_t *workers = NULL;
+    int workers_count = 0;
+    int64_t vertex = 0;
+    int t = 0;
+
+    /* 0. Input validation */
+    if ((NULL == text) || (NULL == file) || (NULL == columns_out)) {
+        result = E__NULL_ARGUMENT;
+        goto l_cleanup;
+    }
+
+    if ((ADJACENCY_TEXT_FORMAT_NONE == format) || (ADJACENCY_TEXT_FORMAT_MAX <= format)) {
+        result = E__INVALID_VALUE;
+        goto l_cleanup;
+    }
+
+    /* 1. Parse the header */
+    (void)memset(&parsed, 0, sizeof(parsed));
+    parsed.format = format;
+    parsed.body = text;
+    parsed.end = text + size;
+    result = adjacency_text_parse_header(&parsed);
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+
+    /* 2. Split the lines between threads */
+    workers_count = adjacency_text_get_threads_count((size_t)(parsed.end - parsed.body),
+                                                     ADJACENCY_TEXT_MIN_BYTES_PER_THREAD);
+    workers = (adjacency_text_worker_t *)calloc((size_t)workers_count, sizeof(*workers));
+    if (NULL == workers) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+    adjacency_text_split_lines(&parsed, workers, workers_count);
+
+    /* 3. A METIS line's vertex is its index, so each thread's first vertex
+     *    follows the lines of the ones before it */
+    if (ADJACENCY_TEXT_FORMAT_METIS == format) {
+        for (t = 0 ; t < workers_count ; ++t) {
+            workers[t].stage = ADJACENCY_TEXT_STAGE_COUNT_LINES;
+        }
+
+        result = adjacency_text_run(workers, workers_count);
+        if (E__SUCCESS != result) {
+            goto l_cleanup;
+        }
+
+        for (t = 0 ; t < workers_count ; ++t) {
+            workers[t].first_vertex = vertex;
+            vertex += workers[t].lines_count;
+        }
+    }
+
+    /* 4. Parse the edges */
+    for (t = 0 ; t < workers_count ; ++t) {
+        workers[t].stage = ADJACENCY_TEXT_STAGE_PARSE;
+    }
+
+    result = adjacency_text_run(workers, workers_count);
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+
+    /* 5. Build the rows */
+    result = adjacency_text_build_rows(&parsed, workers, workers_count, file, columns_out);
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+
+    result = E__SUCCESS;
+l_cleanup:
+    if (NULL != workers) {
+        for (t = 0 ; t < workers_count ; ++t) {
+            FREE_SAFE(workers[t].edges);
+        }
+    }
+    FREE_SAFE(workers);
+
+    return result;
+}
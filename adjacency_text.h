@@ -0,0 +1,71 @@
+/**
+ * @file adjacency_text.h
+ * @purpose Parse a text graph into the rows of an adjacency file.
+ *          The format is chosen by the file's extension:
+ *              .el, .edges, .txt: an edge list, a "u v" line per edge, of
+ *                                 0-based vertices. Lines starting with # or %
+ *                                 are comments
+ *              .graph, .metis: a METIS graph, a header line "n m [fmt [ncon]]"
+ *                              then a line of 1-based neighbors per vertex
+ *              .mtx: a Matrix Market coordinate matrix, an "i j [value]" line
+ *                    per entry, of 1-based vertices
+ *          Every edge goes both ways, and repeated edges are kept once
+ */
+#ifndef __ADJACENCY_TEXT_H__
+#define __ADJACENCY_TEXT_H__
+
+/* Includes **************************************************************************************/
+#include <stddef.h>
+
+#include "results.h"
+#include "common.h"
+#include "adjacency_file.h"
+
+
+/* Enums *****************************************************************************************/
+typedef enum adjacency_text_format_e {
+    /* Not a text graph, but one of the binary formats */
+    ADJACENCY_TEXT_FORMAT_NONE = 0,
+    ADJACENCY_TEXT_FORMAT_EDGE_LIST,
+    ADJACENCY_TEXT_FORMAT_METIS,
+    ADJACENCY_TEXT_FORMAT_MATRIX_MARKET,
+
+    ADJACENCY_TEXT_FORMAT_MAX
+} adjacency_text_format_t;
+
+
+/* Functions Declarations ************************************************************************/
+/**
+ * @purpose Get the text format of a file, by its extension
+ *
+ * @param path The file's path
+ *
+ * @return The file's format, ADJACENCY_TEXT_FORMAT_NONE if it isn't text
+ */
+adjacency_text_format_t
+ADJACENCY_TEXT_get_format(const char *path);
+
+/*
+ * @purpose Parse a text graph, by threads over its lines
+ *
+ * @param text The text
+ * @param size The text's size
+ * @param format The text's format
+ * @param file The file to set as a FILE_WIDTH_32 file, whose data is the
+ *             parsed rows. Each row's IDs are sorted and unique
+ * @param columns_out The parsed rows, which file's data points into
+ *
+ * @return One of result_t values
+ *
+ * @remark file's degrees and positions are freed by ADJACENCY_FILE_close,
+ *         columns_out must be freed by the caller
+ */
+result_t
+ADJACENCY_TEXT_parse(const unsigned char *text,
+                     size_t size,
+                     adjacency_text_format_t format,
+                     adjacency_file_t *file,
+                     int **columns_out);
+
+
+#endif /* __ADJACENCY_TEXT_H__ */
@@ -16,10 +16,10 @@
 #include "eigen.h"
 #include "results.h"
 #include "vector.h"
-#include "spmat_list.h"
 #include "debug.h"
 #include "list.h"
 #include "division_file.h"
+#include "division_tree.h"
 #include "submatrix.h"
 
 
@@ -27,10 +27,20 @@
 /* Contains memory allocated for the cluster */
 typedef struct cluster_data_s {
     submatrix_t **p_group;
-    double *s_vector;
-    double *temp_b_vector;
+    /* Bit-packed: see sign_vector.h */
+    sign_word_t *s_vector;
+    eigen_real_t *temp_b_vector;
     int *temp_indexes_vector;
-    double *temp_eigen_vector;
+    eigen_real_t *temp_eigen_vector;
+    /* Division optimization's moved vertices and their improvements */
+    int *temp_indices_vector;
+    double *temp_improve_vector;
+    /* Reused by every optimization iteration's unmoved vertices list */
+    list_arena_t *scores_arena;
+    /* Recycled headers of the groups' submatrices */
+    submatrix_pool_t *submatrix_pool;
+    /* Lazy groups only: network-sized positions buffer, all -1 */
+    int *temp_positions_vector;
 } cluster_data_t;
 
 
@@ -49,26 +59,30 @@ typedef struct cluster_data_s {
 static
 result_t
 cluster_calculate_leading_eigenvalue(const submatrix_t *matrix,
-                                     const double *eigen_vector,
+                                     const eigen_real_t *eigen_vector,
                                      double *eigen_value_out);
 
 static
 result_t
 cluster_optimize_division_iteration(submatrix_t *smat,
-                                    double *s_vector,
+                                    sign_word_t *s_vector,
                                     double *improve,
                                     int *indices,
+                                    list_arena_t *scores_arena,
                                     double *delta_q_out);
 
 static
 result_t
 cluster_optimize_division(submatrix_t *smat,
-                          double *s_vector);
+                          cluster_data_t *d);
 
 /**
  * @purpose divide a network to two groups
  * @param input Matrix to divide
- * @param s_vector A pre-allocated input->n sized s-vector
+ * @param temp_row_sums Temp buffer with size n, for the 1-norm's calculation
+ * @param s_vector A pre-allocated s-vector holding input->n signs
+ * @param leading_eigenvalue_out The leading eigenvalue, set even if network
+ *                               is undivisible
  *
  * @return One of result_t values, E__UNDIVISIBLE_NETWORK if network is
  *         undivisible
@@ -78,23 +92,77 @@ cluster_optimize_division(submatrix_t *smat,
 static
 result_t
 cluster_divide(submatrix_t *smat,
-               double *temp_b_vector,
-               double *temp_eigen_vector,
-               double *s_vector);
+               double *temp_row_sums,
+               eigen_real_t *temp_b_vector,
+               eigen_real_t *temp_eigen_vector,
+               sign_word_t *s_vector,
+               double *leading_eigenvalue_out);
 
 static
 result_t
 cluster_sub_divide_optimized(submatrix_t *smat,
-                             double *temp_b_vector,
-                             double *temp_eigen_vector,
-                             double *s_vector);
+                             cluster_data_t *d,
+                             double *leading_eigenvalue_out);
 
 static
 result_t
 cluster_create_submatrix(const adjacency_t *adj,
                          matrix_t *matrix,
+                         submatrix_pool_t *pool,
                          submatrix_t **smat_out);
 
+/**
+ * @purpose free a group's submatrix
+ * @param group The group to free. Safe to call with NULL
+ * @param network The network's matrix, which is not freed with the group, or
+ *                NULL if the group owns it
+ */
+static
+void
+cluster_free_group(submatrix_t *group, const matrix_t *network);
+
+/**
+ * @purpose add a divided group's two groups to the p-group, or write them
+ *          if they are final. The smaller group is divided first
+ * @param tree The division tree, whose leaves are set as they're written,
+ *             or NULL
+ *
+ * @return One of result_t values
+ *
+ * @remark The groups are either owned by the p-group or freed
+ */
+static
+result_t
+cluster_push_groups(cluster_data_t *d,
+                    size_t *p_group_length,
+                    submatrix_t *group1,
+                    submatrix_t *group2,
+                    const matrix_t *network,
+                    division_file_t *output_file,
+                    division_tree_t *tree);
+
+/**
+ * @purpose record a division in the division tree
+ * @param tree The division tree
+ * @param node The divided group's node
+ * @param leading_eigenvalue The group's leading eigenvalue
+ * @param gain The modularity gained by the division
+ * @param group1 The division's first group
+ * @param group2 The division's second group
+ *
+ * @return One of result_t values
+ *
+ * @remark A trivial division, of an empty group, sets the group as a leaf
+ */
+static
+result_t
+cluster_record_division(division_tree_t *tree,
+                        int64_t node,
+                        double leading_eigenvalue,
+                        double gain,
+                        submatrix_t *group1,
+                        submatrix_t *group2);
+
 static
 result_t
 cluster_data_init(cluster_data_t *data, int n);
@@ -108,7 +176,7 @@ cluster_data_free(cluster_data_t *data);
 static
 result_t
 cluster_calculate_leading_eigenvalue(const submatrix_t *matrix,
-                                     const double *eigen_vector,
+                                     const eigen_real_t *eigen_vector,
                                      double *eigen_value_out)
 {
     result_t result = E__UNKNOWN;
@@ -123,15 +191,15 @@ cluster_calculate_leading_eigenvalue(const submatrix_t *matrix,
         goto l_cleanup;
     }
 
-    /* 1. Multiply the matrice with the vector */
-    /* 2.1. Caculate eigen norm */
-    eigen_value_numerator = SUBMAT_SPMAT_LIST_calculate_q(matrix,
-                                                          eigen_vector);
+    /* 1. Caculate eigen norm. The numerator is summed in double precision
+     *    even if the eigen vector is a float, since the divisibility decision
+     *    depends on it */
+    eigen_value_numerator = SUBMATRIX_MULT_VMV(matrix, eigen_vector);
     eigen_value_denominator = VECTOR_scalar_multiply(eigen_vector,
                                                      eigen_vector,
                                                      matrix->orig->n);
 
-    /* 2.2. Calculate the avarage, or set as 0 */
+    /* 2. Calculate the avarage, or set as 0 */
     if (IS_POSITIVE(eigen_value_denominator)) {
         eigen_value = eigen_value_numerator / eigen_value_denominator;
     } else {
@@ -154,24 +222,24 @@ l_cleanup:
 static
 result_t
 cluster_divide(submatrix_t *smat,
-               double *temp_b_vector,
-               double *temp_eigen_vector,
-               double *s_vector)
+               double *temp_row_sums,
+               eigen_real_t *temp_b_vector,
+               eigen_real_t *temp_eigen_vector,
+               sign_word_t *s_vector,
+               double *leading_eigenvalue_out)
 {
     result_t result = E__UNKNOWN;
     double leading_eigenvalue = 0.0;
     double stbs = 0.0;
-    size_t s_ones = 0;
     double onenorm = 0.0;
-    int i = 0;
     int n = 0;
 
 
     /* 1. Calculate leading eigenvector */
     n = smat->g_length;
 
-    /* 1.1. Calculate the 1-norm of the matrix using b-vector as temp vector */
-    onenorm = SUBMAT_SPMAT_LIST_get_1norm(smat, temp_b_vector);
+    /* 1.1. Calculate the 1-norm of the matrix */
+    onenorm = SUBMATRIX_GET_1NORM(smat, temp_row_sums);
 
     /* 1.2. Randomize b-vector */
     VECTOR_random_vector(n, temp_b_vector);
@@ -199,6 +267,7 @@ cluster_divide(submatrix_t *smat,
     /* 3.2. Decrease 1-norm from the result, restore the diag variable */ 
     smat->add_to_diag = 0.0;
     leading_eigenvalue -= onenorm;
+    *leading_eigenvalue_out = leading_eigenvalue;
 
     /* 3. Check divisibility #1 */
     if (0 >= leading_eigenvalue) {
@@ -216,17 +285,10 @@ cluster_divide(submatrix_t *smat,
     }
 
     /* 4.1. Calculate s-vector */
-    for (i = 0 ; i < n; ++i) {
-        if (0 < temp_eigen_vector[i]) {
-            s_vector[i] = 1;
-            ++s_ones;
-        } else {
-            s_vector[i] = -1;
-        }
-    }
+    (void)VECTOR_create_s_vector(temp_eigen_vector, n, s_vector);
 
     /* 5. Calculating stbs */
-    stbs = SUBMAT_SPMAT_LIST_calculate_q(smat, s_vector);
+    stbs = SUBMATRIX_CALCULATE_Q(smat, s_vector);
 
     /* 6. Check divisibility #2 */
     if (0 >= stbs) {
@@ -247,18 +309,22 @@ l_cleanup:
 static
 result_t
 cluster_sub_divide_optimized(submatrix_t *smat,
-                             double *temp_b_vector,
-                             double *temp_eigen_vector,
-                             double *s_vector)
+                             cluster_data_t *d,
+                             double *leading_eigenvalue_out)
 {
     result_t result = E__UNKNOWN;
 
-    result = cluster_divide(smat, temp_b_vector, temp_eigen_vector,s_vector);
+    result = cluster_divide(smat,
+                            d->temp_improve_vector,
+                            d->temp_b_vector,
+                            d->temp_eigen_vector,
+                            d->s_vector,
+                            leading_eigenvalue_out);
     if (E__SUCCESS != result) {
         goto l_cleanup;
     }
 
-    result = cluster_optimize_division(smat, s_vector);
+    result = cluster_optimize_division(smat, d);
     if (E__SUCCESS != result) {
         goto l_cleanup;
     }
@@ -273,6 +339,7 @@ static
 result_t
 cluster_create_submatrix(const adjacency_t *adj,
                          matrix_t *matrix,
+                         submatrix_pool_t *pool,
                          submatrix_t **smat_out)
 {
     result_t result = E__UNKNOWN;
@@ -280,7 +347,7 @@ cluster_create_submatrix(const adjacency_t *adj,
     int i = 0;
 
     /* 1. Create submatrix */
-    result = SUBMATRIX_create(adj, matrix, &smat);
+    result = SUBMATRIX_create(adj, matrix, pool, &smat);
     /* TODO: Calculate transposed */
     if (E__SUCCESS != result) {
         goto l_cleanup;
@@ -304,10 +371,143 @@ l_cleanup:
     return result;
 }
 
+static
+void
+cluster_free_group(submatrix_t *group, const matrix_t *network)
+{
+    if ((NULL != group) && (NULL != network) && (network == group->orig)) {
+        /* The network's matrix is freed once the division is over */
+        group->orig = NULL;
+    }
+
+    SUBMATRIX_free(group);
+}
+
+static
+result_t
+cluster_push_groups(cluster_data_t *d,
+                    size_t *p_group_length,
+                    submatrix_t *group1,
+                    submatrix_t *group2,
+                    const matrix_t *network,
+                    division_file_t *output_file,
+                    division_tree_t *tree)
+{
+    result_t result = E__UNKNOWN;
+    submatrix_t *groups[2] = {NULL, NULL};
+    size_t i = 0;
+
+    /* 1. A trivial division: the whole group is final */
+    if ((0 == group1->g_length) || (0 == group2->g_length)) {
+        result = DIVISION_FILE_write_matrix(output_file,
+                                            group1->g,
+                                            group1->g_length);
+        if (E__SUCCESS != result) {
+            goto l_cleanup;
+        }
+
+        result = DIVISION_FILE_write_matrix(output_file,
+                                            group2->g,
+                                            group2->g_length);
+        if (E__SUCCESS != result) {
+            goto l_cleanup;
+        }
+
+        result = E__SUCCESS;
+        goto l_cleanup;
+    }
+
+    /* 2. Push the larger group first, so the smaller one is divided next.
+     *    This keeps the count of groups waiting in the p-group low */
+    if (group1->g_length >= group2->g_length) {
+        groups[0] = group1;
+        groups[1] = group2;
+    } else {
+        groups[0] = group2;
+        groups[1] = group1;
+    }
+
+    for (i = 0 ; i < 2 ; ++i) {
+        if (1 == groups[i]->g_length) {
+            /* 2.1. A single vertex is final */
+            if (NULL != tree) {
+                result = DIVISION_TREE_set_leaf(tree, groups[i]->node, 0.0);
+                if (E__SUCCESS != result) {
+                    goto l_cleanup;
+                }
+            }
+
+            result = DIVISION_FILE_write_matrix(output_file,
+                                                groups[i]->g,
+                                                groups[i]->g_length);
+            if (E__SUCCESS != result) {
+                goto l_cleanup;
+            }
+        } else {
+            /* 2.2. Owned by the p-group */
+            d->p_group[*p_group_length] = groups[i];
+            ++*p_group_length;
+            if (group1 == groups[i]) {
+                group1 = NULL;
+            } else {
+                group2 = NULL;
+            }
+        }
+    }
+
+    result = E__SUCCESS;
+l_cleanup:
+
+    cluster_free_group(group1, network);
+    cluster_free_group(group2, network);
+
+    return result;
+}
+
+static
+result_t
+cluster_record_division(division_tree_t *tree,
+                        int64_t node,
+                        double leading_eigenvalue,
+                        double gain,
+                        submatrix_t *group1,
+                        submatrix_t *group2)
+{
+    result_t result = E__UNKNOWN;
+    int64_t child = 0;
+
+    /* 1. A trivial division leaves the group whole */
+    if ((0 == group1->g_length) || (0 == group2->g_length)) {
+        result = DIVISION_TREE_set_leaf(tree, node, leading_eigenvalue);
+        goto l_cleanup;
+    }
+
+    /* 2. Otherwise its groups are the node's children */
+    result = DIVISION_TREE_divide(tree,
+                                  node,
+                                  leading_eigenvalue,
+                                  gain,
+                                  group1->g_length,
+                                  group2->g_length,
+                                  &child);
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+
+    group1->node = child;
+    group2->node = child + 1;
+
+    result = E__SUCCESS;
+l_cleanup:
+
+    return result;
+}
+
 result_t
 CLUSTER_divide_repeatedly(adjacency_t *adj,
                           matrix_t *matrix,
-                          division_file_t *output_file)
+                          division_file_t *output_file,
+                          division_tree_t *tree)
 {
     result_t result = E__UNKNOWN;
     result_t division_result = E__UNKNOWN;
@@ -315,9 +515,15 @@ CLUSTER_divide_repeatedly(adjacency_t *adj,
     submatrix_t *current_matrix = NULL;
     submatrix_t *group1 = NULL;
     submatrix_t *group2 = NULL;
+    /* Lazy groups are built out of the network's matrix, which is kept */
+    const matrix_t *network = (CLUSTER_LAZY_GROUPS) ? matrix : NULL;
+    double leading_eigenvalue = 0.0;
+    double gain = 0.0;
     size_t p_group_length = 0;
     cluster_data_t d;
 
+    (void)memset(&d, 0, sizeof(d));
+
     /* 0. Input validation */
     if ((NULL == adj) || (NULL == output_file)) {
         result = E__NULL_ARGUMENT;
@@ -331,7 +537,7 @@ CLUSTER_divide_repeatedly(adjacency_t *adj,
 
     /* 1. Initializations */
 
-    result = cluster_create_submatrix(adj, matrix, &smat);
+    result = cluster_create_submatrix(adj, matrix, d.submatrix_pool, &smat);
     if (E__SUCCESS != result) {
         goto l_cleanup;
     }
@@ -341,18 +547,39 @@ CLUSTER_divide_repeatedly(adjacency_t *adj,
     ++p_group_length;
     /* Prevent input from being double freed */
 
-    for (; 0 < p_group_length ; --p_group_length)
+    while (0 < p_group_length)
     {
         /* Take next matrix */
-        current_matrix = d.p_group[p_group_length - 1];
+        --p_group_length;
+        current_matrix = d.p_group[p_group_length];
+        d.p_group[p_group_length] = NULL;
+
+        /* Build a pending group's matrix */
+        if (CLUSTER_LAZY_GROUPS) {
+            result = SUBMATRIX_materialize(current_matrix,
+                                           network,
+                                           d.temp_positions_vector);
+            if (E__SUCCESS != result) {
+                goto l_cleanup;
+            }
+        }
 
+        leading_eigenvalue = 0.0;
         division_result = cluster_sub_divide_optimized(current_matrix,
-                                                       d.temp_b_vector,
-                                                       d.temp_eigen_vector,
-                                                       d.s_vector);
+                                                       &d,
+                                                       &leading_eigenvalue);
         if (E__SUCCESS != division_result) {
             if (E__UNDIVISIBLE_NETWORK == division_result) {
                 /* Matrix is undivisibe - write it */
+                if (NULL != tree) {
+                    result = DIVISION_TREE_set_leaf(tree,
+                                                    current_matrix->node,
+                                                    leading_eigenvalue);
+                    if (E__SUCCESS != result) {
+                        goto l_cleanup;
+                    }
+                }
+
                 result = DIVISION_FILE_write_matrix(output_file,
                                                     current_matrix->g,
                                                     current_matrix->g_length);
@@ -361,8 +588,8 @@ CLUSTER_divide_repeatedly(adjacency_t *adj,
                 }
                 /* printf("no division"); */
 
-                SUBMATRIX_FREE_SAFE(current_matrix);
-                d.p_group[p_group_length - 1] = NULL;
+                cluster_free_group(current_matrix, network);
+                current_matrix = NULL;
 
                 /* Get next matrix from the p-group */
                 continue;
@@ -372,78 +599,73 @@ CLUSTER_divide_repeatedly(adjacency_t *adj,
             }
         }
 
-        /* Network is divisible */
-        result = SUBMAT_SPMAT_LIST_split(current_matrix,
-                                         d.s_vector,
-                                         d.temp_indexes_vector,
-                                         &group1,
-                                         &group2);
-        if (E__SUCCESS != result) {
-            goto l_cleanup;
+        /* Network is divisible. The modularity gained by the division is
+         * s^T B s / 4m, and the degrees sum to 2m */
+        if (NULL != tree) {
+            gain = SUBMATRIX_CALCULATE_Q(current_matrix, d.s_vector) /
+                   (2.0 * (double)adj->M);
         }
-        SUBMATRIX_FREE_SAFE(current_matrix);
-        d.p_group[p_group_length - 1] = NULL;
-
-        if (0 == group1->g_length) {
-            result = DIVISION_FILE_write_matrix(output_file,
-                                                group2->g,
-                                                group2->g_length);
-            if (E__SUCCESS != result) {
-                goto l_cleanup;
-            }
 
-            SUBMATRIX_FREE_SAFE(group1);
-            SUBMATRIX_FREE_SAFE(group2);
-            continue;
+        if (CLUSTER_LAZY_GROUPS) {
+            result = SUBMATRIX_split_pending(current_matrix,
+                                             d.s_vector,
+                                             &group1,
+                                             &group2);
+        } else {
+            result = SUBMATRIX_SPLIT(current_matrix,
+                                     d.s_vector,
+                                     d.temp_indexes_vector,
+                                     &group1,
+                                     &group2);
         }
-        if (0 == group2->g_length) {
-            result = DIVISION_FILE_write_matrix(output_file,
-                                                group1->g,
-                                                group1->g_length);
-            if (E__SUCCESS != result) {
-                goto l_cleanup;
-            }
-            SUBMATRIX_FREE_SAFE(group1);
-            SUBMATRIX_FREE_SAFE(group2);
-            continue;
+        if (E__SUCCESS != result) {
+            goto l_cleanup;
         }
 
-        if (1 == group1->g_length) {
-            result = DIVISION_FILE_write_matrix(output_file,
-                                                group1->g,
-                                                group1->g_length);
+        if (NULL != tree) {
+            result = cluster_record_division(tree,
+                                             current_matrix->node,
+                                             leading_eigenvalue,
+                                             gain,
+                                             group1,
+                                             group2);
             if (E__SUCCESS != result) {
                 goto l_cleanup;
             }
-            SUBMATRIX_FREE_SAFE(group1);
-        } else {
-            d.p_group[p_group_length - 1] = group1;
-            ++p_group_length;
         }
-        
-        if (1 == group2->g_length) {
-            result = DIVISION_FILE_write_matrix(output_file,
-                                                group2->g,
-                                                group2->g_length);
-            if (E__SUCCESS != result) {
-                goto l_cleanup;
-            }
-            SUBMATRIX_FREE_SAFE(group2);
-        } else {
-            d.p_group[p_group_length - 1] = group2;
-            ++p_group_length;
+        cluster_free_group(current_matrix, network);
+        current_matrix = NULL;
+
+        result = cluster_push_groups(&d,
+                                     &p_group_length,
+                                     group1,
+                                     group2,
+                                     network,
+                                     output_file,
+                                     tree);
+        group1 = NULL;
+        group2 = NULL;
+        if (E__SUCCESS != result) {
+            goto l_cleanup;
         }
-
     }
 
     /* Success */
     result = E__SUCCESS;
 l_cleanup:
 
+    cluster_free_group(current_matrix, network);
+    current_matrix = NULL;
+
     /* Will be freed in case of failure before being inserted to p_group */
     while (p_group_length > 0) {
         --p_group_length;
-        SUBMATRIX_FREE_SAFE(d.p_group[p_group_length]);
+        cluster_free_group(d.p_group[p_group_length], network);
+        d.p_group[p_group_length] = NULL;
+    }
+
+    if (CLUSTER_LAZY_GROUPS) {
+        MATRIX_FREE_SAFE(matrix);
     }
 
     cluster_data_free(&d);
@@ -455,40 +677,26 @@ l_cleanup:
 static
 result_t
 cluster_optimize_division(submatrix_t *smat,
-                          double *s_vector)
+                          cluster_data_t *d)
 {
     result_t result = E__UNKNOWN;
     double delta_q = 0.0;
-    int *indices = NULL;
-    double *improve = NULL;
 
     /* 0. Input validation */
 
-    if ((NULL == smat) || (NULL == s_vector)) {
+    if ((NULL == smat) || (NULL == d)) {
         result = E__NULL_ARGUMENT;
         goto l_cleanup;
     }
 
-    /* 1. Allocate memory */
-
-    indices = (int *)malloc(sizeof(*indices) * smat->g_length);
-    if (NULL == indices) {
-        result = E__MALLOC_ERROR;
-        goto l_cleanup;
-    }
-
-    improve = (double *)malloc(sizeof(*improve) * smat->g_length);
-    if (NULL == improve) {
-        result = E__MALLOC_ERROR;
-        goto l_cleanup;
-    }
-
-    /* 2. Do iterations as long as there's improvement */
+    /* 1. Do iterations as long as there's improvement.
+     *    Note: The temp vectors are allocated once, with the network's size */
     do {
         result = cluster_optimize_division_iteration(smat,
-                                                     s_vector,
-                                                     improve,
-                                                     indices,
+                                                     d->s_vector,
+                                                     d->temp_improve_vector,
+                                                     d->temp_indices_vector,
+                                                     d->scores_arena,
                                                      &delta_q);
         if (E__SUCCESS != result) {
             goto l_cleanup;
@@ -499,18 +707,16 @@ cluster_optimize_division(submatrix_t *smat,
     result = E__SUCCESS;
 l_cleanup:
 
-    FREE_SAFE(improve);
-    FREE_SAFE(indices);
-
     return result;
 }
 
 static
 result_t
 cluster_optimize_division_iteration(submatrix_t *smat,
-                                    double *s_vector,
+                                    sign_word_t *s_vector,
                                     double *improve,
                                     int *indices,
+                                    list_arena_t *scores_arena,
                                     double *delta_q_out)
 {
     result_t result = E__UNKNOWN;
@@ -525,7 +731,7 @@ cluster_optimize_division_iteration(submatrix_t *smat,
     int max_improvement_index = 0;
 
     /* 1. Initialize list */
-    result = LIST_range(smat->g_length, &unmoved_scores);
+    result = LIST_range(scores_arena, smat->g_length, &unmoved_scores);
     if (E__SUCCESS != result) {
         goto l_cleanup;
     }
@@ -537,10 +743,10 @@ cluster_optimize_division_iteration(submatrix_t *smat,
                 scanner = scanner->next) {
             /* Calculate score when moving k */
             k = scanner->index;
-            s_vector[k] *= -1;
+            SIGN_VECTOR_FLIP(s_vector, k);
             
-            scanner->value = SUBMAT_SPMAT_LIST_calc_q_score(smat, s_vector, k);
-            s_vector[k] *= -1;
+            scanner->value = SUBMATRIX_CALC_Q_SCORE(smat, s_vector, k);
+            SIGN_VECTOR_FLIP(s_vector, k);
 
             /* Update max score */
             if (NULL == max_unmoved) {
@@ -551,7 +757,7 @@ cluster_optimize_division_iteration(submatrix_t *smat,
         }
 
         /* 4. Move vertex max_score_index with a maximal score */
-        s_vector[max_unmoved->index] = -s_vector[max_unmoved->index];
+        SIGN_VECTOR_FLIP(s_vector, max_unmoved->index);
         indices[i] = max_unmoved->index;
         if (0 == i) {
             improve[i] = max_unmoved->value;
@@ -574,7 +780,7 @@ cluster_optimize_division_iteration(submatrix_t *smat,
 
     /* 6. Apply the max improvement to the s-vector */
     for (i = smat->g_length - 1 ; i > max_improvement_index ; --i) {
-        s_vector[indices[i]] *= -1;
+        SIGN_VECTOR_FLIP(s_vector, indices[i]);
     }
 
     if (max_improvement_index == smat->g_length - 1) {
@@ -600,11 +806,17 @@ result_t
 cluster_data_init(cluster_data_t *data, int n)
 {
     result_t result = E__UNKNOWN;
-    double *temp_b_vector = NULL;
-    double *temp_eigen_vector = NULL;
+    eigen_real_t *temp_b_vector = NULL;
+    eigen_real_t *temp_eigen_vector = NULL;
     submatrix_t **p_group = NULL;
-    double *s_vector = NULL;
+    sign_word_t *s_vector = NULL;
     int *temp_indexes_vector = NULL;
+    int *temp_indices_vector = NULL;
+    double *temp_improve_vector = NULL;
+    list_arena_t *scores_arena = NULL;
+    submatrix_pool_t *submatrix_pool = NULL;
+    int *temp_positions_vector = NULL;
+    int i = 0;
 
     p_group = (submatrix_t **)malloc(n * sizeof(*p_group));
     if (NULL == p_group) {
@@ -612,13 +824,14 @@ cluster_data_init(cluster_data_t *data, int n)
         goto l_cleanup;
     }
 
-    s_vector = (double *)malloc(n * sizeof(*s_vector));
+    s_vector = (sign_word_t *)malloc(MAX(SIGN_VECTOR_WORDS(n), 1) *
+                                     sizeof(*s_vector));
     if (NULL == s_vector) {
         result = E__MALLOC_ERROR;
         goto l_cleanup;
     }
 
-    temp_b_vector = (double *)malloc(n * sizeof(*temp_b_vector));
+    temp_b_vector = (eigen_real_t *)malloc(n * sizeof(*temp_b_vector));
     if (NULL == temp_b_vector) {
         result = E__MALLOC_ERROR;
         goto l_cleanup;
@@ -630,17 +843,56 @@ cluster_data_init(cluster_data_t *data, int n)
         goto l_cleanup;
     }
 
-    temp_eigen_vector = (double *)malloc(n * sizeof(*temp_eigen_vector));
+    temp_eigen_vector = (eigen_real_t *)malloc(n * sizeof(*temp_eigen_vector));
     if (NULL == temp_eigen_vector) {
         result = E__MALLOC_ERROR;
         goto l_cleanup;
     }
 
+    temp_indices_vector = (int *)malloc(n * sizeof(*temp_indices_vector));
+    if (NULL == temp_indices_vector) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+
+    temp_improve_vector = (double *)malloc(n * sizeof(*temp_improve_vector));
+    if (NULL == temp_improve_vector) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+
+    result = LIST_ARENA_create(&scores_arena);
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+
+    result = SUBMATRIX_POOL_create(MOD_MATRIX_TYPE, &submatrix_pool);
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+
+    if (CLUSTER_LAZY_GROUPS) {
+        temp_positions_vector = (int *)malloc(n *
+                                              sizeof(*temp_positions_vector));
+        if (NULL == temp_positions_vector) {
+            result = E__MALLOC_ERROR;
+            goto l_cleanup;
+        }
+        for (i = 0 ; i < n ; ++i) {
+            temp_positions_vector[i] = -1;
+        }
+    }
+
     data->s_vector = s_vector;
     data->temp_indexes_vector = temp_indexes_vector;
     data->temp_eigen_vector = temp_eigen_vector;
     data->temp_b_vector = temp_b_vector;
     data->p_group = p_group;
+    data->temp_indices_vector = temp_indices_vector;
+    data->temp_improve_vector = temp_improve_vector;
+    data->scores_arena = scores_arena;
+    data->submatrix_pool = submatrix_pool;
+    data->temp_positions_vector = temp_positions_vector;
 
     result = E__SUCCESS;
 l_cleanup:
@@ -651,6 +903,13 @@ l_cleanup:
         FREE_SAFE(s_vector);
         FREE_SAFE(temp_b_vector);
         FREE_SAFE(temp_eigen_vector);
+        FREE_SAFE(temp_indices_vector);
+        FREE_SAFE(temp_improve_vector);
+        LIST_ARENA_destroy(scores_arena);
+        scores_arena = NULL;
+        SUBMATRIX_POOL_destroy(submatrix_pool);
+        submatrix_pool = NULL;
+        FREE_SAFE(temp_positions_vector);
     }
 
     return result;
@@ -665,4 +924,11 @@ cluster_data_free(cluster_data_t *d)
     FREE_SAFE(d->s_vector);
     FREE_SAFE(d->temp_b_vector);
     FREE_SAFE(d->temp_eigen_vector);
+    FREE_SAFE(d->temp_indices_vector);
+    FREE_SAFE(d->temp_improve_vector);
+    LIST_ARENA_destroy(d->scores_arena);
+    d->scores_arena = NULL;
+    SUBMATRIX_POOL_destroy(d->submatrix_pool);
+    d->submatrix_pool = NULL;
+    FREE_SAFE(d->temp_positions_vector);
 }
@@ -9,14 +9,26 @@
  /* Includes **************************************************************************************/
 #include "results.h"
 #include "division_file.h"
+#include "division_tree.h"
 #include "adjacency_matrix.h"
 
 
 /* Functions Declarations ************************************************************************/
+/*
+ * @purpose Divide the network repeatedly, and write its final groups
+ *
+ * @param adj The network's adjacency
+ * @param matrix The network's matrix, which is freed by the division
+ * @param output_file The file the final groups are written to
+ * @param tree The tree the divisions are recorded in, or NULL
+ *
+ * @return One of result_t values
+ */
 result_t
 CLUSTER_divide_repeatedly(adjacency_t *adj,
                           matrix_t *matrix,
-                          division_file_t *output_file);
+                          division_file_t *output_file,
+                          division_tree_t *tree);
 
 
 #endif /* __CLUSTER_H__ */
@@ -19,6 +19,13 @@
 /* Typedefs **************************************************************************************/
 typedef unsigned char bool_t;
 
+/* The type of the eigen solver's vectors */
+#if EIGEN_SINGLE_PRECISION
+typedef float eigen_real_t;
+#else /* EIGEN_SINGLE_PRECISION */
+typedef double eigen_real_t;
+#endif /* EIGEN_SINGLE_PRECISION */
+
 
 /* Macros ****************************************************************************************/
 /** Close a FILE* and set it as NULL */
@@ -39,6 +46,8 @@ typedef unsigned char bool_t;
 
 #define MAX(a, b) (((a) > (b)) ? (a) : (b))
 
+#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+
 #define IS_POSITIVE(s) ((s) > EPSILON)
 
 
@@ -6,17 +6,109 @@
 #ifndef __CONFIG_H__
 #define __CONFIG_H__
 
-/* Constants *************************************************************************************/
-#include "matrix.h"
-
-
 /* Constants *************************************************************************************/
 #define EPSILON (0.00001)
 
 #ifndef MOD_MATRIX_TYPE
-#define MOD_MATRIX_TYPE (MATRIX_TYPE_SPMAT_LIST)
+#define MOD_MATRIX_TYPE (MATRIX_TYPE_SPMAT_ARRAY)
 #endif /* MOD_MATRIX_TYPE */
 
+/* Relabel the vertices after they are read, so the neighbors a row accesses
+ * are close to each other. The divisions are written with the input's labels */
+#ifndef ADJACENCY_ORDER
+#define ADJACENCY_ORDER (ADJACENCY_ORDER_INPUT)
+#endif /* ADJACENCY_ORDER */
+
+/* The threads reading and sorting the input's rows, 0 for a thread per
+ * online CPU */
+#ifndef ADJACENCY_LOADER_THREADS
+#define ADJACENCY_LOADER_THREADS (0)
+#endif /* ADJACENCY_LOADER_THREADS */
+
+/* Persist the input's row index to a sidecar file next to it, so the next
+ * load doesn't hop over every row to find where the rows begin */
+#ifndef ADJACENCY_FILE_INDEX_SIDECAR
+#define ADJACENCY_FILE_INDEX_SIDECAR (0)
+#endif /* ADJACENCY_FILE_INDEX_SIDECAR */
+
+/* Cache the built adjacency to a file next to the input. The next runs map
+ * it instead of parsing, ordering and sorting the input again */
+#ifndef ADJACENCY_CACHE
+#define ADJACENCY_CACHE (0)
+#endif /* ADJACENCY_CACHE */
+
+/* Build each group's matrix out of the network's matrix only when the group
+ * is divided, so the groups waiting to be divided hold their g-vectors only */
+#ifndef CLUSTER_LAZY_GROUPS
+#define CLUSTER_LAZY_GROUPS (0)
+#endif /* CLUSTER_LAZY_GROUPS */
+
+/* The widest instruction set the vector kernels may use, if the CPU supports
+ * it. VECTOR_SIMD_NONE leaves the portable kernels only */
+#ifndef VECTOR_SIMD_MAX
+#define VECTOR_SIMD_MAX (VECTOR_SIMD_AVX512)
+#endif /* VECTOR_SIMD_MAX */
+
+/* Store only the columns of the contiguous arrays matrix's cells: every
+ * cell's value is 1, as the input format has no weights */
+#ifndef SPMAT_ARRAY_PATTERN_ONLY
+#define SPMAT_ARRAY_PATTERN_ONLY (1)
+#endif /* SPMAT_ARRAY_PATTERN_ONLY */
+
+/* Store only the upper triangle of the contiguous arrays matrix, as the
+ * adjacency is symmetric. Halves its cells, while the whole matrix kernels
+ * scatter each cell to both of its rows */
+#ifndef SPMAT_ARRAY_SYMMETRIC
+#define SPMAT_ARRAY_SYMMETRIC (0)
+#endif /* SPMAT_ARRAY_SYMMETRIC */
+
+/* A contiguous arrays matrix's split hands each part of up to this many rows
+ * to a bitset matrix, whose rows are multiplied by the s-vector 64 cells at
+ * a time. 0 keeps every part in the contiguous arrays */
+#ifndef SPMAT_BITSET_MAX_ROWS
+#define SPMAT_BITSET_MAX_ROWS (2048)
+#endif /* SPMAT_BITSET_MAX_ROWS */
+
+/* The SELL-C-sigma matrix's chunk height C: the rows multiplied at once, a
+ * SIMD lane each. The rows are sorted by their lengths within windows of
+ * sigma rows, so a chunk's rows are padded to similar lengths */
+#ifndef SPMAT_SELL_CHUNK
+#define SPMAT_SELL_CHUNK (8)
+#endif /* SPMAT_SELL_CHUNK */
+
+#ifndef SPMAT_SELL_SIGMA
+#define SPMAT_SELL_SIGMA (256)
+#endif /* SPMAT_SELL_SIGMA */
+
+/* Store the power iteration's vectors as floats, halving their memory traffic.
+ * The matrix, the sums and the modularity calculations stay double */
+#ifndef EIGEN_SINGLE_PRECISION
+#define EIGEN_SINGLE_PRECISION (0)
+#endif /* EIGEN_SINGLE_PRECISION */
+
+/* Bytes of groups gathered before they are written to the output file with a
+ * single write. At least 8, a 64-bit count's size */
+#ifndef DIVISION_FILE_BUFFER_SIZE
+#define DIVISION_FILE_BUFFER_SIZE ((size_t)1 << 22)
+#endif /* DIVISION_FILE_BUFFER_SIZE */
+
+/* Write the output file on a thread of its own, from a second buffer, while
+ * the next groups are divided and gathered */
+#ifndef DIVISION_FILE_WRITER_THREAD
+#define DIVISION_FILE_WRITER_THREAD (0)
+#endif /* DIVISION_FILE_WRITER_THREAD */
+
+/* Stream the output file even when it's a regular one, so its groups may be
+ * read while it's written. Pipes and the standard output are always streamed */
+#ifndef DIVISION_FILE_STREAM
+#define DIVISION_FILE_STREAM (0)
+#endif /* DIVISION_FILE_STREAM */
+
+/* Bytes of groups gathered before a streamed output file is written */
+#ifndef DIVISION_FILE_STREAM_CHUNK_SIZE
+#define DIVISION_FILE_STREAM_CHUNK_SIZE ((size_t)1 << 16)
+#endif /* DIVISION_FILE_STREAM_CHUNK_SIZE */
+
 
 #endif /* __CONFIG_H__ */
 
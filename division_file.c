@@ -3,29 +3,548 @@
  * @purpose The output file of the spmat division,
  */
 
+/** Feature test macros **************************************************************************/
+#define _POSIX_C_SOURCE (200809L)
+
 /** Includes *************************************************************************************/
 #include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <pthread.h>
 
 #include "results.h"
+#include "common.h"
+#include "config.h"
 #include "matrix.h"
 #include "division_file.h"
 #include "spmat_list.h"
+#include "file_format.h"
+
+
+/** Constants ************************************************************************************/
+/* Permissions of a created output file, before the umask */
+#define DIVISION_FILE_MODE (0666)
 
 
 /** Structs **************************************************************************************/
 struct division_file_s {
-    FILE *file;
-    int number_of_matrices;
+    int fd;
+    file_width_t width;
+    int64_t number_of_matrices;
+    const int *vertices;
+    int *mapped_indexes;
+    /* Whether the file is written front to back, with a trailer */
+    bool_t is_stream;
+    /* The buffer the groups are gathered in, of capacity bytes */
+    unsigned char *buffer;
+    size_t capacity;
+    size_t size;
+    /* The writer thread's buffer, of pending_size bytes still to be written,
+     * 0 once it was written */
+    unsigned char *pending;
+    size_t pending_size;
+    bool_t has_writer;
+    bool_t is_stopping;
+    result_t writer_result;
+    pthread_t writer;
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    /* The labels file, and each input vertex's group, -1 until it's written */
+    int labels_fd;
+    int32_t *labels;
+    int labels_length;
 };
 
 
 /** Functions Declarations ***********************************************************************/
+/**
+ * @purpose Order indexes ascending
+ * @see qsort
+ */
+static
+int
+division_file_compare_indexes(const void *index1, const void *index2);
+
+/**
+ * @purpose write a whole buffer to a file, over partial and interrupted writes
+ * @param fd - the file
+ * @param data - the buffer
+ * @param size - the buffer's size
+ *
+ * @return one of retrun_t values
+ */
+static
+result_t
+division_file_write_all(int fd, const unsigned char *data, size_t size);
+
+/**
+ * @purpose write the buffers handed by division_file_flush, until the file
+ *          is stopped
+ * @param arg - the division file
+ *
+ * @return NULL
+ */
+static
+void *
+division_file_writer_thread(void *arg);
+
+/**
+ * @purpose start the writer thread, if the build asks for it
+ * @param division_file - the division file
+ *
+ * @return one of retrun_t values
+ *
+ * @remark the buffers are written on the calling thread if the writer
+ *         can't be started
+ */
+static
+result_t
+division_file_start_writer(division_file_t *division_file);
+
+/**
+ * @purpose stop the writer thread, after it writes its pending buffer
+ * @param division_file - the division file
+ */
+static
+void
+division_file_stop_writer(division_file_t *division_file);
+
+/**
+ * @purpose write the gathered groups, or hand them to the writer thread and
+ *          gather the next ones in its previous buffer
+ * @param division_file - the division file
+ *
+ * @return one of retrun_t values, a failed write of the writer thread's as well
+ */
+static
+result_t
+division_file_flush(division_file_t *division_file);
+
+/**
+ * @purpose wait for the writer thread to write its pending buffer
+ * @param division_file - the division file
+ *
+ * @return one of retrun_t values, the writer thread's first failed write's
+ */
+static
 result_t
-DIVISION_FILE_open(const char *path, division_file_t **division_file_out)
+division_file_wait_writer(division_file_t *division_file);
+
+/**
+ * @purpose gather bytes in the buffer, flushing it whenever it fills
+ * @param division_file - the division file
+ * @param data - the bytes
+ * @param size - count of bytes
+ *
+ * @return one of retrun_t values
+ */
+static
+result_t
+division_file_append(division_file_t *division_file,
+                     const void *data,
+                     size_t size);
+
+/**
+ * @purpose write the labels file: its header, then every vertex's group
+ * @param division_file - the division file
+ *
+ * @return one of retrun_t values
+ */
+static
+result_t
+division_file_write_labels(division_file_t *division_file);
+
+/**
+ * @purpose write a count, 32 or 64-bit by the file's width
+ * @param division_file- path of output file
+ * @param count - the count
+ *
+ * @return one of retrun_t values
+ */
+static
+result_t
+division_file_write_count(division_file_t *division_file, int64_t count);
+
+/**
+ * @purpose write vertex IDs, 32 or 64-bit by the file's width
+ * @param division_file- path of output file
+ * @param indexes - the IDs
+ * @param length - count of IDs
+ *
+ * @return one of retrun_t values
+ */
+static
+result_t
+division_file_write_ids(division_file_t *division_file,
+                        const int *indexes,
+                        int length);
+
+
+/** Functions ***********************************************************************************/
+static
+int
+division_file_compare_indexes(const void *index1, const void *index2)
+{
+    int first = *(const int *)index1;
+    int second = *(const int *)index2;
+
+    return (first > second) - (first < second);
+}
+
+static
+result_t
+division_file_write_all(int fd, const unsigned char *data, size_t size)
+{
+    result_t result = E__UNKNOWN;
+    ssize_t result_write = -1;
+
+    while (0 < size) {
+        result_write = write(fd, data, size);
+        if (0 > result_write) {
+            if (EINTR == errno) {
+                continue;
+            }
+            result = E__FWRITE_ERROR;
+            goto l_cleanup;
+        }
+
+        data += result_write;
+        size -= (size_t)result_write;
+    }
+
+    result = E__SUCCESS;
+l_cleanup:
+
+    return result;
+}
+
+static
+void *
+division_file_writer_thread(void *arg)
+{
+    division_file_t *division_file = (division_file_t *)arg;
+    result_t result = E__UNKNOWN;
+
+    (void)pthread_mutex_lock(&division_file->lock);
+    for (;;) {
+        while ((0 == division_file->pending_size) && (!division_file->is_stopping)) {
+            (void)pthread_cond_wait(&division_file->changed, &division_file->lock);
+        }
+        if (0 == division_file->pending_size) {
+            break;
+        }
+
+        /* The buffer is the writer's until its size is reset */
+        (void)pthread_mutex_unlock(&division_file->lock);
+        result = division_file_write_all(division_file->fd,
+                                         division_file->pending,
+                                         division_file->pending_size);
+        (void)pthread_mutex_lock(&division_file->lock);
+
+        if (E__SUCCESS == division_file->writer_result) {
+            division_file->writer_result = result;
+        }
+        division_file->pending_size = 0;
+        (void)pthread_cond_broadcast(&division_file->changed);
+    }
+    (void)pthread_mutex_unlock(&division_file->lock);
+
+    return NULL;
+}
+
+static
+result_t
+division_file_start_writer(division_file_t *division_file)
+{
+    result_t result = E__UNKNOWN;
+
+    if (!DIVISION_FILE_WRITER_THREAD) {
+        result = E__SUCCESS;
+        goto l_cleanup;
+    }
+
+    /* 1. The writer writes one buffer while the groups are gathered in the other */
+    division_file->pending = (unsigned char *)malloc(division_file->capacity);
+    if (NULL == division_file->pending) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+
+    /* 2. Start the writer, or write on this thread if it can't be */
+    if (0 != pthread_mutex_init(&division_file->lock, NULL)) {
+        result = E__SUCCESS;
+        goto l_cleanup;
+    }
+    if (0 != pthread_cond_init(&division_file->changed, NULL)) {
+        (void)pthread_mutex_destroy(&division_file->lock);
+        result = E__SUCCESS;
+        goto l_cleanup;
+    }
+    if (0 != pthread_create(&division_file->writer,
+                            NULL,
+                            division_file_writer_thread,
+                            division_file)) {
+        (void)pthread_cond_destroy(&division_file->changed);
+        (void)pthread_mutex_destroy(&division_file->lock);
+        result = E__SUCCESS;
+        goto l_cleanup;
+    }
+    division_file->has_writer = TRUE;
+
+    result = E__SUCCESS;
+l_cleanup:
+
+    return result;
+}
+
+static
+void
+division_file_stop_writer(division_file_t *division_file)
+{
+    if (!division_file->has_writer) {
+        return;
+    }
+
+    (void)pthread_mutex_lock(&division_file->lock);
+    division_file->is_stopping = TRUE;
+    (void)pthread_cond_broadcast(&division_file->changed);
+    (void)pthread_mutex_unlock(&division_file->lock);
+
+    (void)pthread_join(division_file->writer, NULL);
+    (void)pthread_cond_destroy(&division_file->changed);
+    (void)pthread_mutex_destroy(&division_file->lock);
+    division_file->has_writer = FALSE;
+}
+
+static
+result_t
+division_file_flush(division_file_t *division_file)
+{
+    result_t result = E__UNKNOWN;
+    unsigned char *buffer = NULL;
+
+    if (0 == division_file->size) {
+        result = E__SUCCESS;
+        goto l_cleanup;
+    }
+
+    /* 1. Without a writer thread, the buffer is written here */
+    if (!division_file->has_writer) {
+        result = division_file_write_all(division_file->fd,
+                                         division_file->buffer,
+                                         division_file->size);
+        if (E__SUCCESS != result) {
+            goto l_cleanup;
+        }
+        division_file->size = 0;
+
+        result = E__SUCCESS;
+        goto l_cleanup;
+    }
+
+    /* 2. Wait for the writer to be done with its buffer, then swap them */
+    (void)pthread_mutex_lock(&division_file->lock);
+    while ((0 != division_file->pending_size) &&
+           (E__SUCCESS == division_file->writer_result)) {
+        (void)pthread_cond_wait(&division_file->changed, &division_file->lock);
+    }
+
+    result = division_file->writer_result;
+    if (E__SUCCESS == result) {
+        buffer = division_file->pending;
+        division_file->pending = division_file->buffer;
+        division_file->pending_size = division_file->size;
+        division_file->buffer = buffer;
+        division_file->size = 0;
+        (void)pthread_cond_broadcast(&division_file->changed);
+    }
+    (void)pthread_mutex_unlock(&division_file->lock);
+
+l_cleanup:
+
+    return result;
+}
+
+static
+result_t
+division_file_wait_writer(division_file_t *division_file)
+{
+    result_t result = E__UNKNOWN;
+
+    if (!division_file->has_writer) {
+        result = E__SUCCESS;
+        goto l_cleanup;
+    }
+
+    (void)pthread_mutex_lock(&division_file->lock);
+    while (0 != division_file->pending_size) {
+        (void)pthread_cond_wait(&division_file->changed, &division_file->lock);
+    }
+    result = division_file->writer_result;
+    (void)pthread_mutex_unlock(&division_file->lock);
+
+l_cleanup:
+
+    return result;
+}
+
+static
+result_t
+division_file_append(division_file_t *division_file,
+                     const void *data,
+                     size_t size)
+{
+    result_t result = E__UNKNOWN;
+    const unsigned char *bytes = (const unsigned char *)data;
+    size_t chunk = 0;
+
+    while (0 < size) {
+        if (division_file->capacity == division_file->size) {
+            result = division_file_flush(division_file);
+            if (E__SUCCESS != result) {
+                goto l_cleanup;
+            }
+        }
+
+        chunk = MIN(size, division_file->capacity - division_file->size);
+        (void)memcpy(&division_file->buffer[division_file->size], bytes, chunk);
+        division_file->size += chunk;
+        bytes += chunk;
+        size -= chunk;
+    }
+
+    result = E__SUCCESS;
+l_cleanup:
+
+    return result;
+}
+
+static
+result_t
+division_file_write_labels(division_file_t *division_file)
+{
+    result_t result = E__UNKNOWN;
+    unsigned char header[FILE_FORMAT_LABELS_HEADER_SIZE];
+    int32_t marker = FILE_FORMAT_LABELS_MARKER;
+    int32_t reserved = 0;
+    int64_t n = division_file->labels_length;
+    size_t header_size = 0;
+
+    /* 1. The marker, then the counts, aligned to their size */
+    (void)memcpy(&header[header_size], &marker, sizeof(marker));
+    header_size += sizeof(marker);
+    (void)memcpy(&header[header_size], &reserved, sizeof(reserved));
+    header_size += sizeof(reserved);
+    (void)memcpy(&header[header_size], &n, sizeof(n));
+    header_size += sizeof(n);
+    (void)memcpy(&header[header_size],
+                 &division_file->number_of_matrices,
+                 sizeof(division_file->number_of_matrices));
+    header_size += sizeof(division_file->number_of_matrices);
+
+    result = division_file_write_all(division_file->labels_fd, header, header_size);
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+
+    /* 2. The labels, as they are */
+    result = division_file_write_all(division_file->labels_fd,
+                                     (const unsigned char *)division_file->labels,
+                                     sizeof(*division_file->labels) *
+                                     (size_t)division_file->labels_length);
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+
+    result = E__SUCCESS;
+l_cleanup:
+
+    return result;
+}
+
+static
+result_t
+division_file_write_count(division_file_t *division_file, int64_t count)
+{
+    result_t result = E__UNKNOWN;
+    int32_t narrow_count = (int32_t)count;
+
+    if (FILE_WIDTH_LEGACY == division_file->width) {
+        if (INT32_MAX < count) {
+            result = E__INVALID_SIZE;
+            goto l_cleanup;
+        }
+        result = division_file_append(division_file, &narrow_count, sizeof(narrow_count));
+    } else {
+        result = division_file_append(division_file, &count, sizeof(count));
+    }
+
+l_cleanup:
+
+    return result;
+}
+
+static
+result_t
+division_file_write_ids(division_file_t *division_file,
+                        const int *indexes,
+                        int length)
+{
+    result_t result = E__UNKNOWN;
+    int64_t wide_id = 0;
+    size_t block = 0;
+    size_t i = 0;
+
+    /* 1. 32-bit IDs are copied as they are */
+    if (FILE_WIDTH_64 != division_file->width) {
+        result = division_file_append(division_file,
+                                      indexes,
+                                      sizeof(*indexes) * (size_t)length);
+        goto l_cleanup;
+    }
+
+    /* 2. 64-bit IDs are widened into the buffer, as many as fit at a time */
+    while (0 < length) {
+        if (division_file->capacity - division_file->size < sizeof(wide_id)) {
+            result = division_file_flush(division_file);
+            if (E__SUCCESS != result) {
+                goto l_cleanup;
+            }
+        }
+
+        block = MIN((size_t)length,
+                    (division_file->capacity - division_file->size) / sizeof(wide_id));
+        for (i = 0 ; i < block ; ++i) {
+            wide_id = indexes[i];
+            (void)memcpy(&division_file->buffer[division_file->size], &wide_id, sizeof(wide_id));
+            division_file->size += sizeof(wide_id);
+        }
+
+        indexes += block;
+        length -= (int)block;
+    }
+
+    result = E__SUCCESS;
+l_cleanup:
+
+    return result;
+}
+
+result_t
+DIVISION_FILE_open(const char *path,
+                   file_width_t width,
+                   division_file_t **division_file_out)
 {
     result_t result = E__UNKNOWN;
     division_file_t *division_file = NULL;
-    int result_fseek = -1;
+    struct stat status;
+    off_t result_seek = -1;
+    int32_t marker = 0;
 
     /* 0. Input validation */
     if ((NULL == path) || (NULL == division_file_out)) {
@@ -33,6 +552,11 @@ DIVISION_FILE_open(const char *path, division_file_t **division_file_out)
         goto l_cleanup;
     }
 
+    if ((0 > (int)width) || (FILE_WIDTH_MAX <= width)) {
+        result = E__INVALID_VALUE;
+        goto l_cleanup;
+    }
+
     /* 1. Allocate struct and open file */
     division_file = (division_file_t *)malloc(sizeof(*division_file));
     if (NULL == division_file) {
@@ -40,19 +564,74 @@ DIVISION_FILE_open(const char *path, division_file_t **division_file_out)
         goto l_cleanup;
     }
 
+    division_file->width = width;
     division_file->number_of_matrices = 0;
-    division_file->file = fopen(path, "wb");
-    if (NULL == division_file->file) {
+    division_file->vertices = NULL;
+    division_file->mapped_indexes = NULL;
+    division_file->is_stream = FALSE;
+    division_file->buffer = NULL;
+    division_file->capacity = DIVISION_FILE_BUFFER_SIZE;
+    division_file->size = 0;
+    division_file->pending = NULL;
+    division_file->pending_size = 0;
+    division_file->has_writer = FALSE;
+    division_file->is_stopping = FALSE;
+    division_file->writer_result = E__SUCCESS;
+    division_file->labels_fd = -1;
+    division_file->labels = NULL;
+    division_file->labels_length = 0;
+    division_file->fd = (0 == strcmp(path, DIVISION_FILE_STDOUT)) ?
+                        STDOUT_FILENO :
+                        open(path, O_WRONLY | O_CREAT | O_TRUNC, DIVISION_FILE_MODE);
+    if (-1 == division_file->fd) {
         result = E__FOPEN_ERROR;
         goto l_cleanup;
     }
 
-    /* 2. Initialize writing position */
-    result_fseek = fseek(division_file->file,
-                         sizeof(division_file->number_of_matrices),
-                         SEEK_SET);
-    if (-1 == result_fseek) {
-        result = E__FSEEK_ERROR;
+    /* 2. A file that can't be seeked back to its header is streamed. Its
+     *    groups are written in smaller chunks, so they reach the reader sooner */
+    if (0 != fstat(division_file->fd, &status)) {
+        result = E__FOPEN_ERROR;
+        goto l_cleanup;
+    }
+
+    if ((STDOUT_FILENO == division_file->fd) ||
+        (!S_ISREG(status.st_mode)) ||
+        (DIVISION_FILE_STREAM)) {
+        division_file->is_stream = TRUE;
+        division_file->capacity = MIN(DIVISION_FILE_BUFFER_SIZE, DIVISION_FILE_STREAM_CHUNK_SIZE);
+        if (FILE_WIDTH_LEGACY == width) {
+            division_file->width = FILE_WIDTH_32;
+        }
+    }
+
+    /* 3. Allocate the buffer the groups are gathered in */
+    division_file->buffer = (unsigned char *)malloc(division_file->capacity);
+    if (NULL == division_file->buffer) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+
+    /* 4. Initialize writing position, after the marker and matrix count.
+     *    A streamed file starts with its marker instead */
+    if (division_file->is_stream) {
+        marker = FILE_FORMAT_STREAM_MARKER(division_file->width);
+        result = division_file_append(division_file, &marker, sizeof(marker));
+        if (E__SUCCESS != result) {
+            goto l_cleanup;
+        }
+    } else {
+        result_seek = lseek(division_file->fd,
+                            (off_t)FILE_FORMAT_HEADER_SIZE(width),
+                            SEEK_SET);
+        if (-1 == result_seek) {
+            result = E__FSEEK_ERROR;
+            goto l_cleanup;
+        }
+    }
+
+    result = division_file_start_writer(division_file);
+    if (E__SUCCESS != result) {
         goto l_cleanup;
     }
 
@@ -69,13 +648,96 @@ l_cleanup:
     return result;
 }
 
+result_t
+DIVISION_FILE_map_vertices(division_file_t *division_file,
+                           const int *vertices,
+                           int n)
+{
+    result_t result = E__UNKNOWN;
+    int *mapped_indexes = NULL;
+
+    /* 0. Input validation */
+    if ((NULL == division_file) || (NULL == vertices)) {
+        result = E__NULL_ARGUMENT;
+        goto l_cleanup;
+    }
+
+    /* 1. Allocate the buffer the indexes are mapped to */
+    mapped_indexes = (int *)malloc(sizeof(*mapped_indexes) * MAX(n, 1));
+    if (NULL == mapped_indexes) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+
+    FREE_SAFE(division_file->mapped_indexes);
+    division_file->mapped_indexes = mapped_indexes;
+    division_file->vertices = vertices;
+
+    /* Success */
+    result = E__SUCCESS;
+l_cleanup:
+
+    return result;
+}
+
+result_t
+DIVISION_FILE_open_labels(division_file_t *division_file,
+                          const char *path,
+                          int n)
+{
+    result_t result = E__UNKNOWN;
+    int32_t *labels = NULL;
+    int labels_fd = -1;
+
+    /* 0. Input validation */
+    if ((NULL == division_file) || (NULL == path)) {
+        result = E__NULL_ARGUMENT;
+        goto l_cleanup;
+    }
+
+    if ((0 > n) || (NULL != division_file->labels)) {
+        result = E__INVALID_VALUE;
+        goto l_cleanup;
+    }
+
+    /* 1. Allocate the labels, none of the vertices is written yet */
+    labels = (int32_t *)malloc(sizeof(*labels) * MAX(n, 1));
+    if (NULL == labels) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+    (void)memset(labels, 0xff, sizeof(*labels) * (size_t)n);
+
+    /* 2. Create the labels file */
+    labels_fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, DIVISION_FILE_MODE);
+    if (-1 == labels_fd) {
+        result = E__FOPEN_ERROR;
+        goto l_cleanup;
+    }
+
+    /* Success */
+    division_file->labels_fd = labels_fd;
+    division_file->labels = labels;
+    division_file->labels_length = n;
+    labels_fd = -1;
+    labels = NULL;
+
+    result = E__SUCCESS;
+l_cleanup:
+    if (-1 != labels_fd) {
+        (void)close(labels_fd);
+    }
+    FREE_SAFE(labels);
+
+    return result;
+}
+
 result_t
 DIVISION_FILE_write_matrix(division_file_t *division_file,
                            const int *indexes,
                            int length)
 {
     result_t result = E__UNKNOWN;
-    size_t result_write = 0;
     int i = 0;
 
     /* 0. Input validation */
@@ -90,29 +752,38 @@ DIVISION_FILE_write_matrix(division_file_t *division_file,
         goto l_cleanup;
     }
 
-    /* 1. Write n to file */
-    result_write = fwrite(&length,
-                          sizeof(length),
-                          1,
-                          division_file->file);
-    if (1 != result_write) {
-        result = E__FWRITE_ERROR;
-        goto l_cleanup;
+    /* 1. Map the indexes back to the input's vertices */
+    if (NULL != division_file->vertices) {
+        for (i = 0 ; i < length ; ++i) {
+            division_file->mapped_indexes[i] = division_file->vertices[indexes[i]];
+        }
+        qsort(division_file->mapped_indexes,
+              (size_t)length,
+              sizeof(*division_file->mapped_indexes),
+              division_file_compare_indexes);
+        indexes = division_file->mapped_indexes;
     }
 
-    /* 2. Write neighbors to file */
-    for (i = 0 ; i < length ; ++i) {
-        result_write = fwrite(&indexes[i],
-                              sizeof(*indexes),
-                              1,
-                              division_file->file);
-        if (1 != result_write) {
-            result = E__FWRITE_ERROR;
-            goto l_cleanup;
+    /* 1.1. Label the input's vertices with the group's number */
+    if (NULL != division_file->labels) {
+        for (i = 0 ; i < length ; ++i) {
+            division_file->labels[indexes[i]] = (int32_t)division_file->number_of_matrices;
         }
     }
 
-    /* 3. Increase matrix count */
+    /* 2. Write n to file */
+    result = division_file_write_count(division_file, length);
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+
+    /* 3. Write neighbors to file */
+    result = division_file_write_ids(division_file, indexes, length);
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+
+    /* 4. Increase matrix count */
     ++division_file->number_of_matrices;
 
     /* Success */
@@ -126,28 +797,82 @@ result_t
 DIVISION_FILE_finalize(division_file_t *division_file)
 {
     result_t result = E__UNKNOWN;
-    int result_fseek = -1;
-    size_t result_write = 0;
+    unsigned char header[sizeof(int32_t) + sizeof(int64_t)];
+    size_t header_size = 0;
+    ssize_t result_write = -1;
+    int32_t marker = 0;
+    int32_t narrow_count = 0;
 
     if (NULL == division_file) {
         result = E__NULL_ARGUMENT;
         goto l_cleanup;
     }
 
-    /* 1. Write final size to file */
-    /* 1.1. Seek to beginning */
-    result_fseek = fseek(division_file->file, 0, SEEK_SET);
-    if (-1 == result_fseek) {
-        result = E__FSEEK_ERROR;
+    /* 1. A streamed file ends with its trailer: a 0 count and the groups count */
+    if (division_file->is_stream) {
+        result = division_file_write_count(division_file, 0);
+        if (E__SUCCESS != result) {
+            goto l_cleanup;
+        }
+
+        result = division_file_write_count(division_file,
+                                           division_file->number_of_matrices);
+        if (E__SUCCESS != result) {
+            goto l_cleanup;
+        }
+    }
+
+    /* 2. Write the gathered groups, and wait for them to be written */
+    result = division_file_flush(division_file);
+    if (E__SUCCESS != result) {
         goto l_cleanup;
     }
 
-    /* 1.2. Write matrix count */
-    result_write = fwrite((void *)&division_file->number_of_matrices,
-                          sizeof(division_file->number_of_matrices),
-                          1,
-                          division_file->file);
-    if (1 != result_write) {
+    result = division_file_wait_writer(division_file);
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+
+    /* 3. Write the labels file, now the groups are numbered */
+    if (NULL != division_file->labels) {
+        result = division_file_write_labels(division_file);
+        if (E__SUCCESS != result) {
+            goto l_cleanup;
+        }
+    }
+
+    if (division_file->is_stream) {
+        result = E__SUCCESS;
+        goto l_cleanup;
+    }
+
+    /* 4. Write final size to file */
+    /* 4.1. A wide file starts with its marker */
+    if (FILE_WIDTH_LEGACY != division_file->width) {
+        marker = FILE_FORMAT_MARKER(division_file->width);
+        (void)memcpy(&header[header_size], &marker, sizeof(marker));
+        header_size += sizeof(marker);
+    }
+
+    /* 4.2. Then the matrix count */
+    if (FILE_WIDTH_LEGACY == division_file->width) {
+        if (INT32_MAX < division_file->number_of_matrices) {
+            result = E__INVALID_SIZE;
+            goto l_cleanup;
+        }
+        narrow_count = (int32_t)division_file->number_of_matrices;
+        (void)memcpy(&header[header_size], &narrow_count, sizeof(narrow_count));
+        header_size += sizeof(narrow_count);
+    } else {
+        (void)memcpy(&header[header_size],
+                     &division_file->number_of_matrices,
+                     sizeof(division_file->number_of_matrices));
+        header_size += sizeof(division_file->number_of_matrices);
+    }
+
+    /* 4.3. Write it at the beginning, which was left for it */
+    result_write = pwrite(division_file->fd, header, header_size, 0);
+    if ((ssize_t)header_size != result_write) {
         result = E__FWRITE_ERROR;
         goto l_cleanup;
     }
@@ -165,7 +890,17 @@ DIVISION_FILE_close(division_file_t *division_file)
 {
     if (NULL != division_file)
     {
-        FCLOSE_SAFE(division_file->file);
+        division_file_stop_writer(division_file);
+        if ((-1 != division_file->fd) && (STDOUT_FILENO != division_file->fd)) {
+            (void)close(division_file->fd);
+        }
+        FREE_SAFE(division_file->buffer);
+        FREE_SAFE(division_file->pending);
+        FREE_SAFE(division_file->mapped_indexes);
+        if (-1 != division_file->labels_fd) {
+            (void)close(division_file->labels_fd);
+        }
+        FREE_SAFE(division_file->labels);
         FREE_SAFE(division_file);
     }
 }
@@ -9,6 +9,12 @@
 /** Includes *************************************************************************************/
 #include "results.h"
 #include "matrix.h"
+#include "file_format.h"
+
+
+/** Constants **********************************************************************************/
+/* The output path of the standard output, which is streamed */
+#define DIVISION_FILE_STDOUT ("-")
 
 
 /** Structs **************************************************************************************/
@@ -18,13 +24,51 @@ typedef struct division_file_s division_file_t;
 /** Functions Declarations ***********************************************************************/
 /**
  * @purpose open file
- * @param path- path of input file
+ * @param path- path of input file, a pipe, or DIVISION_FILE_STDOUT
+ * @param width - width of the written counts and vertex IDs, as the input's
  * @param division_file_out path of output file
  *
  * @return one of retrun_t values
+ *
+ * @remark a file that isn't a regular one is streamed, see file_format.h.
+ *         a legacy width is streamed with 32-bit IDs
+ */
+result_t
+DIVISION_FILE_open(const char *path,
+                   file_width_t width,
+                   division_file_t **division_file_out);
+
+/**
+ * @purpose map the written indexes back to the input file's vertices
+ * @param division_file- path of output file
+ * @param vertices - mapping array from vertice index to its input index,
+ *                   must outlive the division file
+ * @param n - vertices count
+ *
+ * @return one of retrun_t values
+ *
+ * @remark each matrix's mapped indexes are written in ascending order
+ */
+result_t
+DIVISION_FILE_map_vertices(division_file_t *division_file,
+                           const int *vertices,
+                           int n);
+
+/**
+ * @purpose also write a labels file: every input vertex's group, by its ID
+ * @param division_file- path of output file
+ * @param path - path of the labels file
+ * @param n - vertices count
+ *
+ * @return one of retrun_t values
+ *
+ * @remark the groups are numbered in the order they're written. the labels
+ *         file is written by DIVISION_FILE_finalize, see file_format.h
  */
 result_t
-DIVISION_FILE_open(const char *path, division_file_t **division_file_out);
+DIVISION_FILE_open_labels(division_file_t *division_file,
+                          const char *path,
+                          int n);
 
 /**
  * @purpose write a matrix to the output file
@@ -0,0 +1,301 @@
+/**
+ * @file division_tree.c
+ * @purpose The tree of the repeated divisions, and its dendrogram file
+ */
+
+/* Includes **************************************************************************************/
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+
+#include "results.h"
+#include "common.h"
+#include "file_format.h"
+#include "division_tree.h"
+
+
+/* Constants *************************************************************************************/
+/* The nodes allocated at first, the tree's capacity doubles once they fill */
+#define DIVISION_TREE_INITIAL_CAPACITY (64)
+
+
+/* Structs ***************************************************************************************/
+struct division_tree_s {
+    FILE *file;
+    int n;
+    division_tree_node_t *nodes;
+    int64_t nodes_count;
+    int64_t capacity;
+    /* The leaves set so far, which are the groups written so far */
+    int64_t groups_count;
+};
+
+
+/* Functions Declarations ************************************************************************/
+/**
+ * @purpose Allocate another node, whose fields are set as a leaf's
+ *
+ * @param tree The tree
+ * @param parent The node's parent
+ * @param size The node's vertices count
+ *
+ * @return One of result_t values
+ */
+static
+result_t
+division_tree_add_node(division_tree_t *tree, int64_t parent, int64_t size);
+
+/**
+ * @purpose Validate a node of the tree
+ *
+ * @return One of result_t values
+ */
+static
+result_t
+division_tree_check_node(const division_tree_t *tree, int64_t node);
+
+
+/* Functions *************************************************************************************/
+static
+result_t
+division_tree_add_node(division_tree_t *tree, int64_t parent, int64_t size)
+{
+    result_t result = E__UNKNOWN;
+    division_tree_node_t *nodes = NULL;
+    division_tree_node_t *node = NULL;
+    int64_t capacity = 0;
+
+    /* 1. Grow the nodes, if they're full */
+    if (tree->nodes_count == tree->capacity) {
+        capacity = MAX(2 * tree->capacity, DIVISION_TREE_INITIAL_CAPACITY);
+        nodes = (division_tree_node_t *)realloc(tree->nodes,
+                                                sizeof(*nodes) * (size_t)capacity);
+        if (NULL == nodes) {
+            result = E__MALLOC_ERROR;
+            goto l_cleanup;
+        }
+        tree->nodes = nodes;
+        tree->capacity = capacity;
+    }
+
+    /* 2. A node is a leaf until it's divided */
+    node = &tree->nodes[tree->nodes_count];
+    node->parent = parent;
+    node->child = -1;
+    node->size = size;
+    node->group = -1;
+    node->eigenvalue = 0.0;
+    node->gain = 0.0;
+    ++tree->nodes_count;
+
+    result = E__SUCCESS;
+l_cleanup:
+
+    return result;
+}
+
+static
+result_t
+division_tree_check_node(const division_tree_t *tree, int64_t node)
+{
+    result_t result = E__UNKNOWN;
+
+    if (NULL == tree) {
+        result = E__NULL_ARGUMENT;
+        goto l_cleanup;
+    }
+
+    /* A node is divided or set as a leaf once */
+    if ((0 > node) || (tree->nodes_count <= node) ||
+        (-1 != tree->nodes[node].child) || (-1 != tree->nodes[node].group)) {
+        result = E__INVALID_VALUE;
+        goto l_cleanup;
+    }
+
+    result = E__SUCCESS;
+l_cleanup:
+
+    return result;
+}
+
+result_t
+DIVISION_TREE_create(const char *path, int n, division_tree_t **tree_out)
+{
+    result_t result = E__UNKNOWN;
+    division_tree_t *tree = NULL;
+
+    /* 0. Input validation */
+    if ((NULL == path) || (NULL == tree_out)) {
+        result = E__NULL_ARGUMENT;
+        goto l_cleanup;
+    }
+
+    if (0 > n) {
+        result = E__INVALID_VALUE;
+        goto l_cleanup;
+    }
+
+    /* 1. Allocate the tree and create its file, before the divisions */
+    tree = (division_tree_t *)malloc(sizeof(*tree));
+    if (NULL == tree) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+
+    tree->n = n;
+    tree->nodes = NULL;
+    tree->nodes_count = 0;
+    tree->capacity = 0;
+    tree->groups_count = 0;
+    tree->file = fopen(path, "wb");
+    if (NULL == tree->file) {
+        result = E__FOPEN_ERROR;
+        goto l_cleanup;
+    }
+
+    /* 2. The root is the whole network */
+    result = division_tree_add_node(tree, -1, n);
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+
+    /* Success */
+    *tree_out = tree;
+
+    result = E__SUCCESS;
+l_cleanup:
+    if (E__SUCCESS != result) {
+        DIVISION_TREE_close(tree);
+        tree = NULL;
+    }
+
+    return result;
+}
+
+result_t
+DIVISION_TREE_divide(division_tree_t *tree,
+                     int64_t node,
+                     double eigenvalue,
+                     double gain,
+                     int size1,
+                     int size2,
+                     int64_t *child_out)
+{
+    result_t result = E__UNKNOWN;
+    int64_t child = 0;
+
+    /* 0. Input validation */
+    if (NULL == child_out) {
+        result = E__NULL_ARGUMENT;
+        goto l_cleanup;
+    }
+
+    result = division_tree_check_node(tree, node);
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+
+    /* 1. Add the groups as consecutive nodes */
+    child = tree->nodes_count;
+    result = division_tree_add_node(tree, node, size1);
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+
+    result = division_tree_add_node(tree, node, size2);
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+
+    /* 2. Link the node to them. Note: the nodes may have been reallocated */
+    tree->nodes[node].child = child;
+    tree->nodes[node].eigenvalue = eigenvalue;
+    tree->nodes[node].gain = gain;
+
+    /* Success */
+    *child_out = child;
+
+    result = E__SUCCESS;
+l_cleanup:
+
+    return result;
+}
+
+result_t
+DIVISION_TREE_set_leaf(division_tree_t *tree, int64_t node, double eigenvalue)
+{
+    result_t result = E__UNKNOWN;
+
+    /* 0. Input validation */
+    result = division_tree_check_node(tree, node);
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+
+    /* 1. Number the leaf as its group is written */
+    tree->nodes[node].group = tree->groups_count;
+    tree->nodes[node].eigenvalue = eigenvalue;
+    ++tree->groups_count;
+
+    result = E__SUCCESS;
+l_cleanup:
+
+    return result;
+}
+
+result_t
+DIVISION_TREE_finalize(division_tree_t *tree)
+{
+    result_t result = E__UNKNOWN;
+    int32_t header_marker[2] = {FILE_FORMAT_TREE_MARKER, 0};
+    int64_t header_counts[3] = {0, 0, 0};
+
+    /* 0. Input validation */
+    if (NULL == tree) {
+        result = E__NULL_ARGUMENT;
+        goto l_cleanup;
+    }
+
+    /* 1. Write the header: marker, 0, n, nodes count and groups count */
+    header_counts[0] = tree->n;
+    header_counts[1] = tree->nodes_count;
+    header_counts[2] = tree->groups_count;
+    if ((1 != fwrite(header_marker, sizeof(header_marker), 1, tree->file)) ||
+        (1 != fwrite(header_counts, sizeof(header_counts), 1, tree->file))) {
+        result = E__FWRITE_ERROR;
+        goto l_cleanup;
+    }
+
+    /* 2. Write the nodes, as they are */
+    if ((size_t)tree->nodes_count != fwrite(tree->nodes,
+                                            sizeof(*tree->nodes),
+                                            (size_t)tree->nodes_count,
+                                            tree->file)) {
+        result = E__FWRITE_ERROR;
+        goto l_cleanup;
+    }
+
+    /* 3. Close the file, to catch a failed flush */
+    if (0 != fclose(tree->file)) {
+        tree->file = NULL;
+        result = E__FWRITE_ERROR;
+        goto l_cleanup;
+    }
+    tree->file = NULL;
+
+    result = E__SUCCESS;
+l_cleanup:
+
+    return result;
+}
+
+void
+DIVISION_TREE_close(division_tree_t *tree)
+{
+    if (NULL != tree) {
+        FCLOSE_SAFE(tree->file);
+        FREE_SAFE(tree->nodes);
+        FREE_SAFE(tree);
+    }
+}
@@ -0,0 +1,112 @@
+/**
+ * @file division_tree.h
+ * @purpose The tree of the repeated divisions: every group divided on the way
+ *          to the output's groups, and the two groups it was divided into.
+ *          It is written as a dendrogram file, so the hierarchy may be cut at
+ *          any depth or gain without dividing again, see file_format.h
+ */
+#ifndef __DIVISION_TREE_H__
+#define __DIVISION_TREE_H__
+
+/* Includes **************************************************************************************/
+#include <stdint.h>
+
+#include "results.h"
+#include "common.h"
+
+
+/* Structs ***************************************************************************************/
+typedef struct division_tree_s division_tree_t;
+
+/**
+ * @brief A node of the tree, as it is written
+ * @param parent The node the group was divided out of, -1 for the root
+ * @param child The first of the two nodes the group was divided into, the
+ *              second is child + 1. -1 for a leaf
+ * @param size The group's vertices count
+ * @param group A leaf's group, its position in the output file. -1 for
+ *              a divided group
+ * @param eigenvalue The leading eigenvalue of the group's modularity matrix,
+ *                   0 if the group wasn't divided
+ * @param gain The modularity gained by the division, 0 for a leaf
+ */
+typedef struct division_tree_node_s {
+    int64_t parent;
+    int64_t child;
+    int64_t size;
+    int64_t group;
+    double eigenvalue;
+    double gain;
+} division_tree_node_t;
+
+
+/* Functions Declarations ************************************************************************/
+/*
+ * @purpose Create a tree, whose root is the whole network
+ *
+ * @param path The dendrogram file's path
+ * @param n The network's vertices count
+ * @param tree_out The created tree. Its root is node 0
+ *
+ * @return One of result_t values
+ *
+ * @remark tree_out must be closed using DIVISION_TREE_close
+ */
+result_t
+DIVISION_TREE_create(const char *path, int n, division_tree_t **tree_out);
+
+/*
+ * @purpose Add the two groups a node was divided into
+ *
+ * @param tree The tree
+ * @param node The divided node
+ * @param eigenvalue The leading eigenvalue of the node's modularity matrix
+ * @param gain The modularity gained by the division
+ * @param size1 The first group's vertices count
+ * @param size2 The second group's vertices count
+ * @param child_out The first group's node, the second's is child_out + 1
+ *
+ * @return One of result_t values
+ */
+result_t
+DIVISION_TREE_divide(division_tree_t *tree,
+                     int64_t node,
+                     double eigenvalue,
+                     double gain,
+                     int size1,
+                     int size2,
+                     int64_t *child_out);
+
+/*
+ * @purpose Set a node as a leaf, the next group written to the output
+ *
+ * @param tree The tree
+ * @param node The node
+ * @param eigenvalue The leading eigenvalue of the node's modularity matrix,
+ *                   0 if it wasn't calculated
+ *
+ * @return One of result_t values
+ */
+result_t
+DIVISION_TREE_set_leaf(division_tree_t *tree, int64_t node, double eigenvalue);
+
+/*
+ * @purpose Write the tree to its file
+ *
+ * @param tree The tree
+ *
+ * @return One of result_t values
+ */
+result_t
+DIVISION_TREE_finalize(division_tree_t *tree);
+
+/*
+ * @purpose Close a tree
+ *
+ * @remark Safe to call with NULL
+ */
+void
+DIVISION_TREE_close(division_tree_t *tree);
+
+
+#endif /* __DIVISION_TREE_H__ */
@@ -17,19 +17,20 @@
 #include "vector.h"
 #include "config.h"
 #include "submatrix.h"
-#include "spmat_list.h"
 
 
 /* Functions *****************************************************************/
 result_t
 EIGEN_calculate_eigen(const submatrix_t *smat,
-                      double *b_vector,
-                      double *eigen)
+                      eigen_real_t *b_vector,
+                      eigen_real_t *eigen)
 {
     result_t result = E__UNKNOWN;
-    double *original_vector_res = NULL;
-    double *vector_res = NULL;
-    double *temp = NULL;
+    eigen_real_t *original_vector_res = NULL;
+    eigen_real_t *vector_res = NULL;
+    eigen_real_t *temp = NULL;
+    double norm_square = 0.0;
+    bool_t is_close = FALSE;
     int n = 0;
 
     if ((NULL == smat) || (NULL == b_vector)) {
@@ -47,19 +48,22 @@ EIGEN_calculate_eigen(const submatrix_t *smat,
     vector_res = b_vector;
     b_vector = original_vector_res;
 
-    /* 2.2. Do power iterations */
+    /* 2.2. Do power iterations. Each does two sweeps over the vectors: the
+     *      multiplication, which also sums the result's squares, then the
+     *      normalization, which also compares with the previous vector */
     do {
         /* Swap */
         temp = vector_res;
         vector_res = b_vector;
         b_vector = temp;
 
-        SUBMAT_SPMAT_LIST_mult(smat, b_vector, vector_res);
-        result = VECTOR_normalize(vector_res, n);
-        if (E__SUCCESS != result) {
-            goto l_cleanup;
-        }
-    } while (!VECTOR_is_close(vector_res, b_vector, n, EPSILON));
+        norm_square = SUBMATRIX_MULT(smat, b_vector, vector_res);
+        is_close = VECTOR_scale_and_is_close(vector_res,
+                                             b_vector,
+                                             n,
+                                             1.0 / sqrt(norm_square),
+                                             EPSILON);
+    } while (!is_close);
 
     /* 3. Make sure the result is in prev_vector_res */
     if (original_vector_res == b_vector) {
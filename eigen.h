@@ -25,7 +25,7 @@
  */
 result_t
 EIGEN_calculate_eigen(const submatrix_t *smat,
-                      double *b_vector,
-                      double *eigen);
+                      eigen_real_t *b_vector,
+                      eigen_real_t *eigen);
 
 #endif /* __EIGEN_H__ */
@@ -0,0 +1,102 @@
+/**
+ * @file file_format.h
+ * @purpose The widths of the input and output files' counts and vertex IDs.
+ *
+ *          The legacy files are 32-bit throughout:
+ *              input:  n, then per vertex: count, count neighbors
+ *              output: groups count, then per group: count, count vertices
+ *
+ *          The wide files start with a negative 32-bit marker, minus the
+ *          width in bytes of their vertex IDs (-4 or -8). A legacy file
+ *          starts with a count, which is never negative. The counts that
+ *          follow (n, groups count and every list's count) are 64-bit
+ *
+ *          A compressed input file starts with its own marker, n and the rows
+ *          count of its blocks, all 64-bit but the marker. Then come the
+ *          positions of its blocks, and the position the last one ends at.
+ *          Each block is independently decodable, and holds:
+ *              its rows' counts, as a Stream VByte stream (see stream_vbyte.h)
+ *              per row: its sorted neighbors' gaps, as a Stream VByte stream
+ *          A row's first gap is its first neighbor. Its output is written as a
+ *          FILE_WIDTH_32 file
+ *
+ *          A streamed output file, written to a pipe, has no groups count to
+ *          seek back to. It starts with its own marker, one below the wide
+ *          marker of its vertex IDs' width (-5 or -9), and its counts are
+ *          64-bit. Then come its groups, each a count and count vertices, and
+ *          a trailer: a 0 count, which no group has, and the groups count
+ *
+ *          A labels file maps each input vertex to its group, the group's
+ *          position in the output file. It starts with its marker, a 32-bit
+ *          0, then n and the groups count, both 64-bit. Then come n 32-bit
+ *          labels, the v'th of vertex v, so a reader may map the file and
+ *          index its labels directly
+ *
+ *          A dendrogram file holds the tree of the divisions. It starts with
+ *          its marker, a 32-bit 0, then n, the nodes count and the groups
+ *          count, all 64-bit. Then come the nodes, the root first, each a
+ *          division_tree_node_t (see division_tree.h): parent, first child,
+ *          size and group, all 64-bit, then the eigenvalue and the gain,
+ *          both doubles. A node's children are consecutive, and follow it
+ */
+#ifndef __FILE_FORMAT_H__
+#define __FILE_FORMAT_H__
+
+/* Includes **************************************************************************************/
+#include <stdint.h>
+
+
+/* Enums *****************************************************************************************/
+typedef enum file_width_e {
+    /* 32-bit counts and vertex IDs, with no marker */
+    FILE_WIDTH_LEGACY = 0,
+    /* Marker, 64-bit counts and 32-bit vertex IDs */
+    FILE_WIDTH_32,
+    /* Marker, 64-bit counts and vertex IDs */
+    FILE_WIDTH_64,
+
+    FILE_WIDTH_MAX
+} file_width_t;
+
+
+/* Macros ****************************************************************************************/
+/* The marker starting a wide file */
+#define FILE_FORMAT_MARKER(width) \
+    ((int32_t)((FILE_WIDTH_64 == (width)) ? -8 : -4))
+
+/* The width of a wide file, by its marker, or FILE_WIDTH_MAX if invalid */
+#define FILE_FORMAT_WIDTH(marker)                                   \
+    ((-4 == (marker)) ? FILE_WIDTH_32 :                             \
+     ((-8 == (marker)) ? FILE_WIDTH_64 : FILE_WIDTH_MAX))
+
+/* The marker starting a streamed output file */
+#define FILE_FORMAT_STREAM_MARKER(width) ((int32_t)(FILE_FORMAT_MARKER(width) - 1))
+
+/* The marker starting a compressed input file */
+#define FILE_FORMAT_COMPRESSED_MARKER ((int32_t)-1)
+
+/* The marker starting a labels file */
+#define FILE_FORMAT_LABELS_MARKER ((int32_t)-2)
+
+/* The marker starting a dendrogram file */
+#define FILE_FORMAT_TREE_MARKER ((int32_t)-3)
+
+/* Size in bytes of a labels file's header: marker, 0, n and groups count */
+#define FILE_FORMAT_LABELS_HEADER_SIZE \
+    (2 * sizeof(int32_t) + 2 * sizeof(int64_t))
+
+/* Size in bytes of a file's counts and vertex IDs */
+#define FILE_FORMAT_COUNT_SIZE(width) \
+    ((FILE_WIDTH_LEGACY == (width)) ? sizeof(int32_t) : sizeof(int64_t))
+
+#define FILE_FORMAT_ID_SIZE(width) \
+    ((FILE_WIDTH_64 == (width)) ? sizeof(int64_t) : sizeof(int32_t))
+
+/* Size in bytes of an output file's header: marker and groups count.
+ * A streamed output file has only its marker, and the count in its trailer */
+#define FILE_FORMAT_HEADER_SIZE(width)                                  \
+    (((FILE_WIDTH_LEGACY == (width)) ? 0 : sizeof(int32_t)) +           \
+     FILE_FORMAT_COUNT_SIZE(width))
+
+
+#endif /* __FILE_FORMAT_H__ */
@@ -22,6 +22,26 @@ static
 void
 node_link(node_t *first, node_t *second);
 
+/**
+ * @purpose allocate a node from the list's arena, or using malloc
+ * @param list The list the node will belong to
+ * @param node_out The new node
+ *
+ * @return One of result_t values
+ */
+static
+result_t
+list_alloc_node(list_t *list, node_t **node_out);
+
+/**
+ * @purpose free a node to the list's arena free-list, or using free
+ * @param list The list the node belonged to
+ * @param node The node to free
+ */
+static
+void
+list_free_node(list_t *list, node_t *node);
+
 
 /* Functions *****************************************************************/
 static
@@ -37,28 +57,123 @@ node_link(node_t *first, node_t *second)
     }
 }
 
+static
 result_t
-LIST_create(list_t **list_out)
+list_alloc_node(list_t *list, node_t **node_out)
 {
     result_t result = E__UNKNOWN;
-    list_t *list = NULL;
+    node_t *node = NULL;
+
+    if (NULL != list->arena) {
+        result = POOL_alloc(list->arena->nodes, (void **)&node);
+        if (E__SUCCESS != result) {
+            goto l_cleanup;
+        }
+    } else {
+        node = (node_t *)malloc(sizeof(*node));
+        if (NULL == node) {
+            result = E__MALLOC_ERROR;
+            goto l_cleanup;
+        }
+    }
+
+    *node_out = node;
+
+    result = E__SUCCESS;
+l_cleanup:
+
+    return result;
+}
+
+static
+void
+list_free_node(list_t *list, node_t *node)
+{
+    if (NULL != list->arena) {
+        POOL_release(list->arena->nodes, node);
+    } else {
+        free(node);
+    }
+}
+
+result_t
+LIST_ARENA_create(list_arena_t **arena_out)
+{
+    result_t result = E__UNKNOWN;
+    list_arena_t *arena = NULL;
+
+    if (NULL == arena_out) {
+        result = E__NULL_ARGUMENT;
+        goto l_cleanup;
+    }
 
-    list = (list_t *)malloc(sizeof(*list));
-    if (NULL == list) {
+    arena = (list_arena_t *)malloc(sizeof(*arena));
+    if (NULL == arena) {
         result = E__MALLOC_ERROR;
         goto l_cleanup;
     }
+    arena->lists = NULL;
+    arena->nodes = NULL;
+
+    result = POOL_create(sizeof(list_t), &arena->lists);
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+
+    result = POOL_create(sizeof(node_t), &arena->nodes);
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+
+    *arena_out = arena;
+
+    result = E__SUCCESS;
+l_cleanup:
+    if (E__SUCCESS != result) {
+        LIST_ARENA_destroy(arena);
+        arena = NULL;
+    }
+
+    return result;
+}
+
+void
+LIST_ARENA_destroy(list_arena_t *arena)
+{
+    if (NULL != arena) {
+        POOL_DESTROY_SAFE(arena->nodes);
+        POOL_DESTROY_SAFE(arena->lists);
+        FREE_SAFE(arena);
+    }
+}
+
+result_t
+LIST_create(list_arena_t *arena, list_t **list_out)
+{
+    result_t result = E__UNKNOWN;
+    list_t *list = NULL;
+
+    if (NULL != arena) {
+        result = POOL_alloc(arena->lists, (void **)&list);
+        if (E__SUCCESS != result) {
+            goto l_cleanup;
+        }
+    } else {
+        list = (list_t *)malloc(sizeof(*list));
+        if (NULL == list) {
+            result = E__MALLOC_ERROR;
+            goto l_cleanup;
+        }
+    }
 
     list->first = NULL;
     list->last = NULL;
+    list->arena = arena;
 
     *list_out = list;
 
     result = E__SUCCESS;
 l_cleanup:
-    if (E__SUCCESS != result) {
-        FREE_SAFE(list);
-    }
 
     return result;
 }
@@ -74,9 +189,14 @@ LIST_destroy(list_t *list)
         while (NULL != node) {
             prev_node = node;
             node = node->next;
-            FREE_SAFE(prev_node);
+            list_free_node(list, prev_node);
+        }
+
+        if (NULL != list->arena) {
+            POOL_release(list->arena->lists, list);
+        } else {
+            FREE_SAFE(list);
         }
-        FREE_SAFE(list);
     }
 }
 
@@ -93,9 +213,8 @@ LIST_insert(list_t *list, node_t *next_node, double value, int index)
         goto l_cleanup;
     }
 
-    new_node = (node_t *)malloc(sizeof(*new_node));
-    if (NULL == new_node) {
-        result = E__MALLOC_ERROR;
+    result = list_alloc_node(list, &new_node);
+    if (E__SUCCESS != result) {
         goto l_cleanup;
     }
     new_node->value = value;
@@ -141,7 +260,7 @@ LIST_scalar_multiply(list_t *list, const double *v)
 
 
 result_t
-LIST_range(size_t count, list_t **list_out)
+LIST_range(list_arena_t *arena, size_t count, list_t **list_out)
 {
     result_t result = E__UNKNOWN;
     list_t *list = NULL;
@@ -151,7 +270,7 @@ LIST_range(size_t count, list_t **list_out)
         result = E__NULL_ARGUMENT;
     }
 
-    result = LIST_create(&list);
+    result = LIST_create(arena, &list);
     if (E__SUCCESS != result) {
         goto l_cleanup;
     }
@@ -201,7 +320,7 @@ LIST_remove_node(list_t *list, node_t *node)
 
     node_link(prev, next);
 
-    FREE_SAFE(node);
+    list_free_node(list, node);
 
     result = E__SUCCESS;
 l_cleanup:
@@ -8,13 +8,22 @@
 #include <stddef.h>
 
 #include "results.h"
+#include "pool.h"
 
 /* Structs ***************************************************************************************/
 typedef struct node_s node_t;
 
+/* Pools of lists and nodes that are released together, e.g. a matrix's rows */
+typedef struct list_arena_s {
+    pool_t *lists;
+    pool_t *nodes;
+} list_arena_t;
+
 typedef struct list_s {
     struct node_s *first;
     struct node_s *last;
+    /* The arena the list and its nodes were allocated from, or NULL */
+    list_arena_t *arena;
 } list_t;
 
 struct node_s {
@@ -26,14 +35,36 @@ struct node_s {
 
 
 /* Functions Declarations ************************************************************************/
+/**
+ * @purpose Create an empty list arena
+ * @param arena_out The new arena
+ *
+ * @return One of result_t values
+ *
+ * @remark The arena must be destroyed using LIST_ARENA_destroy
+ */
+result_t
+LIST_ARENA_create(list_arena_t **arena_out);
+
+/**
+ * @purpose Release every list and node allocated from the arena at once
+ * @param arena The arena to destroy. Safe to call with NULL
+ *
+ * @remark The arena's lists must not be used nor destroyed afterwards
+ */
+void
+LIST_ARENA_destroy(list_arena_t *arena);
+
 /**
  * @purpose Create an empty list_t
+ * @param arena The arena to allocate the list and its nodes from, or NULL
+ *              to use malloc
  * @param list_out The new list
  *
  * @return One of result_t values
  */
 result_t
-LIST_create(list_t **list_out);
+LIST_create(list_arena_t *arena, list_t **list_out);
 
 /*
  * @purpose Destroy a list_t
@@ -61,9 +92,10 @@ LIST_insert(list_t *list, node_t *next_node, double value, int index);
 
 /*
  * Create a list from 0 (including) to count - 1 (including)
+ * The list is allocated from arena, or using malloc if it is NULL
  */
 result_t
-LIST_range(size_t count, list_t **list_out);
+LIST_range(list_arena_t *arena, size_t count, list_t **list_out);
 
 /**
  * @purpose Perform scalar multiplication with the node and a given vector
@@ -5,6 +5,7 @@
  */
 
 #include <stdio.h>
+#include <string.h>
 #include <time.h>
 
 #include "results.h"
@@ -14,6 +15,8 @@
 #include "spmat_list.h"
 #include "cluster.h"
 #include "config.h"
+#include "vector.h"
+#include "stream_vbyte.h"
 
 
 /* Enums *****************************************************************************************/
@@ -21,6 +24,8 @@ enum clsuter_args_e {
     ARG_PROGRAM_NAME,
     ARG_INPUT_ADJACENCY,
     ARG_OUTPUT_GRAPH,
+    ARG_OUTPUT_LABELS,
+    ARG_OUTPUT_TREE,
     ARG_COUNT
 };
 
@@ -34,12 +39,19 @@ int main(int argc, const char * argv[])
     matrix_t *group1 = NULL;
     matrix_t *group2 = NULL;
     division_file_t *division_file = NULL;
+    division_tree_t *division_tree = NULL;
     clock_t start = 0;
     clock_t end = 0;
 
     /* 1. Input validation */
-    if (ARG_COUNT != argc) {
-        (void)fprintf(stderr, "Usage: %s INPUT_ADJACENCY OUTPUT_MATRICES\n", argv[0]);
+    if ((ARG_OUTPUT_LABELS > argc) || (ARG_COUNT < argc)) {
+        (void)fprintf(stderr,
+                      "Usage: %s INPUT_ADJACENCY OUTPUT_MATRICES [OUTPUT_LABELS [OUTPUT_TREE]]\n",
+                      argv[0]);
+        (void)fprintf(stderr, "INPUT_ADJACENCY may be a pipe, or - to read stdin\n");
+        (void)fprintf(stderr, "OUTPUT_MATRICES may be a pipe, or - to stream to stdout\n");
+        (void)fprintf(stderr, "OUTPUT_LABELS gets the group of every vertex, unless empty\n");
+        (void)fprintf(stderr, "OUTPUT_TREE gets the tree of the divisions\n");
 
         result = E__INVALID_CMDLINE_ARGS;
         goto l_cleanup;
@@ -47,6 +59,10 @@ int main(int argc, const char * argv[])
 
     start = clock();
 
+    /* Select the vector kernels and the input's decoder for this CPU */
+    (void)VECTOR_init();
+    STREAM_VBYTE_init();
+
     /* 2. Open adjacency matrix */
     result = ADJACENCY_MATRIX_open(argv[ARG_INPUT_ADJACENCY], &adj, &matrix);
     if (E__SUCCESS != result) {
@@ -55,13 +71,38 @@ int main(int argc, const char * argv[])
 
 
     /* 3. Create output file */
-    result = DIVISION_FILE_open(argv[ARG_OUTPUT_GRAPH], &division_file);
+    result = DIVISION_FILE_open(argv[ARG_OUTPUT_GRAPH], adj->width, &division_file);
     if (E__SUCCESS != result) {
         goto l_cleanup;
     }
 
+    /* 4. Write the divisions with the input's labels */
+    if (NULL != adj->vertices) {
+        result = DIVISION_FILE_map_vertices(division_file, adj->vertices, adj->n);
+        if (E__SUCCESS != result) {
+            goto l_cleanup;
+        }
+    }
+
+    /* 4.1. Label each vertex with its group, if asked to */
+    if ((ARG_OUTPUT_LABELS < argc) && ('\0' != argv[ARG_OUTPUT_LABELS][0])) {
+        result = DIVISION_FILE_open_labels(division_file, argv[ARG_OUTPUT_LABELS], adj->n);
+        if (E__SUCCESS != result) {
+            goto l_cleanup;
+        }
+    }
+
+    /* 4.2. Record the tree of the divisions, if asked to */
+    if (ARG_OUTPUT_TREE < argc) {
+        result = DIVISION_TREE_create(argv[ARG_OUTPUT_TREE], adj->n, &division_tree);
+        if (E__SUCCESS != result) {
+            goto l_cleanup;
+        }
+    }
+
     /* 5. Divide. Note: mod_matrix is freed by divide */
-    result = CLUSTER_divide_repeatedly(adj, matrix, division_file);
+    result = CLUSTER_divide_repeatedly(adj, matrix, division_file, division_tree);
+    matrix = NULL;
     if (E__SUCCESS != result) {
         goto l_cleanup;
     }
@@ -72,12 +113,25 @@ int main(int argc, const char * argv[])
         goto l_cleanup;
     }
 
+    if (NULL != division_tree) {
+        result = DIVISION_TREE_finalize(division_tree);
+        if (E__SUCCESS != result) {
+            goto l_cleanup;
+        }
+    }
+
     end = clock();
-    printf("OUR PROGRAM: took %f sec\n", (double)(end - start) / CLOCKS_PER_SEC);
+    /* The groups may have been streamed to stdout */
+    (void)fprintf((0 == strcmp(argv[ARG_OUTPUT_GRAPH], DIVISION_FILE_STDOUT)) ? stderr : stdout,
+                  "OUR PROGRAM: took %f sec\n",
+                  (double)(end - start) / CLOCKS_PER_SEC);
 
 
     result = E__SUCCESS;
 l_cleanup:
+    /* Not divided, as the output couldn't be opened */
+    MATRIX_FREE_SAFE(matrix);
+
     if (NULL != adj) {
         ADJACENCY_MATRIX_free(adj);
         adj = NULL;
@@ -86,6 +140,9 @@ l_cleanup:
     DIVISION_FILE_close(division_file);
     division_file = NULL;
 
+    DIVISION_TREE_close(division_tree);
+    division_tree = NULL;
+
     MATRIX_FREE_SAFE(group1);
     MATRIX_FREE_SAFE(group2);
 
@@ -15,6 +15,10 @@
 #include "matrix.h"
 #include "common.h"
 #include "spmat_list.h"
+#include "spmat_array.h"
+#include "spmat_sell.h"
+#include "spmat_bitset.h"
+#include "spmat_varint.h"
 
 /* Functions ************************************************************************************/
 result_t
@@ -27,7 +31,31 @@ MATRIX_create_matrix(int n, matrix_type_t type, matrix_t **matrix_out)
     switch (type)
     {
     case MATRIX_TYPE_SPMAT_LIST:
-        result = SPMAT_LIST_allocate(n, &mat);
+        result = SPMAT_LIST_allocate(n, NULL, &mat);
+        if (E__SUCCESS != result) {
+            goto l_cleanup;
+        }
+        break;
+    case MATRIX_TYPE_SPMAT_ARRAY:
+        result = SPMAT_ARRAY_allocate(n, NULL, &mat);
+        if (E__SUCCESS != result) {
+            goto l_cleanup;
+        }
+        break;
+    case MATRIX_TYPE_SPMAT_SELL:
+        result = SPMAT_SELL_allocate(n, NULL, &mat);
+        if (E__SUCCESS != result) {
+            goto l_cleanup;
+        }
+        break;
+    case MATRIX_TYPE_SPMAT_BITSET:
+        result = SPMAT_BITSET_allocate(n, NULL, &mat);
+        if (E__SUCCESS != result) {
+            goto l_cleanup;
+        }
+        break;
+    case MATRIX_TYPE_SPMAT_VARINT:
+        result = SPMAT_VARINT_allocate(n, NULL, &mat);
         if (E__SUCCESS != result) {
             goto l_cleanup;
         }
@@ -50,6 +78,56 @@ l_cleanup:
     return result;
 }
 
+result_t
+MATRIX_create_headers_pool(matrix_type_t type, pool_t **pool_out)
+{
+    result_t result = E__UNKNOWN;
+
+    switch (type)
+    {
+    case MATRIX_TYPE_SPMAT_LIST:
+        result = SPMAT_LIST_create_headers_pool(pool_out);
+        break;
+    case MATRIX_TYPE_SPMAT_ARRAY:
+        result = SPMAT_ARRAY_create_headers_pool(pool_out);
+        break;
+    case MATRIX_TYPE_SPMAT_SELL:
+        result = SPMAT_SELL_create_headers_pool(pool_out);
+        break;
+    case MATRIX_TYPE_SPMAT_BITSET:
+        result = SPMAT_BITSET_create_headers_pool(pool_out);
+        break;
+    case MATRIX_TYPE_SPMAT_VARINT:
+        result = SPMAT_VARINT_create_headers_pool(pool_out);
+        break;
+    default:
+        result = E__UNKNOWN_MATRIX_IMPLEMNTATION;
+        break;
+    }
+
+    return result;
+}
+
+bool_t
+MATRIX_is_valid_pattern(const int *columns, int length, int n)
+{
+    int k = 0;
+
+    if ((0 > length) || ((NULL == columns) && (0 != length))) {
+        return FALSE;
+    }
+
+    for (k = 0 ; k < length ; ++k) {
+        if ((0 > columns[k]) ||
+            (n <= columns[k]) ||
+            ((0 < k) && (columns[k - 1] >= columns[k]))) {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
 #ifdef NEED_COL_VECTOR_TRANSPOSE
 result_t
 MATRIX_col_vector_transpose(matrix_t *vector_in, matrix_t **vector_out)
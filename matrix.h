@@ -10,6 +10,8 @@
 
 #include "results.h"
 #include "common.h"
+#include "pool.h"
+#include "sign_vector.h"
 
 
 /* Macros ********************************************************************/
@@ -26,6 +28,9 @@
 #define MATRIX_ADD_ROW(m, row, i) \
     MATRIX_VTABLE((m))->add_row((m), (row), (i))
 
+#define MATRIX_ADD_PATTERN_ROW(m, columns, length, i) \
+    MATRIX_VTABLE((m))->add_pattern_row((m), (columns), (length), (i))
+
 #define MATRIX_FREE_SAFE(m) do {                            \
     if (NULL != (m)) {                                      \
         MATRIX_FREE(m);                                     \
@@ -37,6 +42,10 @@
 /* Enums *********************************************************************/
 typedef enum matrix_type_e {
     MATRIX_TYPE_SPMAT_LIST,
+    MATRIX_TYPE_SPMAT_ARRAY,
+    MATRIX_TYPE_SPMAT_SELL,
+    MATRIX_TYPE_SPMAT_BITSET,
+    MATRIX_TYPE_SPMAT_VARINT,
     MATRIX_TYPE_MAX
 } matrix_type_t;
 
@@ -44,6 +53,9 @@ typedef enum matrix_type_e {
 /* Typedefs ******************************************************************/
 typedef struct matrix_s matrix_t;
 
+/* See submatrix.h */
+struct submatrix_s;
+
 /*
  * Increase the values of the row in the matrix with a given row
  **/
@@ -51,6 +63,15 @@ typedef result_t (*matrix_add_row_f)(matrix_t *matrix,
                                      const double *row,
                                      int i);
 
+/*
+ * Set a row of the matrix by its non-zero columns, whose values are all 1.
+ * The columns must be ascending and unique. A row can be set only once
+ **/
+typedef result_t (*matrix_add_pattern_row_f)(matrix_t *matrix,
+                                             const int *columns,
+                                             int length,
+                                             int i);
+
 /* Frees all resources used by A */
 typedef void (*matrix_free_f)(matrix_t *matrix);
 
@@ -75,6 +96,65 @@ typedef double (*matrix_mult_vmv_f)(const matrix_t *matrix,
  */
 typedef double (*matrix_get_1norm_f)(const matrix_t *matrix);
 
+/**
+ * Get a g-vector storage owned by the matrix, which its submatrix uses
+ * instead of allocating one
+ *
+ * @return The matrix's g-vector, or NULL if the submatrix should allocate it
+ */
+typedef int *(*matrix_get_g_f)(matrix_t *matrix);
+
+/**
+ * Build a new matrix out of the rows and columns of given indexes
+ *
+ * @param matrix The matrix to extract from
+ * @param g The indexes to extract, ascending
+ * @param g_length The count of indexes
+ * @param temp_positions A matrix->n sized buffer whose entries are all -1.
+ *                       The entries are restored to -1
+ * @param headers The pool to allocate the new matrix's header from, or NULL
+ * @param matrix_out The new g_length sized matrix
+ *
+ * @return One of result_t values
+ */
+typedef result_t (*matrix_extract_f)(const matrix_t *matrix,
+                                     const int *g,
+                                     int g_length,
+                                     int *temp_positions,
+                                     pool_t *headers,
+                                     matrix_t **matrix_out);
+
+/* Submatrix operations: the submatrix's orig is the implementing matrix */
+/* Calculate the 1-norm of the submatrix. tmp_row_sums is n-sized */
+typedef double (*submatrix_get_1norm_f)(const struct submatrix_s *smat,
+                                        double *tmp_row_sums);
+
+/* Multiply the submatrix with a vector, into a pre-allocated result.
+ * Returns the result's squared norm, accumulated while it is written */
+typedef double (*submatrix_mult_f)(const struct submatrix_s *smat,
+                                   const eigen_real_t *vector,
+                                   eigen_real_t *result);
+
+/* Calculate v^T*B*v of the submatrix with a vector, in double precision */
+typedef double (*submatrix_mult_vmv_f)(const struct submatrix_s *smat,
+                                       const eigen_real_t *vector);
+
+/* Calculate v^T*B*v of the submatrix */
+typedef double (*submatrix_calculate_q_f)(const struct submatrix_s *smat,
+                                          const sign_word_t *s_vector);
+
+/* Calculate the improved Q score of moving a given row */
+typedef double (*submatrix_calc_q_score_f)(const struct submatrix_s *smat,
+                                           const sign_word_t *s_vector,
+                                           int row);
+
+/* Split a submatrix into two submatrices accordingly to an s-vector */
+typedef result_t (*submatrix_split_f)(struct submatrix_s *smat,
+                                      const sign_word_t *s_vector,
+                                      int *temp_s_indexes,
+                                      struct submatrix_s **smat1_out,
+                                      struct submatrix_s **smat2_out);
+
 
 /* Structs *******************************************************************/
 /**
@@ -82,9 +162,18 @@ typedef double (*matrix_get_1norm_f)(const matrix_t *matrix);
  **/
 typedef struct matrix_vtable_s {
     matrix_add_row_f add_row;
+    matrix_add_pattern_row_f add_pattern_row;
     matrix_free_f free;
     matrix_mult_f mult; /* Calculate M*v */
     matrix_mult_vmv_f mult_vmv; /* Calculate v^T*M*v */
+    matrix_get_g_f get_g; /* Optional */
+    matrix_extract_f extract;
+    submatrix_get_1norm_f submat_get_1norm;
+    submatrix_mult_f submat_mult;
+    submatrix_mult_vmv_f submat_mult_vmv;
+    submatrix_calculate_q_f submat_calculate_q;
+    submatrix_calc_q_score_f submat_calc_q_score;
+    submatrix_split_f submat_split;
 } matrix_vtable_t;
 
 /* A square matrix implementation */
@@ -93,6 +182,8 @@ struct matrix_s {
     matrix_type_t type;
     const matrix_vtable_t *vtable;
     void *private;
+    /* The pool the matrix's header was allocated from, or NULL */
+    pool_t *pool;
 };
 
 
@@ -109,6 +200,29 @@ struct matrix_s {
 result_t
 MATRIX_create_matrix(int n, matrix_type_t type, matrix_t **matrix_out);
 
+/*
+ * @purpose Create a pool that recycles headers of matrices of a given type
+ *
+ * @param type The matrices' implementation
+ * @param pool_out The pool created
+ *
+ * @return One of result_t values
+ */
+result_t
+MATRIX_create_headers_pool(matrix_type_t type, pool_t **pool_out);
+
+/*
+ * @purpose Check the columns of a pattern row
+ *
+ * @param columns The row's columns
+ * @param length The count of columns
+ * @param n The matrix's size
+ *
+ * @return TRUE if the columns are valid indexes, ascending and unique
+ */
+bool_t
+MATRIX_is_valid_pattern(const int *columns, int length, int n);
+
 #ifdef NEED_COL_VECTOR_TRANSPOSE
 /*
  * @purpose Create a "transpose" vector to row vector
@@ -0,0 +1,221 @@
+/**
+ * @file pool.c
+ * @purpose Fixed-size objects pool: bump allocation out of growing blocks,
+ *          free-list reuse of released objects and bulk release
+ */
+
+/* Includes ******************************************************************/
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "results.h"
+#include "common.h"
+#include "pool.h"
+
+
+/* Constants *****************************************************************/
+/* Objects count of the first block. Small matrices stay small */
+#define POOL_FIRST_BLOCK_CAPACITY (16)
+
+/* Every block doubles the previous one's capacity up to this limit */
+#define POOL_MAX_BLOCK_CAPACITY (64 * 1024)
+
+
+/* Macros ********************************************************************/
+/* Round size up to a multiple of the given alignment */
+#define POOL_ALIGN_UP(size, alignment) \
+    ((((size) + (alignment) - 1) / (alignment)) * (alignment))
+
+/* Objects are placed right after the block's header */
+#define POOL_BLOCK_OBJECTS(block) \
+    ((char *)(block) + POOL_ALIGN_UP(sizeof(pool_block_t), sizeof(pool_align_t)))
+
+
+/* Structs *******************************************************************/
+/* The strictest alignment the pool's users require */
+typedef union pool_align_u {
+    void *pointer;
+    double value;
+    long integer;
+} pool_align_t;
+
+/* A released object holds the next free object */
+typedef struct pool_free_object_s {
+    struct pool_free_object_s *next;
+} pool_free_object_t;
+
+/* Header of a block, followed by its objects */
+typedef struct pool_block_s {
+    struct pool_block_s *next;
+} pool_block_t;
+
+struct pool_s {
+    size_t object_size;
+    /* Capacity of the next block to allocate */
+    size_t next_block_capacity;
+    /* Bump pointer within the current block */
+    char *bump;
+    char *bump_end;
+    /* All the blocks, newest first */
+    pool_block_t *blocks;
+    /* Released objects */
+    pool_free_object_t *free_list;
+};
+
+
+/* Functions Declarations ****************************************************/
+/**
+ * @purpose Allocate a new block and make it the current bump block
+ * @param pool The pool
+ *
+ * @return One of result_t values
+ */
+static
+result_t
+pool_grow(pool_t *pool);
+
+
+/* Functions *****************************************************************/
+result_t
+POOL_create(size_t object_size, pool_t **pool_out)
+{
+    result_t result = E__UNKNOWN;
+    pool_t *pool = NULL;
+
+    /* 0. Input validation */
+    if (NULL == pool_out) {
+        result = E__NULL_ARGUMENT;
+        goto l_cleanup;
+    }
+
+    if (0 == object_size) {
+        result = E__INVALID_SIZE;
+        goto l_cleanup;
+    }
+
+    /* 1. Allocate pool */
+    pool = (pool_t *)malloc(sizeof(*pool));
+    if (NULL == pool) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+
+    /* 2. Initialize. A released object must be able to hold a pointer */
+    pool->object_size = POOL_ALIGN_UP(MAX(object_size,
+                                          sizeof(pool_free_object_t)),
+                                      sizeof(pool_align_t));
+    pool->next_block_capacity = POOL_FIRST_BLOCK_CAPACITY;
+    pool->bump = NULL;
+    pool->bump_end = NULL;
+    pool->blocks = NULL;
+    pool->free_list = NULL;
+
+    /* Success */
+    *pool_out = pool;
+
+    result = E__SUCCESS;
+l_cleanup:
+
+    return result;
+}
+
+static
+result_t
+pool_grow(pool_t *pool)
+{
+    result_t result = E__UNKNOWN;
+    pool_block_t *block = NULL;
+    size_t capacity = 0;
+
+    /* 1. Allocate block */
+    capacity = pool->next_block_capacity;
+    block = (pool_block_t *)malloc(
+        POOL_ALIGN_UP(sizeof(*block), sizeof(pool_align_t)) +
+        (capacity * pool->object_size));
+    if (NULL == block) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+
+    /* 2. Link block and bump from it */
+    block->next = pool->blocks;
+    pool->blocks = block;
+    pool->bump = POOL_BLOCK_OBJECTS(block);
+    pool->bump_end = pool->bump + (capacity * pool->object_size);
+
+    /* 3. Grow geometrically */
+    if (POOL_MAX_BLOCK_CAPACITY > capacity) {
+        pool->next_block_capacity = capacity * 2;
+    }
+
+    result = E__SUCCESS;
+l_cleanup:
+
+    return result;
+}
+
+result_t
+POOL_alloc(pool_t *pool, void **object_out)
+{
+    result_t result = E__UNKNOWN;
+    void *object = NULL;
+
+    /* 0. Input validation */
+    if ((NULL == pool) || (NULL == object_out)) {
+        result = E__NULL_ARGUMENT;
+        goto l_cleanup;
+    }
+
+    /* 1. Reuse a released object */
+    if (NULL != pool->free_list) {
+        object = (void *)pool->free_list;
+        pool->free_list = pool->free_list->next;
+    } else {
+        /* 2. Bump the current block, allocate a new one if exhausted */
+        if (pool->bump == pool->bump_end) {
+            result = pool_grow(pool);
+            if (E__SUCCESS != result) {
+                goto l_cleanup;
+            }
+        }
+
+        object = (void *)pool->bump;
+        pool->bump += pool->object_size;
+    }
+
+    /* Success */
+    *object_out = object;
+
+    result = E__SUCCESS;
+l_cleanup:
+
+    return result;
+}
+
+void
+POOL_release(pool_t *pool, void *object)
+{
+    pool_free_object_t *free_object = (pool_free_object_t *)object;
+
+    if ((NULL != pool) && (NULL != free_object)) {
+        free_object->next = pool->free_list;
+        pool->free_list = free_object;
+    }
+}
+
+void
+POOL_destroy(pool_t *pool)
+{
+    pool_block_t *block = NULL;
+    pool_block_t *next_block = NULL;
+
+    if (NULL != pool) {
+        for (block = pool->blocks ; NULL != block ; block = next_block) {
+            next_block = block->next;
+            FREE_SAFE(block);
+        }
+        pool->blocks = NULL;
+        pool->free_list = NULL;
+        FREE_SAFE(pool);
+    }
+}
@@ -0,0 +1,71 @@
+/**
+ * @file pool.h
+ * @purpose Fixed-size objects pool: bump allocation out of growing blocks,
+ *          free-list reuse of released objects and bulk release
+ */
+#ifndef __POOL_H__
+#define __POOL_H__
+
+/* Includes ******************************************************************/
+#include <stddef.h>
+
+#include "results.h"
+
+
+/* Macros ********************************************************************/
+#define POOL_DESTROY_SAFE(p) do {   \
+    if (NULL != (p)) {              \
+        POOL_destroy((p));          \
+        (p) = NULL;                 \
+    }                               \
+} while (0)
+
+
+/* Typedefs ******************************************************************/
+typedef struct pool_s pool_t;
+
+
+/* Functions Declarations ****************************************************/
+/**
+ * @purpose Create an empty pool of objects with a given size
+ * @param object_size The size of every object allocated from the pool
+ * @param pool_out The new pool
+ *
+ * @return One of result_t values
+ *
+ * @remark The pool must be destroyed using POOL_destroy
+ */
+result_t
+POOL_create(size_t object_size, pool_t **pool_out);
+
+/**
+ * @purpose Allocate an object from the pool
+ * @param pool The pool
+ * @param object_out The new object. Its content is undefined
+ *
+ * @return One of result_t values
+ *
+ * @remark Released objects are reused before the current block is bumped
+ */
+result_t
+POOL_alloc(pool_t *pool, void **object_out);
+
+/**
+ * @purpose Return an object to the pool's free-list
+ * @param pool The pool the object was allocated from
+ * @param object The object to release. Safe to call with NULL
+ */
+void
+POOL_release(pool_t *pool, void *object);
+
+/**
+ * @purpose Free all the pool's blocks at once
+ * @param pool The pool to destroy. Safe to call with NULL
+ *
+ * @remark Every object allocated from the pool becomes invalid
+ */
+void
+POOL_destroy(pool_t *pool);
+
+
+#endif /* __POOL_H__ */
@@ -24,6 +24,8 @@ typedef enum result_e {
     E__INVALID_S_VECTOR,
     E__ROW_ALREADY_IN_USE,
     E__UNDIVISIBLE_NETWORK,
+    E__INVALID_VALUE,
+    E__MMAP_ERROR,
 } result_t; 
 
 #endif /* __RESULTS_H__ */
@@ -0,0 +1,39 @@
+/**
+ * @file sign_vector.h
+ * @purpose Bit-packed s-vector: one bit per vertex, set iff its s-value is -1
+ */
+#ifndef __SIGN_VECTOR_H__
+#define __SIGN_VECTOR_H__
+
+/* Includes ******************************************************************/
+#include <stdint.h>
+
+
+/* Constants *****************************************************************/
+#define SIGN_WORD_BITS (64)
+
+
+/* Typedefs ******************************************************************/
+typedef uint64_t sign_word_t;
+
+
+/* Macros ********************************************************************/
+/* Number of words holding length signs */
+#define SIGN_VECTOR_WORDS(length) \
+    (((size_t)(length) + SIGN_WORD_BITS - 1) / SIGN_WORD_BITS)
+
+/* 1 if the i'th s-value is -1, otherwise 0 */
+#define SIGN_VECTOR_BIT(s, i) \
+    ((int)(((s)[(size_t)(i) / SIGN_WORD_BITS] >> \
+            ((size_t)(i) % SIGN_WORD_BITS)) & 1))
+
+/* The i'th s-value as 1.0 or -1.0, without branching */
+#define SIGN_VECTOR_VALUE(s, i) ((double)(1 - 2 * SIGN_VECTOR_BIT((s), (i))))
+
+/* Move the i'th vertex to the other group */
+#define SIGN_VECTOR_FLIP(s, i) \
+    ((s)[(size_t)(i) / SIGN_WORD_BITS] ^= \
+        ((sign_word_t)1 << ((size_t)(i) % SIGN_WORD_BITS)))
+
+
+#endif /* __SIGN_VECTOR_H__ */
@@ -0,0 +1,1643 @@
+/*
+ * @file spmat_array.c
+ * @purpose Sparse matrix implemented using contiguous rows and columns arrays.
+ *          A split partitions the arrays in place: the two submatrices are
+ *          views over subranges of their parent's storage
+ */
+
+/* Includes ******************************************************************/
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "results.h"
+#include "matrix.h"
+#include "spmat_array.h"
+#include "spmat_bitset.h"
+#include "common.h"
+#include "debug.h"
+#include "vector.h"
+#include "submatrix.h"
+#include "pool.h"
+
+
+/* Constants *****************************************************************/
+/* Initial columns capacity of a storage, grows by doubling */
+#define SPMAT_ARRAY_INITIAL_CAPACITY (1024)
+
+
+/* Structs *******************************************************************/
+typedef struct spmat_array_row_s {
+    /* The row's first column within the storage's columns */
+    size_t offset;
+    /* Count of the row's columns. Columns filtered out by splits follow */
+    int length;
+} spmat_array_row_t;
+
+/*
+ * The rows of a matrix and of all the views split from it.
+ * Rows and g are permuted by splits, so every view's rows are contiguous.
+ * Each row's columns are local indexes within the view it belongs to.
+ * If SPMAT_ARRAY_SYMMETRIC, a row holds only the columns from its own index
+ * on. A split keeps the indexes' order within each part, so the views stay
+ * upper triangular
+ */
+typedef struct spmat_array_storage_s {
+    spmat_array_row_t *rows;
+    /* Original vertex index of each row */
+    int *g;
+    int *columns;
+#if !SPMAT_ARRAY_PATTERN_ONLY
+    double *values;
+#endif /* SPMAT_ARRAY_PATTERN_ONLY */
+    size_t columns_count;
+    size_t columns_capacity;
+#if SPMAT_ARRAY_SYMMETRIC
+    /* Per row A*v and row sums, which the cells are scattered to */
+    double *row_dots;
+    double *row_sums;
+    /* If row_dots is A*s of the view over [scattered_begin,
+     * scattered_begin + scattered_length), the s-vector. Otherwise
+     * scattered_length is -1 */
+    sign_word_t *scattered_s;
+    int scattered_begin;
+    int scattered_length;
+#endif /* SPMAT_ARRAY_SYMMETRIC */
+    /* Count of views over the storage */
+    int references;
+} spmat_array_storage_t;
+
+/* matrix->private: a view over rows [begin, begin + n) of a storage */
+typedef struct spmat_array_data_s {
+    spmat_array_storage_t *storage;
+    int begin;
+} spmat_array_data_t;
+
+/* A matrix_t and its view, allocated at once */
+typedef struct spmat_array_header_s {
+    matrix_t matrix;
+    spmat_array_data_t data;
+} spmat_array_header_t;
+
+
+/* Small parts of a split are handed over to bitset matrices, which can only
+ * hold cells of 1 */
+#define SPMAT_ARRAY_USE_BITSET \
+    (SPMAT_ARRAY_PATTERN_ONLY && (0 < SPMAT_BITSET_MAX_ROWS))
+
+
+/* Macros ********************************************************************/
+#define GET_ARRAY_DATA(matrix) ((spmat_array_data_t *)((matrix)->private))
+
+#define GET_STORAGE(matrix) (GET_ARRAY_DATA(matrix)->storage)
+
+/* The view's rows array */
+#define GET_ROWS(matrix) \
+    (&GET_STORAGE(matrix)->rows[GET_ARRAY_DATA(matrix)->begin])
+
+#define GET_ROW_COLUMNS(storage, row) (&(storage)->columns[(row)->offset])
+
+#if SPMAT_ARRAY_SYMMETRIC
+/* The view's scatter buffers */
+#define GET_ROW_DOTS(matrix) \
+    (&GET_STORAGE(matrix)->row_dots[GET_ARRAY_DATA(matrix)->begin])
+
+#define GET_ROW_SUMS(matrix) \
+    (&GET_STORAGE(matrix)->row_sums[GET_ARRAY_DATA(matrix)->begin])
+#endif /* SPMAT_ARRAY_SYMMETRIC */
+
+/* The value of the k'th cell of a row. Pattern-only matrices' values are
+ * all 1, so the kernels are built without loading them */
+#if SPMAT_ARRAY_PATTERN_ONLY
+#define GET_ROW_VALUE(storage, row, k) (1.0)
+#else /* SPMAT_ARRAY_PATTERN_ONLY */
+#define GET_ROW_VALUE(storage, row, k) \
+    ((storage)->values[(row)->offset + (size_t)(k)])
+#endif /* SPMAT_ARRAY_PATTERN_ONLY */
+
+/* The first column a row stores */
+#if SPMAT_ARRAY_SYMMETRIC
+#define SPMAT_ARRAY_FIRST_COLUMN(row_index) (row_index)
+#else /* SPMAT_ARRAY_SYMMETRIC */
+#define SPMAT_ARRAY_FIRST_COLUMN(row_index) (0)
+#endif /* SPMAT_ARRAY_SYMMETRIC */
+
+#define SPMAT_GET_EXPECTED_VALUE(smat, i, j) (                              \
+    (smat->adj->neighbors[(i)] * smat->adj->neighbors_div_M[(j)])           \
+)
+
+
+/* Functions Declarations ****************************************************/
+/**
+ * @purpose Create a view over a subrange of a storage's rows
+ * @param storage The storage
+ * @param begin The view's first row within the storage
+ * @param n The view's rows count
+ * @param headers The pool to allocate the header from, or NULL
+ * @param mat_out The new matrix
+ *
+ * @return One of result_t values
+ */
+static
+result_t
+spmat_array_create_view(spmat_array_storage_t *storage,
+                        int begin,
+                        int n,
+                        pool_t *headers,
+                        matrix_t **mat_out);
+
+/**
+ * @purpose Free a storage and its arrays
+ * @param storage The storage. Safe to call with NULL
+ */
+static
+void
+spmat_array_storage_free(spmat_array_storage_t *storage);
+
+/**
+ * @purpose Make room for more columns at the storage's end
+ * @param storage The storage
+ * @param count The columns count to make room for
+ *
+ * @return One of result_t values
+ */
+static
+result_t
+spmat_array_storage_reserve(spmat_array_storage_t *storage, size_t count);
+
+/**
+ * @purpose Set a row of the matrix. A row can be set only once
+ * @see matrix_add_row_f on matrix.h
+ */
+static
+result_t
+spmat_array_add_row(matrix_t *mat, const double *row, int i);
+
+/**
+ * @purpose Set a row of the matrix by its columns. A row can be set only once
+ * @see matrix_add_pattern_row_f on matrix.h
+ */
+static
+result_t
+spmat_array_add_pattern_row(matrix_t *mat, const int *columns, int length, int i);
+
+/**
+ * @purpose Release a view. The storage is freed with its last view
+ * @see matrix_free_f on matrix.h
+ */
+static
+void
+spmat_array_free(matrix_t *mat);
+
+/**
+ * @see matrix_mult_f on matrix.h
+ */
+static
+void
+spmat_array_mult(const matrix_t *mat, const double *v, double *result);
+
+/**
+ * @see matrix_get_g_f on matrix.h
+ */
+static
+int *
+spmat_array_get_g(matrix_t *mat);
+
+/**
+ * @see matrix_extract_f on matrix.h
+ */
+static
+result_t
+spmat_array_extract(const matrix_t *mat,
+                    const int *g,
+                    int g_length,
+                    int *temp_positions,
+                    pool_t *headers,
+                    matrix_t **mat_out);
+
+/**
+ * @purpose Sum k_j/M, and optionally k_j/M * v_j, over the submatrix's g
+ * @param smat The submatrix
+ * @param v A g_length-sized vector, or NULL
+ * @param k_dot_v_out k/M multiplied by v. Not set if v is NULL
+ *
+ * @return The sum of k_j/M
+ */
+static
+double
+spmat_array_sum_neighbors_div_M(const submatrix_t *smat,
+                                const eigen_real_t *v,
+                                double *k_dot_v_out);
+
+#if SPMAT_ARRAY_SYMMETRIC
+/**
+ * @purpose Multiply the view's adjacency part with a vector into the view's
+ *          scatter buffers. Each stored cell is added to both of its rows
+ * @param smat The submatrix
+ * @param v The vector, or NULL to multiply with the s-vector
+ * @param s_vector The s-vector, used if v is NULL. It is kept along the
+ *                 buffers, see spmat_array_update_scattered_s
+ */
+static
+void
+spmat_array_scatter_mult(const submatrix_t *smat,
+                         const eigen_real_t *v,
+                         const sign_word_t *s_vector);
+
+/**
+ * @purpose Sum the view's non-zero cells' parts of the 1-norm, scattering
+ *          each stored cell off the diag to both of its rows
+ * @param smat The submatrix
+ * @param k_sums Set to the sum of kj/M over each row's non-zero cells
+ *
+ * @remark The row sums buffer is set to A's rows' sums, and the dots buffer
+ *         to the sum of |A_ij - ki*kj/M| over each row's cells off the diag
+ */
+static
+void
+spmat_array_scatter_1norm(const submatrix_t *smat, double *k_sums);
+
+/**
+ * @purpose Add a column's cells, multiplied by a factor, to the dots of the
+ *          rows they belong to
+ * @param smat The submatrix
+ * @param col_g The column
+ * @param factor The factor
+ */
+static
+void
+spmat_array_scatter_column(const submatrix_t *smat, int col_g, double factor);
+
+/**
+ * @purpose Update the dots buffer from A*s of the s-vector kept by the last
+ *          scatter to A*s of a given s-vector, a moved vertex at a time.
+ *          The dots are scattered again if they don't belong to the view
+ * @param smat The submatrix
+ * @param s_vector The s-vector
+ * @param skipped_g A row whose move is left out of the dots and the kept
+ *                  s-vector
+ *
+ * @remark The refinement moves a single vertex between its score
+ *         calculations, so this is far cheaper than gathering the rows'
+ *         cells below the diag
+ */
+static
+void
+spmat_array_update_scattered_s(const submatrix_t *smat,
+                               const sign_word_t *s_vector,
+                               int skipped_g);
+
+/**
+ * @purpose Find a column within a row's sorted columns
+ *
+ * @return The column's position in the row, or -1 if it isn't there
+ */
+static
+int
+spmat_array_find_column(const int *columns, int length, int column);
+#endif /* SPMAT_ARRAY_SYMMETRIC */
+
+/**
+ * @purpose Multiply a row of the submatrix (with hat) with a given vector
+ * @param smat The submatrix
+ * @param row_g The row's index
+ * @param v The vector
+ * @param k_sum The sum of k_j/M over g
+ * @param k_dot_v The scalar multiplication of k/M over g with v
+ *
+ * @return The multiplication result
+ *
+ * @remark If SPMAT_ARRAY_SYMMETRIC, the row's adjacency part is taken from
+ *         the scatter buffers, see spmat_array_scatter_mult
+ */
+static
+double
+spmat_array_mult_row(const submatrix_t *smat,
+                     int row_g,
+                     const eigen_real_t *v,
+                     double k_sum,
+                     double k_dot_v);
+
+/**
+ * @purpose Multiply a row of the submatrix (with hat) with an s-vector
+ * @param smat The submatrix
+ * @param row_g The row's index
+ * @param s_vector The s-vector
+ * @param k_sum The sum of k_j/M over g
+ * @param k_dot_s The scalar multiplication of k/M over g with s
+ *
+ * @return The multiplication result
+ *
+ * @remark If SPMAT_ARRAY_SYMMETRIC, the row's adjacency part is taken from
+ *         the scatter buffers, see spmat_array_scatter_mult
+ */
+static
+double
+spmat_array_mult_row_with_s(const submatrix_t *smat,
+                            int row_g,
+                            const sign_word_t *s_vector,
+                            double k_sum,
+                            double k_dot_s);
+
+/**
+ * @purpose Permute the storage's rows and g-vector in place
+ * @param storage The storage
+ * @param begin The first row to permute
+ * @param positions Maps each row to its new position, relative to begin.
+ *                  Every entry is marked as visited (bitwise not)
+ * @param length The count of rows to permute
+ */
+static
+void
+spmat_array_permute_rows(spmat_array_storage_t *storage,
+                         int begin,
+                         int *positions,
+                         int length);
+
+#if SPMAT_ARRAY_USE_BITSET
+/**
+ * @purpose Copy a view's rows and g-vector to a new bitset matrix
+ * @param mat The view
+ * @param bitset_out The bitset matrix
+ *
+ * @return One of result_t values
+ */
+static
+result_t
+spmat_array_to_bitset(const matrix_t *mat, matrix_t **bitset_out);
+#endif /* SPMAT_ARRAY_USE_BITSET */
+
+
+/* Virtual Table *************************************************************/
+const matrix_vtable_t SPMAT_ARRAY_VTABLE = {
+    .add_row = spmat_array_add_row,
+    .add_pattern_row = spmat_array_add_pattern_row,
+    .free = spmat_array_free,
+    .mult = spmat_array_mult,
+    .mult_vmv = NULL,
+    .get_g = spmat_array_get_g,
+    .extract = spmat_array_extract,
+    .submat_get_1norm = SUBMAT_SPMAT_ARRAY_get_1norm,
+    .submat_mult = SUBMAT_SPMAT_ARRAY_mult,
+    .submat_mult_vmv = SUBMAT_SPMAT_ARRAY_mult_vmv,
+    .submat_calculate_q = SUBMAT_SPMAT_ARRAY_calculate_q,
+    .submat_calc_q_score = SUBMAT_SPMAT_ARRAY_calc_q_score,
+    .submat_split = SUBMAT_SPMAT_ARRAY_split,
+};
+
+
+/* Functions *****************************************************************/
+result_t
+SPMAT_ARRAY_create_headers_pool(pool_t **pool_out)
+{
+    return POOL_create(sizeof(spmat_array_header_t), pool_out);
+}
+
+result_t
+SPMAT_ARRAY_allocate(int n, pool_t *headers, matrix_t **mat_out)
+{
+    result_t result = E__UNKNOWN;
+    spmat_array_storage_t *storage = NULL;
+    matrix_t *mat = NULL;
+    int i = 0;
+
+    /* 0. Input validation */
+    if (NULL == mat_out) {
+        result = E__NULL_ARGUMENT;
+        goto l_cleanup;
+    }
+
+    if (0 > n) {
+        result = E__INVALID_SIZE;
+        goto l_cleanup;
+    }
+
+    /* 1. Allocate storage */
+    storage = (spmat_array_storage_t *)malloc(sizeof(*storage));
+    if (NULL == storage) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+    (void)memset(storage, 0, sizeof(*storage));
+
+    /* 2. Rows, initialized as empty */
+    storage->rows = (spmat_array_row_t *)malloc(MAX(n, 1) *
+                                                sizeof(*storage->rows));
+    if (NULL == storage->rows) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+    (void)memset(storage->rows, 0, MAX(n, 1) * sizeof(*storage->rows));
+
+    /* 3. g-vector, the rows are the original vertices */
+    storage->g = (int *)malloc(MAX(n, 1) * sizeof(*storage->g));
+    if (NULL == storage->g) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+    for (i = 0 ; i < n ; ++i) {
+        storage->g[i] = i;
+    }
+
+#if SPMAT_ARRAY_SYMMETRIC
+    /* 3.1. Scatter buffers */
+    storage->row_dots = (double *)malloc(MAX(n, 1) *
+                                         sizeof(*storage->row_dots));
+    if (NULL == storage->row_dots) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+
+    storage->row_sums = (double *)malloc(MAX(n, 1) *
+                                         sizeof(*storage->row_sums));
+    if (NULL == storage->row_sums) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+
+    storage->scattered_s = (sign_word_t *)malloc(
+        MAX(SIGN_VECTOR_WORDS(n), 1) * sizeof(*storage->scattered_s));
+    if (NULL == storage->scattered_s) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+    storage->scattered_length = -1;
+#endif /* SPMAT_ARRAY_SYMMETRIC */
+
+    /* 4. View over the whole storage */
+    result = spmat_array_create_view(storage, 0, n, headers, &mat);
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+    storage = NULL;
+
+    DEBUG_PRINT("%s: addr %p n=%d\n", __func__, (void *)mat, n);
+    /* Success */
+    *mat_out = mat;
+
+    result = E__SUCCESS;
+l_cleanup:
+
+    if (E__SUCCESS != result) {
+        spmat_array_storage_free(storage);
+        storage = NULL;
+    }
+
+    return result;
+}
+
+static
+result_t
+spmat_array_create_view(spmat_array_storage_t *storage,
+                        int begin,
+                        int n,
+                        pool_t *headers,
+                        matrix_t **mat_out)
+{
+    result_t result = E__UNKNOWN;
+    spmat_array_header_t *header = NULL;
+
+    /* 1. Allocate the header, recycle one if possible */
+    if (NULL != headers) {
+        result = POOL_alloc(headers, (void **)&header);
+        if (E__SUCCESS != result) {
+            goto l_cleanup;
+        }
+    } else {
+        header = (spmat_array_header_t *)malloc(sizeof(*header));
+        if (NULL == header) {
+            result = E__MALLOC_ERROR;
+            goto l_cleanup;
+        }
+    }
+
+    /* 2. Initialize */
+    (void)memset(header, 0, sizeof(*header));
+    header->matrix.vtable = &SPMAT_ARRAY_VTABLE;
+    header->matrix.n = n;
+    header->matrix.type = MATRIX_TYPE_SPMAT_ARRAY;
+    header->matrix.pool = headers;
+    header->matrix.private = (void *)&header->data;
+    header->data.storage = storage;
+    header->data.begin = begin;
+
+    /* 3. Reference the storage */
+    ++storage->references;
+
+    /* Success */
+    *mat_out = &header->matrix;
+
+    result = E__SUCCESS;
+l_cleanup:
+
+    return result;
+}
+
+static
+void
+spmat_array_storage_free(spmat_array_storage_t *storage)
+{
+    if (NULL != storage) {
+#if !SPMAT_ARRAY_PATTERN_ONLY
+        FREE_SAFE(storage->values);
+#endif /* SPMAT_ARRAY_PATTERN_ONLY */
+#if SPMAT_ARRAY_SYMMETRIC
+        FREE_SAFE(storage->scattered_s);
+        FREE_SAFE(storage->row_sums);
+        FREE_SAFE(storage->row_dots);
+#endif /* SPMAT_ARRAY_SYMMETRIC */
+        FREE_SAFE(storage->columns);
+        FREE_SAFE(storage->g);
+        FREE_SAFE(storage->rows);
+        FREE_SAFE(storage);
+    }
+}
+
+static
+void
+spmat_array_free(matrix_t *mat)
+{
+    spmat_array_data_t *data = NULL;
+
+    if (NULL != mat) {
+        DEBUG_PRINT("%s: addr %p n=%d\n", __func__, (void *)mat, mat->n);
+        data = GET_ARRAY_DATA(mat);
+        if ((NULL != data) && (NULL != data->storage)) {
+            /* 1. Free the storage with its last view */
+            --data->storage->references;
+            if (0 == data->storage->references) {
+                spmat_array_storage_free(data->storage);
+            }
+            data->storage = NULL;
+        }
+        mat->private = NULL;
+
+        /* 2. The view is a part of the header */
+        if (NULL != mat->pool) {
+            POOL_release(mat->pool, mat);
+        } else {
+            free(mat);
+        }
+    }
+}
+
+static
+result_t
+spmat_array_storage_reserve(spmat_array_storage_t *storage, size_t count)
+{
+    result_t result = E__UNKNOWN;
+    size_t capacity = 0;
+    int *columns = NULL;
+#if !SPMAT_ARRAY_PATTERN_ONLY
+    double *values = NULL;
+#endif /* SPMAT_ARRAY_PATTERN_ONLY */
+
+    /* 1. Check if there's enough room */
+    if (storage->columns_capacity - storage->columns_count >= count) {
+        result = E__SUCCESS;
+        goto l_cleanup;
+    }
+
+    /* 2. Double the capacity until there's enough room */
+    capacity = MAX(storage->columns_capacity, SPMAT_ARRAY_INITIAL_CAPACITY);
+    while (capacity - storage->columns_count < count) {
+        capacity *= 2;
+    }
+
+    /* 3. Reallocate */
+    columns = (int *)realloc(storage->columns, capacity * sizeof(*columns));
+    if (NULL == columns) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+    storage->columns = columns;
+
+#if !SPMAT_ARRAY_PATTERN_ONLY
+    values = (double *)realloc(storage->values, capacity * sizeof(*values));
+    if (NULL == values) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+    storage->values = values;
+#endif /* SPMAT_ARRAY_PATTERN_ONLY */
+
+    storage->columns_capacity = capacity;
+
+    result = E__SUCCESS;
+l_cleanup:
+
+    return result;
+}
+
+static
+result_t
+spmat_array_add_row(matrix_t *mat, const double *values, int row_index)
+{
+    result_t result = E__UNKNOWN;
+    spmat_array_storage_t *storage = NULL;
+    spmat_array_row_t *row = NULL;
+    size_t row_length = 0;
+    int col = 0;
+
+    /* 0. Input validation */
+    if ((NULL == mat) || (NULL == mat->private) || (NULL == values)) {
+        result = E__NULL_ARGUMENT;
+        goto l_cleanup;
+    }
+
+    if (!MATRIX_IS_VALID_ROW_INDEX(mat, row_index)) {
+        result = E__INVALID_ROW_INDEX;
+        goto l_cleanup;
+    }
+
+    storage = GET_STORAGE(mat);
+    row = &GET_ROWS(mat)[row_index];
+    if (0 != row->length) {
+        result = E__ROW_ALREADY_IN_USE;
+        goto l_cleanup;
+    }
+
+    /* 1. Count the non-zero columns */
+    for (col = SPMAT_ARRAY_FIRST_COLUMN(row_index) ; mat->n > col ; ++col) {
+        if (0 != values[col]) {
+#if SPMAT_ARRAY_PATTERN_ONLY
+            /* The value can't be stored */
+            if (1.0 != values[col]) {
+                result = E__INVALID_VALUE;
+                goto l_cleanup;
+            }
+#endif /* SPMAT_ARRAY_PATTERN_ONLY */
+            ++row_length;
+        }
+    }
+
+    /* 2. Append the row to the storage's columns */
+    result = spmat_array_storage_reserve(storage, row_length);
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+
+#if SPMAT_ARRAY_SYMMETRIC
+    storage->scattered_length = -1;
+#endif /* SPMAT_ARRAY_SYMMETRIC */
+
+    row->offset = storage->columns_count;
+    for (col = SPMAT_ARRAY_FIRST_COLUMN(row_index) ; mat->n > col ; ++col) {
+        if (0 != values[col]) {
+            storage->columns[storage->columns_count] = col;
+#if !SPMAT_ARRAY_PATTERN_ONLY
+            storage->values[storage->columns_count] = values[col];
+#endif /* SPMAT_ARRAY_PATTERN_ONLY */
+            ++storage->columns_count;
+        }
+    }
+    row->length = (int)row_length;
+
+    result = E__SUCCESS;
+l_cleanup:
+
+    return result;
+}
+
+static
+result_t
+spmat_array_add_pattern_row(matrix_t *mat,
+                            const int *columns,
+                            int length,
+                            int row_index)
+{
+    result_t result = E__UNKNOWN;
+    spmat_array_storage_t *storage = NULL;
+    spmat_array_row_t *row = NULL;
+    int first = 0;
+    int k = 0;
+
+    /* 0. Input validation */
+    if ((NULL == mat) || (NULL == mat->private)) {
+        result = E__NULL_ARGUMENT;
+        goto l_cleanup;
+    }
+
+    if (!MATRIX_IS_VALID_ROW_INDEX(mat, row_index)) {
+        result = E__INVALID_ROW_INDEX;
+        goto l_cleanup;
+    }
+
+    if (!MATRIX_is_valid_pattern(columns, length, mat->n)) {
+        result = E__INVALID_VALUE;
+        goto l_cleanup;
+    }
+
+    storage = GET_STORAGE(mat);
+    row = &GET_ROWS(mat)[row_index];
+    if (0 != row->length) {
+        result = E__ROW_ALREADY_IN_USE;
+        goto l_cleanup;
+    }
+
+    /* 1. Skip the columns that aren't stored */
+    while ((first < length) &&
+           (SPMAT_ARRAY_FIRST_COLUMN(row_index) > columns[first])) {
+        ++first;
+    }
+
+    /* 2. Append the row to the storage's columns */
+    result = spmat_array_storage_reserve(storage, (size_t)(length - first));
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+
+#if SPMAT_ARRAY_SYMMETRIC
+    storage->scattered_length = -1;
+#endif /* SPMAT_ARRAY_SYMMETRIC */
+
+    row->offset = storage->columns_count;
+    for (k = first ; k < length ; ++k) {
+        storage->columns[storage->columns_count] = columns[k];
+#if !SPMAT_ARRAY_PATTERN_ONLY
+        storage->values[storage->columns_count] = 1.0;
+#endif /* SPMAT_ARRAY_PATTERN_ONLY */
+        ++storage->columns_count;
+    }
+    row->length = length - first;
+
+    result = E__SUCCESS;
+l_cleanup:
+
+    return result;
+}
+
+static
+void
+spmat_array_mult(const matrix_t *mat, const double *v, double *result)
+{
+    const spmat_array_storage_t *storage = NULL;
+    const spmat_array_row_t *rows = NULL;
+    const int *columns = NULL;
+    double row_result = 0.0;
+    int i = 0;
+    int k = 0;
+
+    if ((NULL == mat) || (NULL == v) || (NULL == result)) {
+        return;
+    }
+
+    storage = GET_STORAGE(mat);
+    rows = GET_ROWS(mat);
+#if SPMAT_ARRAY_SYMMETRIC
+    /* The cells below the diag are scattered by the rows above them */
+    (void)memset(result, 0, mat->n * sizeof(*result));
+#endif /* SPMAT_ARRAY_SYMMETRIC */
+    for (i = 0 ; i < mat->n ; ++i) {
+        columns = GET_ROW_COLUMNS(storage, &rows[i]);
+        row_result = 0.0;
+        for (k = 0 ; k < rows[i].length ; ++k) {
+            row_result += GET_ROW_VALUE(storage, &rows[i], k) * v[columns[k]];
+#if SPMAT_ARRAY_SYMMETRIC
+            if (columns[k] != i) {
+                result[columns[k]] += GET_ROW_VALUE(storage, &rows[i], k) * v[i];
+            }
+#endif /* SPMAT_ARRAY_SYMMETRIC */
+        }
+#if SPMAT_ARRAY_SYMMETRIC
+        result[i] += row_result;
+#else /* SPMAT_ARRAY_SYMMETRIC */
+        result[i] = row_result;
+#endif /* SPMAT_ARRAY_SYMMETRIC */
+    }
+}
+
+static
+int *
+spmat_array_get_g(matrix_t *mat)
+{
+    return &GET_STORAGE(mat)->g[GET_ARRAY_DATA(mat)->begin];
+}
+
+static
+result_t
+spmat_array_extract(const matrix_t *mat,
+                    const int *g,
+                    int g_length,
+                    int *temp_positions,
+                    pool_t *headers,
+                    matrix_t **mat_out)
+{
+    result_t result = E__UNKNOWN;
+    matrix_t *extracted = NULL;
+    const spmat_array_storage_t *orig_storage = NULL;
+    const spmat_array_row_t *orig_row = NULL;
+    spmat_array_storage_t *storage = NULL;
+    spmat_array_row_t *row = NULL;
+    const int *columns = NULL;
+    bool_t are_positions_set = FALSE;
+    int position = 0;
+    int i = 0;
+    int k = 0;
+
+    /* 0. Input validation */
+    if ((NULL == mat) || (NULL == g) ||
+            (NULL == temp_positions) || (NULL == mat_out)) {
+        result = E__NULL_ARGUMENT;
+        goto l_cleanup;
+    }
+
+    /* 1. Allocate the extracted matrix */
+    result = SPMAT_ARRAY_allocate(g_length, headers, &extracted);
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+    orig_storage = GET_STORAGE(mat);
+    storage = GET_STORAGE(extracted);
+
+    /* 2. Map each extracted index to its new position */
+    for (i = 0 ; i < g_length ; ++i) {
+        temp_positions[g[i]] = i;
+    }
+    are_positions_set = TRUE;
+
+    /* 3. Append each row's columns that were extracted.
+     *    g is ascending, so the new rows stay sorted */
+    for (i = 0 ; i < g_length ; ++i) {
+        orig_row = &GET_ROWS(mat)[g[i]];
+        columns = GET_ROW_COLUMNS(orig_storage, orig_row);
+
+        result = spmat_array_storage_reserve(storage, orig_row->length);
+        if (E__SUCCESS != result) {
+            goto l_cleanup;
+        }
+
+        row = &storage->rows[i];
+        row->offset = storage->columns_count;
+        for (k = 0 ; k < orig_row->length ; ++k) {
+            position = temp_positions[columns[k]];
+            if (0 <= position) {
+                storage->columns[storage->columns_count] = position;
+#if !SPMAT_ARRAY_PATTERN_ONLY
+                storage->values[storage->columns_count] =
+                    GET_ROW_VALUE(orig_storage, orig_row, k);
+#endif /* SPMAT_ARRAY_PATTERN_ONLY */
+                ++storage->columns_count;
+            }
+        }
+        row->length = (int)(storage->columns_count - row->offset);
+
+        /* 3.1. Keep the original vertex of the row */
+        storage->g[i] = spmat_array_get_g((matrix_t *)mat)[g[i]];
+    }
+
+    /* Success */
+    *mat_out = extracted;
+
+    result = E__SUCCESS;
+l_cleanup:
+
+    /* 4. Restore the positions buffer */
+    if (are_positions_set) {
+        for (i = 0 ; i < g_length ; ++i) {
+            temp_positions[g[i]] = -1;
+        }
+    }
+
+    if (E__SUCCESS != result) {
+        spmat_array_free(extracted);
+        extracted = NULL;
+    }
+
+    return result;
+}
+
+static
+double
+spmat_array_sum_neighbors_div_M(const submatrix_t *smat,
+                                const eigen_real_t *v,
+                                double *k_dot_v_out)
+{
+    const double *neighbors_div_M = smat->adj->neighbors_div_M;
+    double k_sum = 0.0;
+    double k_dot_v = 0.0;
+    int j = 0;
+
+    if (NULL == v) {
+        for (j = 0 ; j < smat->g_length ; ++j) {
+            k_sum += neighbors_div_M[smat->g[j]];
+        }
+    } else {
+        for (j = 0 ; j < smat->g_length ; ++j) {
+            k_sum += neighbors_div_M[smat->g[j]];
+            k_dot_v += neighbors_div_M[smat->g[j]] * v[j];
+        }
+        *k_dot_v_out = k_dot_v;
+    }
+
+    return k_sum;
+}
+
+#if SPMAT_ARRAY_SYMMETRIC
+static
+void
+spmat_array_scatter_mult(const submatrix_t *smat,
+                         const eigen_real_t *v,
+                         const sign_word_t *s_vector)
+{
+    spmat_array_storage_t *storage = GET_STORAGE(smat->orig);
+    const spmat_array_row_t *rows = GET_ROWS(smat->orig);
+    double *dots = GET_ROW_DOTS(smat->orig);
+    double *sums = GET_ROW_SUMS(smat->orig);
+    const int *columns = NULL;
+    double value = 0.0;
+    double v_row = 0.0;
+    double a_dot_v = 0.0;
+    double a_sum = 0.0;
+    int row_g = 0;
+    int i = 0;
+
+    /* 1. Clear the buffers: the rows above add to them */
+    (void)memset(dots, 0, smat->g_length * sizeof(*dots));
+    (void)memset(sums, 0, smat->g_length * sizeof(*sums));
+
+    /* 1.1. Keep the s-vector the dots belong to */
+    storage->scattered_length = -1;
+    if (NULL == v) {
+        (void)memcpy(storage->scattered_s,
+                     s_vector,
+                     SIGN_VECTOR_WORDS(smat->g_length) * sizeof(*s_vector));
+        storage->scattered_begin = GET_ARRAY_DATA(smat->orig)->begin;
+        storage->scattered_length = smat->g_length;
+    }
+
+    for (row_g = 0 ; row_g < smat->g_length ; ++row_g) {
+        columns = GET_ROW_COLUMNS(storage, &rows[row_g]);
+        v_row = (NULL != v) ? v[row_g] : SIGN_VECTOR_VALUE(s_vector, row_g);
+        a_dot_v = 0.0;
+        a_sum = 0.0;
+        i = 0;
+
+        /* 2. The diag is the row's first column, if it is stored */
+        if ((0 < rows[row_g].length) && (row_g == columns[0])) {
+            value = GET_ROW_VALUE(storage, &rows[row_g], 0);
+            a_dot_v += value * v_row;
+            a_sum += value;
+            i = 1;
+        }
+
+        /* 3. Every other cell (row_g, j) is also the cell (j, row_g) */
+        if (NULL != v) {
+            for ( ; i < rows[row_g].length ; ++i) {
+                value = GET_ROW_VALUE(storage, &rows[row_g], i);
+                a_dot_v += value * v[columns[i]];
+                a_sum += value;
+                dots[columns[i]] += value * v_row;
+                sums[columns[i]] += value;
+            }
+        } else {
+            for ( ; i < rows[row_g].length ; ++i) {
+                value = GET_ROW_VALUE(storage, &rows[row_g], i);
+                a_dot_v += value * SIGN_VECTOR_VALUE(s_vector, columns[i]);
+                a_sum += value;
+                dots[columns[i]] += value * v_row;
+                sums[columns[i]] += value;
+            }
+        }
+
+        dots[row_g] += a_dot_v;
+        sums[row_g] += a_sum;
+    }
+}
+
+static
+void
+spmat_array_scatter_1norm(const submatrix_t *smat, double *k_sums)
+{
+    const spmat_array_storage_t *storage = GET_STORAGE(smat->orig);
+    const spmat_array_row_t *rows = GET_ROWS(smat->orig);
+    const double *neighbors_div_M = smat->adj->neighbors_div_M;
+    double *norms = GET_ROW_DOTS(smat->orig);
+    double *sums = GET_ROW_SUMS(smat->orig);
+    const int *columns = NULL;
+    double value = 0.0;
+    double cell_norm = 0.0;
+    int row_g = 0;
+    int col_g = 0;
+    int i = 0;
+
+    GET_STORAGE(smat->orig)->scattered_length = -1;
+    (void)memset(norms, 0, smat->g_length * sizeof(*norms));
+    (void)memset(sums, 0, smat->g_length * sizeof(*sums));
+    (void)memset(k_sums, 0, smat->g_length * sizeof(*k_sums));
+
+    for (row_g = 0 ; row_g < smat->g_length ; ++row_g) {
+        columns = GET_ROW_COLUMNS(storage, &rows[row_g]);
+        for (i = 0 ; i < rows[row_g].length ; ++i) {
+            col_g = columns[i];
+            value = GET_ROW_VALUE(storage, &rows[row_g], i);
+            sums[row_g] += value;
+            if (col_g != row_g) {
+                /* ki*kj/M is symmetric too */
+                cell_norm = fabs(value -
+                                 SPMAT_GET_EXPECTED_VALUE(smat,
+                                                          smat->g[row_g],
+                                                          smat->g[col_g]));
+                sums[col_g] += value;
+                norms[row_g] += cell_norm;
+                norms[col_g] += cell_norm;
+                k_sums[row_g] += neighbors_div_M[smat->g[col_g]];
+                k_sums[col_g] += neighbors_div_M[smat->g[row_g]];
+            }
+        }
+    }
+}
+
+static
+void
+spmat_array_scatter_column(const submatrix_t *smat, int col_g, double factor)
+{
+    const spmat_array_storage_t *storage = GET_STORAGE(smat->orig);
+    const spmat_array_row_t *rows = GET_ROWS(smat->orig);
+    double *dots = GET_ROW_DOTS(smat->orig);
+    const int *columns = NULL;
+    int row_g = 0;
+    int i = 0;
+
+    /* 1. The cells below the diag are stored by the rows above */
+    for (row_g = 0 ; row_g < col_g ; ++row_g) {
+        i = spmat_array_find_column(GET_ROW_COLUMNS(storage, &rows[row_g]),
+                                    rows[row_g].length,
+                                    col_g);
+        if (0 <= i) {
+            dots[row_g] += factor * GET_ROW_VALUE(storage, &rows[row_g], i);
+        }
+    }
+
+    /* 2. The column's row stores the rest */
+    columns = GET_ROW_COLUMNS(storage, &rows[col_g]);
+    for (i = 0 ; i < rows[col_g].length ; ++i) {
+        dots[columns[i]] += factor * GET_ROW_VALUE(storage, &rows[col_g], i);
+    }
+}
+
+static
+void
+spmat_array_update_scattered_s(const submatrix_t *smat,
+                               const sign_word_t *s_vector,
+                               int skipped_g)
+{
+    spmat_array_storage_t *storage = GET_STORAGE(smat->orig);
+    sign_word_t *scattered_s = storage->scattered_s;
+    sign_word_t moved = 0;
+    size_t words = SIGN_VECTOR_WORDS(smat->g_length);
+    size_t word = 0;
+    int bit = 0;
+    int col_g = 0;
+
+    /* 1. Scatter again if the dots belong to another view or vector */
+    if ((storage->scattered_begin != GET_ARRAY_DATA(smat->orig)->begin) ||
+            (storage->scattered_length != smat->g_length)) {
+        spmat_array_scatter_mult(smat, NULL, s_vector);
+    }
+
+    /* 2. Move each vertex whose sign differs: s_j changes by -2*s_j */
+    for (word = 0 ; word < words ; ++word) {
+        moved = s_vector[word] ^ scattered_s[word];
+        for (bit = 0 ; (0 != moved) && (bit < SIGN_WORD_BITS) ; ++bit) {
+            col_g = (int)(word * SIGN_WORD_BITS) + bit;
+            if ((0 == ((moved >> bit) & 1)) ||
+                    (col_g == skipped_g) || (col_g >= smat->g_length)) {
+                continue;
+            }
+            moved &= ~((sign_word_t)1 << bit);
+            spmat_array_scatter_column(smat,
+                                       col_g,
+                                       -2.0 * SIGN_VECTOR_VALUE(scattered_s,
+                                                                col_g));
+            SIGN_VECTOR_FLIP(scattered_s, col_g);
+        }
+    }
+}
+
+static
+int
+spmat_array_find_column(const int *columns, int length, int column)
+{
+    int low = 0;
+    int high = length;
+    int middle = 0;
+
+    while (low < high) {
+        middle = low + (high - low) / 2;
+        if (columns[middle] < column) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    return ((low < length) && (column == columns[low])) ? low : -1;
+}
+#endif /* SPMAT_ARRAY_SYMMETRIC */
+
+static
+double
+spmat_array_mult_row(const submatrix_t *smat,
+                     int row_g,
+                     const eigen_real_t *v,
+                     double k_sum,
+                     double k_dot_v)
+{
+#if !SPMAT_ARRAY_SYMMETRIC
+    const spmat_array_storage_t *storage = GET_STORAGE(smat->orig);
+    const spmat_array_row_t *row = &GET_ROWS(smat->orig)[row_g];
+    const int *columns = GET_ROW_COLUMNS(storage, row);
+    int i = 0;
+#endif /* SPMAT_ARRAY_SYMMETRIC */
+    double a_dot_v = 0.0;
+    double a_sum = 0.0;
+    double k = 0.0;
+    double f = 0.0;
+
+    /* 1. The adjacency part: A[g]*v and the row's sum */
+#if SPMAT_ARRAY_SYMMETRIC
+    a_dot_v = GET_ROW_DOTS(smat->orig)[row_g];
+    a_sum = GET_ROW_SUMS(smat->orig)[row_g];
+#else /* SPMAT_ARRAY_SYMMETRIC */
+    for (i = 0 ; i < row->length ; ++i) {
+        a_dot_v += GET_ROW_VALUE(storage, row, i) * v[columns[i]];
+        a_sum += GET_ROW_VALUE(storage, row, i);
+    }
+#endif /* SPMAT_ARRAY_SYMMETRIC */
+
+    /* 2. B[g]_ij = A_ij - ki*kj/M, and f_i is the sum of B[g]'s row */
+    k = (double)smat->adj->neighbors[smat->g[row_g]];
+    f = a_sum - (k * k_sum);
+
+    return a_dot_v - (k * k_dot_v) + ((smat->add_to_diag - f) * v[row_g]);
+}
+
+static
+double
+spmat_array_mult_row_with_s(const submatrix_t *smat,
+                            int row_g,
+                            const sign_word_t *s_vector,
+                            double k_sum,
+                            double k_dot_s)
+{
+#if !SPMAT_ARRAY_SYMMETRIC
+    const spmat_array_storage_t *storage = GET_STORAGE(smat->orig);
+    const spmat_array_row_t *row = &GET_ROWS(smat->orig)[row_g];
+    const int *columns = GET_ROW_COLUMNS(storage, row);
+    int i = 0;
+#endif /* SPMAT_ARRAY_SYMMETRIC */
+    double a_dot_s = 0.0;
+    double a_sum = 0.0;
+    double k = 0.0;
+    double f = 0.0;
+
+    /* 1. The adjacency part: A[g]*s and the row's sum */
+#if SPMAT_ARRAY_SYMMETRIC
+    a_dot_s = GET_ROW_DOTS(smat->orig)[row_g];
+    a_sum = GET_ROW_SUMS(smat->orig)[row_g];
+#else /* SPMAT_ARRAY_SYMMETRIC */
+    for (i = 0 ; i < row->length ; ++i) {
+        a_dot_s += GET_ROW_VALUE(storage, row, i) *
+                   SIGN_VECTOR_VALUE(s_vector, columns[i]);
+        a_sum += GET_ROW_VALUE(storage, row, i);
+    }
+#endif /* SPMAT_ARRAY_SYMMETRIC */
+
+    /* 2. B[g]_ij = A_ij - ki*kj/M, and f_i is the sum of B[g]'s row */
+    k = (double)smat->adj->neighbors[smat->g[row_g]];
+    f = a_sum - (k * k_sum);
+
+    return a_dot_s - (k * k_dot_s) +
+           ((smat->add_to_diag - f) * SIGN_VECTOR_VALUE(s_vector, row_g));
+}
+
+double
+SUBMAT_SPMAT_ARRAY_mult(const submatrix_t *smat,
+                        const eigen_real_t *vector,
+                        eigen_real_t *result)
+{
+    double k_sum = 0.0;
+    double k_dot_v = 0.0;
+    double norm_square = 0.0;
+    double current_row_mul = 0.0;
+    int row_g = 0;
+
+    k_sum = spmat_array_sum_neighbors_div_M(smat, vector, &k_dot_v);
+#if SPMAT_ARRAY_SYMMETRIC
+    spmat_array_scatter_mult(smat, vector, NULL);
+#endif /* SPMAT_ARRAY_SYMMETRIC */
+    for (row_g = 0 ; row_g < smat->g_length ; ++row_g) {
+        current_row_mul = spmat_array_mult_row(smat,
+                                               row_g,
+                                               vector,
+                                               k_sum,
+                                               k_dot_v);
+        result[row_g] = (eigen_real_t)current_row_mul;
+        norm_square += current_row_mul * current_row_mul;
+    }
+
+    return norm_square;
+}
+
+double
+SUBMAT_SPMAT_ARRAY_mult_vmv(const submatrix_t *smat,
+                            const eigen_real_t *vector)
+{
+    double k_sum = 0.0;
+    double k_dot_v = 0.0;
+    double result = 0.0;
+    int row_g = 0;
+
+    k_sum = spmat_array_sum_neighbors_div_M(smat, vector, &k_dot_v);
+#if SPMAT_ARRAY_SYMMETRIC
+    spmat_array_scatter_mult(smat, vector, NULL);
+#endif /* SPMAT_ARRAY_SYMMETRIC */
+    for (row_g = 0 ; row_g < smat->g_length ; ++row_g) {
+        result += vector[row_g] * spmat_array_mult_row(smat,
+                                                       row_g,
+                                                       vector,
+                                                       k_sum,
+                                                       k_dot_v);
+    }
+
+    return result;
+}
+
+double
+SUBMAT_SPMAT_ARRAY_calculate_q(const submatrix_t *smat,
+                               const sign_word_t *s_vector)
+{
+    double k_sum = 0.0;
+    double k_dot_s = 0.0;
+    double mult_vmv = 0.0;
+    int row_g = 0;
+
+    k_sum = spmat_array_sum_neighbors_div_M(smat, NULL, NULL);
+    k_dot_s = VECTOR_gather_multiply_with_s(smat->adj->neighbors_div_M,
+                                            smat->g,
+                                            s_vector,
+                                            smat->g_length);
+#if SPMAT_ARRAY_SYMMETRIC
+    spmat_array_scatter_mult(smat, NULL, s_vector);
+#endif /* SPMAT_ARRAY_SYMMETRIC */
+    for (row_g = 0 ; row_g < smat->g_length ; ++row_g) {
+        mult_vmv += SIGN_VECTOR_VALUE(s_vector, row_g) *
+                    spmat_array_mult_row_with_s(smat,
+                                                row_g,
+                                                s_vector,
+                                                k_sum,
+                                                k_dot_s);
+    }
+
+    return mult_vmv;
+}
+
+double
+SUBMAT_SPMAT_ARRAY_get_1norm(const submatrix_t *smat,
+                             double *tmp_row_sums)
+{
+    const spmat_array_storage_t *storage = GET_STORAGE(smat->orig);
+    const spmat_array_row_t *rows = GET_ROWS(smat->orig);
+    const double *neighbors_div_M = smat->adj->neighbors_div_M;
+    const int *columns = NULL;
+    double norm = 0.0;
+    double k_sum = 0.0;
+    double k = 0.0;
+    double a_sum = 0.0;
+    double a_diag = 0.0;
+    double edges_norm = 0.0;
+    double edges_k_sum = 0.0;
+    double zeroes_norm = 0.0;
+    double diag_value = 0.0;
+    int row_g = 0;
+    int row_i = 0;
+#if !SPMAT_ARRAY_SYMMETRIC
+    int i = 0;
+#endif /* SPMAT_ARRAY_SYMMETRIC */
+
+    /* Note: The adjacency matrix is symmetric, therefore 1-norm can be done on
+     *       either max row sum or max column sum */
+    k_sum = spmat_array_sum_neighbors_div_M(smat, NULL, NULL);
+
+#if SPMAT_ARRAY_SYMMETRIC
+    spmat_array_scatter_1norm(smat, tmp_row_sums);
+#else /* SPMAT_ARRAY_SYMMETRIC */
+    UNUSED_ARG(tmp_row_sums);
+#endif /* SPMAT_ARRAY_SYMMETRIC */
+
+    for (row_g = 0 ; row_g < smat->g_length ; ++row_g) {
+        row_i = smat->g[row_g];
+        k = (double)smat->adj->neighbors[row_i];
+        columns = GET_ROW_COLUMNS(storage, &rows[row_g]);
+
+        /* 1. Non-zero cells: |A_ij - ki*kj/M| */
+#if SPMAT_ARRAY_SYMMETRIC
+        a_sum = GET_ROW_SUMS(smat->orig)[row_g];
+        edges_norm = GET_ROW_DOTS(smat->orig)[row_g];
+        edges_k_sum = tmp_row_sums[row_g];
+        a_diag = 0.0;
+        if ((0 < rows[row_g].length) && (row_g == columns[0])) {
+            a_diag = GET_ROW_VALUE(storage, &rows[row_g], 0);
+        }
+#else /* SPMAT_ARRAY_SYMMETRIC */
+        a_sum = 0.0;
+        a_diag = 0.0;
+        edges_norm = 0.0;
+        edges_k_sum = 0.0;
+        for (i = 0 ; i < rows[row_g].length ; ++i) {
+            a_sum += GET_ROW_VALUE(storage, &rows[row_g], i);
+            if (columns[i] == row_g) {
+                a_diag += GET_ROW_VALUE(storage, &rows[row_g], i);
+            } else {
+                edges_k_sum += neighbors_div_M[smat->g[columns[i]]];
+                edges_norm += fabs(GET_ROW_VALUE(storage, &rows[row_g], i) -
+                                   SPMAT_GET_EXPECTED_VALUE(smat,
+                                                            row_i,
+                                                            smat->g[columns[i]]));
+            }
+        }
+#endif /* SPMAT_ARRAY_SYMMETRIC */
+
+        /* 2. Zero cells: |0 - ki*kj/M| summed over the rest of the row */
+        zeroes_norm = k * (k_sum - edges_k_sum - neighbors_div_M[row_i]);
+
+        /* 3. The diag is decreased by the row's sum f_i */
+        diag_value = a_diag - SPMAT_GET_EXPECTED_VALUE(smat, row_i, row_i) +
+                     smat->add_to_diag - (a_sum - (k * k_sum));
+
+        norm = MAX(norm, zeroes_norm + edges_norm + fabs(diag_value));
+    }
+
+    return norm;
+}
+
+double
+SUBMAT_SPMAT_ARRAY_calc_q_score(const submatrix_t *smat,
+                                const sign_word_t *vector,
+                                int row_g)
+{
+    const spmat_array_storage_t *storage = GET_STORAGE(smat->orig);
+    const spmat_array_row_t *row = &GET_ROWS(smat->orig)[row_g];
+    const int *columns = GET_ROW_COLUMNS(storage, row);
+    double a_dot_s = 0.0;
+    double k_dot_s = 0.0;
+    double k = 0.0;
+    double s_row = 0.0;
+    double q_part1 = 0.0;
+    double expected_value = 0.0;
+    int row_i = 0;
+    int i = 0;
+
+    row_i = smat->g[row_g];
+    k = (double)smat->adj->neighbors[row_i];
+
+    /* 1. B_ij * s_j = A_ij * s_j - ki * (kj/M * s_j) */
+#if SPMAT_ARRAY_SYMMETRIC
+    /* 1.1. The dots hold A*s, except for the row's own move, which only
+     *      changes its diag's term */
+    spmat_array_update_scattered_s(smat, vector, row_g);
+    a_dot_s = GET_ROW_DOTS(smat->orig)[row_g];
+    if ((0 < row->length) && (row_g == columns[0]) &&
+            (SIGN_VECTOR_BIT(vector, row_g) !=
+             SIGN_VECTOR_BIT(GET_STORAGE(smat->orig)->scattered_s, row_g))) {
+        a_dot_s += 2.0 * SIGN_VECTOR_VALUE(vector, row_g) *
+                   GET_ROW_VALUE(storage, row, 0);
+    }
+    UNUSED_ARG(i);
+#else /* SPMAT_ARRAY_SYMMETRIC */
+    for (i = 0 ; i < row->length ; ++i) {
+        a_dot_s += GET_ROW_VALUE(storage, row, i) *
+                   SIGN_VECTOR_VALUE(vector, columns[i]);
+    }
+#endif /* SPMAT_ARRAY_SYMMETRIC */
+    k_dot_s = VECTOR_gather_multiply_with_s(smat->adj->neighbors_div_M,
+                                            smat->g,
+                                            vector,
+                                            smat->g_length);
+    s_row = SIGN_VECTOR_VALUE(vector, row_g);
+    q_part1 = a_dot_s - (k * k_dot_s) + (2 * smat->add_to_diag * s_row);
+
+    expected_value = SPMAT_GET_EXPECTED_VALUE(smat, row_i, row_i);
+
+    return 4 * (s_row * q_part1 + expected_value);
+}
+
+static
+void
+spmat_array_permute_rows(spmat_array_storage_t *storage,
+                         int begin,
+                         int *positions,
+                         int length)
+{
+    spmat_array_row_t *rows = &storage->rows[begin];
+    int *g = &storage->g[begin];
+    spmat_array_row_t carried_row;
+    spmat_array_row_t swapped_row;
+    int carried_g = 0;
+    int swapped_g = 0;
+    int target = 0;
+    int i = 0;
+    int j = 0;
+
+    /* Follow each permutation cycle, carrying the displaced row along */
+    for (i = 0 ; i < length ; ++i) {
+        if (0 > positions[i]) {
+            /* Already placed */
+            continue;
+        }
+
+        carried_row = rows[i];
+        carried_g = g[i];
+        for (j = i ; 0 <= positions[j] ; j = target) {
+            target = positions[j];
+            positions[j] = ~target;
+
+            swapped_row = rows[target];
+            rows[target] = carried_row;
+            carried_row = swapped_row;
+
+            swapped_g = g[target];
+            g[target] = carried_g;
+            carried_g = swapped_g;
+        }
+    }
+}
+
+#if SPMAT_ARRAY_USE_BITSET
+static
+result_t
+spmat_array_to_bitset(const matrix_t *mat, matrix_t **bitset_out)
+{
+    result_t result = E__UNKNOWN;
+    const spmat_array_storage_t *storage = GET_STORAGE(mat);
+    const spmat_array_row_t *rows = GET_ROWS(mat);
+    const int *columns = NULL;
+    matrix_t *bitset = NULL;
+    int i = 0;
+    int k = 0;
+
+    /* 1. Allocate the bitset matrix, with the view's vertices */
+    result = SPMAT_BITSET_allocate(mat->n, NULL, &bitset);
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+    (void)memcpy(MATRIX_VTABLE(bitset)->get_g(bitset),
+                 spmat_array_get_g((matrix_t *)mat),
+                 mat->n * sizeof(*storage->g));
+
+    /* 2. Set the rows' cells. An upper triangle's cells are mirrored */
+    for (i = 0 ; i < mat->n ; ++i) {
+        columns = GET_ROW_COLUMNS(storage, &rows[i]);
+        for (k = 0 ; k < rows[i].length ; ++k) {
+            SPMAT_BITSET_set_cell(bitset, i, columns[k]);
+#if SPMAT_ARRAY_SYMMETRIC
+            SPMAT_BITSET_set_cell(bitset, columns[k], i);
+#endif /* SPMAT_ARRAY_SYMMETRIC */
+        }
+    }
+
+    /* Success */
+    *bitset_out = bitset;
+
+    result = E__SUCCESS;
+l_cleanup:
+
+    return result;
+}
+#endif /* SPMAT_ARRAY_USE_BITSET */
+
+result_t
+SUBMAT_SPMAT_ARRAY_split(submatrix_t *smat,
+                         const sign_word_t *vector_s,
+                         int *temp_s_indexes,
+                         submatrix_t **matrix1_out,
+                         submatrix_t **matrix2_out)
+{
+    result_t result = E__UNKNOWN;
+    spmat_array_storage_t *storage = NULL;
+    spmat_array_row_t *rows = NULL;
+    matrix_t *matrices[2] = {NULL, NULL};
+    submatrix_t *smats[2] = {NULL, NULL};
+#if SPMAT_ARRAY_USE_BITSET
+    matrix_t *bitset = NULL;
+#endif /* SPMAT_ARRAY_USE_BITSET */
+    int *columns = NULL;
+    int begin = 0;
+    int matrix1_n = 0;
+    int row_length = 0;
+    int part = 0;
+    int i = 0;
+    int k = 0;
+
+    /* 0. Input validation */
+    /* Null arguments */
+    if ((NULL == smat) ||
+            (NULL == vector_s) ||
+            (NULL == temp_s_indexes) ||
+            (NULL == matrix1_out) ||
+            (NULL == matrix2_out)) {
+        result = E__NULL_ARGUMENT;
+        goto l_cleanup;
+    }
+
+    storage = GET_STORAGE(smat->orig);
+    rows = GET_ROWS(smat->orig);
+    begin = GET_ARRAY_DATA(smat->orig)->begin;
+
+    /* 1. Create s-indexes vector, get matrix1's length */
+    matrix1_n = VECTOR_create_s_indexes(vector_s,
+                                        smat->g_length,
+                                        temp_s_indexes);
+
+    /* 2. Create the views: matrix1 is the first matrix1_n rows */
+    result = spmat_array_create_view(storage,
+                                     begin,
+                                     matrix1_n,
+                                     SUBMATRIX_MATRICES_POOL(smat),
+                                     &matrices[0]);
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+
+    result = spmat_array_create_view(storage,
+                                     begin + matrix1_n,
+                                     smat->g_length - matrix1_n,
+                                     SUBMATRIX_MATRICES_POOL(smat),
+                                     &matrices[1]);
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+
+#if SPMAT_ARRAY_SYMMETRIC
+    storage->scattered_length = -1;
+#endif /* SPMAT_ARRAY_SYMMETRIC */
+
+    /* 3. Filter each row's columns to its own group, keeping them sorted.
+     *    The cross columns are dropped from the row's length */
+    for (i = 0 ; i < smat->g_length ; ++i) {
+        columns = GET_ROW_COLUMNS(storage, &rows[i]);
+        row_length = 0;
+        for (k = 0 ; k < rows[i].length ; ++k) {
+            if (SIGN_VECTOR_BIT(vector_s, columns[k]) ==
+                    SIGN_VECTOR_BIT(vector_s, i)) {
+                columns[row_length] = temp_s_indexes[columns[k]];
+#if !SPMAT_ARRAY_PATTERN_ONLY
+                GET_ROW_VALUE(storage, &rows[i], row_length) =
+                    GET_ROW_VALUE(storage, &rows[i], k);
+#endif /* SPMAT_ARRAY_PATTERN_ONLY */
+                ++row_length;
+            }
+        }
+        rows[i].length = row_length;
+    }
+
+    /* 4. Stable partition of the rows and g-vector: matrix1 then matrix2 */
+    for (i = 0 ; i < smat->g_length ; ++i) {
+        temp_s_indexes[i] += matrix1_n * SIGN_VECTOR_BIT(vector_s, i);
+    }
+    spmat_array_permute_rows(storage, begin, temp_s_indexes, smat->g_length);
+
+    /* 5. Create the submatrices */
+    for (part = 0 ; part < 2 ; ++part) {
+#if SPMAT_ARRAY_USE_BITSET
+        /* 5.1. A small part is copied out of the storage to a bitset */
+        if (SPMAT_BITSET_MAX_ROWS >= matrices[part]->n) {
+            result = spmat_array_to_bitset(matrices[part], &bitset);
+            if (E__SUCCESS != result) {
+                goto l_cleanup;
+            }
+            spmat_array_free(matrices[part]);
+            matrices[part] = bitset;
+            bitset = NULL;
+        }
+#endif /* SPMAT_ARRAY_USE_BITSET */
+
+        result = SUBMATRIX_create(smat->adj,
+                                  matrices[part],
+                                  smat->pool,
+                                  &smats[part]);
+        if (E__SUCCESS != result) {
+            goto l_cleanup;
+        }
+        smats[part]->g_length = matrices[part]->n;
+        matrices[part] = NULL;
+    }
+
+    /* Success */
+    *matrix1_out = smats[0];
+    *matrix2_out = smats[1];
+
+    result = E__SUCCESS;
+l_cleanup:
+
+    if (E__SUCCESS != result) {
+        MATRIX_FREE_SAFE(matrices[0]);
+        MATRIX_FREE_SAFE(matrices[1]);
+        SUBMATRIX_FREE_SAFE(smats[0]);
+        SUBMATRIX_FREE_SAFE(smats[1]);
+    }
+
+    return result;
+}
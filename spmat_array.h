@@ -0,0 +1,94 @@
+/*
+ * @file spmat_array.h
+ * @purpose Sparse matrix implemented using contiguous rows and columns arrays.
+ *          A split partitions the arrays in place: the two submatrices are
+ *          views over subranges of their parent's storage
+ */
+#ifndef __SPMAT_ARRAY_H__
+#define __SPMAT_ARRAY_H__
+
+/* Includes ******************************************************************/
+#include <stddef.h>
+
+#include "matrix.h"
+#include "submatrix.h"
+#include "common.h"
+#include "pool.h"
+
+
+/* Functions Declarations ****************************************************/
+/* Creates a pool of contiguous arrays sparse matrices' headers */
+result_t
+SPMAT_ARRAY_create_headers_pool(pool_t **pool_out);
+
+/*
+ * Allocates a new contiguous arrays sparse matrix of size n.
+ * Its header is recycled from the headers pool, or allocated if it is NULL
+ */
+result_t
+SPMAT_ARRAY_allocate(int n, pool_t *headers, matrix_t **mat);
+
+/*
+ * Calculate the 1-norm of a given submatrix
+ *
+ * @param submatrix The submatrix
+ * @param tmp_rows_sums Temp buffer with size n
+ */
+double
+SUBMAT_SPMAT_ARRAY_get_1norm(const submatrix_t *smat,
+                             double *tmp_row_sums);
+
+/*
+ * Multiply the submatrix with a given vector, to a pre-allocated buffer
+ *
+ * @param submatrix The submatrix
+ * @param vector Buffer to multiply with
+ * @param result pre-allocated buffer
+ *
+ * @return The result's squared norm
+ */
+double
+SUBMAT_SPMAT_ARRAY_mult(const submatrix_t *smat,
+                        const eigen_real_t *vector,
+                        eigen_real_t *result);
+
+/*
+ * Calculate v^T*B*v of the submatrix with a given vector. Every row's
+ * multiplication is kept in double precision
+ */
+double
+SUBMAT_SPMAT_ARRAY_mult_vmv(const submatrix_t *smat,
+                            const eigen_real_t *vector);
+
+/**
+ * Calculate the Q of the submatrix with a given vector
+ */
+double
+SUBMAT_SPMAT_ARRAY_calculate_q(const submatrix_t *smat,
+                               const sign_word_t *s_vector);
+
+/**
+ * Split a submatrix into two submatrices accordingly to a given s-vector.
+ * The rows, g-vector and columns are permuted in place, and the returned
+ * submatrices are views over the two parts of smat's storage. A part of up
+ * to SPMAT_BITSET_MAX_ROWS rows is copied to a bitset matrix instead.
+ *
+ * @remark temp_s_indexes is overwritten
+ */
+result_t
+SUBMAT_SPMAT_ARRAY_split(submatrix_t *smat,
+                         const sign_word_t *vector_s,
+                         int *temp_s_indexes,
+                         submatrix_t **matrix1_out,
+                         submatrix_t **matrix2_out);
+
+/**
+ * Calculate the the improved formula Q score within algorithm 4
+ */
+double
+SUBMAT_SPMAT_ARRAY_calc_q_score(const submatrix_t *smat,
+                                const sign_word_t *vector,
+                                int row);
+
+
+#endif /* __SPMAT_ARRAY_H__ */
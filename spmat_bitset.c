@@ -0,0 +1,855 @@
+/*
+ * @file spmat_bitset.c
+ * @purpose Adjacency matrix implemented as a bitset row per vertex.
+ *          A row multiplied by the bit-packed s-vector is counted 64 cells
+ *          at a time: popcount(row) - 2 * popcount(row & s). Meant for the
+ *          small, dense groups of the division's deep levels
+ */
+
+/* Includes ******************************************************************/
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+#include "results.h"
+#include "matrix.h"
+#include "spmat_bitset.h"
+#include "common.h"
+#include "debug.h"
+#include "vector.h"
+#include "submatrix.h"
+#include "pool.h"
+
+
+/* Constants *****************************************************************/
+/* A De Bruijn sequence: multiplied by a single bit, its top 6 bits are
+ * unique for each bit's index */
+#define SPMAT_BITSET_DE_BRUIJN (UINT64_C(0x03f79d71b4cb0a89))
+#define SPMAT_BITSET_DE_BRUIJN_SHIFT (58)
+
+
+/* Structs *******************************************************************/
+/* matrix->private: n rows of row_words words each. Cells are all 1 */
+typedef struct spmat_bitset_data_s {
+    sign_word_t *bits;
+    /* Original vertex index of each row */
+    int *g;
+    /* Count of each row's set bits */
+    int *row_sums;
+    size_t row_words;
+} spmat_bitset_data_t;
+
+/* A matrix_t and its data, allocated at once */
+typedef struct spmat_bitset_header_s {
+    matrix_t matrix;
+    spmat_bitset_data_t data;
+} spmat_bitset_header_t;
+
+
+/* Macros ********************************************************************/
+#define GET_BITSET_DATA(matrix) ((spmat_bitset_data_t *)((matrix)->private))
+
+#define GET_ROW_BITS(data, row) (&(data)->bits[(size_t)(row) * \
+                                               (data)->row_words])
+
+/* The index of a word's lowest set bit. The word must not be 0 */
+#define SPMAT_BITSET_LOWEST_BIT(word) (spmat_bitset_de_bruijn_index[         \
+    (((word) & (~(word) + 1)) * SPMAT_BITSET_DE_BRUIJN) >>                  \
+    SPMAT_BITSET_DE_BRUIJN_SHIFT])
+
+#define SPMAT_GET_EXPECTED_VALUE(smat, i, j) (                              \
+    (smat->adj->neighbors[(i)] * smat->adj->neighbors_div_M[(j)])           \
+)
+
+
+/* Globals *******************************************************************/
+/* Maps the top bits of a bit multiplied by the sequence to its index */
+static const int spmat_bitset_de_bruijn_index[SIGN_WORD_BITS] = {
+    0, 1, 48, 2, 57, 49, 28, 3, 61, 58, 50, 42, 38, 29, 17, 4,
+    62, 55, 59, 36, 53, 51, 43, 22, 45, 39, 33, 30, 24, 18, 12, 5,
+    63, 47, 56, 27, 60, 41, 37, 16, 54, 35, 52, 21, 44, 32, 23, 11,
+    46, 26, 40, 15, 34, 20, 31, 10, 25, 14, 19, 9, 13, 8, 7, 6,
+};
+
+
+/* Functions Declarations ****************************************************/
+/**
+ * @purpose Set a row of the matrix. A row can be set only once
+ * @see matrix_add_row_f on matrix.h
+ */
+static
+result_t
+spmat_bitset_add_row(matrix_t *mat, const double *row, int i);
+
+/**
+ * @purpose Set a row of the matrix by its columns. A row can be set only once
+ * @see matrix_add_pattern_row_f on matrix.h
+ */
+static
+result_t
+spmat_bitset_add_pattern_row(matrix_t *mat, const int *columns, int length, int i);
+
+/**
+ * @see matrix_free_f on matrix.h
+ */
+static
+void
+spmat_bitset_free(matrix_t *mat);
+
+/**
+ * @see matrix_mult_f on matrix.h
+ */
+static
+void
+spmat_bitset_mult(const matrix_t *mat, const double *v, double *result);
+
+/**
+ * @see matrix_get_g_f on matrix.h
+ */
+static
+int *
+spmat_bitset_get_g(matrix_t *mat);
+
+/**
+ * @see matrix_extract_f on matrix.h
+ */
+static
+result_t
+spmat_bitset_extract(const matrix_t *mat,
+                     const int *g,
+                     int g_length,
+                     int *temp_positions,
+                     pool_t *headers,
+                     matrix_t **mat_out);
+
+/**
+ * @purpose Sum k_j/M, and optionally k_j/M * v_j, over the submatrix's g
+ * @param smat The submatrix
+ * @param v A g_length-sized vector, or NULL
+ * @param k_dot_v_out k/M multiplied by v. Not set if v is NULL
+ *
+ * @return The sum of k_j/M
+ */
+static
+double
+spmat_bitset_sum_neighbors_div_M(const submatrix_t *smat,
+                                 const eigen_real_t *v,
+                                 double *k_dot_v_out);
+
+/**
+ * @purpose Multiply a row of the submatrix (with hat) with a given vector
+ * @param smat The submatrix
+ * @param row_g The row's index
+ * @param v The vector
+ * @param k_sum The sum of k_j/M over g
+ * @param k_dot_v The scalar multiplication of k/M over g with v
+ *
+ * @return The multiplication result
+ */
+static
+double
+spmat_bitset_mult_row(const submatrix_t *smat,
+                      int row_g,
+                      const eigen_real_t *v,
+                      double k_sum,
+                      double k_dot_v);
+
+/**
+ * @purpose Multiply a row of the adjacency with an s-vector
+ * @param data The matrix's data
+ * @param row_g The row's index
+ * @param s_vector The s-vector
+ *
+ * @return The multiplication result
+ */
+static
+double
+spmat_bitset_row_dot_s(const spmat_bitset_data_t *data,
+                       int row_g,
+                       const sign_word_t *s_vector);
+
+
+/* Virtual Table *************************************************************/
+const matrix_vtable_t SPMAT_BITSET_VTABLE = {
+    .add_row = spmat_bitset_add_row,
+    .add_pattern_row = spmat_bitset_add_pattern_row,
+    .free = spmat_bitset_free,
+    .mult = spmat_bitset_mult,
+    .mult_vmv = NULL,
+    .get_g = spmat_bitset_get_g,
+    .extract = spmat_bitset_extract,
+    .submat_get_1norm = SUBMAT_SPMAT_BITSET_get_1norm,
+    .submat_mult = SUBMAT_SPMAT_BITSET_mult,
+    .submat_mult_vmv = SUBMAT_SPMAT_BITSET_mult_vmv,
+    .submat_calculate_q = SUBMAT_SPMAT_BITSET_calculate_q,
+    .submat_calc_q_score = SUBMAT_SPMAT_BITSET_calc_q_score,
+    .submat_split = SUBMAT_SPMAT_BITSET_split,
+};
+
+
+/* Functions *****************************************************************/
+result_t
+SPMAT_BITSET_create_headers_pool(pool_t **pool_out)
+{
+    return POOL_create(sizeof(spmat_bitset_header_t), pool_out);
+}
+
+result_t
+SPMAT_BITSET_allocate(int n, pool_t *headers, matrix_t **mat_out)
+{
+    result_t result = E__UNKNOWN;
+    spmat_bitset_header_t *header = NULL;
+    spmat_bitset_data_t *data = NULL;
+    int i = 0;
+
+    /* 0. Input validation */
+    if (NULL == mat_out) {
+        result = E__NULL_ARGUMENT;
+        goto l_cleanup;
+    }
+
+    if (0 > n) {
+        result = E__INVALID_SIZE;
+        goto l_cleanup;
+    }
+
+    /* 1. Allocate the header, recycle one if possible */
+    if (NULL != headers) {
+        result = POOL_alloc(headers, (void **)&header);
+        if (E__SUCCESS != result) {
+            goto l_cleanup;
+        }
+    } else {
+        header = (spmat_bitset_header_t *)malloc(sizeof(*header));
+        if (NULL == header) {
+            result = E__MALLOC_ERROR;
+            goto l_cleanup;
+        }
+    }
+    (void)memset(header, 0, sizeof(*header));
+    header->matrix.vtable = &SPMAT_BITSET_VTABLE;
+    header->matrix.n = n;
+    header->matrix.type = MATRIX_TYPE_SPMAT_BITSET;
+    header->matrix.pool = headers;
+    header->matrix.private = (void *)&header->data;
+    data = &header->data;
+
+    /* 2. Rows, initialized as empty */
+    data->row_words = SIGN_VECTOR_WORDS(n);
+    data->bits = (sign_word_t *)calloc(MAX((size_t)n * data->row_words, 1),
+                                       sizeof(*data->bits));
+    if (NULL == data->bits) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+
+    data->row_sums = (int *)calloc(MAX(n, 1), sizeof(*data->row_sums));
+    if (NULL == data->row_sums) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+
+    /* 3. g-vector, the rows are the original vertices */
+    data->g = (int *)malloc(MAX(n, 1) * sizeof(*data->g));
+    if (NULL == data->g) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+    for (i = 0 ; i < n ; ++i) {
+        data->g[i] = i;
+    }
+
+    DEBUG_PRINT("%s: addr %p n=%d\n", __func__, (void *)header, n);
+    /* Success */
+    *mat_out = &header->matrix;
+
+    result = E__SUCCESS;
+l_cleanup:
+
+    if ((E__SUCCESS != result) && (NULL != header)) {
+        spmat_bitset_free(&header->matrix);
+        header = NULL;
+    }
+
+    return result;
+}
+
+void
+SPMAT_BITSET_set_cell(matrix_t *mat, int row, int col)
+{
+    spmat_bitset_data_t *data = GET_BITSET_DATA(mat);
+    sign_word_t *bits = GET_ROW_BITS(data, row);
+
+    if (0 == SIGN_VECTOR_BIT(bits, col)) {
+        SIGN_VECTOR_FLIP(bits, col);
+        ++data->row_sums[row];
+    }
+}
+
+static
+void
+spmat_bitset_free(matrix_t *mat)
+{
+    spmat_bitset_data_t *data = NULL;
+
+    if (NULL != mat) {
+        DEBUG_PRINT("%s: addr %p n=%d\n", __func__, (void *)mat, mat->n);
+        data = GET_BITSET_DATA(mat);
+        if (NULL != data) {
+            FREE_SAFE(data->g);
+            FREE_SAFE(data->row_sums);
+            FREE_SAFE(data->bits);
+        }
+        mat->private = NULL;
+
+        /* The data is a part of the header */
+        if (NULL != mat->pool) {
+            POOL_release(mat->pool, mat);
+        } else {
+            free(mat);
+        }
+    }
+}
+
+static
+result_t
+spmat_bitset_add_row(matrix_t *mat, const double *values, int row_index)
+{
+    result_t result = E__UNKNOWN;
+    int col = 0;
+
+    /* 0. Input validation */
+    if ((NULL == mat) || (NULL == mat->private) || (NULL == values)) {
+        result = E__NULL_ARGUMENT;
+        goto l_cleanup;
+    }
+
+    if (!MATRIX_IS_VALID_ROW_INDEX(mat, row_index)) {
+        result = E__INVALID_ROW_INDEX;
+        goto l_cleanup;
+    }
+
+    if (0 != GET_BITSET_DATA(mat)->row_sums[row_index]) {
+        result = E__ROW_ALREADY_IN_USE;
+        goto l_cleanup;
+    }
+
+    /* 1. The cells can only be 1 */
+    for (col = 0 ; mat->n > col ; ++col) {
+        if ((0 != values[col]) && (1.0 != values[col])) {
+            result = E__INVALID_VALUE;
+            goto l_cleanup;
+        }
+    }
+
+    /* 2. Set the row's bits */
+    for (col = 0 ; mat->n > col ; ++col) {
+        if (0 != values[col]) {
+            SPMAT_BITSET_set_cell(mat, row_index, col);
+        }
+    }
+
+    result = E__SUCCESS;
+l_cleanup:
+
+    return result;
+}
+
+static
+result_t
+spmat_bitset_add_pattern_row(matrix_t *mat,
+                             const int *columns,
+                             int length,
+                             int row_index)
+{
+    result_t result = E__UNKNOWN;
+    int k = 0;
+
+    /* 0. Input validation */
+    if ((NULL == mat) || (NULL == mat->private)) {
+        result = E__NULL_ARGUMENT;
+        goto l_cleanup;
+    }
+
+    if (!MATRIX_IS_VALID_ROW_INDEX(mat, row_index)) {
+        result = E__INVALID_ROW_INDEX;
+        goto l_cleanup;
+    }
+
+    if (!MATRIX_is_valid_pattern(columns, length, mat->n)) {
+        result = E__INVALID_VALUE;
+        goto l_cleanup;
+    }
+
+    if (0 != GET_BITSET_DATA(mat)->row_sums[row_index]) {
+        result = E__ROW_ALREADY_IN_USE;
+        goto l_cleanup;
+    }
+
+    /* 1. Set the row's bits */
+    for (k = 0 ; k < length ; ++k) {
+        SPMAT_BITSET_set_cell(mat, row_index, columns[k]);
+    }
+
+    result = E__SUCCESS;
+l_cleanup:
+
+    return result;
+}
+
+static
+void
+spmat_bitset_mult(const matrix_t *mat, const double *v, double *result)
+{
+    const spmat_bitset_data_t *data = NULL;
+    const sign_word_t *bits = NULL;
+    sign_word_t word = 0;
+    double row_result = 0.0;
+    size_t w = 0;
+    int i = 0;
+
+    if ((NULL == mat) || (NULL == v) || (NULL == result)) {
+        return;
+    }
+
+    data = GET_BITSET_DATA(mat);
+    for (i = 0 ; i < mat->n ; ++i) {
+        bits = GET_ROW_BITS(data, i);
+        row_result = 0.0;
+        for (w = 0 ; w < data->row_words ; ++w) {
+            for (word = bits[w] ; 0 != word ; word &= word - 1) {
+                row_result += v[w * SIGN_WORD_BITS +
+                                SPMAT_BITSET_LOWEST_BIT(word)];
+            }
+        }
+        result[i] = row_result;
+    }
+}
+
+static
+int *
+spmat_bitset_get_g(matrix_t *mat)
+{
+    return GET_BITSET_DATA(mat)->g;
+}
+
+static
+result_t
+spmat_bitset_extract(const matrix_t *mat,
+                     const int *g,
+                     int g_length,
+                     int *temp_positions,
+                     pool_t *headers,
+                     matrix_t **mat_out)
+{
+    result_t result = E__UNKNOWN;
+    matrix_t *extracted = NULL;
+    const spmat_bitset_data_t *orig_data = NULL;
+    const sign_word_t *bits = NULL;
+    sign_word_t word = 0;
+    bool_t are_positions_set = FALSE;
+    int position = 0;
+    size_t w = 0;
+    int i = 0;
+
+    /* 0. Input validation */
+    if ((NULL == mat) || (NULL == g) ||
+            (NULL == temp_positions) || (NULL == mat_out)) {
+        result = E__NULL_ARGUMENT;
+        goto l_cleanup;
+    }
+
+    /* 1. Allocate the extracted matrix */
+    result = SPMAT_BITSET_allocate(g_length, headers, &extracted);
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+    orig_data = GET_BITSET_DATA(mat);
+
+    /* 2. Map each extracted index to its new position */
+    for (i = 0 ; i < g_length ; ++i) {
+        temp_positions[g[i]] = i;
+    }
+    are_positions_set = TRUE;
+
+    /* 3. Set each row's cells that were extracted */
+    for (i = 0 ; i < g_length ; ++i) {
+        bits = GET_ROW_BITS(orig_data, g[i]);
+        for (w = 0 ; w < orig_data->row_words ; ++w) {
+            for (word = bits[w] ; 0 != word ; word &= word - 1) {
+                position = temp_positions[w * SIGN_WORD_BITS +
+                                          SPMAT_BITSET_LOWEST_BIT(word)];
+                if (0 <= position) {
+                    SPMAT_BITSET_set_cell(extracted, i, position);
+                }
+            }
+        }
+
+        /* 3.1. Keep the original vertex of the row */
+        GET_BITSET_DATA(extracted)->g[i] = orig_data->g[g[i]];
+    }
+
+    /* Success */
+    *mat_out = extracted;
+
+    result = E__SUCCESS;
+l_cleanup:
+
+    /* 4. Restore the positions buffer */
+    if (are_positions_set) {
+        for (i = 0 ; i < g_length ; ++i) {
+            temp_positions[g[i]] = -1;
+        }
+    }
+
+    if (E__SUCCESS != result) {
+        spmat_bitset_free(extracted);
+        extracted = NULL;
+    }
+
+    return result;
+}
+
+static
+double
+spmat_bitset_sum_neighbors_div_M(const submatrix_t *smat,
+                                 const eigen_real_t *v,
+                                 double *k_dot_v_out)
+{
+    const double *neighbors_div_M = smat->adj->neighbors_div_M;
+    double k_sum = 0.0;
+    double k_dot_v = 0.0;
+    int j = 0;
+
+    if (NULL == v) {
+        for (j = 0 ; j < smat->g_length ; ++j) {
+            k_sum += neighbors_div_M[smat->g[j]];
+        }
+    } else {
+        for (j = 0 ; j < smat->g_length ; ++j) {
+            k_sum += neighbors_div_M[smat->g[j]];
+            k_dot_v += neighbors_div_M[smat->g[j]] * v[j];
+        }
+        *k_dot_v_out = k_dot_v;
+    }
+
+    return k_sum;
+}
+
+static
+double
+spmat_bitset_mult_row(const submatrix_t *smat,
+                      int row_g,
+                      const eigen_real_t *v,
+                      double k_sum,
+                      double k_dot_v)
+{
+    const spmat_bitset_data_t *data = GET_BITSET_DATA(smat->orig);
+    const sign_word_t *bits = GET_ROW_BITS(data, row_g);
+    sign_word_t word = 0;
+    double a_dot_v = 0.0;
+    double k = 0.0;
+    double f = 0.0;
+    size_t w = 0;
+
+    /* 1. The adjacency part: A[g]*v, the row's sum is its bits count */
+    for (w = 0 ; w < data->row_words ; ++w) {
+        for (word = bits[w] ; 0 != word ; word &= word - 1) {
+            a_dot_v += v[w * SIGN_WORD_BITS + SPMAT_BITSET_LOWEST_BIT(word)];
+        }
+    }
+
+    /* 2. B[g]_ij = A_ij - ki*kj/M, and f_i is the sum of B[g]'s row */
+    k = (double)smat->adj->neighbors[smat->g[row_g]];
+    f = (double)data->row_sums[row_g] - (k * k_sum);
+
+    return a_dot_v - (k * k_dot_v) + ((smat->add_to_diag - f) * v[row_g]);
+}
+
+static
+double
+spmat_bitset_row_dot_s(const spmat_bitset_data_t *data,
+                       int row_g,
+                       const sign_word_t *s_vector)
+{
+    /* The row's +1 cells less its -1 cells */
+    return (double)data->row_sums[row_g] -
+           2.0 * (double)VECTOR_count_common_bits(GET_ROW_BITS(data, row_g),
+                                                  s_vector,
+                                                  data->row_words);
+}
+
+double
+SUBMAT_SPMAT_BITSET_mult(const submatrix_t *smat,
+                         const eigen_real_t *vector,
+                         eigen_real_t *result)
+{
+    double k_sum = 0.0;
+    double k_dot_v = 0.0;
+    double norm_square = 0.0;
+    double current_row_mul = 0.0;
+    int row_g = 0;
+
+    k_sum = spmat_bitset_sum_neighbors_div_M(smat, vector, &k_dot_v);
+    for (row_g = 0 ; row_g < smat->g_length ; ++row_g) {
+        current_row_mul = spmat_bitset_mult_row(smat,
+                                                row_g,
+                                                vector,
+                                                k_sum,
+                                                k_dot_v);
+        result[row_g] = (eigen_real_t)current_row_mul;
+        norm_square += current_row_mul * current_row_mul;
+    }
+
+    return norm_square;
+}
+
+double
+SUBMAT_SPMAT_BITSET_mult_vmv(const submatrix_t *smat,
+                             const eigen_real_t *vector)
+{
+    double k_sum = 0.0;
+    double k_dot_v = 0.0;
+    double result = 0.0;
+    int row_g = 0;
+
+    k_sum = spmat_bitset_sum_neighbors_div_M(smat, vector, &k_dot_v);
+    for (row_g = 0 ; row_g < smat->g_length ; ++row_g) {
+        result += vector[row_g] * spmat_bitset_mult_row(smat,
+                                                        row_g,
+                                                        vector,
+                                                        k_sum,
+                                                        k_dot_v);
+    }
+
+    return result;
+}
+
+double
+SUBMAT_SPMAT_BITSET_calculate_q(const submatrix_t *smat,
+                                const sign_word_t *s_vector)
+{
+    const spmat_bitset_data_t *data = GET_BITSET_DATA(smat->orig);
+    double k_sum = 0.0;
+    double k_dot_s = 0.0;
+    double k = 0.0;
+    double f = 0.0;
+    double s_row = 0.0;
+    double mult_vmv = 0.0;
+    int row_g = 0;
+
+    k_sum = spmat_bitset_sum_neighbors_div_M(smat, NULL, NULL);
+    k_dot_s = VECTOR_gather_multiply_with_s(smat->adj->neighbors_div_M,
+                                            smat->g,
+                                            s_vector,
+                                            smat->g_length);
+    for (row_g = 0 ; row_g < smat->g_length ; ++row_g) {
+        /* B[g]_ij = A_ij - ki*kj/M, and f_i is the sum of B[g]'s row */
+        k = (double)smat->adj->neighbors[smat->g[row_g]];
+        f = (double)data->row_sums[row_g] - (k * k_sum);
+        s_row = SIGN_VECTOR_VALUE(s_vector, row_g);
+        mult_vmv += s_row * (spmat_bitset_row_dot_s(data, row_g, s_vector) -
+                             (k * k_dot_s) +
+                             ((smat->add_to_diag - f) * s_row));
+    }
+
+    return mult_vmv;
+}
+
+double
+SUBMAT_SPMAT_BITSET_get_1norm(const submatrix_t *smat,
+                              double *tmp_row_sums)
+{
+    const spmat_bitset_data_t *data = GET_BITSET_DATA(smat->orig);
+    const double *neighbors_div_M = smat->adj->neighbors_div_M;
+    const sign_word_t *bits = NULL;
+    sign_word_t word = 0;
+    double norm = 0.0;
+    double k_sum = 0.0;
+    double k = 0.0;
+    double a_sum = 0.0;
+    double a_diag = 0.0;
+    double edges_norm = 0.0;
+    double edges_k_sum = 0.0;
+    double zeroes_norm = 0.0;
+    double diag_value = 0.0;
+    size_t w = 0;
+    int row_g = 0;
+    int row_i = 0;
+    int col_g = 0;
+
+    UNUSED_ARG(tmp_row_sums);
+
+    /* Note: The adjacency matrix is symmetric, therefore 1-norm can be done on
+     *       either max row sum or max column sum */
+    k_sum = spmat_bitset_sum_neighbors_div_M(smat, NULL, NULL);
+
+    for (row_g = 0 ; row_g < smat->g_length ; ++row_g) {
+        row_i = smat->g[row_g];
+        k = (double)smat->adj->neighbors[row_i];
+        bits = GET_ROW_BITS(data, row_g);
+
+        /* 1. Non-zero cells: |1 - ki*kj/M| */
+        a_sum = (double)data->row_sums[row_g];
+        a_diag = (double)SIGN_VECTOR_BIT(bits, row_g);
+        edges_norm = 0.0;
+        edges_k_sum = 0.0;
+        for (w = 0 ; w < data->row_words ; ++w) {
+            for (word = bits[w] ; 0 != word ; word &= word - 1) {
+                col_g = (int)(w * SIGN_WORD_BITS) +
+                        SPMAT_BITSET_LOWEST_BIT(word);
+                if (col_g != row_g) {
+                    edges_k_sum += neighbors_div_M[smat->g[col_g]];
+                    edges_norm += fabs(1.0 -
+                                       SPMAT_GET_EXPECTED_VALUE(smat,
+                                                                row_i,
+                                                                smat->g[col_g]));
+                }
+            }
+        }
+
+        /* 2. Zero cells: |0 - ki*kj/M| summed over the rest of the row */
+        zeroes_norm = k * (k_sum - edges_k_sum - neighbors_div_M[row_i]);
+
+        /* 3. The diag is decreased by the row's sum f_i */
+        diag_value = a_diag - SPMAT_GET_EXPECTED_VALUE(smat, row_i, row_i) +
+                     smat->add_to_diag - (a_sum - (k * k_sum));
+
+        norm = MAX(norm, zeroes_norm + edges_norm + fabs(diag_value));
+    }
+
+    return norm;
+}
+
+double
+SUBMAT_SPMAT_BITSET_calc_q_score(const submatrix_t *smat,
+                                 const sign_word_t *vector,
+                                 int row_g)
+{
+    double a_dot_s = 0.0;
+    double k_dot_s = 0.0;
+    double k = 0.0;
+    double s_row = 0.0;
+    double q_part1 = 0.0;
+    double expected_value = 0.0;
+    int row_i = 0;
+
+    row_i = smat->g[row_g];
+    k = (double)smat->adj->neighbors[row_i];
+
+    /* 1. B_ij * s_j = A_ij * s_j - ki * (kj/M * s_j) */
+    a_dot_s = spmat_bitset_row_dot_s(GET_BITSET_DATA(smat->orig),
+                                     row_g,
+                                     vector);
+    k_dot_s = VECTOR_gather_multiply_with_s(smat->adj->neighbors_div_M,
+                                            smat->g,
+                                            vector,
+                                            smat->g_length);
+    s_row = SIGN_VECTOR_VALUE(vector, row_g);
+    q_part1 = a_dot_s - (k * k_dot_s) + (2 * smat->add_to_diag * s_row);
+
+    expected_value = SPMAT_GET_EXPECTED_VALUE(smat, row_i, row_i);
+
+    return 4 * (s_row * q_part1 + expected_value);
+}
+
+result_t
+SUBMAT_SPMAT_BITSET_split(submatrix_t *smat,
+                          const sign_word_t *vector_s,
+                          int *temp_s_indexes,
+                          submatrix_t **matrix1_out,
+                          submatrix_t **matrix2_out)
+{
+    result_t result = E__UNKNOWN;
+    const spmat_bitset_data_t *data = NULL;
+    const sign_word_t *bits = NULL;
+    matrix_t *matrices[2] = {NULL, NULL};
+    submatrix_t *smats[2] = {NULL, NULL};
+    sign_word_t word = 0;
+    size_t w = 0;
+    int matrix1_n = 0;
+    int bit = 0;
+    int i = 0;
+
+    /* 0. Input validation */
+    /* Null arguments */
+    if ((NULL == smat) ||
+            (NULL == vector_s) ||
+            (NULL == temp_s_indexes) ||
+            (NULL == matrix1_out) ||
+            (NULL == matrix2_out)) {
+        result = E__NULL_ARGUMENT;
+        goto l_cleanup;
+    }
+
+    data = GET_BITSET_DATA(smat->orig);
+
+    /* 1. Create s-indexes vector, get matrix1's length */
+    matrix1_n = VECTOR_create_s_indexes(vector_s,
+                                        smat->g_length,
+                                        temp_s_indexes);
+
+    /* 2. Allocate the matrices */
+    result = SPMAT_BITSET_allocate(matrix1_n,
+                                   SUBMATRIX_MATRICES_POOL(smat),
+                                   &matrices[0]);
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+
+    result = SPMAT_BITSET_allocate(smat->g_length - matrix1_n,
+                                   SUBMATRIX_MATRICES_POOL(smat),
+                                   &matrices[1]);
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+
+    /* 3. Copy each row to its group's matrix: only the bits it shares with
+     *    the row's own group's s-vector bits are kept */
+    for (i = 0 ; i < smat->g_length ; ++i) {
+        bit = SIGN_VECTOR_BIT(vector_s, i);
+        bits = GET_ROW_BITS(data, i);
+        GET_BITSET_DATA(matrices[bit])->g[temp_s_indexes[i]] = smat->g[i];
+        for (w = 0 ; w < data->row_words ; ++w) {
+            word = bits[w] & (bit ? vector_s[w] : ~vector_s[w]);
+            for ( ; 0 != word ; word &= word - 1) {
+                SPMAT_BITSET_set_cell(
+                    matrices[bit],
+                    temp_s_indexes[i],
+                    temp_s_indexes[w * SIGN_WORD_BITS +
+                                   SPMAT_BITSET_LOWEST_BIT(word)]);
+            }
+        }
+    }
+
+    /* 4. Create the submatrices */
+    for (bit = 0 ; bit < 2 ; ++bit) {
+        result = SUBMATRIX_create(smat->adj,
+                                  matrices[bit],
+                                  smat->pool,
+                                  &smats[bit]);
+        if (E__SUCCESS != result) {
+            goto l_cleanup;
+        }
+        smats[bit]->g_length = matrices[bit]->n;
+        matrices[bit] = NULL;
+    }
+
+    /* Success */
+    *matrix1_out = smats[0];
+    *matrix2_out = smats[1];
+
+    result = E__SUCCESS;
+l_cleanup:
+
+    if (E__SUCCESS != result) {
+        MATRIX_FREE_SAFE(matrices[0]);
+        MATRIX_FREE_SAFE(matrices[1]);
+        SUBMATRIX_FREE_SAFE(smats[0]);
+        SUBMATRIX_FREE_SAFE(smats[1]);
+    }
+
+    return result;
+}
@@ -0,0 +1,102 @@
+/*
+ * @file spmat_bitset.h
+ * @purpose Adjacency matrix implemented as a bitset row per vertex.
+ *          A row multiplied by the bit-packed s-vector is counted 64 cells
+ *          at a time: popcount(row) - 2 * popcount(row & s). Meant for the
+ *          small, dense groups of the division's deep levels
+ */
+#ifndef __SPMAT_BITSET_H__
+#define __SPMAT_BITSET_H__
+
+/* Includes ******************************************************************/
+#include <stddef.h>
+
+#include "matrix.h"
+#include "submatrix.h"
+#include "common.h"
+#include "pool.h"
+
+
+/* Functions Declarations ****************************************************/
+/* Creates a pool of bitset matrices' headers */
+result_t
+SPMAT_BITSET_create_headers_pool(pool_t **pool_out);
+
+/*
+ * Allocates a new bitset matrix of size n, with no cells set.
+ * Its header is recycled from the headers pool, or allocated if it is NULL
+ */
+result_t
+SPMAT_BITSET_allocate(int n, pool_t *headers, matrix_t **mat);
+
+/*
+ * Set a cell of a bitset matrix to 1. Used by the other matrices to hand
+ * their rows over to a bitset matrix
+ *
+ * @remark The row and column must be valid indexes
+ */
+void
+SPMAT_BITSET_set_cell(matrix_t *mat, int row, int col);
+
+/*
+ * Calculate the 1-norm of a given submatrix
+ *
+ * @param submatrix The submatrix
+ * @param tmp_rows_sums Temp buffer with size n
+ */
+double
+SUBMAT_SPMAT_BITSET_get_1norm(const submatrix_t *smat,
+                              double *tmp_row_sums);
+
+/*
+ * Multiply the submatrix with a given vector, to a pre-allocated buffer
+ *
+ * @param submatrix The submatrix
+ * @param vector Buffer to multiply with
+ * @param result pre-allocated buffer
+ *
+ * @return The result's squared norm
+ */
+double
+SUBMAT_SPMAT_BITSET_mult(const submatrix_t *smat,
+                         const eigen_real_t *vector,
+                         eigen_real_t *result);
+
+/*
+ * Calculate v^T*B*v of the submatrix with a given vector. Every row's
+ * multiplication is kept in double precision
+ */
+double
+SUBMAT_SPMAT_BITSET_mult_vmv(const submatrix_t *smat,
+                             const eigen_real_t *vector);
+
+/**
+ * Calculate the Q of the submatrix with a given vector
+ */
+double
+SUBMAT_SPMAT_BITSET_calculate_q(const submatrix_t *smat,
+                                const sign_word_t *s_vector);
+
+/**
+ * Split a submatrix into two submatrices accordingly to a given s-vector.
+ * Each part's rows are copied to a bitset matrix of its own.
+ *
+ * @remark temp_s_indexes is overwritten
+ */
+result_t
+SUBMAT_SPMAT_BITSET_split(submatrix_t *smat,
+                          const sign_word_t *vector_s,
+                          int *temp_s_indexes,
+                          submatrix_t **matrix1_out,
+                          submatrix_t **matrix2_out);
+
+/**
+ * Calculate the the improved formula Q score within algorithm 4
+ */
+double
+SUBMAT_SPMAT_BITSET_calc_q_score(const submatrix_t *smat,
+                                 const sign_word_t *vector,
+                                 int row);
+
+
+#endif /* __SPMAT_BITSET_H__ */
@@ -32,8 +32,16 @@ typedef struct spmat_row_s {
 typedef struct spmat_data_s {
     /* Begin of row's linked list */
     spmat_row_t *rows;
+    /* The rows' lists and nodes, released at once with the matrix */
+    list_arena_t *arena;
 } spmat_data_t;
 
+/* A matrix_t and its spmat struct, allocated at once */
+typedef struct spmat_header_s {
+    matrix_t matrix;
+    spmat_data_t data;
+} spmat_header_t;
+
 
 /* Macros ********************************************************************/
 #define GET_SPMAT_DATA(matrix) ((spmat_data_t *)((matrix)->private))
@@ -61,6 +69,14 @@ static
 result_t
 spmat_list_add_row(matrix_t *A, const double *row, int i);
 
+/**
+ * @purpose Set a row of the matrix by its columns. A row can be set only once
+ * @see matrix_add_pattern_row_f on matrix.h
+ */
+static
+result_t
+spmat_list_add_pattern_row(matrix_t *mat, const int *columns, int length, int i);
+
 /**
  * @purpose free allocated memory for a matrix
  * @param A input Matrix
@@ -86,8 +102,9 @@ spmat_list_mult(const matrix_t *A, const double *v, double *result);
  *          relevant to a specific group after division
  * @param original_row input row list from sparse matrix
  * @param vector_s input s vector describing division
- * @param relavant_vector_s_value inoput 1 or -1, describing which group we are building
+ * @param relevant_bit input 0 or 1 (s-value 1 or -1), describing which group we are building
  * @param s_indexes input list of incrementing indexes for each one of the groups
+ * @param arena input the arena of the matrix the new row belongs to
  * @param row_out output new row
  *
  * @return One of result_t values
@@ -96,11 +113,24 @@ spmat_list_mult(const matrix_t *A, const double *v, double *result);
 static
 result_t
 spmat_list_reduce_row(const spmat_row_t *original_row,
-                       const double * vector_s,
-                       double relevant_vector_s_value,
+                       const sign_word_t * vector_s,
+                       int relevant_bit,
                        const int * s_indexes,
+                       list_arena_t *arena,
                        spmat_row_t *row_out);
 
+/**
+ * @see matrix_extract_f on matrix.h
+ */
+static
+result_t
+spmat_list_extract(const matrix_t *mat,
+                   const int *g,
+                   int g_length,
+                   int *temp_positions,
+                   pool_t *headers,
+                   matrix_t **mat_out);
+
 /**
  * @see matrix_split_f on matrix.h
  */
@@ -114,12 +144,33 @@ static
 double
 submat_spmat_list_mult_row_with_s(const submatrix_t *submatrix,
                                   int row_g,
-                                  const double *s_vector);
+                                  const eigen_real_t *s_vector);
+
+/**
+ * Calculate the multiplication result of the row_g'th row of B-hat matrix
+ * with a given s_vector
+ *
+ * @param smat The submatrix
+ * @param row_g The row index to multiply
+ * @param s_vector The s vector to multiply with
+ * @param k_sum The sum of kj/M over the submatrix's vertices
+ * @param k_dot_s The sum of kj/M * sj over the submatrix's vertices
+ *
+ * @return The multiplication
+ */
+static
+double
+submat_spmat_list_mult_row_with_signs(const submatrix_t *smat,
+                                      int row_g,
+                                      const sign_word_t *s_vector,
+                                      double k_sum,
+                                      double k_dot_s);
 
 /**
  * Calculate the multiplication result of the row_g'th row of B matrix,
  * a B matrix (withno hat!) with a given s_vector.
- * Algorithm is improved: is calculates sequences of zeroes effeciently
+ * Algorithm is improved: B_ij * s_j = A_ij * s_j - ki * (kj/M * s_j), so
+ * only the row's non-zeroes are scanned besides one pass over kj/M
  *
  * @param smat The submatrix
  * @param row_g The row index to multiply
@@ -131,27 +182,43 @@ static
 double
 submat_spmat_list_mult_row_with_s_no_hat_improved(const submatrix_t *smat,
                                                   int row_g,
-                                                  const double *s_vector);
+                                                  const sign_word_t *s_vector);
 
 
 /* Virtual Table *************************************************************/
 const matrix_vtable_t SPMAT_LIST_VTABLE = {
     .add_row = spmat_list_add_row,
+    .add_pattern_row = spmat_list_add_pattern_row,
     .free = spmat_list_free,
     .mult = spmat_list_mult,
     .mult_vmv = NULL,
+    .get_g = NULL,
+    .extract = spmat_list_extract,
+    .submat_get_1norm = SUBMAT_SPMAT_LIST_get_1norm,
+    .submat_mult = SUBMAT_SPMAT_LIST_mult,
+    .submat_mult_vmv = SUBMAT_SPMAT_LIST_mult_vmv,
+    .submat_calculate_q = SUBMAT_SPMAT_LIST_calculate_q,
+    .submat_calc_q_score = SUBMAT_SPMAT_LIST_calc_q_score,
+    .submat_split = SUBMAT_SPMAT_LIST_split,
 };
 
 
 /* Functions *****************************************************************/
 result_t
-SPMAT_LIST_allocate(int n, matrix_t **mat_out)
+SPMAT_LIST_create_headers_pool(pool_t **pool_out)
+{
+    return POOL_create(sizeof(spmat_header_t), pool_out);
+}
+
+result_t
+SPMAT_LIST_allocate(int n, pool_t *headers, matrix_t **mat_out)
 {
     result_t result = E__UNKNOWN;
+    spmat_header_t *header = NULL;
     matrix_t *mat = NULL;
     spmat_data_t *spmat_data = NULL;
     spmat_row_t *rows_array = NULL;
-    int rows_array_size = 0;
+    size_t rows_array_size = 0;
 
     /* 0. Input validation */
     if (NULL == mat_out) {
@@ -164,45 +231,50 @@ SPMAT_LIST_allocate(int n, matrix_t **mat_out)
         goto l_cleanup;
     }
 
-    /* 1. Allocate matrix_t */
-    mat = (matrix_t *)malloc(sizeof(*mat));
-    if (NULL == mat) {
-        result = E__MALLOC_ERROR;
-        goto l_cleanup;
+    /* 1. Allocate matrix_t and spmat struct, recycle a header if possible */
+    if (NULL != headers) {
+        result = POOL_alloc(headers, (void **)&header);
+        if (E__SUCCESS != result) {
+            goto l_cleanup;
+        }
+    } else {
+        header = (spmat_header_t *)malloc(sizeof(*header));
+        if (NULL == header) {
+            result = E__MALLOC_ERROR;
+            goto l_cleanup;
+        }
     }
 
     /* 2. Initialize */
-    (void)memset(mat, 0, sizeof(*mat));
-    mat->private = NULL;
+    (void)memset(header, 0, sizeof(*header));
+    mat = &header->matrix;
+    spmat_data = &header->data;
     mat->vtable = &SPMAT_LIST_VTABLE;
     mat->n = n;
     mat->type = MATRIX_TYPE_SPMAT_LIST;
+    mat->pool = headers;
+    mat->private = (void *)spmat_data;
 
-    /* 3. spmat struct */
-    spmat_data = (spmat_data_t *)malloc(sizeof(*spmat_data));
-    if (NULL == spmat_data) {
-        result = E__MALLOC_ERROR;
-        goto l_cleanup;
-    }
-    (void)memset(spmat_data, 0, sizeof(*spmat_data));
-
-    /* 4. Rows array */
-    /* 4.1. Allocate */
+    /* 3. Rows array */
+    /* 3.1. Allocate */
     rows_array_size = n * sizeof(*rows_array);
     rows_array = (spmat_row_t *)malloc(rows_array_size);
     if (NULL == rows_array) {
         result = E__MALLOC_ERROR;
         goto l_cleanup;
     }
-    /* 4.2. Initialise as NULL, sum 0.0, index 0 */
+    /* 3.2. Initialise as NULL, sum 0.0, index 0 */
     (void)memset(rows_array, 0, rows_array_size);
 
-    /* 4.3. Assign rows */
+    /* 3.3. Assign rows */
     spmat_data->rows = rows_array;
 
-    /* 5. Validate matrix */
-    mat->private = (void *)spmat_data;
-    
+    /* 4. Arena of the rows' lists */
+    result = LIST_ARENA_create(&spmat_data->arena);
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+
     DEBUG_PRINT("%s: addr %p n=%d\n", __func__, (void *)mat, n);
     /* Success */
     *mat_out = mat;
@@ -226,25 +298,34 @@ spmat_list_free(matrix_t *mat)
     spmat_row_t *rows_array = NULL;
     int i = 0;
 
-    DEBUG_PRINT("%s: addr %p n=%d\n", __func__, (void *)mat, mat->n);
     if (NULL != mat) {
+        DEBUG_PRINT("%s: addr %p n=%d\n", __func__, (void *)mat, mat->n);
         spmat_data = GET_SPMAT_DATA(mat);
         if (NULL != spmat_data) {
             rows_array = spmat_data->rows;
             if (NULL != rows_array) {
-                for (i = 0 ; i < mat->n ; ++i) {
-                    LIST_destroy(rows_array[i].list);
-                    rows_array[i].list = NULL;
+                /* Lists allocated from the arena are released in bulk */
+                if (NULL == spmat_data->arena) {
+                    for (i = 0 ; i < mat->n ; ++i) {
+                        LIST_destroy(rows_array[i].list);
+                        rows_array[i].list = NULL;
+                    }
                 }
 
                 FREE_SAFE(spmat_data->rows);
                 rows_array = NULL;
             }
-            
-            FREE_SAFE(spmat_data);
+            LIST_ARENA_destroy(spmat_data->arena);
+            spmat_data->arena = NULL;
             mat->private = NULL;
         }
-        FREE_SAFE(mat);
+
+        /* The spmat struct is a part of the header */
+        if (NULL != mat->pool) {
+            POOL_release(mat->pool, mat);
+        } else {
+            free(mat);
+        }
     }
 }
 
@@ -289,7 +370,8 @@ spmat_list_add_row(matrix_t *mat, const double *values, int row_index)
                 /* DEBUG_PRINT("row %d: Inserting last node at col %d value %f", row_index, col, values[col]); */
                 /* 2.2.1. Next node is NULL - we simply add it */
                 if (NULL == row->list) {
-                    result = LIST_create(&row->list);
+                    result = LIST_create(GET_SPMAT_DATA(mat)->arena,
+                                         &row->list);
                     if (E__SUCCESS != result) {
                         goto l_cleanup;
                     }
@@ -312,7 +394,8 @@ spmat_list_add_row(matrix_t *mat, const double *values, int row_index)
                     /* 2.3.3. Add new node
                      *        Note: row->list already exists */
                     if (NULL == row->list) {
-                        result = LIST_create(&row->list);
+                        result = LIST_create(GET_SPMAT_DATA(mat)->arena,
+                                             &row->list);
                         if (E__SUCCESS != result) {
                             goto l_cleanup;
                         }
@@ -337,6 +420,64 @@ l_cleanup:
     return result;
 } 
 
+static
+result_t
+spmat_list_add_pattern_row(matrix_t *mat,
+                           const int *columns,
+                           int length,
+                           int row_index)
+{
+    result_t result = E__UNKNOWN;
+    spmat_row_t *row = NULL;
+    int k = 0;
+
+    /* 0. Input validation */
+    if ((NULL == mat) || (NULL == mat->private)) {
+        result = E__NULL_ARGUMENT;
+        goto l_cleanup;
+    }
+
+    if (!MATRIX_IS_VALID_ROW_INDEX(mat, row_index)) {
+        result = E__INVALID_ROW_INDEX;
+        goto l_cleanup;
+    }
+
+    if (!MATRIX_is_valid_pattern(columns, length, mat->n)) {
+        result = E__INVALID_VALUE;
+        goto l_cleanup;
+    }
+
+    row = &GET_ROW(mat, row_index);
+    if (NULL != row->list) {
+        result = E__ROW_ALREADY_IN_USE;
+        goto l_cleanup;
+    }
+
+    if (0 == length) {
+        result = E__SUCCESS;
+        goto l_cleanup;
+    }
+
+    /* 1. Append the columns to a new list */
+    result = LIST_create(GET_SPMAT_DATA(mat)->arena, &row->list);
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+
+    for (k = 0 ; k < length ; ++k) {
+        result = LIST_insert(row->list, NULL, 1.0, columns[k]);
+        if (E__SUCCESS != result) {
+            goto l_cleanup;
+        }
+    }
+    row->sum = length;
+
+    result = E__SUCCESS;
+l_cleanup:
+
+    return result;
+}
+
 static
 void
 spmat_list_mult(const matrix_t *mat, const double *v, double *multiplication_result)
@@ -370,15 +511,15 @@ l_cleanup:
 static
 result_t
 spmat_list_reduce_row(const spmat_row_t *original_row,
-        const double * vector_s,
-        double relevant_vector_s_value,
+        const sign_word_t * vector_s,
+        int relevant_bit,
         const int * s_indexes,
+        list_arena_t *arena,
         spmat_row_t *row_out)
 {
     result_t result = E__UNKNOWN;
     const node_t *scanner = NULL;
     list_t *reduced_list = NULL;
-    double scanned_s_value = 0.0; /* 1 or -1 */
     int scanned_index = 0.0; /* 0 ... n */
     double sum = 0.0;
 
@@ -389,7 +530,7 @@ spmat_list_reduce_row(const spmat_row_t *original_row,
     }
 
     /* 2. Create new list */
-    result = LIST_create(&reduced_list);
+    result = LIST_create(arena, &reduced_list);
     if (E__SUCCESS != result) {
         goto l_cleanup;
     }
@@ -416,9 +557,8 @@ spmat_list_reduce_row(const spmat_row_t *original_row,
          *        [ ind 0 ]     [ ind 1 ]
          *
          */
-        scanned_s_value = vector_s[scanner->index];
         /* 2.1. Skip nodes with different s-value */
-        if (scanned_s_value != relevant_vector_s_value) {
+        if (SIGN_VECTOR_BIT(vector_s, scanner->index) != relevant_bit) {
             continue;
         }
 
@@ -449,10 +589,103 @@ l_cleanup:
     return result;
 }
 
+static
+result_t
+spmat_list_extract(const matrix_t *mat,
+                   const int *g,
+                   int g_length,
+                   int *temp_positions,
+                   pool_t *headers,
+                   matrix_t **mat_out)
+{
+    result_t result = E__UNKNOWN;
+    matrix_t *extracted = NULL;
+    list_arena_t *arena = NULL;
+    const spmat_row_t *orig_row = NULL;
+    spmat_row_t *row = NULL;
+    const node_t *scanner = NULL;
+    bool_t are_positions_set = FALSE;
+    int position = 0;
+    int i = 0;
+
+    /* 0. Input validation */
+    if ((NULL == mat) || (NULL == g) ||
+            (NULL == temp_positions) || (NULL == mat_out)) {
+        result = E__NULL_ARGUMENT;
+        goto l_cleanup;
+    }
+
+    /* 1. Allocate the extracted matrix */
+    result = SPMAT_LIST_allocate(g_length, headers, &extracted);
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+    arena = GET_SPMAT_DATA(extracted)->arena;
+
+    /* 2. Map each extracted index to its new position */
+    for (i = 0 ; i < g_length ; ++i) {
+        temp_positions[g[i]] = i;
+    }
+    are_positions_set = TRUE;
+
+    /* 3. Copy each row's nodes whose columns were extracted.
+     *    g is ascending, so the new rows stay sorted */
+    for (i = 0 ; i < g_length ; ++i) {
+        orig_row = &GET_ROW(mat, g[i]);
+        row = &GET_ROW(extracted, i);
+        row->index = orig_row->index;
+        if (NULL == orig_row->list) {
+            continue;
+        }
+
+        for (scanner = orig_row->list->first ;
+                NULL != scanner ;
+                scanner = scanner->next) {
+            position = temp_positions[scanner->index];
+            if (0 > position) {
+                continue;
+            }
+
+            if (NULL == row->list) {
+                result = LIST_create(arena, &row->list);
+                if (E__SUCCESS != result) {
+                    goto l_cleanup;
+                }
+            }
+
+            result = LIST_insert(row->list, NULL, scanner->value, position);
+            if (E__SUCCESS != result) {
+                goto l_cleanup;
+            }
+            row->sum += scanner->value;
+        }
+    }
+
+    /* Success */
+    *mat_out = extracted;
+
+    result = E__SUCCESS;
+l_cleanup:
+
+    /* 4. Restore the positions buffer */
+    if (are_positions_set) {
+        for (i = 0 ; i < g_length ; ++i) {
+            temp_positions[g[i]] = -1;
+        }
+    }
+
+    if (E__SUCCESS != result) {
+        spmat_list_free(extracted);
+        extracted = NULL;
+    }
+
+    return result;
+}
+
 /* TODO: Remove temp_s_indexes */
 result_t
 SUBMAT_SPMAT_LIST_split(submatrix_t *smat,
-        const double * vector_s,
+        const sign_word_t * vector_s,
         int *temp_s_indexes,
         submatrix_t **matrix1_out,
         submatrix_t **matrix2_out)
@@ -465,8 +698,9 @@ SUBMAT_SPMAT_LIST_split(submatrix_t *smat,
     submatrix_t *smat2 = NULL;
     int i = 0;
     int matrix1_n = 0;
-    double scanned_s_value = 0.0;
-    spmat_row_t *relevant_row_pointer = NULL;
+    int scanned_bit = 0;
+    submatrix_t *relevant_smat = NULL;
+    submatrix_t *groups[2] = {NULL, NULL};
 
     /* 0. Input validation */
     /* Null arguments */
@@ -483,60 +717,57 @@ SUBMAT_SPMAT_LIST_split(submatrix_t *smat,
                                         smat->g_length,
                                         temp_s_indexes);
 
-    result = SPMAT_LIST_allocate(matrix1_n, &matrix1);
+    result = SPMAT_LIST_allocate(matrix1_n, SUBMATRIX_MATRICES_POOL(smat), &matrix1);
     if (E__SUCCESS != result) {
         goto l_cleanup;
     }
 
     /* 2. Create matrixes as spmat lists */
     /* 2.1. smat 1 */
-    result = SUBMATRIX_create(smat->adj, matrix1, &smat1);
+    result = SUBMATRIX_create(smat->adj, matrix1, smat->pool, &smat1);
     if (E__SUCCESS != result) {
         goto l_cleanup;
     }
     matrix1 = NULL;
 
-    result = SPMAT_LIST_allocate(smat->g_length - matrix1_n, &matrix2);
+    result = SPMAT_LIST_allocate(smat->g_length - matrix1_n,
+                                 SUBMATRIX_MATRICES_POOL(smat),
+                                 &matrix2);
     if (E__SUCCESS != result) {
         goto l_cleanup;
     }
 
     /* 2.2. smat 2 */
-    result = SUBMATRIX_create(smat->adj, matrix2, &smat2);
+    result = SUBMATRIX_create(smat->adj, matrix2, smat->pool, &smat2);
     if (E__SUCCESS != result) {
         goto l_cleanup;
     }
     matrix2 = NULL;
 
     orig = smat->orig;
+    groups[0] = smat1;
+    groups[1] = smat2;
     /* 3. Go over each row of the original smat */
     for (i = 0 ; i < orig->n ; ++i) {
-        /* 3.1. Get the relevant s-value (1=matrix1, -1=matrix2) */
-        scanned_s_value = vector_s[i]; /* 1 or -1 */
-
-        /* 3.3. Split g vector */
-        if (1.0 == scanned_s_value) {
-            relevant_row_pointer = &GET_ROW(smat1->orig, smat1->g_length);
-            smat1->g[smat1->g_length] = smat->g[i];
-            ++smat1->g_length;
-        } else if (-1.0 == scanned_s_value) {
-            relevant_row_pointer = &GET_ROW(smat2->orig, smat2->g_length);
-            smat2->g[smat2->g_length] = smat->g[i];
-            ++smat2->g_length;
-        } else {
-            result = E__INVALID_S_VECTOR;
-            goto l_cleanup;
-        }
+        /* 3.1. Get the relevant group (bit 0=matrix1, 1=matrix2) */
+        scanned_bit = SIGN_VECTOR_BIT(vector_s, i);
+        relevant_smat = groups[scanned_bit];
 
-        /* 3.4. Add the filtered values in the row */
-        result = spmat_list_reduce_row(&GET_ROW(orig, i),
+        /* 3.2. Add the filtered values in the row */
+        result = spmat_list_reduce_row(
+                &GET_ROW(orig, i),
                 vector_s,
-                scanned_s_value,
+                scanned_bit,
                 temp_s_indexes,
-                relevant_row_pointer);
+                GET_SPMAT_DATA(relevant_smat->orig)->arena,
+                &GET_ROW(relevant_smat->orig, relevant_smat->g_length));
         if (E__SUCCESS != result) {
             goto l_cleanup;
         }
+
+        /* 3.3. Split g vector */
+        relevant_smat->g[relevant_smat->g_length] = smat->g[i];
+        ++relevant_smat->g_length;
     }
 
     /* Success */
@@ -738,63 +969,77 @@ static
 double
 submat_spmat_list_mult_row_with_s_no_hat_improved(const submatrix_t *smat,
                                                   int row_g,
-                                                  const double *s_vector)
+                                                  const sign_word_t *s_vector)
 {
     double result = 0.0;
     list_t *l = NULL;
     node_t *s = NULL;
-    int col_i = 0;
     int row_i = 0;
-    double expected_value = 0.0;
-    int prev_g = 0;
-    int current_g = 0;
-    double kj_zeroes_sums = 0.0;
+    double k_dot_s = 0.0;
     double values_sum = 0.0;
 
     row_i = smat->g[row_g];
 
+    /* 1. The adjacency part, over the row's non-zeroes only */
     l = GET_ROW(smat->orig, row_g).list;
     if (NULL != l) {
         /* If line is NULL, continue with calculation */
         for (s = l->first ; NULL != s ; s = s->next) {
-            current_g = s->index;
-
-            /* Add previous 0.0 cells */
-            kj_zeroes_sums += VECTOR_scalar_multiply_with_s(
-                &smat->adj->neighbors_div_M[prev_g],
-                &s_vector[prev_g],
-                current_g - prev_g
-            );
-            /* If current_g is last, the loop will break and the fix will be
-             * applied */
-            prev_g = current_g + 1;
-
-            col_i = smat->g[current_g];
-            expected_value = SPMAT_GET_EXPECTED_VALUE(smat, row_i, col_i);
-            values_sum += (s->value - expected_value) * (s_vector[current_g] > 0 ? 1 : -1);
+            values_sum += s->value * SIGN_VECTOR_VALUE(s_vector, s->index);
         }
     }
-    current_g = smat->g_length;
-
-    kj_zeroes_sums += VECTOR_scalar_multiply_with_s(
-        &smat->adj->neighbors_div_M[prev_g],
-        &s_vector[prev_g],
-        MAX(current_g - prev_g, 0)
-    );
 
-    kj_zeroes_sums *= (double)smat->adj->neighbors[row_i];
+    /* 2. The expected part: ki * sum of kj/M * sj */
+    k_dot_s = VECTOR_gather_multiply_with_s(smat->adj->neighbors_div_M,
+                                            smat->g,
+                                            s_vector,
+                                            smat->g_length);
+    k_dot_s *= (double)smat->adj->neighbors[row_i];
 
-    result = values_sum - kj_zeroes_sums + (smat->add_to_diag * s_vector[row_g]);
-    result += (smat->add_to_diag) * s_vector[row_g];
+    result = values_sum - k_dot_s +
+             (smat->add_to_diag * SIGN_VECTOR_VALUE(s_vector, row_g));
+    result += (smat->add_to_diag) * SIGN_VECTOR_VALUE(s_vector, row_g);
 
     return result;
 }
 
+static
+double
+submat_spmat_list_mult_row_with_signs(const submatrix_t *smat,
+                                      int row_g,
+                                      const sign_word_t *s_vector,
+                                      double k_sum,
+                                      double k_dot_s)
+{
+    list_t *l = NULL;
+    node_t *s = NULL;
+    double a_dot_s = 0.0;
+    double a_sum = 0.0;
+    double k = 0.0;
+    double f = 0.0;
+
+    /* 1. The adjacency part: A[g]*s and the row's sum */
+    l = GET_ROW(smat->orig, row_g).list;
+    if (NULL != l) {
+        for (s = l->first ; NULL != s ; s = s->next) {
+            a_dot_s += s->value * SIGN_VECTOR_VALUE(s_vector, s->index);
+            a_sum += s->value;
+        }
+    }
+
+    /* 2. B[g]_ij = A_ij - ki*kj/M, and f_i is the sum of B[g]'s row */
+    k = (double)smat->adj->neighbors[smat->g[row_g]];
+    f = a_sum - (k * k_sum);
+
+    return a_dot_s - (k * k_dot_s) +
+           ((smat->add_to_diag - f) * SIGN_VECTOR_VALUE(s_vector, row_g));
+}
+
 static
 double
 submat_spmat_list_mult_row_with_s(const submatrix_t *smat,
                                   int row_g,
-                                  const double *s_vector)
+                                  const eigen_real_t *s_vector)
 {
     double result = 0.0;
     list_t *l = NULL;
@@ -847,21 +1092,32 @@ submat_spmat_list_mult_row_with_s(const submatrix_t *smat,
 
 double
 SUBMAT_SPMAT_LIST_calculate_q(const submatrix_t *submatrix,
-                              const double *s_vector)
+                              const sign_word_t *s_vector)
 {
     double current_row_mul = 0.0;
     double mult_vmv = 0.0;
+    double k_sum = 0.0;
+    double k_dot_s = 0.0;
     int row_g = 0;
 
-    /* Multiply each row with s-vector */
+    /* The kj/M sums are shared by all the rows */
     for (row_g = 0 ; row_g < submatrix->g_length ; ++row_g) {
-        current_row_mul = 0.0;
+        k_sum += submatrix->adj->neighbors_div_M[submatrix->g[row_g]];
+    }
+    k_dot_s = VECTOR_gather_multiply_with_s(submatrix->adj->neighbors_div_M,
+                                            submatrix->g,
+                                            s_vector,
+                                            submatrix->g_length);
 
+    /* Multiply each row with s-vector */
+    for (row_g = 0 ; row_g < submatrix->g_length ; ++row_g) {
         /* Add to result v[row] times M[row, :]*v */
-        current_row_mul = submat_spmat_list_mult_row_with_s(submatrix,
-                                                            row_g,
-                                                            s_vector);
-        mult_vmv += (s_vector[row_g] * current_row_mul);
+        current_row_mul = submat_spmat_list_mult_row_with_signs(submatrix,
+                                                                row_g,
+                                                                s_vector,
+                                                                k_sum,
+                                                                k_dot_s);
+        mult_vmv += (SIGN_VECTOR_VALUE(s_vector, row_g) * current_row_mul);
     }
 
     return mult_vmv;
@@ -935,25 +1191,44 @@ l_cleanup:
 }
 #endif
 
-void
+double
 SUBMAT_SPMAT_LIST_mult(const submatrix_t *submatrix,
-                       const double *vector,
-                       double *result)
+                       const eigen_real_t *vector,
+                       eigen_real_t *result)
 {
     int row_g = 0;
     double current_row_mul = 0.0;
+    double norm_square = 0.0;
 
     for (row_g = 0 ; row_g < submatrix->g_length ; ++row_g) {
         current_row_mul = submat_spmat_list_mult_row_with_s(submatrix,
                                                             row_g,
                                                             vector);
-        result[row_g] = current_row_mul;
+        result[row_g] = (eigen_real_t)current_row_mul;
+        norm_square += current_row_mul * current_row_mul;
+    }
+
+    return norm_square;
+}
+
+double
+SUBMAT_SPMAT_LIST_mult_vmv(const submatrix_t *submatrix,
+                           const eigen_real_t *vector)
+{
+    int row_g = 0;
+    double result = 0.0;
+
+    for (row_g = 0 ; row_g < submatrix->g_length ; ++row_g) {
+        result += vector[row_g] *
+                  submat_spmat_list_mult_row_with_s(submatrix, row_g, vector);
     }
+
+    return result;
 }
 
 double
 SUBMAT_SPMAT_LIST_calc_q_score(const submatrix_t *smat,
-                               const double *vector,
+                               const sign_word_t *vector,
                                int row_g)
 {
 	double q_part1 = 0.0;
@@ -966,7 +1241,7 @@ SUBMAT_SPMAT_LIST_calc_q_score(const submatrix_t *smat,
                                                                 vector);
     row_i = smat->g[row_g];
     expected_value = SPMAT_GET_EXPECTED_VALUE(smat, row_i, row_i);
-    q_score = 4 * (vector[row_g] * q_part1 + expected_value);
+    q_score = 4 * (SIGN_VECTOR_VALUE(vector, row_g) * q_part1 + expected_value);
 
     return q_score;
 }
@@ -12,12 +12,20 @@
 #include "matrix.h"
 #include "submatrix.h"
 #include "common.h"
+#include "pool.h"
 
 
 /* Functions Declarations ****************************************************/
-/* Allocates a new linked-lists sparse matrix of size n */
+/* Creates a pool of linked-lists sparse matrices' headers */
 result_t
-SPMAT_LIST_allocate(int n, matrix_t **mat);
+SPMAT_LIST_create_headers_pool(pool_t **pool_out);
+
+/*
+ * Allocates a new linked-lists sparse matrix of size n.
+ * Its header is recycled from the headers pool, or allocated if it is NULL
+ */
+result_t
+SPMAT_LIST_allocate(int n, pool_t *headers, matrix_t **mat);
 
 /*
  * Calculate the 1-norm of a given submatrix
@@ -35,11 +43,21 @@ SUBMAT_SPMAT_LIST_get_1norm(const submatrix_t *smat,
  * @param submatrix The submatrix
  * @param vector Buffer to multiply with
  * @param result pre-allocated buffer
+ *
+ * @return The result's squared norm
  */
-void
+double
 SUBMAT_SPMAT_LIST_mult(const submatrix_t *submatrix,
-                       const double *vector,
-                       double *result);
+                       const eigen_real_t *vector,
+                       eigen_real_t *result);
+
+/*
+ * Calculate v^T*B*v of the submatrix with a given vector. Every row's
+ * multiplication is kept in double precision
+ */
+double
+SUBMAT_SPMAT_LIST_mult_vmv(const submatrix_t *submatrix,
+                           const eigen_real_t *vector);
 
 /**
  * Calculate the Q of the submatrix with a given vector using the formula
@@ -47,14 +65,14 @@ SUBMAT_SPMAT_LIST_mult(const submatrix_t *submatrix,
  */
 double
 SUBMAT_SPMAT_LIST_calculate_q(const submatrix_t *submatrix,
-                              const double *s_vector);
+                              const sign_word_t *s_vector);
 
 /**
  * Split a submatrix into two submatrices accordingly to a given s-vector
  */
 result_t
 SUBMAT_SPMAT_LIST_split(submatrix_t *smat,
-        const double * vector_s,
+        const sign_word_t * vector_s,
         int *temp_s_indexes,
         submatrix_t **matrix1_out,
         submatrix_t **matrix2_out);
@@ -64,7 +82,7 @@ SUBMAT_SPMAT_LIST_split(submatrix_t *smat,
  */
 double
 SUBMAT_SPMAT_LIST_calc_q_score(const submatrix_t *smat,
-                       const double *vector,
+                       const sign_word_t *vector,
                        int row);
 
 
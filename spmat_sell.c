@@ -0,0 +1,1305 @@
+/*
+ * @file spmat_sell.c
+ * @purpose Sparse matrix implemented as SELL-C-sigma (sliced ELLPACK).
+ *          The rows are grouped into chunks of SPMAT_SELL_CHUNK rows, sorted
+ *          by their lengths within windows of SPMAT_SELL_SIGMA rows. Each
+ *          chunk is stored column-major, so a chunk's k'th cells are
+ *          contiguous and every lane of a SIMD register handles its own row
+ */
+
+/* Includes ******************************************************************/
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "results.h"
+#include "matrix.h"
+#include "spmat_sell.h"
+#include "common.h"
+#include "debug.h"
+#include "vector.h"
+#include "submatrix.h"
+#include "pool.h"
+
+
+/* Constants *****************************************************************/
+/* Initial cells capacity of the added rows, grows by doubling */
+#define SPMAT_SELL_INITIAL_CAPACITY (1024)
+
+#if (0 >= SPMAT_SELL_CHUNK) || (0 != (SPMAT_SELL_SIGMA % SPMAT_SELL_CHUNK))
+#error "SPMAT_SELL_SIGMA must be a multiple of SPMAT_SELL_CHUNK"
+#endif
+
+
+/* Structs *******************************************************************/
+/*
+ * The rows added to a matrix that wasn't sliced yet.
+ * Row i's cells are [offsets[i], offsets[i] + lengths[i])
+ */
+typedef struct spmat_sell_staging_s {
+    size_t *offsets;
+    /* -1 until the row is added */
+    int *lengths;
+    int *columns;
+    double *values;
+    size_t cells_count;
+    size_t cells_capacity;
+    int rows_added;
+} spmat_sell_staging_t;
+
+/* A row and its length, sorted within its window */
+typedef struct spmat_sell_slot_s {
+    int length;
+    int row;
+} spmat_sell_slot_t;
+
+/*
+ * matrix->private.
+ * Slot i is lane i % C of chunk i / C. The chunk's cells start at
+ * chunk_offsets[i / C], and its k'th cells are the C cells from
+ * k * C on. The cells after a row's length and the padding slots' cells
+ * are zeroes of column 0
+ */
+typedef struct spmat_sell_data_s {
+    /* Original vertex index of each row */
+    int *g;
+    int *row_slots;
+    int *row_lengths;
+    /* The row of each slot, or -1 for padding */
+    int *slot_rows;
+    /* chunks_count + 1 entries: the last is the cells count */
+    size_t *chunk_offsets;
+    int *columns;
+    double *values;
+    int chunks_count;
+    /* The rows added so far, NULL once the matrix is sliced */
+    spmat_sell_staging_t *staging;
+} spmat_sell_data_t;
+
+/* A matrix_t and its data, allocated at once */
+typedef struct spmat_sell_header_s {
+    matrix_t matrix;
+    spmat_sell_data_t data;
+} spmat_sell_header_t;
+
+
+/* Macros ********************************************************************/
+#define GET_SELL_DATA(matrix) ((spmat_sell_data_t *)((matrix)->private))
+
+/* The position of a row's k'th cell within the cells */
+#define SPMAT_SELL_CELL(data, row, k) (                                     \
+    (data)->chunk_offsets[(data)->row_slots[(row)] / SPMAT_SELL_CHUNK] +    \
+    ((size_t)(k) * SPMAT_SELL_CHUNK) +                                      \
+    ((size_t)(data)->row_slots[(row)] % SPMAT_SELL_CHUNK)                   \
+)
+
+/* The width of a chunk: its longest row's length */
+#define SPMAT_SELL_CHUNK_WIDTH(data, chunk) ((int)(                         \
+    ((data)->chunk_offsets[(chunk) + 1] - (data)->chunk_offsets[(chunk)]) / \
+    SPMAT_SELL_CHUNK)                                                       \
+)
+
+#define SPMAT_GET_EXPECTED_VALUE(smat, i, j) (                              \
+    (smat->adj->neighbors[(i)] * smat->adj->neighbors_div_M[(j)])           \
+)
+
+
+/* Functions Declarations ****************************************************/
+/**
+ * @purpose Free a matrix's arrays and the rows that weren't sliced
+ * @param data The matrix's data
+ */
+static
+void
+spmat_sell_data_free(spmat_sell_data_t *data);
+
+/**
+ * @purpose Make room for a row at the added rows' end
+ * @param staging The added rows
+ * @param count The cells count to make room for
+ *
+ * @return One of result_t values
+ *
+ * @remark The row's cells are written from cells_count on, then committed
+ *         by spmat_sell_commit_row
+ */
+static
+result_t
+spmat_sell_reserve_row(spmat_sell_staging_t *staging, size_t count);
+
+/**
+ * @purpose Set the row written at the added rows' end. The matrix is sliced
+ *          once all of its rows were added
+ * @param mat The matrix
+ * @param row_index The row's index
+ * @param length The row's cells count
+ *
+ * @return One of result_t values
+ */
+static
+result_t
+spmat_sell_commit_row(matrix_t *mat, int row_index, int length);
+
+/**
+ * @purpose Slice the added rows into chunks, and free them
+ * @param mat The matrix, whose rows were all added
+ *
+ * @return One of result_t values
+ */
+static
+result_t
+spmat_sell_slice(matrix_t *mat);
+
+/**
+ * @purpose Order slots by descending length, then by ascending row
+ * @see qsort
+ */
+static
+int
+spmat_sell_compare_slots(const void *slot1, const void *slot2);
+
+/**
+ * @purpose Set a row of the matrix. A row can be set only once
+ * @see matrix_add_row_f on matrix.h
+ */
+static
+result_t
+spmat_sell_add_row(matrix_t *mat, const double *row, int i);
+
+/**
+ * @purpose Set a row of the matrix by its columns. A row can be set only once
+ * @see matrix_add_pattern_row_f on matrix.h
+ */
+static
+result_t
+spmat_sell_add_pattern_row(matrix_t *mat, const int *columns, int length, int i);
+
+/**
+ * @see matrix_free_f on matrix.h
+ */
+static
+void
+spmat_sell_free(matrix_t *mat);
+
+/**
+ * @see matrix_mult_f on matrix.h
+ */
+static
+void
+spmat_sell_mult(const matrix_t *mat, const double *v, double *result);
+
+/**
+ * @see matrix_get_g_f on matrix.h
+ */
+static
+int *
+spmat_sell_get_g(matrix_t *mat);
+
+/**
+ * @see matrix_extract_f on matrix.h
+ */
+static
+result_t
+spmat_sell_extract(const matrix_t *mat,
+                   const int *g,
+                   int g_length,
+                   int *temp_positions,
+                   pool_t *headers,
+                   matrix_t **mat_out);
+
+/**
+ * @purpose Sum k_j/M, and optionally k_j/M * v_j, over the submatrix's g
+ * @param smat The submatrix
+ * @param v A g_length-sized vector, or NULL
+ * @param k_dot_v_out k/M multiplied by v. Not set if v is NULL
+ *
+ * @return The sum of k_j/M
+ */
+static
+double
+spmat_sell_sum_neighbors_div_M(const submatrix_t *smat,
+                               const eigen_real_t *v,
+                               double *k_dot_v_out);
+
+/**
+ * @purpose Multiply a chunk's rows with a vector, a lane per row
+ * @param data The matrix's data
+ * @param chunk The chunk
+ * @param v The vector, or NULL to multiply with the s-vector
+ * @param s_vector The s-vector, used if v is NULL
+ * @param dots Set to each lane's A*v
+ * @param sums Set to each lane's row sum
+ */
+static
+void
+spmat_sell_chunk_mult(const spmat_sell_data_t *data,
+                      int chunk,
+                      const eigen_real_t *v,
+                      const sign_word_t *s_vector,
+                      double *dots,
+                      double *sums);
+
+/**
+ * @purpose Multiply a row of the submatrix (with hat) with a given vector,
+ *          out of its adjacency part
+ * @param smat The submatrix
+ * @param row_g The row's index
+ * @param v_row The vector's value at the row
+ * @param a_dot_v The adjacency row multiplied by the vector
+ * @param a_sum The adjacency row's sum
+ * @param k_sum The sum of k_j/M over g
+ * @param k_dot_v The scalar multiplication of k/M over g with v
+ *
+ * @return The multiplication result
+ */
+static
+double
+spmat_sell_hat_row(const submatrix_t *smat,
+                   int row_g,
+                   double v_row,
+                   double a_dot_v,
+                   double a_sum,
+                   double k_sum,
+                   double k_dot_v);
+
+
+/* Virtual Table *************************************************************/
+const matrix_vtable_t SPMAT_SELL_VTABLE = {
+    .add_row = spmat_sell_add_row,
+    .add_pattern_row = spmat_sell_add_pattern_row,
+    .free = spmat_sell_free,
+    .mult = spmat_sell_mult,
+    .mult_vmv = NULL,
+    .get_g = spmat_sell_get_g,
+    .extract = spmat_sell_extract,
+    .submat_get_1norm = SUBMAT_SPMAT_SELL_get_1norm,
+    .submat_mult = SUBMAT_SPMAT_SELL_mult,
+    .submat_mult_vmv = SUBMAT_SPMAT_SELL_mult_vmv,
+    .submat_calculate_q = SUBMAT_SPMAT_SELL_calculate_q,
+    .submat_calc_q_score = SUBMAT_SPMAT_SELL_calc_q_score,
+    .submat_split = SUBMAT_SPMAT_SELL_split,
+};
+
+
+/* Functions *****************************************************************/
+result_t
+SPMAT_SELL_create_headers_pool(pool_t **pool_out)
+{
+    return POOL_create(sizeof(spmat_sell_header_t), pool_out);
+}
+
+result_t
+SPMAT_SELL_allocate(int n, pool_t *headers, matrix_t **mat_out)
+{
+    result_t result = E__UNKNOWN;
+    spmat_sell_header_t *header = NULL;
+    spmat_sell_data_t *data = NULL;
+    spmat_sell_staging_t *staging = NULL;
+    int i = 0;
+
+    /* 0. Input validation */
+    if (NULL == mat_out) {
+        result = E__NULL_ARGUMENT;
+        goto l_cleanup;
+    }
+
+    if (0 > n) {
+        result = E__INVALID_SIZE;
+        goto l_cleanup;
+    }
+
+    /* 1. Allocate the header, recycle one if possible */
+    if (NULL != headers) {
+        result = POOL_alloc(headers, (void **)&header);
+        if (E__SUCCESS != result) {
+            goto l_cleanup;
+        }
+    } else {
+        header = (spmat_sell_header_t *)malloc(sizeof(*header));
+        if (NULL == header) {
+            result = E__MALLOC_ERROR;
+            goto l_cleanup;
+        }
+    }
+    (void)memset(header, 0, sizeof(*header));
+    header->matrix.vtable = &SPMAT_SELL_VTABLE;
+    header->matrix.n = n;
+    header->matrix.type = MATRIX_TYPE_SPMAT_SELL;
+    header->matrix.pool = headers;
+    header->matrix.private = (void *)&header->data;
+    data = &header->data;
+
+    /* 2. g-vector, the rows are the original vertices */
+    data->g = (int *)malloc(MAX(n, 1) * sizeof(*data->g));
+    if (NULL == data->g) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+    for (i = 0 ; i < n ; ++i) {
+        data->g[i] = i;
+    }
+
+    /* 3. The added rows, initialized as missing */
+    staging = (spmat_sell_staging_t *)malloc(sizeof(*staging));
+    if (NULL == staging) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+    (void)memset(staging, 0, sizeof(*staging));
+    data->staging = staging;
+
+    staging->offsets = (size_t *)malloc(MAX(n, 1) *
+                                        sizeof(*staging->offsets));
+    if (NULL == staging->offsets) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+
+    staging->lengths = (int *)malloc(MAX(n, 1) * sizeof(*staging->lengths));
+    if (NULL == staging->lengths) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+    for (i = 0 ; i < n ; ++i) {
+        staging->lengths[i] = -1;
+    }
+
+    /* 4. An empty matrix has all of its rows */
+    if (0 == n) {
+        result = spmat_sell_slice(&header->matrix);
+        if (E__SUCCESS != result) {
+            goto l_cleanup;
+        }
+    }
+
+    DEBUG_PRINT("%s: addr %p n=%d\n", __func__, (void *)header, n);
+    /* Success */
+    *mat_out = &header->matrix;
+
+    result = E__SUCCESS;
+l_cleanup:
+
+    if ((E__SUCCESS != result) && (NULL != header)) {
+        spmat_sell_free(&header->matrix);
+        header = NULL;
+    }
+
+    return result;
+}
+
+static
+void
+spmat_sell_data_free(spmat_sell_data_t *data)
+{
+    if (NULL != data->staging) {
+        FREE_SAFE(data->staging->values);
+        FREE_SAFE(data->staging->columns);
+        FREE_SAFE(data->staging->lengths);
+        FREE_SAFE(data->staging->offsets);
+        FREE_SAFE(data->staging);
+    }
+    FREE_SAFE(data->values);
+    FREE_SAFE(data->columns);
+    FREE_SAFE(data->chunk_offsets);
+    FREE_SAFE(data->slot_rows);
+    FREE_SAFE(data->row_lengths);
+    FREE_SAFE(data->row_slots);
+    FREE_SAFE(data->g);
+}
+
+static
+void
+spmat_sell_free(matrix_t *mat)
+{
+    if (NULL != mat) {
+        DEBUG_PRINT("%s: addr %p n=%d\n", __func__, (void *)mat, mat->n);
+        if (NULL != mat->private) {
+            spmat_sell_data_free(GET_SELL_DATA(mat));
+        }
+        mat->private = NULL;
+
+        /* The data is a part of the header */
+        if (NULL != mat->pool) {
+            POOL_release(mat->pool, mat);
+        } else {
+            free(mat);
+        }
+    }
+}
+
+static
+result_t
+spmat_sell_reserve_row(spmat_sell_staging_t *staging, size_t count)
+{
+    result_t result = E__UNKNOWN;
+    size_t capacity = 0;
+    int *columns = NULL;
+    double *values = NULL;
+
+    /* 1. Check if there's enough room */
+    if (staging->cells_capacity - staging->cells_count >= count) {
+        result = E__SUCCESS;
+        goto l_cleanup;
+    }
+
+    /* 2. Double the capacity until there's enough room */
+    capacity = MAX(staging->cells_capacity, SPMAT_SELL_INITIAL_CAPACITY);
+    while (capacity - staging->cells_count < count) {
+        capacity *= 2;
+    }
+
+    /* 3. Reallocate */
+    columns = (int *)realloc(staging->columns, capacity * sizeof(*columns));
+    if (NULL == columns) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+    staging->columns = columns;
+
+    values = (double *)realloc(staging->values, capacity * sizeof(*values));
+    if (NULL == values) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+    staging->values = values;
+
+    staging->cells_capacity = capacity;
+
+    result = E__SUCCESS;
+l_cleanup:
+
+    return result;
+}
+
+static
+result_t
+spmat_sell_commit_row(matrix_t *mat, int row_index, int length)
+{
+    spmat_sell_staging_t *staging = GET_SELL_DATA(mat)->staging;
+
+    staging->offsets[row_index] = staging->cells_count;
+    staging->lengths[row_index] = length;
+    staging->cells_count += (size_t)length;
+    ++staging->rows_added;
+
+    if (mat->n == staging->rows_added) {
+        return spmat_sell_slice(mat);
+    }
+
+    return E__SUCCESS;
+}
+
+static
+int
+spmat_sell_compare_slots(const void *slot1, const void *slot2)
+{
+    const spmat_sell_slot_t *first = (const spmat_sell_slot_t *)slot1;
+    const spmat_sell_slot_t *second = (const spmat_sell_slot_t *)slot2;
+
+    if (first->length != second->length) {
+        return (first->length > second->length) ? -1 : 1;
+    }
+
+    return (first->row > second->row) - (first->row < second->row);
+}
+
+static
+result_t
+spmat_sell_slice(matrix_t *mat)
+{
+    result_t result = E__UNKNOWN;
+    spmat_sell_data_t *data = GET_SELL_DATA(mat);
+    spmat_sell_staging_t *staging = data->staging;
+    spmat_sell_slot_t *slots = NULL;
+    size_t slots_count = 0;
+    size_t cells_count = 0;
+    size_t cell = 0;
+    size_t staged = 0;
+    int width = 0;
+    int window = 0;
+    int chunk = 0;
+    int row = 0;
+    int i = 0;
+    int k = 0;
+
+    data->chunks_count = (mat->n + SPMAT_SELL_CHUNK - 1) / SPMAT_SELL_CHUNK;
+    slots_count = (size_t)data->chunks_count * SPMAT_SELL_CHUNK;
+
+    /* 1. Allocate the rows' and chunks' arrays */
+    data->row_slots = (int *)malloc(MAX(mat->n, 1) *
+                                    sizeof(*data->row_slots));
+    if (NULL == data->row_slots) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+
+    data->row_lengths = (int *)malloc(MAX(mat->n, 1) *
+                                      sizeof(*data->row_lengths));
+    if (NULL == data->row_lengths) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+    (void)memcpy(data->row_lengths,
+                 staging->lengths,
+                 mat->n * sizeof(*data->row_lengths));
+
+    data->slot_rows = (int *)malloc(MAX(slots_count, 1) *
+                                    sizeof(*data->slot_rows));
+    if (NULL == data->slot_rows) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+
+    data->chunk_offsets = (size_t *)malloc((data->chunks_count + 1) *
+                                           sizeof(*data->chunk_offsets));
+    if (NULL == data->chunk_offsets) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+
+    /* 2. Sort the rows by their lengths within each sigma window */
+    slots = (spmat_sell_slot_t *)malloc(MAX(mat->n, 1) * sizeof(*slots));
+    if (NULL == slots) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+    for (row = 0 ; row < mat->n ; ++row) {
+        slots[row].length = staging->lengths[row];
+        slots[row].row = row;
+    }
+    for (window = 0 ; window < mat->n ; window += SPMAT_SELL_SIGMA) {
+        qsort(&slots[window],
+              (size_t)((mat->n - window < SPMAT_SELL_SIGMA) ?
+                       (mat->n - window) : SPMAT_SELL_SIGMA),
+              sizeof(*slots),
+              spmat_sell_compare_slots);
+    }
+
+    /* 3. Map the slots and the rows, the last chunk is padded */
+    for (i = 0 ; i < (int)slots_count ; ++i) {
+        data->slot_rows[i] = (i < mat->n) ? slots[i].row : -1;
+        if (i < mat->n) {
+            data->row_slots[slots[i].row] = i;
+        }
+    }
+
+    /* 4. Each chunk is as wide as its longest row */
+    for (chunk = 0 ; chunk < data->chunks_count ; ++chunk) {
+        width = 0;
+        for (i = 0 ; i < SPMAT_SELL_CHUNK ; ++i) {
+            row = data->slot_rows[chunk * SPMAT_SELL_CHUNK + i];
+            if (0 <= row) {
+                width = MAX(width, staging->lengths[row]);
+            }
+        }
+        data->chunk_offsets[chunk] = cells_count;
+        cells_count += (size_t)width * SPMAT_SELL_CHUNK;
+    }
+    data->chunk_offsets[data->chunks_count] = cells_count;
+
+    /* 5. Lay the cells column-major, over zero padding */
+    data->columns = (int *)malloc(MAX(cells_count, 1) *
+                                  sizeof(*data->columns));
+    if (NULL == data->columns) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+    (void)memset(data->columns, 0, cells_count * sizeof(*data->columns));
+
+    data->values = (double *)malloc(MAX(cells_count, 1) *
+                                    sizeof(*data->values));
+    if (NULL == data->values) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+    for (cell = 0 ; cell < cells_count ; ++cell) {
+        data->values[cell] = 0.0;
+    }
+
+    for (row = 0 ; row < mat->n ; ++row) {
+        staged = staging->offsets[row];
+        for (k = 0 ; k < staging->lengths[row] ; ++k) {
+            cell = SPMAT_SELL_CELL(data, row, k);
+            data->columns[cell] = staging->columns[staged + k];
+            data->values[cell] = staging->values[staged + k];
+        }
+    }
+
+    /* 6. The added rows aren't needed anymore */
+    FREE_SAFE(staging->values);
+    FREE_SAFE(staging->columns);
+    FREE_SAFE(staging->lengths);
+    FREE_SAFE(staging->offsets);
+    FREE_SAFE(data->staging);
+
+    result = E__SUCCESS;
+l_cleanup:
+    FREE_SAFE(slots);
+
+    return result;
+}
+
+static
+result_t
+spmat_sell_add_row(matrix_t *mat, const double *values, int row_index)
+{
+    result_t result = E__UNKNOWN;
+    spmat_sell_staging_t *staging = NULL;
+    size_t row_length = 0;
+    int col = 0;
+
+    /* 0. Input validation */
+    if ((NULL == mat) || (NULL == mat->private) || (NULL == values)) {
+        result = E__NULL_ARGUMENT;
+        goto l_cleanup;
+    }
+
+    if (!MATRIX_IS_VALID_ROW_INDEX(mat, row_index)) {
+        result = E__INVALID_ROW_INDEX;
+        goto l_cleanup;
+    }
+
+    /* A sliced matrix has all of its rows */
+    staging = GET_SELL_DATA(mat)->staging;
+    if ((NULL == staging) || (-1 != staging->lengths[row_index])) {
+        result = E__ROW_ALREADY_IN_USE;
+        goto l_cleanup;
+    }
+
+    /* 1. Count the non-zero columns */
+    for (col = 0 ; mat->n > col ; ++col) {
+        if (0 != values[col]) {
+            ++row_length;
+        }
+    }
+
+    /* 2. Append the row to the added rows */
+    result = spmat_sell_reserve_row(staging, row_length);
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+
+    row_length = 0;
+    for (col = 0 ; mat->n > col ; ++col) {
+        if (0 != values[col]) {
+            staging->columns[staging->cells_count + row_length] = col;
+            staging->values[staging->cells_count + row_length] = values[col];
+            ++row_length;
+        }
+    }
+
+    result = spmat_sell_commit_row(mat, row_index, (int)row_length);
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+
+    result = E__SUCCESS;
+l_cleanup:
+
+    return result;
+}
+
+static
+result_t
+spmat_sell_add_pattern_row(matrix_t *mat,
+                           const int *columns,
+                           int length,
+                           int row_index)
+{
+    result_t result = E__UNKNOWN;
+    spmat_sell_staging_t *staging = NULL;
+    int k = 0;
+
+    /* 0. Input validation */
+    if ((NULL == mat) || (NULL == mat->private)) {
+        result = E__NULL_ARGUMENT;
+        goto l_cleanup;
+    }
+
+    if (!MATRIX_IS_VALID_ROW_INDEX(mat, row_index)) {
+        result = E__INVALID_ROW_INDEX;
+        goto l_cleanup;
+    }
+
+    if (!MATRIX_is_valid_pattern(columns, length, mat->n)) {
+        result = E__INVALID_VALUE;
+        goto l_cleanup;
+    }
+
+    /* A sliced matrix has all of its rows */
+    staging = GET_SELL_DATA(mat)->staging;
+    if ((NULL == staging) || (-1 != staging->lengths[row_index])) {
+        result = E__ROW_ALREADY_IN_USE;
+        goto l_cleanup;
+    }
+
+    /* 1. Append the row to the added rows */
+    result = spmat_sell_reserve_row(staging, (size_t)length);
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+
+    for (k = 0 ; k < length ; ++k) {
+        staging->columns[staging->cells_count + k] = columns[k];
+        staging->values[staging->cells_count + k] = 1.0;
+    }
+
+    result = spmat_sell_commit_row(mat, row_index, length);
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+
+    result = E__SUCCESS;
+l_cleanup:
+
+    return result;
+}
+
+static
+void
+spmat_sell_mult(const matrix_t *mat, const double *v, double *result)
+{
+    const spmat_sell_data_t *data = NULL;
+    double row_result = 0.0;
+    size_t cell = 0;
+    int i = 0;
+    int k = 0;
+
+    if ((NULL == mat) || (NULL == v) || (NULL == result)) {
+        return;
+    }
+
+    data = GET_SELL_DATA(mat);
+    for (i = 0 ; i < mat->n ; ++i) {
+        row_result = 0.0;
+        for (k = 0 ; k < data->row_lengths[i] ; ++k) {
+            cell = SPMAT_SELL_CELL(data, i, k);
+            row_result += data->values[cell] * v[data->columns[cell]];
+        }
+        result[i] = row_result;
+    }
+}
+
+static
+int *
+spmat_sell_get_g(matrix_t *mat)
+{
+    return GET_SELL_DATA(mat)->g;
+}
+
+static
+result_t
+spmat_sell_extract(const matrix_t *mat,
+                   const int *g,
+                   int g_length,
+                   int *temp_positions,
+                   pool_t *headers,
+                   matrix_t **mat_out)
+{
+    result_t result = E__UNKNOWN;
+    matrix_t *extracted = NULL;
+    const spmat_sell_data_t *orig_data = NULL;
+    spmat_sell_data_t *data = NULL;
+    spmat_sell_staging_t *staging = NULL;
+    bool_t are_positions_set = FALSE;
+    size_t cell = 0;
+    int row_length = 0;
+    int position = 0;
+    int i = 0;
+    int k = 0;
+
+    /* 0. Input validation */
+    if ((NULL == mat) || (NULL == g) ||
+            (NULL == temp_positions) || (NULL == mat_out)) {
+        result = E__NULL_ARGUMENT;
+        goto l_cleanup;
+    }
+
+    /* 1. Allocate the extracted matrix */
+    result = SPMAT_SELL_allocate(g_length, headers, &extracted);
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+    orig_data = GET_SELL_DATA(mat);
+    data = GET_SELL_DATA(extracted);
+    staging = data->staging;
+
+    /* 2. Map each extracted index to its new position */
+    for (i = 0 ; i < g_length ; ++i) {
+        temp_positions[g[i]] = i;
+    }
+    are_positions_set = TRUE;
+
+    /* 3. Add each row's columns that were extracted. The last row slices
+     *    the extracted matrix */
+    for (i = 0 ; i < g_length ; ++i) {
+        /* 3.1. Keep the original vertex of the row */
+        data->g[i] = orig_data->g[g[i]];
+
+        result = spmat_sell_reserve_row(staging,
+                                        orig_data->row_lengths[g[i]]);
+        if (E__SUCCESS != result) {
+            goto l_cleanup;
+        }
+
+        row_length = 0;
+        for (k = 0 ; k < orig_data->row_lengths[g[i]] ; ++k) {
+            cell = SPMAT_SELL_CELL(orig_data, g[i], k);
+            position = temp_positions[orig_data->columns[cell]];
+            if (0 <= position) {
+                staging->columns[staging->cells_count + row_length] = position;
+                staging->values[staging->cells_count + row_length] =
+                    orig_data->values[cell];
+                ++row_length;
+            }
+        }
+
+        result = spmat_sell_commit_row(extracted, i, row_length);
+        if (E__SUCCESS != result) {
+            goto l_cleanup;
+        }
+    }
+
+    /* Success */
+    *mat_out = extracted;
+
+    result = E__SUCCESS;
+l_cleanup:
+
+    /* 4. Restore the positions buffer */
+    if (are_positions_set) {
+        for (i = 0 ; i < g_length ; ++i) {
+            temp_positions[g[i]] = -1;
+        }
+    }
+
+    if (E__SUCCESS != result) {
+        spmat_sell_free(extracted);
+        extracted = NULL;
+    }
+
+    return result;
+}
+
+static
+double
+spmat_sell_sum_neighbors_div_M(const submatrix_t *smat,
+                               const eigen_real_t *v,
+                               double *k_dot_v_out)
+{
+    const double *neighbors_div_M = smat->adj->neighbors_div_M;
+    double k_sum = 0.0;
+    double k_dot_v = 0.0;
+    int j = 0;
+
+    if (NULL == v) {
+        for (j = 0 ; j < smat->g_length ; ++j) {
+            k_sum += neighbors_div_M[smat->g[j]];
+        }
+    } else {
+        for (j = 0 ; j < smat->g_length ; ++j) {
+            k_sum += neighbors_div_M[smat->g[j]];
+            k_dot_v += neighbors_div_M[smat->g[j]] * v[j];
+        }
+        *k_dot_v_out = k_dot_v;
+    }
+
+    return k_sum;
+}
+
+static
+void
+spmat_sell_chunk_mult(const spmat_sell_data_t *data,
+                      int chunk,
+                      const eigen_real_t *v,
+                      const sign_word_t *s_vector,
+                      double *dots,
+                      double *sums)
+{
+    const int *columns = &data->columns[data->chunk_offsets[chunk]];
+    const double *values = &data->values[data->chunk_offsets[chunk]];
+    int width = SPMAT_SELL_CHUNK_WIDTH(data, chunk);
+    int lane = 0;
+    int k = 0;
+
+    for (lane = 0 ; lane < SPMAT_SELL_CHUNK ; ++lane) {
+        dots[lane] = 0.0;
+        sums[lane] = 0.0;
+    }
+
+    /* The k'th cells of the chunk's rows are contiguous: each lane adds its
+     * own row's cell. The padding's zeroes add nothing */
+    if (NULL != v) {
+        for (k = 0 ; k < width ; ++k) {
+            for (lane = 0 ; lane < SPMAT_SELL_CHUNK ; ++lane) {
+                dots[lane] += values[lane] * v[columns[lane]];
+                sums[lane] += values[lane];
+            }
+            columns += SPMAT_SELL_CHUNK;
+            values += SPMAT_SELL_CHUNK;
+        }
+    } else {
+        for (k = 0 ; k < width ; ++k) {
+            for (lane = 0 ; lane < SPMAT_SELL_CHUNK ; ++lane) {
+                dots[lane] += values[lane] *
+                              SIGN_VECTOR_VALUE(s_vector, columns[lane]);
+                sums[lane] += values[lane];
+            }
+            columns += SPMAT_SELL_CHUNK;
+            values += SPMAT_SELL_CHUNK;
+        }
+    }
+}
+
+static
+double
+spmat_sell_hat_row(const submatrix_t *smat,
+                   int row_g,
+                   double v_row,
+                   double a_dot_v,
+                   double a_sum,
+                   double k_sum,
+                   double k_dot_v)
+{
+    double k = 0.0;
+    double f = 0.0;
+
+    /* B[g]_ij = A_ij - ki*kj/M, and f_i is the sum of B[g]'s row */
+    k = (double)smat->adj->neighbors[smat->g[row_g]];
+    f = a_sum - (k * k_sum);
+
+    return a_dot_v - (k * k_dot_v) + ((smat->add_to_diag - f) * v_row);
+}
+
+double
+SUBMAT_SPMAT_SELL_mult(const submatrix_t *smat,
+                       const eigen_real_t *vector,
+                       eigen_real_t *result)
+{
+    const spmat_sell_data_t *data = GET_SELL_DATA(smat->orig);
+    double dots[SPMAT_SELL_CHUNK];
+    double sums[SPMAT_SELL_CHUNK];
+    double k_sum = 0.0;
+    double k_dot_v = 0.0;
+    double norm_square = 0.0;
+    double current_row_mul = 0.0;
+    int chunk = 0;
+    int lane = 0;
+    int row_g = 0;
+
+    k_sum = spmat_sell_sum_neighbors_div_M(smat, vector, &k_dot_v);
+    for (chunk = 0 ; chunk < data->chunks_count ; ++chunk) {
+        spmat_sell_chunk_mult(data, chunk, vector, NULL, dots, sums);
+        for (lane = 0 ; lane < SPMAT_SELL_CHUNK ; ++lane) {
+            row_g = data->slot_rows[chunk * SPMAT_SELL_CHUNK + lane];
+            if (0 > row_g) {
+                continue;
+            }
+            current_row_mul = spmat_sell_hat_row(smat,
+                                                 row_g,
+                                                 vector[row_g],
+                                                 dots[lane],
+                                                 sums[lane],
+                                                 k_sum,
+                                                 k_dot_v);
+            result[row_g] = (eigen_real_t)current_row_mul;
+            norm_square += current_row_mul * current_row_mul;
+        }
+    }
+
+    return norm_square;
+}
+
+double
+SUBMAT_SPMAT_SELL_mult_vmv(const submatrix_t *smat,
+                           const eigen_real_t *vector)
+{
+    const spmat_sell_data_t *data = GET_SELL_DATA(smat->orig);
+    double dots[SPMAT_SELL_CHUNK];
+    double sums[SPMAT_SELL_CHUNK];
+    double k_sum = 0.0;
+    double k_dot_v = 0.0;
+    double result = 0.0;
+    int chunk = 0;
+    int lane = 0;
+    int row_g = 0;
+
+    k_sum = spmat_sell_sum_neighbors_div_M(smat, vector, &k_dot_v);
+    for (chunk = 0 ; chunk < data->chunks_count ; ++chunk) {
+        spmat_sell_chunk_mult(data, chunk, vector, NULL, dots, sums);
+        for (lane = 0 ; lane < SPMAT_SELL_CHUNK ; ++lane) {
+            row_g = data->slot_rows[chunk * SPMAT_SELL_CHUNK + lane];
+            if (0 > row_g) {
+                continue;
+            }
+            result += vector[row_g] * spmat_sell_hat_row(smat,
+                                                         row_g,
+                                                         vector[row_g],
+                                                         dots[lane],
+                                                         sums[lane],
+                                                         k_sum,
+                                                         k_dot_v);
+        }
+    }
+
+    return result;
+}
+
+double
+SUBMAT_SPMAT_SELL_calculate_q(const submatrix_t *smat,
+                              const sign_word_t *s_vector)
+{
+    const spmat_sell_data_t *data = GET_SELL_DATA(smat->orig);
+    double dots[SPMAT_SELL_CHUNK];
+    double sums[SPMAT_SELL_CHUNK];
+    double k_sum = 0.0;
+    double k_dot_s = 0.0;
+    double s_row = 0.0;
+    double mult_vmv = 0.0;
+    int chunk = 0;
+    int lane = 0;
+    int row_g = 0;
+
+    k_sum = spmat_sell_sum_neighbors_div_M(smat, NULL, NULL);
+    k_dot_s = VECTOR_gather_multiply_with_s(smat->adj->neighbors_div_M,
+                                            smat->g,
+                                            s_vector,
+                                            smat->g_length);
+    for (chunk = 0 ; chunk < data->chunks_count ; ++chunk) {
+        spmat_sell_chunk_mult(data, chunk, NULL, s_vector, dots, sums);
+        for (lane = 0 ; lane < SPMAT_SELL_CHUNK ; ++lane) {
+            row_g = data->slot_rows[chunk * SPMAT_SELL_CHUNK + lane];
+            if (0 > row_g) {
+                continue;
+            }
+            s_row = SIGN_VECTOR_VALUE(s_vector, row_g);
+            mult_vmv += s_row * spmat_sell_hat_row(smat,
+                                                   row_g,
+                                                   s_row,
+                                                   dots[lane],
+                                                   sums[lane],
+                                                   k_sum,
+                                                   k_dot_s);
+        }
+    }
+
+    return mult_vmv;
+}
+
+double
+SUBMAT_SPMAT_SELL_get_1norm(const submatrix_t *smat,
+                            double *tmp_row_sums)
+{
+    const spmat_sell_data_t *data = GET_SELL_DATA(smat->orig);
+    const double *neighbors_div_M = smat->adj->neighbors_div_M;
+    double norm = 0.0;
+    double k_sum = 0.0;
+    double k = 0.0;
+    double value = 0.0;
+    double a_sum = 0.0;
+    double a_diag = 0.0;
+    double edges_norm = 0.0;
+    double edges_k_sum = 0.0;
+    double zeroes_norm = 0.0;
+    double diag_value = 0.0;
+    size_t cell = 0;
+    int row_g = 0;
+    int row_i = 0;
+    int col_g = 0;
+    int i = 0;
+
+    UNUSED_ARG(tmp_row_sums);
+
+    /* Note: The adjacency matrix is symmetric, therefore 1-norm can be done on
+     *       either max row sum or max column sum */
+    k_sum = spmat_sell_sum_neighbors_div_M(smat, NULL, NULL);
+
+    for (row_g = 0 ; row_g < smat->g_length ; ++row_g) {
+        row_i = smat->g[row_g];
+        k = (double)smat->adj->neighbors[row_i];
+
+        /* 1. Non-zero cells: |A_ij - ki*kj/M| */
+        a_sum = 0.0;
+        a_diag = 0.0;
+        edges_norm = 0.0;
+        edges_k_sum = 0.0;
+        for (i = 0 ; i < data->row_lengths[row_g] ; ++i) {
+            cell = SPMAT_SELL_CELL(data, row_g, i);
+            col_g = data->columns[cell];
+            value = data->values[cell];
+            a_sum += value;
+            if (col_g == row_g) {
+                a_diag += value;
+            } else {
+                edges_k_sum += neighbors_div_M[smat->g[col_g]];
+                edges_norm += fabs(value -
+                                   SPMAT_GET_EXPECTED_VALUE(smat,
+                                                            row_i,
+                                                            smat->g[col_g]));
+            }
+        }
+
+        /* 2. Zero cells: |0 - ki*kj/M| summed over the rest of the row */
+        zeroes_norm = k * (k_sum - edges_k_sum - neighbors_div_M[row_i]);
+
+        /* 3. The diag is decreased by the row's sum f_i */
+        diag_value = a_diag - SPMAT_GET_EXPECTED_VALUE(smat, row_i, row_i) +
+                     smat->add_to_diag - (a_sum - (k * k_sum));
+
+        norm = MAX(norm, zeroes_norm + edges_norm + fabs(diag_value));
+    }
+
+    return norm;
+}
+
+double
+SUBMAT_SPMAT_SELL_calc_q_score(const submatrix_t *smat,
+                               const sign_word_t *vector,
+                               int row_g)
+{
+    const spmat_sell_data_t *data = GET_SELL_DATA(smat->orig);
+    double a_dot_s = 0.0;
+    double k_dot_s = 0.0;
+    double k = 0.0;
+    double s_row = 0.0;
+    double q_part1 = 0.0;
+    double expected_value = 0.0;
+    size_t cell = 0;
+    int row_i = 0;
+    int i = 0;
+
+    row_i = smat->g[row_g];
+    k = (double)smat->adj->neighbors[row_i];
+
+    /* 1. B_ij * s_j = A_ij * s_j - ki * (kj/M * s_j) */
+    for (i = 0 ; i < data->row_lengths[row_g] ; ++i) {
+        cell = SPMAT_SELL_CELL(data, row_g, i);
+        a_dot_s += data->values[cell] *
+                   SIGN_VECTOR_VALUE(vector, data->columns[cell]);
+    }
+    k_dot_s = VECTOR_gather_multiply_with_s(smat->adj->neighbors_div_M,
+                                            smat->g,
+                                            vector,
+                                            smat->g_length);
+    s_row = SIGN_VECTOR_VALUE(vector, row_g);
+    q_part1 = a_dot_s - (k * k_dot_s) + (2 * smat->add_to_diag * s_row);
+
+    expected_value = SPMAT_GET_EXPECTED_VALUE(smat, row_i, row_i);
+
+    return 4 * (s_row * q_part1 + expected_value);
+}
+
+result_t
+SUBMAT_SPMAT_SELL_split(submatrix_t *smat,
+                        const sign_word_t *vector_s,
+                        int *temp_s_indexes,
+                        submatrix_t **matrix1_out,
+                        submatrix_t **matrix2_out)
+{
+    result_t result = E__UNKNOWN;
+    const spmat_sell_data_t *data = NULL;
+    matrix_t *matrices[2] = {NULL, NULL};
+    submatrix_t *smats[2] = {NULL, NULL};
+    spmat_sell_staging_t *staging = NULL;
+    size_t cell = 0;
+    int matrix1_n = 0;
+    int row_length = 0;
+    int bit = 0;
+    int i = 0;
+    int k = 0;
+
+    /* 0. Input validation */
+    /* Null arguments */
+    if ((NULL == smat) ||
+            (NULL == vector_s) ||
+            (NULL == temp_s_indexes) ||
+            (NULL == matrix1_out) ||
+            (NULL == matrix2_out)) {
+        result = E__NULL_ARGUMENT;
+        goto l_cleanup;
+    }
+
+    data = GET_SELL_DATA(smat->orig);
+
+    /* 1. Create s-indexes vector, get matrix1's length */
+    matrix1_n = VECTOR_create_s_indexes(vector_s,
+                                        smat->g_length,
+                                        temp_s_indexes);
+
+    /* 2. Allocate the matrices */
+    result = SPMAT_SELL_allocate(matrix1_n,
+                                 SUBMATRIX_MATRICES_POOL(smat),
+                                 &matrices[0]);
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+
+    result = SPMAT_SELL_allocate(smat->g_length - matrix1_n,
+                                 SUBMATRIX_MATRICES_POOL(smat),
+                                 &matrices[1]);
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+
+    /* 3. Add each row to its group's matrix, filtering its columns to its
+     *    own group. Each matrix is sliced by its last row */
+    for (i = 0 ; i < smat->g_length ; ++i) {
+        bit = SIGN_VECTOR_BIT(vector_s, i);
+        staging = GET_SELL_DATA(matrices[bit])->staging;
+        GET_SELL_DATA(matrices[bit])->g[temp_s_indexes[i]] = smat->g[i];
+
+        result = spmat_sell_reserve_row(staging, data->row_lengths[i]);
+        if (E__SUCCESS != result) {
+            goto l_cleanup;
+        }
+
+        row_length = 0;
+        for (k = 0 ; k < data->row_lengths[i] ; ++k) {
+            cell = SPMAT_SELL_CELL(data, i, k);
+            if (SIGN_VECTOR_BIT(vector_s, data->columns[cell]) == bit) {
+                staging->columns[staging->cells_count + row_length] =
+                    temp_s_indexes[data->columns[cell]];
+                staging->values[staging->cells_count + row_length] =
+                    data->values[cell];
+                ++row_length;
+            }
+        }
+
+        result = spmat_sell_commit_row(matrices[bit],
+                                       temp_s_indexes[i],
+                                       row_length);
+        if (E__SUCCESS != result) {
+            goto l_cleanup;
+        }
+    }
+
+    /* 4. Create the submatrices */
+    for (bit = 0 ; bit < 2 ; ++bit) {
+        result = SUBMATRIX_create(smat->adj,
+                                  matrices[bit],
+                                  smat->pool,
+                                  &smats[bit]);
+        if (E__SUCCESS != result) {
+            goto l_cleanup;
+        }
+        smats[bit]->g_length = matrices[bit]->n;
+        matrices[bit] = NULL;
+    }
+
+    /* Success */
+    *matrix1_out = smats[0];
+    *matrix2_out = smats[1];
+
+    result = E__SUCCESS;
+l_cleanup:
+
+    if (E__SUCCESS != result) {
+        MATRIX_FREE_SAFE(matrices[0]);
+        MATRIX_FREE_SAFE(matrices[1]);
+        SUBMATRIX_FREE_SAFE(smats[0]);
+        SUBMATRIX_FREE_SAFE(smats[1]);
+    }
+
+    return result;
+}
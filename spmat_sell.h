@@ -0,0 +1,96 @@
+/*
+ * @file spmat_sell.h
+ * @purpose Sparse matrix implemented as SELL-C-sigma (sliced ELLPACK).
+ *          The rows are grouped into chunks of SPMAT_SELL_CHUNK rows, sorted
+ *          by their lengths within windows of SPMAT_SELL_SIGMA rows. Each
+ *          chunk is stored column-major, so a chunk's k'th cells are
+ *          contiguous and every lane of a SIMD register handles its own row
+ */
+#ifndef __SPMAT_SELL_H__
+#define __SPMAT_SELL_H__
+
+/* Includes ******************************************************************/
+#include <stddef.h>
+
+#include "matrix.h"
+#include "submatrix.h"
+#include "common.h"
+#include "pool.h"
+
+
+/* Functions Declarations ****************************************************/
+/* Creates a pool of SELL-C-sigma sparse matrices' headers */
+result_t
+SPMAT_SELL_create_headers_pool(pool_t **pool_out);
+
+/*
+ * Allocates a new SELL-C-sigma sparse matrix of size n.
+ * Its header is recycled from the headers pool, or allocated if it is NULL.
+ * The rows are kept aside until all of them were added, and then sliced
+ * into chunks. The matrix can't be used before that
+ */
+result_t
+SPMAT_SELL_allocate(int n, pool_t *headers, matrix_t **mat);
+
+/*
+ * Calculate the 1-norm of a given submatrix
+ *
+ * @param submatrix The submatrix
+ * @param tmp_rows_sums Temp buffer with size n
+ */
+double
+SUBMAT_SPMAT_SELL_get_1norm(const submatrix_t *smat,
+                            double *tmp_row_sums);
+
+/*
+ * Multiply the submatrix with a given vector, to a pre-allocated buffer
+ *
+ * @param submatrix The submatrix
+ * @param vector Buffer to multiply with
+ * @param result pre-allocated buffer
+ *
+ * @return The result's squared norm
+ */
+double
+SUBMAT_SPMAT_SELL_mult(const submatrix_t *smat,
+                       const eigen_real_t *vector,
+                       eigen_real_t *result);
+
+/*
+ * Calculate v^T*B*v of the submatrix with a given vector. Every row's
+ * multiplication is kept in double precision
+ */
+double
+SUBMAT_SPMAT_SELL_mult_vmv(const submatrix_t *smat,
+                           const eigen_real_t *vector);
+
+/**
+ * Calculate the Q of the submatrix with a given vector
+ */
+double
+SUBMAT_SPMAT_SELL_calculate_q(const submatrix_t *smat,
+                              const sign_word_t *s_vector);
+
+/**
+ * Split a submatrix into two submatrices accordingly to a given s-vector.
+ * Each part's rows are sliced again into chunks of their own.
+ *
+ * @remark temp_s_indexes is overwritten
+ */
+result_t
+SUBMAT_SPMAT_SELL_split(submatrix_t *smat,
+                        const sign_word_t *vector_s,
+                        int *temp_s_indexes,
+                        submatrix_t **matrix1_out,
+                        submatrix_t **matrix2_out);
+
+/**
+ * Calculate the the improved formula Q score within algorithm 4
+ */
+double
+SUBMAT_SPMAT_SELL_calc_q_score(const submatrix_t *smat,
+                               const sign_word_t *vector,
+                               int row);
+
+
+#endif /* __SPMAT_SELL_H__ */
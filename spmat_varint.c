@@ -0,0 +1,991 @@
+/*
+ * @file spmat_varint.c
+ * @purpose Compressed adjacency matrix: each row's sorted columns are stored
+ *          as the gaps between them, encoded as varints (7 bits a byte, the
+ *          high bit set on all but the last byte). The kernels decode the
+ *          rows on the fly. Cells are all 1
+ */
+
+/* Includes ******************************************************************/
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "results.h"
+#include "matrix.h"
+#include "spmat_varint.h"
+#include "common.h"
+#include "debug.h"
+#include "vector.h"
+#include "submatrix.h"
+#include "pool.h"
+
+
+/* Constants *****************************************************************/
+/* Initial bytes capacity of a matrix, grows by doubling */
+#define SPMAT_VARINT_INITIAL_CAPACITY (1024)
+
+/* The most bytes a column's gap is encoded to */
+#define SPMAT_VARINT_MAX_BYTES (5)
+
+/* The bits of a gap each byte holds, and the flag of a following byte */
+#define SPMAT_VARINT_BITS (7)
+#define SPMAT_VARINT_MORE (0x80)
+
+
+/* Structs *******************************************************************/
+/*
+ * matrix->private.
+ * Row i's columns are lengths[i] gaps from bytes[offsets[i]] on. The first
+ * gap is from column 0
+ */
+typedef struct spmat_varint_data_s {
+    unsigned char *bytes;
+    size_t bytes_count;
+    size_t bytes_capacity;
+    size_t *offsets;
+    int *lengths;
+    /* Original vertex index of each row */
+    int *g;
+} spmat_varint_data_t;
+
+/* A matrix_t and its data, allocated at once */
+typedef struct spmat_varint_header_s {
+    matrix_t matrix;
+    spmat_varint_data_t data;
+} spmat_varint_header_t;
+
+
+/* Macros ********************************************************************/
+#define GET_VARINT_DATA(matrix) ((spmat_varint_data_t *)((matrix)->private))
+
+#define GET_ROW_BYTES(data, row) (&(data)->bytes[(data)->offsets[(row)]])
+
+#define SPMAT_GET_EXPECTED_VALUE(smat, i, j) (                              \
+    (smat->adj->neighbors[(i)] * smat->adj->neighbors_div_M[(j)])           \
+)
+
+
+/* Functions Declarations ****************************************************/
+/**
+ * @purpose Make room for a row at the bytes' end
+ * @param data The matrix's data
+ * @param length The row's columns count
+ *
+ * @return One of result_t values
+ */
+static
+result_t
+spmat_varint_reserve_row(spmat_varint_data_t *data, int length);
+
+/**
+ * @purpose Encode a gap at the bytes' end, that has room for it
+ * @param data The matrix's data
+ * @param gap The gap
+ */
+static
+void
+spmat_varint_encode(spmat_varint_data_t *data, unsigned int gap);
+
+/**
+ * @purpose Decode the next column of a row
+ * @param cursor The row's next byte. Advanced past the gap
+ * @param column The row's previous column, or 0 before its first
+ *
+ * @return The row's next column
+ */
+static
+int
+spmat_varint_next_column(const unsigned char **cursor, int column);
+
+/**
+ * @purpose Set a row of the matrix. A row can be set only once
+ * @see matrix_add_row_f on matrix.h
+ */
+static
+result_t
+spmat_varint_add_row(matrix_t *mat, const double *row, int i);
+
+/**
+ * @purpose Set a row of the matrix by its columns. A row can be set only once
+ * @see matrix_add_pattern_row_f on matrix.h
+ */
+static
+result_t
+spmat_varint_add_pattern_row(matrix_t *mat, const int *columns, int length, int i);
+
+/**
+ * @see matrix_free_f on matrix.h
+ */
+static
+void
+spmat_varint_free(matrix_t *mat);
+
+/**
+ * @see matrix_mult_f on matrix.h
+ */
+static
+void
+spmat_varint_mult(const matrix_t *mat, const double *v, double *result);
+
+/**
+ * @see matrix_get_g_f on matrix.h
+ */
+static
+int *
+spmat_varint_get_g(matrix_t *mat);
+
+/**
+ * @see matrix_extract_f on matrix.h
+ */
+static
+result_t
+spmat_varint_extract(const matrix_t *mat,
+                     const int *g,
+                     int g_length,
+                     int *temp_positions,
+                     pool_t *headers,
+                     matrix_t **mat_out);
+
+/**
+ * @purpose Sum k_j/M, and optionally k_j/M * v_j, over the submatrix's g
+ * @param smat The submatrix
+ * @param v A g_length-sized vector, or NULL
+ * @param k_dot_v_out k/M multiplied by v. Not set if v is NULL
+ *
+ * @return The sum of k_j/M
+ */
+static
+double
+spmat_varint_sum_neighbors_div_M(const submatrix_t *smat,
+                                 const eigen_real_t *v,
+                                 double *k_dot_v_out);
+
+/**
+ * @purpose Multiply a row of the submatrix (with hat) with a given vector
+ * @param smat The submatrix
+ * @param row_g The row's index
+ * @param v The vector
+ * @param k_sum The sum of k_j/M over g
+ * @param k_dot_v The scalar multiplication of k/M over g with v
+ *
+ * @return The multiplication result
+ */
+static
+double
+spmat_varint_mult_row(const submatrix_t *smat,
+                      int row_g,
+                      const eigen_real_t *v,
+                      double k_sum,
+                      double k_dot_v);
+
+/**
+ * @purpose Multiply a row of the adjacency with an s-vector
+ * @param data The matrix's data
+ * @param row_g The row's index
+ * @param s_vector The s-vector
+ *
+ * @return The multiplication result
+ */
+static
+double
+spmat_varint_row_dot_s(const spmat_varint_data_t *data,
+                       int row_g,
+                       const sign_word_t *s_vector);
+
+
+/* Virtual Table *************************************************************/
+const matrix_vtable_t SPMAT_VARINT_VTABLE = {
+    .add_row = spmat_varint_add_row,
+    .add_pattern_row = spmat_varint_add_pattern_row,
+    .free = spmat_varint_free,
+    .mult = spmat_varint_mult,
+    .mult_vmv = NULL,
+    .get_g = spmat_varint_get_g,
+    .extract = spmat_varint_extract,
+    .submat_get_1norm = SUBMAT_SPMAT_VARINT_get_1norm,
+    .submat_mult = SUBMAT_SPMAT_VARINT_mult,
+    .submat_mult_vmv = SUBMAT_SPMAT_VARINT_mult_vmv,
+    .submat_calculate_q = SUBMAT_SPMAT_VARINT_calculate_q,
+    .submat_calc_q_score = SUBMAT_SPMAT_VARINT_calc_q_score,
+    .submat_split = SUBMAT_SPMAT_VARINT_split,
+};
+
+
+/* Functions *****************************************************************/
+result_t
+SPMAT_VARINT_create_headers_pool(pool_t **pool_out)
+{
+    return POOL_create(sizeof(spmat_varint_header_t), pool_out);
+}
+
+result_t
+SPMAT_VARINT_allocate(int n, pool_t *headers, matrix_t **mat_out)
+{
+    result_t result = E__UNKNOWN;
+    spmat_varint_header_t *header = NULL;
+    spmat_varint_data_t *data = NULL;
+    int i = 0;
+
+    /* 0. Input validation */
+    if (NULL == mat_out) {
+        result = E__NULL_ARGUMENT;
+        goto l_cleanup;
+    }
+
+    if (0 > n) {
+        result = E__INVALID_SIZE;
+        goto l_cleanup;
+    }
+
+    /* 1. Allocate the header, recycle one if possible */
+    if (NULL != headers) {
+        result = POOL_alloc(headers, (void **)&header);
+        if (E__SUCCESS != result) {
+            goto l_cleanup;
+        }
+    } else {
+        header = (spmat_varint_header_t *)malloc(sizeof(*header));
+        if (NULL == header) {
+            result = E__MALLOC_ERROR;
+            goto l_cleanup;
+        }
+    }
+    (void)memset(header, 0, sizeof(*header));
+    header->matrix.vtable = &SPMAT_VARINT_VTABLE;
+    header->matrix.n = n;
+    header->matrix.type = MATRIX_TYPE_SPMAT_VARINT;
+    header->matrix.pool = headers;
+    header->matrix.private = (void *)&header->data;
+    data = &header->data;
+
+    /* 2. Rows, initialized as empty */
+    data->offsets = (size_t *)calloc(MAX(n, 1), sizeof(*data->offsets));
+    if (NULL == data->offsets) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+
+    data->lengths = (int *)calloc(MAX(n, 1), sizeof(*data->lengths));
+    if (NULL == data->lengths) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+
+    /* 3. g-vector, the rows are the original vertices */
+    data->g = (int *)malloc(MAX(n, 1) * sizeof(*data->g));
+    if (NULL == data->g) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+    for (i = 0 ; i < n ; ++i) {
+        data->g[i] = i;
+    }
+
+    DEBUG_PRINT("%s: addr %p n=%d\n", __func__, (void *)header, n);
+    /* Success */
+    *mat_out = &header->matrix;
+
+    result = E__SUCCESS;
+l_cleanup:
+
+    if ((E__SUCCESS != result) && (NULL != header)) {
+        spmat_varint_free(&header->matrix);
+        header = NULL;
+    }
+
+    return result;
+}
+
+static
+void
+spmat_varint_free(matrix_t *mat)
+{
+    spmat_varint_data_t *data = NULL;
+
+    if (NULL != mat) {
+        DEBUG_PRINT("%s: addr %p n=%d\n", __func__, (void *)mat, mat->n);
+        data = GET_VARINT_DATA(mat);
+        if (NULL != data) {
+            FREE_SAFE(data->g);
+            FREE_SAFE(data->lengths);
+            FREE_SAFE(data->offsets);
+            FREE_SAFE(data->bytes);
+        }
+        mat->private = NULL;
+
+        /* The data is a part of the header */
+        if (NULL != mat->pool) {
+            POOL_release(mat->pool, mat);
+        } else {
+            free(mat);
+        }
+    }
+}
+
+static
+result_t
+spmat_varint_reserve_row(spmat_varint_data_t *data, int length)
+{
+    result_t result = E__UNKNOWN;
+    size_t count = (size_t)length * SPMAT_VARINT_MAX_BYTES;
+    size_t capacity = 0;
+    unsigned char *bytes = NULL;
+
+    /* 1. Check if there's enough room */
+    if (data->bytes_capacity - data->bytes_count >= count) {
+        result = E__SUCCESS;
+        goto l_cleanup;
+    }
+
+    /* 2. Double the capacity until there's enough room */
+    capacity = MAX(data->bytes_capacity, SPMAT_VARINT_INITIAL_CAPACITY);
+    while (capacity - data->bytes_count < count) {
+        capacity *= 2;
+    }
+
+    /* 3. Reallocate */
+    bytes = (unsigned char *)realloc(data->bytes, capacity * sizeof(*bytes));
+    if (NULL == bytes) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+    data->bytes = bytes;
+    data->bytes_capacity = capacity;
+
+    result = E__SUCCESS;
+l_cleanup:
+
+    return result;
+}
+
+static
+void
+spmat_varint_encode(spmat_varint_data_t *data, unsigned int gap)
+{
+    /* The lowest 7 bits first, flagging each byte that others follow */
+    while (SPMAT_VARINT_MORE <= gap) {
+        data->bytes[data->bytes_count] =
+            (unsigned char)((gap & (SPMAT_VARINT_MORE - 1)) | SPMAT_VARINT_MORE);
+        ++data->bytes_count;
+        gap >>= SPMAT_VARINT_BITS;
+    }
+    data->bytes[data->bytes_count] = (unsigned char)gap;
+    ++data->bytes_count;
+}
+
+static
+int
+spmat_varint_next_column(const unsigned char **cursor, int column)
+{
+    const unsigned char *byte = *cursor;
+    unsigned int gap = *byte & (SPMAT_VARINT_MORE - 1);
+    int shift = 0;
+
+    while (0 != (*byte & SPMAT_VARINT_MORE)) {
+        ++byte;
+        shift += SPMAT_VARINT_BITS;
+        gap |= (unsigned int)(*byte & (SPMAT_VARINT_MORE - 1)) << shift;
+    }
+    *cursor = byte + 1;
+
+    return column + (int)gap;
+}
+
+static
+result_t
+spmat_varint_add_row(matrix_t *mat, const double *values, int row_index)
+{
+    result_t result = E__UNKNOWN;
+    spmat_varint_data_t *data = NULL;
+    int row_length = 0;
+    int previous = 0;
+    int col = 0;
+
+    /* 0. Input validation */
+    if ((NULL == mat) || (NULL == mat->private) || (NULL == values)) {
+        result = E__NULL_ARGUMENT;
+        goto l_cleanup;
+    }
+
+    if (!MATRIX_IS_VALID_ROW_INDEX(mat, row_index)) {
+        result = E__INVALID_ROW_INDEX;
+        goto l_cleanup;
+    }
+
+    data = GET_VARINT_DATA(mat);
+    if (0 != data->lengths[row_index]) {
+        result = E__ROW_ALREADY_IN_USE;
+        goto l_cleanup;
+    }
+
+    /* 1. Count the non-zero columns, which can only be 1 */
+    for (col = 0 ; mat->n > col ; ++col) {
+        if (0 != values[col]) {
+            if (1.0 != values[col]) {
+                result = E__INVALID_VALUE;
+                goto l_cleanup;
+            }
+            ++row_length;
+        }
+    }
+
+    /* 2. Append the row's gaps to the bytes */
+    result = spmat_varint_reserve_row(data, row_length);
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+
+    data->offsets[row_index] = data->bytes_count;
+    for (col = 0 ; mat->n > col ; ++col) {
+        if (0 != values[col]) {
+            spmat_varint_encode(data, (unsigned int)(col - previous));
+            previous = col;
+        }
+    }
+    data->lengths[row_index] = row_length;
+
+    result = E__SUCCESS;
+l_cleanup:
+
+    return result;
+}
+
+static
+result_t
+spmat_varint_add_pattern_row(matrix_t *mat,
+                             const int *columns,
+                             int length,
+                             int row_index)
+{
+    result_t result = E__UNKNOWN;
+    spmat_varint_data_t *data = NULL;
+    int previous = 0;
+    int k = 0;
+
+    /* 0. Input validation */
+    if ((NULL == mat) || (NULL == mat->private)) {
+        result = E__NULL_ARGUMENT;
+        goto l_cleanup;
+    }
+
+    if (!MATRIX_IS_VALID_ROW_INDEX(mat, row_index)) {
+        result = E__INVALID_ROW_INDEX;
+        goto l_cleanup;
+    }
+
+    if (!MATRIX_is_valid_pattern(columns, length, mat->n)) {
+        result = E__INVALID_VALUE;
+        goto l_cleanup;
+    }
+
+    data = GET_VARINT_DATA(mat);
+    if (0 != data->lengths[row_index]) {
+        result = E__ROW_ALREADY_IN_USE;
+        goto l_cleanup;
+    }
+
+    /* 1. Append the row's gaps to the bytes */
+    result = spmat_varint_reserve_row(data, length);
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+
+    data->offsets[row_index] = data->bytes_count;
+    for (k = 0 ; k < length ; ++k) {
+        spmat_varint_encode(data, (unsigned int)(columns[k] - previous));
+        previous = columns[k];
+    }
+    data->lengths[row_index] = length;
+
+    result = E__SUCCESS;
+l_cleanup:
+
+    return result;
+}
+
+static
+void
+spmat_varint_mult(const matrix_t *mat, const double *v, double *result)
+{
+    const spmat_varint_data_t *data = NULL;
+    const unsigned char *cursor = NULL;
+    double row_result = 0.0;
+    int col = 0;
+    int i = 0;
+    int k = 0;
+
+    if ((NULL == mat) || (NULL == v) || (NULL == result)) {
+        return;
+    }
+
+    data = GET_VARINT_DATA(mat);
+    for (i = 0 ; i < mat->n ; ++i) {
+        cursor = GET_ROW_BYTES(data, i);
+        col = 0;
+        row_result = 0.0;
+        for (k = 0 ; k < data->lengths[i] ; ++k) {
+            col = spmat_varint_next_column(&cursor, col);
+            row_result += v[col];
+        }
+        result[i] = row_result;
+    }
+}
+
+static
+int *
+spmat_varint_get_g(matrix_t *mat)
+{
+    return GET_VARINT_DATA(mat)->g;
+}
+
+static
+result_t
+spmat_varint_extract(const matrix_t *mat,
+                     const int *g,
+                     int g_length,
+                     int *temp_positions,
+                     pool_t *headers,
+                     matrix_t **mat_out)
+{
+    result_t result = E__UNKNOWN;
+    matrix_t *extracted = NULL;
+    const spmat_varint_data_t *orig_data = NULL;
+    spmat_varint_data_t *data = NULL;
+    const unsigned char *cursor = NULL;
+    bool_t are_positions_set = FALSE;
+    int position = 0;
+    int previous = 0;
+    int col = 0;
+    int i = 0;
+    int k = 0;
+
+    /* 0. Input validation */
+    if ((NULL == mat) || (NULL == g) ||
+            (NULL == temp_positions) || (NULL == mat_out)) {
+        result = E__NULL_ARGUMENT;
+        goto l_cleanup;
+    }
+
+    /* 1. Allocate the extracted matrix */
+    result = SPMAT_VARINT_allocate(g_length, headers, &extracted);
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+    orig_data = GET_VARINT_DATA(mat);
+    data = GET_VARINT_DATA(extracted);
+
+    /* 2. Map each extracted index to its new position */
+    for (i = 0 ; i < g_length ; ++i) {
+        temp_positions[g[i]] = i;
+    }
+    are_positions_set = TRUE;
+
+    /* 3. Encode each row's columns that were extracted again.
+     *    g is ascending, so the new rows stay sorted */
+    for (i = 0 ; i < g_length ; ++i) {
+        result = spmat_varint_reserve_row(data, orig_data->lengths[g[i]]);
+        if (E__SUCCESS != result) {
+            goto l_cleanup;
+        }
+
+        data->offsets[i] = data->bytes_count;
+        cursor = GET_ROW_BYTES(orig_data, g[i]);
+        col = 0;
+        previous = 0;
+        for (k = 0 ; k < orig_data->lengths[g[i]] ; ++k) {
+            col = spmat_varint_next_column(&cursor, col);
+            position = temp_positions[col];
+            if (0 <= position) {
+                spmat_varint_encode(data, (unsigned int)(position - previous));
+                previous = position;
+                ++data->lengths[i];
+            }
+        }
+
+        /* 3.1. Keep the original vertex of the row */
+        data->g[i] = orig_data->g[g[i]];
+    }
+
+    /* Success */
+    *mat_out = extracted;
+
+    result = E__SUCCESS;
+l_cleanup:
+
+    /* 4. Restore the positions buffer */
+    if (are_positions_set) {
+        for (i = 0 ; i < g_length ; ++i) {
+            temp_positions[g[i]] = -1;
+        }
+    }
+
+    if (E__SUCCESS != result) {
+        spmat_varint_free(extracted);
+        extracted = NULL;
+    }
+
+    return result;
+}
+
+static
+double
+spmat_varint_sum_neighbors_div_M(const submatrix_t *smat,
+                                 const eigen_real_t *v,
+                                 double *k_dot_v_out)
+{
+    const double *neighbors_div_M = smat->adj->neighbors_div_M;
+    double k_sum = 0.0;
+    double k_dot_v = 0.0;
+    int j = 0;
+
+    if (NULL == v) {
+        for (j = 0 ; j < smat->g_length ; ++j) {
+            k_sum += neighbors_div_M[smat->g[j]];
+        }
+    } else {
+        for (j = 0 ; j < smat->g_length ; ++j) {
+            k_sum += neighbors_div_M[smat->g[j]];
+            k_dot_v += neighbors_div_M[smat->g[j]] * v[j];
+        }
+        *k_dot_v_out = k_dot_v;
+    }
+
+    return k_sum;
+}
+
+static
+double
+spmat_varint_mult_row(const submatrix_t *smat,
+                      int row_g,
+                      const eigen_real_t *v,
+                      double k_sum,
+                      double k_dot_v)
+{
+    const spmat_varint_data_t *data = GET_VARINT_DATA(smat->orig);
+    const unsigned char *cursor = GET_ROW_BYTES(data, row_g);
+    double a_dot_v = 0.0;
+    double k = 0.0;
+    double f = 0.0;
+    int col = 0;
+    int i = 0;
+
+    /* 1. The adjacency part: A[g]*v, the row's sum is its length */
+    for (i = 0 ; i < data->lengths[row_g] ; ++i) {
+        col = spmat_varint_next_column(&cursor, col);
+        a_dot_v += v[col];
+    }
+
+    /* 2. B[g]_ij = A_ij - ki*kj/M, and f_i is the sum of B[g]'s row */
+    k = (double)smat->adj->neighbors[smat->g[row_g]];
+    f = (double)data->lengths[row_g] - (k * k_sum);
+
+    return a_dot_v - (k * k_dot_v) + ((smat->add_to_diag - f) * v[row_g]);
+}
+
+static
+double
+spmat_varint_row_dot_s(const spmat_varint_data_t *data,
+                       int row_g,
+                       const sign_word_t *s_vector)
+{
+    const unsigned char *cursor = GET_ROW_BYTES(data, row_g);
+    int minus_count = 0;
+    int col = 0;
+    int i = 0;
+
+    /* The row's +1 cells less its -1 cells */
+    for (i = 0 ; i < data->lengths[row_g] ; ++i) {
+        col = spmat_varint_next_column(&cursor, col);
+        minus_count += SIGN_VECTOR_BIT(s_vector, col);
+    }
+
+    return (double)(data->lengths[row_g] - 2 * minus_count);
+}
+
+double
+SUBMAT_SPMAT_VARINT_mult(const submatrix_t *smat,
+                         const eigen_real_t *vector,
+                         eigen_real_t *result)
+{
+    double k_sum = 0.0;
+    double k_dot_v = 0.0;
+    double norm_square = 0.0;
+    double current_row_mul = 0.0;
+    int row_g = 0;
+
+    k_sum = spmat_varint_sum_neighbors_div_M(smat, vector, &k_dot_v);
+    for (row_g = 0 ; row_g < smat->g_length ; ++row_g) {
+        current_row_mul = spmat_varint_mult_row(smat,
+                                                row_g,
+                                                vector,
+                                                k_sum,
+                                                k_dot_v);
+        result[row_g] = (eigen_real_t)current_row_mul;
+        norm_square += current_row_mul * current_row_mul;
+    }
+
+    return norm_square;
+}
+
+double
+SUBMAT_SPMAT_VARINT_mult_vmv(const submatrix_t *smat,
+                             const eigen_real_t *vector)
+{
+    double k_sum = 0.0;
+    double k_dot_v = 0.0;
+    double result = 0.0;
+    int row_g = 0;
+
+    k_sum = spmat_varint_sum_neighbors_div_M(smat, vector, &k_dot_v);
+    for (row_g = 0 ; row_g < smat->g_length ; ++row_g) {
+        result += vector[row_g] * spmat_varint_mult_row(smat,
+                                                        row_g,
+                                                        vector,
+                                                        k_sum,
+                                                        k_dot_v);
+    }
+
+    return result;
+}
+
+double
+SUBMAT_SPMAT_VARINT_calculate_q(const submatrix_t *smat,
+                                const sign_word_t *s_vector)
+{
+    const spmat_varint_data_t *data = GET_VARINT_DATA(smat->orig);
+    double k_sum = 0.0;
+    double k_dot_s = 0.0;
+    double k = 0.0;
+    double f = 0.0;
+    double s_row = 0.0;
+    double mult_vmv = 0.0;
+    int row_g = 0;
+
+    k_sum = spmat_varint_sum_neighbors_div_M(smat, NULL, NULL);
+    k_dot_s = VECTOR_gather_multiply_with_s(smat->adj->neighbors_div_M,
+                                            smat->g,
+                                            s_vector,
+                                            smat->g_length);
+    for (row_g = 0 ; row_g < smat->g_length ; ++row_g) {
+        /* B[g]_ij = A_ij - ki*kj/M, and f_i is the sum of B[g]'s row */
+        k = (double)smat->adj->neighbors[smat->g[row_g]];
+        f = (double)data->lengths[row_g] - (k * k_sum);
+        s_row = SIGN_VECTOR_VALUE(s_vector, row_g);
+        mult_vmv += s_row * (spmat_varint_row_dot_s(data, row_g, s_vector) -
+                             (k * k_dot_s) +
+                             ((smat->add_to_diag - f) * s_row));
+    }
+
+    return mult_vmv;
+}
+
+double
+SUBMAT_SPMAT_VARINT_get_1norm(const submatrix_t *smat,
+                              double *tmp_row_sums)
+{
+    const spmat_varint_data_t *data = GET_VARINT_DATA(smat->orig);
+    const double *neighbors_div_M = smat->adj->neighbors_div_M;
+    const unsigned char *cursor = NULL;
+    double norm = 0.0;
+    double k_sum = 0.0;
+    double k = 0.0;
+    double a_sum = 0.0;
+    double a_diag = 0.0;
+    double edges_norm = 0.0;
+    double edges_k_sum = 0.0;
+    double zeroes_norm = 0.0;
+    double diag_value = 0.0;
+    int row_g = 0;
+    int row_i = 0;
+    int col_g = 0;
+    int i = 0;
+
+    UNUSED_ARG(tmp_row_sums);
+
+    /* Note: The adjacency matrix is symmetric, therefore 1-norm can be done on
+     *       either max row sum or max column sum */
+    k_sum = spmat_varint_sum_neighbors_div_M(smat, NULL, NULL);
+
+    for (row_g = 0 ; row_g < smat->g_length ; ++row_g) {
+        row_i = smat->g[row_g];
+        k = (double)smat->adj->neighbors[row_i];
+        cursor = GET_ROW_BYTES(data, row_g);
+
+        /* 1. Non-zero cells: |1 - ki*kj/M| */
+        a_sum = (double)data->lengths[row_g];
+        a_diag = 0.0;
+        edges_norm = 0.0;
+        edges_k_sum = 0.0;
+        col_g = 0;
+        for (i = 0 ; i < data->lengths[row_g] ; ++i) {
+            col_g = spmat_varint_next_column(&cursor, col_g);
+            if (col_g == row_g) {
+                a_diag = 1.0;
+            } else {
+                edges_k_sum += neighbors_div_M[smat->g[col_g]];
+                edges_norm += fabs(1.0 -
+                                   SPMAT_GET_EXPECTED_VALUE(smat,
+                                                            row_i,
+                                                            smat->g[col_g]));
+            }
+        }
+
+        /* 2. Zero cells: |0 - ki*kj/M| summed over the rest of the row */
+        zeroes_norm = k * (k_sum - edges_k_sum - neighbors_div_M[row_i]);
+
+        /* 3. The diag is decreased by the row's sum f_i */
+        diag_value = a_diag - SPMAT_GET_EXPECTED_VALUE(smat, row_i, row_i) +
+                     smat->add_to_diag - (a_sum - (k * k_sum));
+
+        norm = MAX(norm, zeroes_norm + edges_norm + fabs(diag_value));
+    }
+
+    return norm;
+}
+
+double
+SUBMAT_SPMAT_VARINT_calc_q_score(const submatrix_t *smat,
+                                 const sign_word_t *vector,
+                                 int row_g)
+{
+    double a_dot_s = 0.0;
+    double k_dot_s = 0.0;
+    double k = 0.0;
+    double s_row = 0.0;
+    double q_part1 = 0.0;
+    double expected_value = 0.0;
+    int row_i = 0;
+
+    row_i = smat->g[row_g];
+    k = (double)smat->adj->neighbors[row_i];
+
+    /* 1. B_ij * s_j = A_ij * s_j - ki * (kj/M * s_j) */
+    a_dot_s = spmat_varint_row_dot_s(GET_VARINT_DATA(smat->orig),
+                                     row_g,
+                                     vector);
+    k_dot_s = VECTOR_gather_multiply_with_s(smat->adj->neighbors_div_M,
+                                            smat->g,
+                                            vector,
+                                            smat->g_length);
+    s_row = SIGN_VECTOR_VALUE(vector, row_g);
+    q_part1 = a_dot_s - (k * k_dot_s) + (2 * smat->add_to_diag * s_row);
+
+    expected_value = SPMAT_GET_EXPECTED_VALUE(smat, row_i, row_i);
+
+    return 4 * (s_row * q_part1 + expected_value);
+}
+
+result_t
+SUBMAT_SPMAT_VARINT_split(submatrix_t *smat,
+                          const sign_word_t *vector_s,
+                          int *temp_s_indexes,
+                          submatrix_t **matrix1_out,
+                          submatrix_t **matrix2_out)
+{
+    result_t result = E__UNKNOWN;
+    const spmat_varint_data_t *data = NULL;
+    spmat_varint_data_t *part_data = NULL;
+    const unsigned char *cursor = NULL;
+    matrix_t *matrices[2] = {NULL, NULL};
+    submatrix_t *smats[2] = {NULL, NULL};
+    int matrix1_n = 0;
+    int row = 0;
+    int previous = 0;
+    int col = 0;
+    int bit = 0;
+    int i = 0;
+    int k = 0;
+
+    /* 0. Input validation */
+    /* Null arguments */
+    if ((NULL == smat) ||
+            (NULL == vector_s) ||
+            (NULL == temp_s_indexes) ||
+            (NULL == matrix1_out) ||
+            (NULL == matrix2_out)) {
+        result = E__NULL_ARGUMENT;
+        goto l_cleanup;
+    }
+
+    data = GET_VARINT_DATA(smat->orig);
+
+    /* 1. Create s-indexes vector, get matrix1's length */
+    matrix1_n = VECTOR_create_s_indexes(vector_s,
+                                        smat->g_length,
+                                        temp_s_indexes);
+
+    /* 2. Allocate the matrices */
+    result = SPMAT_VARINT_allocate(matrix1_n,
+                                   SUBMATRIX_MATRICES_POOL(smat),
+                                   &matrices[0]);
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+
+    result = SPMAT_VARINT_allocate(smat->g_length - matrix1_n,
+                                   SUBMATRIX_MATRICES_POOL(smat),
+                                   &matrices[1]);
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+
+    /* 3. Encode each row again in its group's matrix, without the other
+     *    group's columns. The s-indexes keep the columns' order */
+    for (i = 0 ; i < smat->g_length ; ++i) {
+        bit = SIGN_VECTOR_BIT(vector_s, i);
+        part_data = GET_VARINT_DATA(matrices[bit]);
+        row = temp_s_indexes[i];
+        part_data->g[row] = smat->g[i];
+
+        result = spmat_varint_reserve_row(part_data, data->lengths[i]);
+        if (E__SUCCESS != result) {
+            goto l_cleanup;
+        }
+
+        part_data->offsets[row] = part_data->bytes_count;
+        cursor = GET_ROW_BYTES(data, i);
+        col = 0;
+        previous = 0;
+        for (k = 0 ; k < data->lengths[i] ; ++k) {
+            col = spmat_varint_next_column(&cursor, col);
+            if (SIGN_VECTOR_BIT(vector_s, col) == bit) {
+                spmat_varint_encode(part_data,
+                                    (unsigned int)(temp_s_indexes[col] -
+                                                   previous));
+                previous = temp_s_indexes[col];
+                ++part_data->lengths[row];
+            }
+        }
+    }
+
+    /* 4. Create the submatrices */
+    for (bit = 0 ; bit < 2 ; ++bit) {
+        result = SUBMATRIX_create(smat->adj,
+                                  matrices[bit],
+                                  smat->pool,
+                                  &smats[bit]);
+        if (E__SUCCESS != result) {
+            goto l_cleanup;
+        }
+        smats[bit]->g_length = matrices[bit]->n;
+        matrices[bit] = NULL;
+    }
+
+    /* Success */
+    *matrix1_out = smats[0];
+    *matrix2_out = smats[1];
+
+    result = E__SUCCESS;
+l_cleanup:
+
+    if (E__SUCCESS != result) {
+        MATRIX_FREE_SAFE(matrices[0]);
+        MATRIX_FREE_SAFE(matrices[1]);
+        SUBMATRIX_FREE_SAFE(smats[0]);
+        SUBMATRIX_FREE_SAFE(smats[1]);
+    }
+
+    return result;
+}
@@ -0,0 +1,93 @@
+/*
+ * @file spmat_varint.h
+ * @purpose Compressed adjacency matrix: each row's sorted columns are stored
+ *          as the gaps between them, encoded as varints (7 bits a byte, the
+ *          high bit set on all but the last byte). The kernels decode the
+ *          rows on the fly. Cells are all 1
+ */
+#ifndef __SPMAT_VARINT_H__
+#define __SPMAT_VARINT_H__
+
+/* Includes ******************************************************************/
+#include <stddef.h>
+
+#include "matrix.h"
+#include "submatrix.h"
+#include "common.h"
+#include "pool.h"
+
+
+/* Functions Declarations ****************************************************/
+/* Creates a pool of compressed matrices' headers */
+result_t
+SPMAT_VARINT_create_headers_pool(pool_t **pool_out);
+
+/*
+ * Allocates a new compressed matrix of size n.
+ * Its header is recycled from the headers pool, or allocated if it is NULL
+ */
+result_t
+SPMAT_VARINT_allocate(int n, pool_t *headers, matrix_t **mat);
+
+/*
+ * Calculate the 1-norm of a given submatrix
+ *
+ * @param submatrix The submatrix
+ * @param tmp_rows_sums Temp buffer with size n
+ */
+double
+SUBMAT_SPMAT_VARINT_get_1norm(const submatrix_t *smat,
+                              double *tmp_row_sums);
+
+/*
+ * Multiply the submatrix with a given vector, to a pre-allocated buffer
+ *
+ * @param submatrix The submatrix
+ * @param vector Buffer to multiply with
+ * @param result pre-allocated buffer
+ *
+ * @return The result's squared norm
+ */
+double
+SUBMAT_SPMAT_VARINT_mult(const submatrix_t *smat,
+                         const eigen_real_t *vector,
+                         eigen_real_t *result);
+
+/*
+ * Calculate v^T*B*v of the submatrix with a given vector. Every row's
+ * multiplication is kept in double precision
+ */
+double
+SUBMAT_SPMAT_VARINT_mult_vmv(const submatrix_t *smat,
+                             const eigen_real_t *vector);
+
+/**
+ * Calculate the Q of the submatrix with a given vector
+ */
+double
+SUBMAT_SPMAT_VARINT_calculate_q(const submatrix_t *smat,
+                                const sign_word_t *s_vector);
+
+/**
+ * Split a submatrix into two submatrices accordingly to a given s-vector.
+ * Each part's rows are encoded again, without the other part's columns.
+ *
+ * @remark temp_s_indexes is overwritten
+ */
+result_t
+SUBMAT_SPMAT_VARINT_split(submatrix_t *smat,
+                          const sign_word_t *vector_s,
+                          int *temp_s_indexes,
+                          submatrix_t **matrix1_out,
+                          submatrix_t **matrix2_out);
+
+/**
+ * Calculate the the improved formula Q score within algorithm 4
+ */
+double
+SUBMAT_SPMAT_VARINT_calc_q_score(const submatrix_t *smat,
+                                 const sign_word_t *vector,
+                                 int row);
+
+
+#endif /* __SPMAT_VARINT_H__ */
@@ -0,0 +1,299 @@
+/**
+ * @file stream_vbyte.c
+ * @purpose Stream VByte encoding, and its portable and SSSE3 decoders
+ */
+
+/* Includes **************************************************************************************/
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+
+#include "common.h"
+#include "config.h"
+#include "vector.h"
+#include "vector_kernels.h"
+#include "stream_vbyte.h"
+
+#ifdef VECTOR_KERNELS_X86
+#include <immintrin.h>
+#endif /* VECTOR_KERNELS_X86 */
+
+
+/* Constants *************************************************************************************/
+/* Integers per control byte */
+#define STREAM_VBYTE_QUAD (4)
+
+/* Bits of an integer's length within its control byte */
+#define STREAM_VBYTE_LENGTH_BITS (2)
+#define STREAM_VBYTE_LENGTH_MASK (3)
+
+/* Bytes loaded to decode a quad at once, its maximal size */
+#define STREAM_VBYTE_LOAD_SIZE (STREAM_VBYTE_QUAD * sizeof(uint32_t))
+
+/* A shuffle index that zeroes its byte */
+#define STREAM_VBYTE_ZERO_BYTE (0x80)
+
+#define STREAM_VBYTE_CONTROL_VALUES (256)
+
+
+/* Macros ****************************************************************************************/
+/* The byte length of the k'th integer of a control byte */
+#define STREAM_VBYTE_GET_LENGTH(control, k) \
+    ((size_t)(((control) >> ((k) * STREAM_VBYTE_LENGTH_BITS)) & STREAM_VBYTE_LENGTH_MASK) + 1)
+
+#ifdef VECTOR_KERNELS_X86
+#define STREAM_VBYTE_SSSE3 __attribute__((target("ssse3")))
+#endif /* VECTOR_KERNELS_X86 */
+
+
+/* Typedefs **************************************************************************************/
+/**
+ * @purpose Decode whole quads
+ * @param control The quads' control bytes
+ * @param data The quads' data, at least STREAM_VBYTE_LOAD_SIZE bytes readable
+ *             past each quad's start
+ * @param quads The quads count
+ * @param values Buffer of quads * STREAM_VBYTE_QUAD integers
+ *
+ * @return The size of the quads' data
+ */
+typedef size_t (*stream_vbyte_decode_quads_f)(const unsigned char *control,
+                                              const unsigned char *data,
+                                              size_t quads,
+                                              uint32_t *values);
+
+
+/* Functions Declarations ************************************************************************/
+/**
+ * @purpose Decode whole quads, byte by byte
+ * @see stream_vbyte_decode_quads_f, data needs no readable bytes past the quads
+ */
+static
+size_t
+stream_vbyte_decode_quads(const unsigned char *control,
+                          const unsigned char *data,
+                          size_t quads,
+                          uint32_t *values);
+
+/**
+ * @purpose Decode an integer, byte by byte
+ * @param data The integer's bytes
+ * @param length The integer's byte length
+ *
+ * @return The integer
+ */
+static
+uint32_t
+stream_vbyte_decode_value(const unsigned char *data, size_t length);
+
+#ifdef VECTOR_KERNELS_X86
+/**
+ * @purpose Decode whole quads, a shuffle each
+ * @see stream_vbyte_decode_quads_f
+ */
+STREAM_VBYTE_SSSE3
+static
+size_t
+stream_vbyte_decode_quads_ssse3(const unsigned char *control,
+                                const unsigned char *data,
+                                size_t quads,
+                                uint32_t *values);
+#endif /* VECTOR_KERNELS_X86 */
+
+
+/* Globals ***************************************************************************************/
+/* The byte shuffle that spreads a quad's data into its integers, by its
+ * control byte. Set by STREAM_VBYTE_init */
+static unsigned char stream_vbyte_shuffles[STREAM_VBYTE_CONTROL_VALUES][STREAM_VBYTE_LOAD_SIZE];
+
+/* The size of a quad's data, by its control byte. Set by STREAM_VBYTE_init */
+static unsigned char stream_vbyte_quad_sizes[STREAM_VBYTE_CONTROL_VALUES];
+
+/* The quads decoder, selected by STREAM_VBYTE_init */
+static stream_vbyte_decode_quads_f stream_vbyte_quads_decoder = stream_vbyte_decode_quads;
+
+
+/* Functions *************************************************************************************/
+static
+uint32_t
+stream_vbyte_decode_value(const unsigned char *data, size_t length)
+{
+    uint32_t value = 0;
+    size_t b = 0;
+
+    for (b = 0 ; b < length ; ++b) {
+        value |= (uint32_t)data[b] << (b * CHAR_BIT);
+    }
+
+    return value;
+}
+
+static
+size_t
+stream_vbyte_decode_quads(const unsigned char *control,
+                          const unsigned char *data,
+                          size_t quads,
+                          uint32_t *values)
+{
+    size_t position = 0;
+    size_t length = 0;
+    size_t q = 0;
+    size_t k = 0;
+
+    for (q = 0 ; q < quads ; ++q) {
+        for (k = 0 ; k < STREAM_VBYTE_QUAD ; ++k) {
+            length = STREAM_VBYTE_GET_LENGTH(control[q], k);
+            values[q * STREAM_VBYTE_QUAD + k] = stream_vbyte_decode_value(&data[position],
+                                                                          length);
+            position += length;
+        }
+    }
+
+    return position;
+}
+
+#ifdef VECTOR_KERNELS_X86
+STREAM_VBYTE_SSSE3
+static
+size_t
+stream_vbyte_decode_quads_ssse3(const unsigned char *control,
+                                const unsigned char *data,
+                                size_t quads,
+                                uint32_t *values)
+{
+    __m128i quad_data;
+    __m128i shuffle;
+    size_t position = 0;
+    size_t q = 0;
+
+    for (q = 0 ; q < quads ; ++q) {
+        quad_data = _mm_loadu_si128((const __m128i *)&data[position]);
+        shuffle = _mm_loadu_si128((const __m128i *)stream_vbyte_shuffles[control[q]]);
+        _mm_storeu_si128((__m128i *)&values[q * STREAM_VBYTE_QUAD],
+                         _mm_shuffle_epi8(quad_data, shuffle));
+        position += stream_vbyte_quad_sizes[control[q]];
+    }
+
+    return position;
+}
+#endif /* VECTOR_KERNELS_X86 */
+
+void
+STREAM_VBYTE_init(void)
+{
+    size_t position = 0;
+    size_t length = 0;
+    int control = 0;
+    size_t k = 0;
+    size_t b = 0;
+
+    /* 1. Each integer takes its bytes out of the quad's data, in order */
+    for (control = 0 ; control < STREAM_VBYTE_CONTROL_VALUES ; ++control) {
+        position = 0;
+        for (k = 0 ; k < STREAM_VBYTE_QUAD ; ++k) {
+            length = STREAM_VBYTE_GET_LENGTH(control, k);
+            for (b = 0 ; b < sizeof(uint32_t) ; ++b) {
+                stream_vbyte_shuffles[control][k * sizeof(uint32_t) + b] =
+                    (unsigned char)((b < length) ? position + b : STREAM_VBYTE_ZERO_BYTE);
+            }
+            position += length;
+        }
+        stream_vbyte_quad_sizes[control] = (unsigned char)position;
+    }
+
+    /* 2. Select the decoder, unless the build allows no SIMD */
+    stream_vbyte_quads_decoder = stream_vbyte_decode_quads;
+#ifdef VECTOR_KERNELS_X86
+    __builtin_cpu_init();
+    if ((VECTOR_SIMD_NONE < VECTOR_SIMD_MAX) && __builtin_cpu_supports("ssse3")) {
+        stream_vbyte_quads_decoder = stream_vbyte_decode_quads_ssse3;
+    }
+#endif /* VECTOR_KERNELS_X86 */
+}
+
+size_t
+STREAM_VBYTE_encode(const uint32_t *values, size_t count, unsigned char *stream)
+{
+    size_t control_size = STREAM_VBYTE_CONTROL_SIZE(count);
+    size_t position = control_size;
+    size_t length = 0;
+    uint32_t value = 0;
+    size_t i = 0;
+    size_t b = 0;
+
+    /* 1. The last control byte's unused lengths are 0 */
+    (void)memset(stream, 0, control_size);
+
+    /* 2. Each integer takes the bytes up to its highest non-zero byte */
+    for (i = 0 ; i < count ; ++i) {
+        value = values[i];
+        length = 1;
+        while ((length < sizeof(value)) && (0 != (value >> (length * CHAR_BIT)))) {
+            ++length;
+        }
+
+        stream[i / STREAM_VBYTE_QUAD] |=
+            (unsigned char)((length - 1) << ((i % STREAM_VBYTE_QUAD) * STREAM_VBYTE_LENGTH_BITS));
+        for (b = 0 ; b < length ; ++b) {
+            stream[position + b] = (unsigned char)(value >> (b * CHAR_BIT));
+        }
+        position += length;
+    }
+
+    return position;
+}
+
+size_t
+STREAM_VBYTE_get_data_size(const unsigned char *control, size_t count)
+{
+    size_t size = 0;
+    size_t i = 0;
+
+    for (i = 0 ; i < count ; ++i) {
+        size += STREAM_VBYTE_GET_LENGTH(control[i / STREAM_VBYTE_QUAD], i % STREAM_VBYTE_QUAD);
+    }
+
+    return size;
+}
+
+size_t
+STREAM_VBYTE_decode(const unsigned char *stream,
+                    size_t available,
+                    size_t count,
+                    uint32_t *values)
+{
+    const unsigned char *control = stream;
+    size_t control_size = STREAM_VBYTE_CONTROL_SIZE(count);
+    const unsigned char *data = &stream[control_size];
+    size_t quads = count / STREAM_VBYTE_QUAD;
+    size_t fast_quads = 0;
+    size_t position = 0;
+    size_t length = 0;
+    size_t k = 0;
+
+    /* 1. A quad may be loaded whole if it starts a load's size before the
+     *    readable bytes end. Quads are at most a load's size, so the q'th
+     *    starts at most q loads' size into the data */
+    fast_quads = (available - control_size) / STREAM_VBYTE_LOAD_SIZE;
+    if (fast_quads > quads) {
+        fast_quads = quads;
+    }
+    position = stream_vbyte_quads_decoder(control, data, fast_quads, values);
+
+    /* 2. The remaining quads */
+    position += stream_vbyte_decode_quads(&control[fast_quads],
+                                          &data[position],
+                                          quads - fast_quads,
+                                          &values[fast_quads * STREAM_VBYTE_QUAD]);
+
+    /* 3. The last integers, which don't fill their control byte */
+    for (k = 0 ; k < count % STREAM_VBYTE_QUAD ; ++k) {
+        length = STREAM_VBYTE_GET_LENGTH(control[quads], k);
+        values[quads * STREAM_VBYTE_QUAD + k] = stream_vbyte_decode_value(&data[position],
+                                                                          length);
+        position += length;
+    }
+
+    return control_size + position;
+}
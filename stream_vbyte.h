@@ -0,0 +1,80 @@
+/**
+ * @file stream_vbyte.h
+ * @purpose Stream VByte, a codec of 32-bit integers stored in 1 to 4 bytes each.
+ *          The byte lengths of every 4 integers are packed into a control byte,
+ *          and a stream's control bytes precede its data bytes:
+ *              control: ceil(count / 4) bytes, 2 bits an integer, its length - 1
+ *              data: every integer's little-endian bytes, without its leading 0s
+ *          So the data of 4 integers is decoded by a single byte shuffle
+ */
+#ifndef __STREAM_VBYTE_H__
+#define __STREAM_VBYTE_H__
+
+/* Includes **************************************************************************************/
+#include <stddef.h>
+#include <stdint.h>
+
+#include "common.h"
+
+
+/* Macros ****************************************************************************************/
+/* Size in bytes of the control bytes of count integers */
+#define STREAM_VBYTE_CONTROL_SIZE(count) (((size_t)(count) + 3) / 4)
+
+/* Maximal size in bytes of an encoded stream of count integers */
+#define STREAM_VBYTE_MAX_SIZE(count) \
+    (STREAM_VBYTE_CONTROL_SIZE(count) + (size_t)(count) * sizeof(uint32_t))
+
+
+/* Functions Declarations ************************************************************************/
+/**
+ * @purpose Select the decoder of the widest instruction set supported by the
+ *          CPU. Before it is called the portable decoder is used
+ *
+ * @remark Should be called once at startup
+ */
+void
+STREAM_VBYTE_init(void);
+
+/**
+ * @purpose Encode a stream
+ *
+ * @param values The integers to encode
+ * @param count The integers count
+ * @param stream Buffer of at least STREAM_VBYTE_MAX_SIZE(count) bytes
+ *
+ * @return The stream's size in bytes
+ */
+size_t
+STREAM_VBYTE_encode(const uint32_t *values, size_t count, unsigned char *stream);
+
+/**
+ * @purpose Get the size of a stream's data bytes, out of its control bytes
+ *
+ * @param control The stream's control bytes
+ * @param count The integers count
+ *
+ * @return The data's size in bytes
+ */
+size_t
+STREAM_VBYTE_get_data_size(const unsigned char *control, size_t count);
+
+/**
+ * @purpose Decode a stream
+ *
+ * @param stream The stream, which must be valid for count integers
+ * @param available The bytes readable from stream, at least the stream's size.
+ *                  Any more allow the decoder to read past the stream's end
+ * @param count The integers count
+ * @param values Buffer of at least count integers
+ *
+ * @return The stream's size in bytes
+ */
+size_t
+STREAM_VBYTE_decode(const unsigned char *stream,
+                    size_t available,
+                    size_t count,
+                    uint32_t *values);
+
+
+#endif /* __STREAM_VBYTE_H__ */
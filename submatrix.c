@@ -15,16 +15,117 @@
 #include "submatrix.h"
 #include "common.h"
 #include "spmat_list.h"
+#include "pool.h"
+
+
+/* Functions Declarations ****************************************************/
+/**
+ * @purpose Create a submatrix whose g-vector can hold g_capacity indexes
+ * @param adj The network's adjacency data
+ * @param matrix The submatrix's matrix, or NULL if it is pending
+ * @param g_capacity The g-vector's length
+ * @param pool The pool to allocate the submatrix from, or NULL
+ * @param smat_out The submatrix created
+ *
+ * @return One of result_t values
+ */
+static
+result_t
+submatrix_create(const adjacency_t *adj,
+                 matrix_t *matrix,
+                 int g_capacity,
+                 submatrix_pool_t *pool,
+                 submatrix_t **smat_out);
 
 
 /* Functions *****************************************************************/
+result_t
+SUBMATRIX_POOL_create(matrix_type_t type, submatrix_pool_t **pool_out)
+{
+    result_t result = E__UNKNOWN;
+    submatrix_pool_t *pool = NULL;
+
+    if (NULL == pool_out) {
+        result = E__NULL_ARGUMENT;
+        goto l_cleanup;
+    }
+
+    pool = (submatrix_pool_t *)malloc(sizeof(*pool));
+    if (NULL == pool) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+    pool->submatrices = NULL;
+    pool->type = type;
+    pool->matrices = NULL;
+
+    /* 1. Submatrices headers */
+    result = POOL_create(sizeof(submatrix_t), &pool->submatrices);
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+
+    /* 2. Matrices headers */
+    result = MATRIX_create_headers_pool(type, &pool->matrices);
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+
+    *pool_out = pool;
+
+    result = E__SUCCESS;
+l_cleanup:
+    if (E__SUCCESS != result) {
+        SUBMATRIX_POOL_destroy(pool);
+        pool = NULL;
+    }
+
+    return result;
+}
+
+void
+SUBMATRIX_POOL_destroy(submatrix_pool_t *pool)
+{
+    if (NULL != pool) {
+        POOL_DESTROY_SAFE(pool->matrices);
+        POOL_DESTROY_SAFE(pool->submatrices);
+        FREE_SAFE(pool);
+    }
+}
+
 result_t
 SUBMATRIX_create(const adjacency_t *adj,
                  matrix_t *matrix,
+                 submatrix_pool_t *pool,
+                 submatrix_t **smat_out)
+{
+    if (NULL == matrix) {
+        return E__NULL_ARGUMENT;
+    }
+
+    return submatrix_create(adj, matrix, matrix->n, pool, smat_out);
+}
+
+result_t
+SUBMATRIX_create_pending(const adjacency_t *adj,
+                         int g_length,
+                         submatrix_pool_t *pool,
+                         submatrix_t **smat_out)
+{
+    return submatrix_create(adj, NULL, g_length, pool, smat_out);
+}
+
+static
+result_t
+submatrix_create(const adjacency_t *adj,
+                 matrix_t *matrix,
+                 int g_capacity,
+                 submatrix_pool_t *pool,
                  submatrix_t **smat_out)
 {
     result_t result = E__UNKNOWN;
     int *g = NULL;
+    bool_t owns_g = FALSE;
     submatrix_t *smat = NULL;
 
     if ((NULL == adj) || (NULL == smat_out))
@@ -33,32 +134,50 @@ SUBMATRIX_create(const adjacency_t *adj,
         goto l_cleanup;
     }
 
-    /* 1. Allocate g-vector with length n */
-    g = (int *)malloc(adj->n * sizeof(*g));
-    if (NULL == g) {
-        result = E__MALLOC_ERROR;
-        goto l_cleanup;
-    }   
+    /* 1. Use the matrix's g-vector, or allocate one with its length */
+    if ((NULL != matrix) && (NULL != MATRIX_VTABLE(matrix)->get_g)) {
+        g = MATRIX_VTABLE(matrix)->get_g(matrix);
+    }
+    if (NULL != g) {
+        owns_g = FALSE;
+    } else {
+        g = (int *)malloc(MAX(g_capacity, 1) * sizeof(*g));
+        if (NULL == g) {
+            result = E__MALLOC_ERROR;
+            goto l_cleanup;
+        }
+        owns_g = TRUE;
+    }
 
-    smat = (submatrix_t *)malloc(sizeof(*smat));
-    if (NULL == smat) {
-        result = E__MALLOC_ERROR;
-        goto l_cleanup;
+    /* 2. Allocate the submatrix, recycle a header if possible */
+    if (NULL != pool) {
+        result = POOL_alloc(pool->submatrices, (void **)&smat);
+        if (E__SUCCESS != result) {
+            goto l_cleanup;
+        }
+    } else {
+        smat = (submatrix_t *)malloc(sizeof(*smat));
+        if (NULL == smat) {
+            result = E__MALLOC_ERROR;
+            goto l_cleanup;
+        }
     }
 
     smat->adj = adj;
     smat->g = g;
+    smat->owns_g = owns_g;
     smat->g_length = 0;
     smat->add_to_diag = 0.0;
     smat->orig = matrix;
+    smat->pool = pool;
+    smat->node = 0;
 
     *smat_out = smat;
 
     result = E__SUCCESS;
 l_cleanup:
-    if (E__SUCCESS != result) {
-        /* On failure free the smpat */
-        SUBMATRIX_FREE_SAFE(smat);
+    if ((E__SUCCESS != result) && owns_g) {
+        FREE_SAFE(g);
     }
 
     return result;
@@ -68,10 +187,125 @@ void
 SUBMATRIX_free(submatrix_t *smat)
 {
     if (NULL != smat) {
-        FREE_SAFE(smat->g);
+        if (smat->owns_g) {
+            FREE_SAFE(smat->g);
+        }
+        smat->g = NULL;
         MATRIX_FREE_SAFE(smat->orig);
         smat->g_length = 0;
-        FREE_SAFE(smat->orig);
+
+        if (NULL != smat->pool) {
+            POOL_release(smat->pool->submatrices, smat);
+        } else {
+            free(smat);
+        }
+    }
+}
+
+result_t
+SUBMATRIX_materialize(submatrix_t *smat,
+                      const matrix_t *network,
+                      int *temp_positions)
+{
+    result_t result = E__UNKNOWN;
+    pool_t *headers = NULL;
+
+    /* 0. Input validation */
+    if ((NULL == smat) || (NULL == network) || (NULL == temp_positions)) {
+        result = E__NULL_ARGUMENT;
+        goto l_cleanup;
+    }
+
+    /* 1. Nothing to do if the matrix was already built */
+    if (NULL != smat->orig) {
+        result = E__SUCCESS;
+        goto l_cleanup;
+    }
+
+    /* 2. Recycle a header of the network's type */
+    if ((NULL != smat->pool) && (network->type == smat->pool->type)) {
+        headers = smat->pool->matrices;
+    }
+
+    /* 3. Extract the group's rows and columns out of the network */
+    result = MATRIX_VTABLE(network)->extract(network,
+                                             smat->g,
+                                             smat->g_length,
+                                             temp_positions,
+                                             headers,
+                                             &smat->orig);
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+
+    result = E__SUCCESS;
+l_cleanup:
+
+    return result;
+}
+
+result_t
+SUBMATRIX_split_pending(const submatrix_t *smat,
+                        const sign_word_t *s_vector,
+                        submatrix_t **smat1_out,
+                        submatrix_t **smat2_out)
+{
+    result_t result = E__UNKNOWN;
+    submatrix_t *smat1 = NULL;
+    submatrix_t *smat2 = NULL;
+    int smat1_length = 0;
+    int i = 0;
+    int bit = 0;
+    submatrix_t *groups[2] = {NULL, NULL};
+
+    /* 0. Input validation */
+    if ((NULL == smat) || (NULL == s_vector) ||
+            (NULL == smat1_out) || (NULL == smat2_out)) {
+        result = E__NULL_ARGUMENT;
+        goto l_cleanup;
+    }
+
+    /* 1. Count the 1st group's length */
+    for (i = 0 ; i < smat->g_length ; ++i) {
+        smat1_length += 1 - SIGN_VECTOR_BIT(s_vector, i);
+    }
+
+    /* 2. Create the pending submatrices */
+    result = SUBMATRIX_create_pending(smat->adj,
+                                      smat1_length,
+                                      smat->pool,
+                                      &smat1);
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
     }
-    FREE_SAFE(smat);
+
+    result = SUBMATRIX_create_pending(smat->adj,
+                                      smat->g_length - smat1_length,
+                                      smat->pool,
+                                      &smat2);
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+
+    /* 3. Split g vector. Both keep the parent's ascending order */
+    groups[0] = smat1;
+    groups[1] = smat2;
+    for (i = 0 ; i < smat->g_length ; ++i) {
+        bit = SIGN_VECTOR_BIT(s_vector, i);
+        groups[bit]->g[groups[bit]->g_length] = smat->g[i];
+        ++groups[bit]->g_length;
+    }
+
+    /* Success */
+    *smat1_out = smat1;
+    *smat2_out = smat2;
+
+    result = E__SUCCESS;
+l_cleanup:
+    if (E__SUCCESS != result) {
+        SUBMATRIX_FREE_SAFE(smat1);
+        SUBMATRIX_FREE_SAFE(smat2);
+    }
+
+    return result;
 }
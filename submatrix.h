@@ -8,13 +8,21 @@
 
 /* Includes ******************************************************************/
 #include <stddef.h>
+#include <stdint.h>
 
 #include "results.h"
 #include "common.h"
 #include "adjacency_matrix.h"
+#include "pool.h"
 
 
 /* Macros ********************************************************************/
+/* The pool to recycle a submatrix's children matrices' headers from */
+#define SUBMATRIX_MATRICES_POOL(smat) (                                     \
+    ((NULL != (smat)->pool) && ((smat)->orig->type == (smat)->pool->type))  \
+    ? (smat)->pool->matrices                                                \
+    : NULL                                                                  \
+)
 
 #define SUBMATRIX_FREE_SAFE(m) do { \
     if (NULL != (m)) {              \
@@ -24,11 +32,47 @@
 } while (0)
 
 
+/* Submatrix operations, implemented by its matrix's module */
+#define SUBMATRIX_VTABLE(smat) (MATRIX_VTABLE((smat)->orig))
+
+#define SUBMATRIX_GET_1NORM(smat, tmp_row_sums) \
+    (SUBMATRIX_VTABLE(smat)->submat_get_1norm((smat), (tmp_row_sums)))
+
+#define SUBMATRIX_MULT(smat, vector, result) \
+    (SUBMATRIX_VTABLE(smat)->submat_mult((smat), (vector), (result)))
+
+#define SUBMATRIX_MULT_VMV(smat, vector) \
+    (SUBMATRIX_VTABLE(smat)->submat_mult_vmv((smat), (vector)))
+
+#define SUBMATRIX_CALCULATE_Q(smat, s_vector) \
+    (SUBMATRIX_VTABLE(smat)->submat_calculate_q((smat), (s_vector)))
+
+#define SUBMATRIX_CALC_Q_SCORE(smat, s_vector, row) \
+    (SUBMATRIX_VTABLE(smat)->submat_calc_q_score((smat), (s_vector), (row)))
+
+#define SUBMATRIX_SPLIT(smat, s_vector, temp_s_indexes, smat1_out, smat2_out) \
+    (SUBMATRIX_VTABLE(smat)->submat_split((smat),                             \
+                                          (s_vector),                         \
+                                          (temp_s_indexes),                   \
+                                          (smat1_out),                        \
+                                          (smat2_out)))
+
+
 /* Typedefs ******************************************************************/
 typedef struct submatrix_s submatrix_t;
 
 
 /* Structs *******************************************************************/
+/*
+ * Recycled headers of the submatrices of a division, and of their matrices.
+ * Every group created while dividing a network returns its headers here
+ */
+typedef struct submatrix_pool_s {
+    pool_t *submatrices;
+    /* Headers of matrices of the given type only */
+    matrix_type_t type;
+    pool_t *matrices;
+} submatrix_pool_t;
 
 /*
  * A representation of a submatrix given the whole matrix and subindexes.
@@ -45,17 +89,44 @@ struct submatrix_s {
     int g_length;
     /* Array of subindexes of this matrix */
     int *g;
+    /* Whether g was allocated by the submatrix, or is owned by orig */
+    bool_t owns_g;
     /* A constant value to add to the diag */
     double add_to_diag;
+    /* The pool the submatrix was allocated from, or NULL */
+    submatrix_pool_t *pool;
+    /* The group's node in the division tree, if it's recorded */
+    int64_t node;
 };
 
 
 /* Functions Declarations ****************************************************/
+/*
+ * @purpose Create a pool of submatrices whose matrices has a given type
+ *
+ * @param type The submatrices' matrices implementation
+ * @param pool_out The pool created
+ *
+ * @return One of result_t values
+ */
+result_t
+SUBMATRIX_POOL_create(matrix_type_t type, submatrix_pool_t **pool_out);
+
+/*
+ * @purpose Free a submatrix pool
+ *
+ * @remark Every submatrix allocated from the pool must be freed beforehand.
+ *         Safe to call with NULL
+ */
+void
+SUBMATRIX_POOL_destroy(submatrix_pool_t *pool);
+
 /* 
  * @purpose Create a submatrix that wraps a given matrxi
  * 
  * @param full_matrix 
- * @param type The submatrix's implementation
+ * @param matrix The submatrix's matrix. Its size is the g-vector's length
+ * @param pool The pool to allocate the submatrix from, or NULL
  * @param submatrix_out The submatrix creadet
  *
  * @return One of result_t values
@@ -63,8 +134,53 @@ struct submatrix_s {
 result_t
 SUBMATRIX_create(const adjacency_t *adj,
                  matrix_t *matrix,
+                 submatrix_pool_t *pool,
                  submatrix_t **smat_out);
 
+/*
+ * @purpose Create a pending submatrix: its g-vector is allocated with the
+ *          given length, and its matrix is built by SUBMATRIX_materialize
+ *
+ * @param adj The network's adjacency data
+ * @param g_length The g-vector's capacity. g_length itself is set to 0
+ * @param pool The pool to allocate the submatrix from, or NULL
+ * @param submatrix_out The submatrix creadet
+ *
+ * @return One of result_t values
+ */
+result_t
+SUBMATRIX_create_pending(const adjacency_t *adj,
+                         int g_length,
+                         submatrix_pool_t *pool,
+                         submatrix_t **smat_out);
+
+/*
+ * @purpose Build the matrix of a pending submatrix out of the network's
+ *          matrix. Does nothing if the submatrix already has a matrix
+ *
+ * @param smat The submatrix. Its g-vector must be ascending
+ * @param network The whole network's matrix
+ * @param temp_positions A network->n sized buffer whose entries are all -1
+ *
+ * @return One of result_t values
+ */
+result_t
+SUBMATRIX_materialize(submatrix_t *smat,
+                      const matrix_t *network,
+                      int *temp_positions);
+
+/*
+ * @purpose Split a submatrix's g-vector accordingly to a given s-vector into
+ *          two pending submatrices. The submatrix's matrix is not accessed
+ *
+ * @return One of result_t values
+ */
+result_t
+SUBMATRIX_split_pending(const submatrix_t *smat,
+                        const sign_word_t *s_vector,
+                        submatrix_t **smat1_out,
+                        submatrix_t **smat2_out);
+
 /*
  * @remark The original, transpoed and g-vector are not freed!
  */
@@ -0,0 +1,426 @@
+/**
+ * @file graph_convert.c
+ * @purpose Convert an adjacency input file to one of the binary input formats:
+ *          legacy, wide, and compressed (see file_format.h). The input is of
+ *          any format the program reads, including the text graphs (see
+ *          adjacency_text.h)
+ */
+
+/* Includes **************************************************************************************/
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "results.h"
+#include "common.h"
+#include "file_format.h"
+#include "stream_vbyte.h"
+#include "adjacency_file.h"
+
+
+/* Constants *************************************************************************************/
+/* The rows count of a compressed file's blocks */
+#define GRAPH_CONVERT_BLOCK_ROWS (4096)
+
+
+/* Enums *****************************************************************************************/
+enum graph_convert_args_e {
+    ARG_PROGRAM_NAME,
+    ARG_INPUT_ADJACENCY,
+    ARG_OUTPUT_ADJACENCY,
+    ARG_OUTPUT_FORMAT,
+    ARG_COUNT
+};
+
+/* The output formats, by their names on the command line */
+typedef enum graph_convert_format_e {
+    GRAPH_CONVERT_FORMAT_COMPRESSED = 0,
+    GRAPH_CONVERT_FORMAT_LEGACY,
+    GRAPH_CONVERT_FORMAT_32,
+    GRAPH_CONVERT_FORMAT_64,
+
+    GRAPH_CONVERT_FORMAT_MAX
+} graph_convert_format_t;
+
+
+/* Globals ***************************************************************************************/
+static const char *graph_convert_format_names[GRAPH_CONVERT_FORMAT_MAX] = {
+    "compressed",
+    "legacy",
+    "32",
+    "64",
+};
+
+
+/* Functions Declarations ************************************************************************/
+/**
+ * @purpose Compare two columns, for qsort
+ * @param a The first column
+ * @param b The second column
+ *
+ * @return Negative, zero or positive as a is less than, equal to or greater than b
+ */
+static
+int
+graph_convert_compare_columns(const void *a, const void *b);
+
+/**
+ * @purpose Write a 64-bit count or position
+ * @param value The value
+ * @param output The output file
+ *
+ * @return One of result_t values
+ */
+static
+result_t
+graph_convert_write_int64(int64_t value, FILE *output);
+
+/**
+ * @purpose Write the file as legacy or wide
+ * @param file The input file
+ * @param width The output's width
+ * @param output The output file
+ *
+ * @return One of result_t values
+ */
+static
+result_t
+graph_convert_write_plain(const adjacency_file_t *file,
+                          file_width_t width,
+                          FILE *output);
+
+/**
+ * @purpose Write the file as compressed, its rows sorted
+ * @param file The input file
+ * @param output The output file
+ *
+ * @return One of result_t values
+ */
+static
+result_t
+graph_convert_write_compressed(const adjacency_file_t *file, FILE *output);
+
+
+/* Functions *************************************************************************************/
+static
+int
+graph_convert_compare_columns(const void *a, const void *b)
+{
+    int column_a = *(const int *)a;
+    int column_b = *(const int *)b;
+
+    return (column_a > column_b) - (column_a < column_b);
+}
+
+static
+result_t
+graph_convert_write_int64(int64_t value, FILE *output)
+{
+    if (1 != fwrite(&value, sizeof(value), 1, output)) {
+        return E__FWRITE_ERROR;
+    }
+
+    return E__SUCCESS;
+}
+
+static
+result_t
+graph_convert_write_plain(const adjacency_file_t *file,
+                          file_width_t width,
+                          FILE *output)
+{
+    result_t result = E__UNKNOWN;
+    int *columns = NULL;
+    int32_t marker = 0;
+    int32_t narrow = 0;
+    int i = 0;
+    int k = 0;
+
+    /* 1. Allocations */
+    columns = (int *)malloc(sizeof(*columns) * MAX(file->n, 1));
+    if (NULL == columns) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+
+    /* 2. The header, n follows a wide file's marker */
+    if (FILE_WIDTH_LEGACY == width) {
+        narrow = (int32_t)file->n;
+        if (1 != fwrite(&narrow, sizeof(narrow), 1, output)) {
+            result = E__FWRITE_ERROR;
+            goto l_cleanup;
+        }
+    } else {
+        marker = FILE_FORMAT_MARKER(width);
+        if (1 != fwrite(&marker, sizeof(marker), 1, output)) {
+            result = E__FWRITE_ERROR;
+            goto l_cleanup;
+        }
+
+        result = graph_convert_write_int64(file->n, output);
+        if (E__SUCCESS != result) {
+            goto l_cleanup;
+        }
+    }
+
+    /* 3. Each row's count and IDs, in the input's order */
+    for (i = 0 ; i < file->n ; ++i) {
+        result = ADJACENCY_FILE_read_row(file, i, columns);
+        if (E__SUCCESS != result) {
+            goto l_cleanup;
+        }
+
+        if (FILE_WIDTH_LEGACY == width) {
+            narrow = (int32_t)file->degrees[i];
+            if (1 != fwrite(&narrow, sizeof(narrow), 1, output)) {
+                result = E__FWRITE_ERROR;
+                goto l_cleanup;
+            }
+        } else {
+            result = graph_convert_write_int64(file->degrees[i], output);
+            if (E__SUCCESS != result) {
+                goto l_cleanup;
+            }
+        }
+
+        if (FILE_WIDTH_64 != width) {
+            if ((size_t)file->degrees[i] != fwrite(columns,
+                                                   sizeof(*columns),
+                                                   (size_t)file->degrees[i],
+                                                   output)) {
+                result = E__FWRITE_ERROR;
+                goto l_cleanup;
+            }
+        } else {
+            for (k = 0 ; k < file->degrees[i] ; ++k) {
+                result = graph_convert_write_int64(columns[k], output);
+                if (E__SUCCESS != result) {
+                    goto l_cleanup;
+                }
+            }
+        }
+    }
+
+    result = E__SUCCESS;
+l_cleanup:
+    FREE_SAFE(columns);
+
+    return result;
+}
+
+static
+result_t
+graph_convert_write_compressed(const adjacency_file_t *file, FILE *output)
+{
+    result_t result = E__UNKNOWN;
+    int32_t marker = FILE_FORMAT_COMPRESSED_MARKER;
+    int64_t blocks_count = (file->n + GRAPH_CONVERT_BLOCK_ROWS - 1) / GRAPH_CONVERT_BLOCK_ROWS;
+    int64_t *blocks = NULL;
+    uint32_t *values = NULL;
+    int *columns = NULL;
+    unsigned char *stream = NULL;
+    size_t stream_size = 0;
+    int64_t position = 0;
+    int64_t blocks_position = 0;
+    int first = 0;
+    int rows = 0;
+    int64_t b = 0;
+    int i = 0;
+    int k = 0;
+
+    /* 1. Allocations, a row is at most n IDs */
+    blocks = (int64_t *)malloc(sizeof(*blocks) * ((size_t)blocks_count + 1));
+    if (NULL == blocks) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+
+    values = (uint32_t *)malloc(sizeof(*values) * MAX(file->n, GRAPH_CONVERT_BLOCK_ROWS));
+    if (NULL == values) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+
+    columns = (int *)malloc(sizeof(*columns) * MAX(file->n, 1));
+    if (NULL == columns) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+
+    stream = (unsigned char *)malloc(STREAM_VBYTE_MAX_SIZE(MAX(file->n,
+                                                                GRAPH_CONVERT_BLOCK_ROWS)));
+    if (NULL == stream) {
+        result = E__MALLOC_ERROR;
+        goto l_cleanup;
+    }
+
+    /* 2. The header. The blocks' positions are written once they are known */
+    if (1 != fwrite(&marker, sizeof(marker), 1, output)) {
+        result = E__FWRITE_ERROR;
+        goto l_cleanup;
+    }
+
+    result = graph_convert_write_int64(file->n, output);
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+
+    result = graph_convert_write_int64(GRAPH_CONVERT_BLOCK_ROWS, output);
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+
+    blocks_position = (int64_t)(sizeof(marker) + 2 * sizeof(int64_t));
+    position = blocks_position + (blocks_count + 1) * (int64_t)sizeof(*blocks);
+    if (0 != fseek(output, (long)position, SEEK_SET)) {
+        result = E__FSEEK_ERROR;
+        goto l_cleanup;
+    }
+
+    /* 3. Each block's rows' counts, then each row's gaps */
+    for (b = 0 ; b < blocks_count ; ++b) {
+        blocks[b] = position;
+        first = (int)(b * GRAPH_CONVERT_BLOCK_ROWS);
+        rows = MIN(GRAPH_CONVERT_BLOCK_ROWS, file->n - first);
+
+        for (k = 0 ; k < rows ; ++k) {
+            values[k] = (uint32_t)file->degrees[first + k];
+        }
+        stream_size = STREAM_VBYTE_encode(values, (size_t)rows, stream);
+        if (stream_size != fwrite(stream, 1, stream_size, output)) {
+            result = E__FWRITE_ERROR;
+            goto l_cleanup;
+        }
+        position += (int64_t)stream_size;
+
+        for (i = first ; i < first + rows ; ++i) {
+            result = ADJACENCY_FILE_read_row(file, i, columns);
+            if (E__SUCCESS != result) {
+                goto l_cleanup;
+            }
+
+            qsort(columns,
+                  (size_t)file->degrees[i],
+                  sizeof(*columns),
+                  graph_convert_compare_columns);
+            for (k = 0 ; k < file->degrees[i] ; ++k) {
+                values[k] = (uint32_t)((0 == k) ? columns[k] : columns[k] - columns[k - 1]);
+            }
+
+            stream_size = STREAM_VBYTE_encode(values, (size_t)file->degrees[i], stream);
+            if (stream_size != fwrite(stream, 1, stream_size, output)) {
+                result = E__FWRITE_ERROR;
+                goto l_cleanup;
+            }
+            position += (int64_t)stream_size;
+        }
+    }
+    blocks[blocks_count] = position;
+
+    /* 4. The blocks' positions */
+    if (0 != fseek(output, (long)blocks_position, SEEK_SET)) {
+        result = E__FSEEK_ERROR;
+        goto l_cleanup;
+    }
+
+    if ((size_t)blocks_count + 1 != fwrite(blocks,
+                                           sizeof(*blocks),
+                                           (size_t)blocks_count + 1,
+                                           output)) {
+        result = E__FWRITE_ERROR;
+        goto l_cleanup;
+    }
+
+    result = E__SUCCESS;
+l_cleanup:
+    FREE_SAFE(stream);
+    FREE_SAFE(columns);
+    FREE_SAFE(values);
+    FREE_SAFE(blocks);
+
+    return result;
+}
+
+int main(int argc, const char *argv[])
+{
+    result_t result = E__UNKNOWN;
+    graph_convert_format_t format = GRAPH_CONVERT_FORMAT_COMPRESSED;
+    adjacency_file_t *file = NULL;
+    FILE *output = NULL;
+
+    /* 1. Input validation, the format defaults to compressed */
+    if ((ARG_COUNT != argc) && (ARG_COUNT - 1 != argc)) {
+        (void)fprintf(stderr,
+                      "Usage: %s INPUT_ADJACENCY OUTPUT_ADJACENCY [compressed|legacy|32|64]\n",
+                      argv[0]);
+
+        result = E__INVALID_CMDLINE_ARGS;
+        goto l_cleanup;
+    }
+
+    if (ARG_COUNT == argc) {
+        for (format = 0 ; format < GRAPH_CONVERT_FORMAT_MAX ; ++format) {
+            if (0 == strcmp(argv[ARG_OUTPUT_FORMAT], graph_convert_format_names[format])) {
+                break;
+            }
+        }
+
+        if (GRAPH_CONVERT_FORMAT_MAX == format) {
+            (void)fprintf(stderr, "Unknown format: %s\n", argv[ARG_OUTPUT_FORMAT]);
+
+            result = E__INVALID_CMDLINE_ARGS;
+            goto l_cleanup;
+        }
+    }
+
+    /* Select the decoder for this CPU */
+    STREAM_VBYTE_init();
+
+    /* 2. Open the input, of any format */
+    result = ADJACENCY_FILE_open(argv[ARG_INPUT_ADJACENCY], &file);
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+
+    /* 3. Write the output */
+    output = fopen(argv[ARG_OUTPUT_ADJACENCY], "wb");
+    if (NULL == output) {
+        result = E__FOPEN_ERROR;
+        goto l_cleanup;
+    }
+
+    switch (format) {
+    case GRAPH_CONVERT_FORMAT_COMPRESSED:
+        result = graph_convert_write_compressed(file, output);
+        break;
+    case GRAPH_CONVERT_FORMAT_LEGACY:
+        result = graph_convert_write_plain(file, FILE_WIDTH_LEGACY, output);
+        break;
+    case GRAPH_CONVERT_FORMAT_32:
+        result = graph_convert_write_plain(file, FILE_WIDTH_32, output);
+        break;
+    default:
+        result = graph_convert_write_plain(file, FILE_WIDTH_64, output);
+        break;
+    }
+    if (E__SUCCESS != result) {
+        goto l_cleanup;
+    }
+
+    /* 4. Flush */
+    if (0 != fclose(output)) {
+        output = NULL;
+        result = E__FWRITE_ERROR;
+        goto l_cleanup;
+    }
+    output = NULL;
+
+    result = E__SUCCESS;
+l_cleanup:
+    FCLOSE_SAFE(output);
+    ADJACENCY_FILE_close(file);
+
+    return (int)result;
+}
@@ -7,13 +7,27 @@
 #include <time.h>
 #include <stdlib.h>
 #include <math.h>
+#include <stdint.h>
 
 #include "vector.h"
+#include "vector_kernels.h"
 #include "results.h"
 #include "common.h"
+#include "config.h"
 
 #define OPTIMIZE_VECTOR_OPERATIONS
 
+/* The IEEE-754 sign bit of a double */
+#define VECTOR_DOUBLE_SIGN_SHIFT (63)
+
+
+/* Typedefs **************************************************************************************/
+/* A double and its bits */
+typedef union vector_double_bits_u {
+    double value;
+    uint64_t bits;
+} vector_double_bits_t;
+
 /* Functions Declarations ************************************************************************/
 
 /**
@@ -25,85 +39,292 @@
  */
 static
 double
-vector_calculate_magnitude(double *vector, size_t length);
+vector_calculate_magnitude(eigen_real_t *vector, size_t length);
+
+/* Portable kernels: @see vector_kernels_t on vector_kernels.h */
+static
+double
+vector_scalar_multiply(const eigen_real_t * l1, const eigen_real_t * l2, size_t n);
+
+static
+double
+vector_scalar_multiply_with_s(const double * l1, const sign_word_t * s, size_t n);
+
+static
+double
+vector_gather_multiply_with_s(const double * values,
+                              const int * indexes,
+                              const sign_word_t * s,
+                              size_t n);
+
+static
+size_t
+vector_count_common_bits(const sign_word_t * bits1,
+                         const sign_word_t * bits2,
+                         size_t words);
 
 /**
- * @purpose divides vector by scalar umber
- * @param vector The vector to divide
+ * @purpose multiplies vector by scalar number
+ * @param vector The vector to multiply
  * @param length The vector length
- * @param value The value to divide with
+ * @param factor The value to multiply with
  *
- * @remark vector must be valid buffer, value must be non-zero
+ * @remark vector must be valid buffer
  */
 static
 void
-vector_div(double *vector, size_t length, double value);
+vector_scale(eigen_real_t *vector, size_t length, double factor);
+
+static
+bool_t
+vector_is_close(const eigen_real_t * vector_a,
+                const eigen_real_t * vector_b,
+                size_t length,
+                double epsilon);
+
+static
+bool_t
+vector_scale_and_is_close(eigen_real_t * vector,
+                          const eigen_real_t * previous,
+                          size_t length,
+                          double factor,
+                          double epsilon);
+
+
+/* Globals ***************************************************************************************/
+static const vector_kernels_t vector_portable_kernels = {
+    .scalar_multiply = vector_scalar_multiply,
+    .scalar_multiply_with_s = vector_scalar_multiply_with_s,
+    .gather_multiply_with_s = vector_gather_multiply_with_s,
+    .count_common_bits = vector_count_common_bits,
+    .scale = vector_scale,
+    .is_close = vector_is_close,
+    .scale_and_is_close = vector_scale_and_is_close,
+};
+
+/* The kernels the vector functions dispatch to, selected by VECTOR_init */
+static const vector_kernels_t *vector_kernels = &vector_portable_kernels;
 
 
 /* Functions *************************************************************************************/
+vector_simd_t
+VECTOR_init(void)
+{
+    vector_simd_t simd = VECTOR_SIMD_NONE;
+
+#ifdef VECTOR_KERNELS_X86
+    /* Select the widest instruction set both the CPU and the build allow */
+    __builtin_cpu_init();
+    if ((VECTOR_SIMD_AVX512 <= VECTOR_SIMD_MAX) &&
+            __builtin_cpu_supports("avx512f")) {
+        vector_kernels = &VECTOR_KERNELS_AVX512;
+        simd = VECTOR_SIMD_AVX512;
+    } else if ((VECTOR_SIMD_AVX2 <= VECTOR_SIMD_MAX) &&
+            __builtin_cpu_supports("avx2")) {
+        vector_kernels = &VECTOR_KERNELS_AVX2;
+        simd = VECTOR_SIMD_AVX2;
+    } else if ((VECTOR_SIMD_SSE2 <= VECTOR_SIMD_MAX) &&
+            __builtin_cpu_supports("sse2")) {
+        vector_kernels = &VECTOR_KERNELS_SSE2;
+        simd = VECTOR_SIMD_SSE2;
+    } else
+#endif /* VECTOR_KERNELS_X86 */
+    {
+        vector_kernels = &vector_portable_kernels;
+        simd = VECTOR_SIMD_NONE;
+    }
+
+    return simd;
+}
+
+double
+VECTOR_scalar_multiply(const eigen_real_t * l1, const eigen_real_t * l2, size_t n)
+{
+    return vector_kernels->scalar_multiply(l1, l2, n);
+}
+
+double
+VECTOR_scalar_multiply_with_s(const double * l1, const sign_word_t * s, size_t n)
+{
+    return vector_kernels->scalar_multiply_with_s(l1, s, n);
+}
+
+double
+VECTOR_gather_multiply_with_s(const double * values,
+                              const int * indexes,
+                              const sign_word_t * s,
+                              size_t n)
+{
+    return vector_kernels->gather_multiply_with_s(values, indexes, s, n);
+}
+
+size_t
+VECTOR_count_common_bits(const sign_word_t * bits1,
+                         const sign_word_t * bits2,
+                         size_t words)
+{
+    return vector_kernels->count_common_bits(bits1, bits2, words);
+}
+
+bool_t
+VECTOR_is_close(const eigen_real_t * vector_a,
+                const eigen_real_t * vector_b,
+                size_t length,
+                double epsilon)
+{
+    return vector_kernels->is_close(vector_a, vector_b, length, epsilon);
+}
+
+bool_t
+VECTOR_scale_and_is_close(eigen_real_t * vector,
+                          const eigen_real_t * previous,
+                          size_t length,
+                          double factor,
+                          double epsilon)
+{
+    return vector_kernels->scale_and_is_close(vector,
+                                              previous,
+                                              length,
+                                              factor,
+                                              epsilon);
+}
+
+static
 double
-VECTOR_scalar_multiply(const double * l1, const double * l2, size_t n)
+vector_scalar_multiply(const eigen_real_t * l1, const eigen_real_t * l2, size_t n)
 {
     double result = 0.0;
-    const double * l1_end = l1 + n;
+    const eigen_real_t * l1_end = l1 + n;
 
+    /* Note: the products are summed in double precision */
 #ifdef OPTIMIZE_VECTOR_OPERATIONS
     for ( ; l1 < l1_end - 1 ; l1 += 2, l2 += 2) {
-        result += ((l1[0] * l2[0]) + (l1[1] * l2[1]));
+        result += (((double)l1[0] * l2[0]) + ((double)l1[1] * l2[1]));
     }
 #endif /* OPTIMIZE_VECTOR_OPERATIONS */
 
     /* If OPTIMIZE_VECTOR_OPERATIONS is defined, this will run up to 1 iteration */
     for ( ; l1 < l1_end ; ++l1, ++l2) {
-        result += (l1[0] * l2[0]);
+        result += ((double)l1[0] * l2[0]);
     }
 
     return result;
 }
 
+static
 double
-VECTOR_scalar_multiply_with_s(const double * l1, const double * s, size_t n)
+vector_scalar_multiply_with_s(const double * l1, const sign_word_t * s, size_t n)
 {
     double result = 0.0;
-    const double * l1_end = l1 + n;
+    vector_double_bits_t signed_value;
+    sign_word_t word = 0;
+    size_t i = 0;
 
-#ifdef OPTIMIZE_VECTOR_OPERATIONS
-    for ( ; l1 < l1_end - 1 ; l1 += 2, s += 2) {
-        result += ((l1[0] * ((s[0] > 0) ? 1 : -1)) +
-                (l1[1] * ((s[1] > 0) ? 1 : -1)));
+    /* Go over the s-vector a word at a time, consuming its bits. Instead of
+     * branching or multiplying, a value's sign bit is flipped if s is -1 */
+    for (i = 0 ; i < n ; ++i) {
+        if (0 == (i % SIGN_WORD_BITS)) {
+            word = s[i / SIGN_WORD_BITS];
+        }
+        signed_value.value = l1[i];
+        signed_value.bits ^= ((word & 1) << VECTOR_DOUBLE_SIGN_SHIFT);
+        result += signed_value.value;
+        word >>= 1;
     }
-#endif /* OPTIMIZE_VECTOR_OPERATIONS */
 
-    /* If OPTIMIZE_VECTOR_OPERATIONS is defined, this will run up to 1 iteration */
-    for ( ; l1 < l1_end ; ++l1, ++s) {
-        result += (l1[0] * (s[0] > 0 ? 1 : -1));
+    return result;
+}
+
+static
+double
+vector_gather_multiply_with_s(const double * values,
+                              const int * indexes,
+                              const sign_word_t * s,
+                              size_t n)
+{
+    double result = 0.0;
+    vector_double_bits_t signed_value;
+    sign_word_t word = 0;
+    size_t i = 0;
+
+    /* Go over the s-vector a word at a time, consuming its bits. Instead of
+     * branching or multiplying, a value's sign bit is flipped if s is -1 */
+    for (i = 0 ; i < n ; ++i) {
+        if (0 == (i % SIGN_WORD_BITS)) {
+            word = s[i / SIGN_WORD_BITS];
+        }
+        signed_value.value = values[indexes[i]];
+        signed_value.bits ^= ((word & 1) << VECTOR_DOUBLE_SIGN_SHIFT);
+        result += signed_value.value;
+        word >>= 1;
     }
 
     return result;
 }
 
-int
-VECTOR_scalar_multiply_int_with_s(const int * l1, const double * s, size_t n)
+static
+size_t
+vector_count_common_bits(const sign_word_t * bits1,
+                         const sign_word_t * bits2,
+                         size_t words)
 {
-    int result = 0.0;
-    const int * l1_end = l1 + n;
+    sign_word_t word = 0;
+    size_t count = 0;
+    size_t i = 0;
 
-#ifdef OPTIMIZE_VECTOR_OPERATIONS
-    for ( ; l1 < l1_end - 1 ; l1 += 2, s += 2) {
-        result += ((l1[0] * (s[0] > 0 ? 1 : -1)) + (l1[1] * (s[1]) > 0 ? 1 : -1));
+    /* Count each word's bits in parallel: pairs, nibbles, then bytes */
+    for (i = 0 ; i < words ; ++i) {
+        word = bits1[i] & bits2[i];
+        word -= (word >> 1) & UINT64_C(0x5555555555555555);
+        word = (word & UINT64_C(0x3333333333333333)) +
+               ((word >> 2) & UINT64_C(0x3333333333333333));
+        word = (word + (word >> 4)) & UINT64_C(0x0f0f0f0f0f0f0f0f);
+        count += (size_t)((word * UINT64_C(0x0101010101010101)) >> 56);
     }
-#endif /* OPTIMIZE_VECTOR_OPERATIONS */
 
-    /* If OPTIMIZE_VECTOR_OPERATIONS is defined, this will run up to 1 iteration */
-    for ( ; l1 < l1_end ; ++l1, ++s) {
-        result += (l1[0] * (s[0] > 0 ? 1 : -1));
+    return count;
+}
+
+int
+VECTOR_scalar_multiply_int_with_s(const int * l1, const sign_word_t * s, size_t n)
+{
+    int result = 0;
+    size_t i = 0;
+
+    /* x * s is x negated when s's bit is set: (x ^ -bit) + bit */
+    for (i = 0 ; i < n ; ++i) {
+        result += (l1[i] ^ -SIGN_VECTOR_BIT(s, i)) + SIGN_VECTOR_BIT(s, i);
     }
 
     return result;
 }
 
+size_t
+VECTOR_create_s_vector(const eigen_real_t * vector,
+                       size_t length,
+                       sign_word_t * s_vector)
+{
+    size_t i = 0;
+    size_t negatives = 0;
+    sign_word_t bit = 0;
+
+    /* 1. Clear the words, so only -1's bits need to be set */
+    for (i = 0 ; i < SIGN_VECTOR_WORDS(length) ; ++i) {
+        s_vector[i] = 0;
+    }
+
+    /* 2. Set the non-positive values' bits */
+    for (i = 0 ; i < length ; ++i) {
+        bit = (sign_word_t)(0 >= vector[i]);
+        s_vector[i / SIGN_WORD_BITS] |= (bit << (i % SIGN_WORD_BITS));
+        negatives += (size_t)bit;
+    }
+
+    return length - negatives;
+}
+
 void
-VECTOR_random_vector(size_t length, double *vector)
+VECTOR_random_vector(size_t length, eigen_real_t *vector)
 {
     size_t i = 0;
     int random_int = 0;
@@ -111,13 +332,13 @@ VECTOR_random_vector(size_t length, double *vector)
 
     for (i = 0 ; i < length ; ++i) {
         random_int = (rand() % 1000);
-        vector[i] = (double)random_int;
+        vector[i] = (eigen_real_t)random_int;
     }
 }
 
 static
 double
-vector_calculate_magnitude(double *vector, size_t length)
+vector_calculate_magnitude(eigen_real_t *vector, size_t length)
 {
     double norm_square = 0.0;
     double magnitude = 0.0;
@@ -130,30 +351,30 @@ vector_calculate_magnitude(double *vector, size_t length)
 
 static
 void
-vector_div(double *vector, size_t length, double value)
+vector_scale(eigen_real_t *vector, size_t length, double factor)
 {
-    double * i = NULL;
-    double * vector_end = NULL;
+    eigen_real_t * i = NULL;
+    eigen_real_t * vector_end = NULL;
 
     /* 1. Initialize vector start and end */
     i = vector;
     vector_end = vector + length;
 
-    /* 2. Divide using optimization */
+    /* 2. Multiply using optimization */
 #ifdef OPTIMIZE_VECTOR_OPERATIONS
     for ( ; i < vector_end - 1; i += 2) {
-        i[0] /= value;
-        i[1] /= value;
+        i[0] *= factor;
+        i[1] *= factor;
     }
 #endif /* OPTIMIZE_VECTOR_OPERATIONS */
 
     for (; i < vector_end ; ++i) {
-        i[0] /= value;
+        i[0] *= factor;
     }
 }
 
 result_t
-VECTOR_normalize(double *vector, size_t length)
+VECTOR_normalize(eigen_real_t *vector, size_t length)
 {
     result_t result = E__UNKNOWN;
     double magnitude = 0.0;
@@ -163,8 +384,9 @@ VECTOR_normalize(double *vector, size_t length)
         goto l_cleanup;
     }
 
+    /* Multiply by the reciprocal: a division per element is far slower */
     magnitude = vector_calculate_magnitude(vector, length);
-    vector_div(vector, length, magnitude);
+    vector_kernels->scale(vector, length, 1.0 / magnitude);
 
     result = E__SUCCESS;
 l_cleanup:
@@ -172,9 +394,10 @@ l_cleanup:
     return result;
 }
 
+static
 bool_t
-VECTOR_is_close(const double * vector_a,
-                const double * vector_b,
+vector_is_close(const eigen_real_t * vector_a,
+                const eigen_real_t * vector_b,
                 size_t length,
                 double epsilon)
 {
@@ -190,26 +413,42 @@ VECTOR_is_close(const double * vector_a,
     return result;
 }
 
+static
+bool_t
+vector_scale_and_is_close(eigen_real_t * vector,
+                          const eigen_real_t * previous,
+                          size_t length,
+                          double factor,
+                          double epsilon)
+{
+    bool_t result = TRUE;
+    size_t row = 0;
+
+    /* Note: a NaN difference is close, as in vector_is_close */
+    for (row = 0 ; row < length ; ++row) {
+        vector[row] *= factor;
+        result &= !(fabs(vector[row] - previous[row]) >= epsilon);
+    }
+
+    return result;
+}
 
 int
-VECTOR_create_s_indexes(const double * vector_s,
+VECTOR_create_s_indexes(const sign_word_t * vector_s,
                         int length,
                         int *s_indexes)
 {
     int i = 0;
-    int index_1 = 0;
-    int index_2 = 0;
+    /* The next index of the 1's and -1's groups */
+    int next_index[2] = {0, 0};
+    int bit = 0;
 
     /* Go over the s-vector */
     for (i = 0 ; i < length ; ++i) {
-        if (1 == vector_s[i]) {
-            s_indexes[i] = index_1;
-            ++index_1;
-        } else if (-1 == vector_s[i]) {
-            s_indexes[i] = index_2;
-            ++index_2;
-        } 
+        bit = SIGN_VECTOR_BIT(vector_s, i);
+        s_indexes[i] = next_index[bit];
+        ++next_index[bit];
     }
 
-    return index_1;
+    return next_index[0];
 }
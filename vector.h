@@ -10,47 +10,122 @@
 
 #include "results.h"
 #include "common.h"
+#include "sign_vector.h"
+
+
+/* Enums *****************************************************************************************/
+/* The instruction sets of the vector kernels, from the narrowest */
+typedef enum vector_simd_e {
+    VECTOR_SIMD_NONE = 0,
+    VECTOR_SIMD_SSE2,
+    VECTOR_SIMD_AVX2,
+    VECTOR_SIMD_AVX512,
+} vector_simd_t;
 
 
 /* Functions Declarations ************************************************************************/
+/**
+ * @purpose Select the vector kernels of the widest instruction set supported
+ *          by the CPU, up to VECTOR_SIMD_MAX. Before it is called the portable
+ *          kernels are used
+ *
+ * @return The selected instruction set
+ *
+ * @remark Should be called once at startup
+ */
+vector_simd_t
+VECTOR_init(void);
+
 /**
  * @purpose Calculate the scalar multiplication between two vectors
  *
- * @param l1 First vector - must be valid n-sized double array!
- * @param l2 Second vector - must be valid n-sized double array!
+ * @param l1 First vector - must be valid n-sized eigen_real_t array!
+ * @param l2 Second vector - must be valid n-sized eigen_real_t array!
  * @param n The length of the vectors
  *
- * @return The scalar multiplication result
+ * @return The scalar multiplication result, summed in double precision
  * @remark The vectors must be valid
  */
 double
-VECTOR_scalar_multiply(const double * l1, const double * l2, size_t n);
+VECTOR_scalar_multiply(const eigen_real_t * l1, const eigen_real_t * l2, size_t n);
 
 /**
- * @purpose Calculate the scalar multiplication between two vectors
+ * @purpose Calculate the scalar multiplication between a vector and an
+ *          s-vector
  *
  * @param l1 First vector - must be valid n-sized double array!
- * @param l2 Second vector - must be valid n-sized double array!
+ * @param s The bit-packed s-vector - must hold n signs!
  * @param n The length of the vectors
  *
  * @return The scalar multiplication result
  * @remark The vectors must be valid
  */
 double
-VECTOR_scalar_multiply_with_s(const double * l1, const double * s, size_t n);
+VECTOR_scalar_multiply_with_s(const double * l1, const sign_word_t * s, size_t n);
 
 /**
- * @purpose Calculate the scalar multiplication between two vectors
+ * @purpose Calculate the scalar multiplication between a vector gathered
+ *          by indexes and an s-vector: sum of values[indexes[i]] * s[i]
  *
- * @param l1 First vector - must be valid n-sized double array!
- * @param l2 Second vector - must be valid n-sized double array!
+ * @param values The gathered values
+ * @param indexes The n indexes to gather values by
+ * @param s The bit-packed s-vector - must hold n signs!
+ * @param n The length of indexes
+ *
+ * @return The scalar multiplication result
+ * @remark The vectors must be valid
+ */
+double
+VECTOR_gather_multiply_with_s(const double * values,
+                              const int * indexes,
+                              const sign_word_t * s,
+                              size_t n);
+
+/**
+ * @purpose Calculate the scalar multiplication between an integers vector
+ *          and an s-vector
+ *
+ * @param l1 First vector - must be valid n-sized int array!
+ * @param s The bit-packed s-vector - must hold n signs!
  * @param n The length of the vectors
  *
  * @return The scalar multiplication result
  * @remark The vectors must be valid
  */
 int
-VECTOR_scalar_multiply_int_with_s(const int * l1, const double * s, size_t n);
+VECTOR_scalar_multiply_int_with_s(const int * l1, const sign_word_t * s, size_t n);
+
+/**
+ * @purpose Count the bits set on both of two bit-packed vectors. A bitset
+ *          row multiplied by an s-vector is its bits count minus twice its
+ *          common bits with the s-vector
+ *
+ * @param bits1 First vector - must be valid words-sized array!
+ * @param bits2 Second vector - must be valid words-sized array!
+ * @param words The length of the vectors, in words
+ *
+ * @return The count of the common bits
+ * @remark The vectors must be valid
+ */
+size_t
+VECTOR_count_common_bits(const sign_word_t * bits1,
+                         const sign_word_t * bits2,
+                         size_t words);
+
+/**
+ * @purpose Create an s-vector out of a vector's signs: positive values are
+ *          1, the others -1
+ *
+ * @param vector The vector
+ * @param length The vector's length
+ * @param s_vector A pre-allocated SIGN_VECTOR_WORDS(length) words buffer
+ *
+ * @return The count of 1's
+ */
+size_t
+VECTOR_create_s_vector(const eigen_real_t * vector,
+                       size_t length,
+                       sign_word_t * s_vector);
 
 
 /**
@@ -60,7 +135,7 @@ VECTOR_scalar_multiply_int_with_s(const int * l1, const double * s, size_t n);
  * @param vector A pre-allocated lenth-sized vector
  */
 void
-VECTOR_random_vector(size_t length, double *vector);
+VECTOR_random_vector(size_t length, eigen_real_t *vector);
 
 
 /**
@@ -71,7 +146,7 @@ VECTOR_random_vector(size_t length, double *vector);
  * @return One of result_t values
  */
 result_t
-VECTOR_normalize(double *vector, size_t length);
+VECTOR_normalize(eigen_real_t *vector, size_t length);
 
 /**
  * @purpose Checks if all the differences between the matrix' values are smaller than epsilon
@@ -85,15 +160,35 @@ VECTOR_normalize(double *vector, size_t length);
  * @remark Matrixes must have the same size
  */
 bool_t
-VECTOR_is_close(const double * vector_a,
-                const double * vector_b,
+VECTOR_is_close(const eigen_real_t * vector_a,
+                const eigen_real_t * vector_b,
                 size_t length,
                 double epsilon);
 
+/**
+ * @purpose Multiply a vector by a factor, and check if all its differences
+ *          from a previous vector are smaller than epsilon, in one pass
+ * @param vector The vector to multiply
+ * @param previous The vector to compare with
+ * @param length The vectors' length
+ * @param factor The value to multiply with
+ * @param epsilon The largest difference allowed
+ *
+ * @return TRUE if close enough, otherwise FALSE
+ *
+ * @remark The whole vector is multiplied, even if a difference is too large
+ */
+bool_t
+VECTOR_scale_and_is_close(eigen_real_t * vector,
+                          const eigen_real_t * previous,
+                          size_t length,
+                          double factor,
+                          double epsilon);
+
 /**
  * @brief Convert an s-vector to s-index vector
  *
- * Given an s-vector that maps node n to a group (-1.0 or 1.0), this
+ * Given an s-vector that maps node n to a group (-1 or 1), this
  * function will calculate a s-index vectro that maps a node n to its index
  * within its new group.
  * Both groups' new indexes will be written to the one array.
@@ -110,7 +205,7 @@ VECTOR_is_close(const double * vector_a,
  * @remark vector_s and s_indexes must be valid vectors with the given length
  */
 int
-VECTOR_create_s_indexes(const double * vector_s,
+VECTOR_create_s_indexes(const sign_word_t * vector_s,
                         int length,
                         int *s_indexes);
 
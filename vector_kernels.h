@@ -0,0 +1,84 @@
+/**
+ * @file vector_kernels.h
+ * @purpose The vector kernels' table, implemented once per instruction set.
+ *          VECTOR_init selects the table the vector functions dispatch to
+ */
+#ifndef __VECTOR_KERNELS_H__
+#define __VECTOR_KERNELS_H__
+
+/* Includes ******************************************************************/
+#include <stddef.h>
+
+#include "common.h"
+#include "sign_vector.h"
+
+
+/* Macros ********************************************************************/
+/* The SIMD kernels are built using GCC's target attributes and x86 intrinsics */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define VECTOR_KERNELS_X86
+#endif
+
+
+/* Typedefs ******************************************************************/
+/* @see VECTOR_scalar_multiply on vector.h */
+typedef double (*vector_scalar_multiply_f)(const eigen_real_t *l1,
+                                           const eigen_real_t *l2,
+                                           size_t n);
+
+/* @see VECTOR_scalar_multiply_with_s on vector.h */
+typedef double (*vector_scalar_multiply_with_s_f)(const double *l1,
+                                                  const sign_word_t *s,
+                                                  size_t n);
+
+/* @see VECTOR_gather_multiply_with_s on vector.h */
+typedef double (*vector_gather_multiply_with_s_f)(const double *values,
+                                                  const int *indexes,
+                                                  const sign_word_t *s,
+                                                  size_t n);
+
+/* @see VECTOR_count_common_bits on vector.h */
+typedef size_t (*vector_count_common_bits_f)(const sign_word_t *bits1,
+                                             const sign_word_t *bits2,
+                                             size_t words);
+
+/* Multiply a vector in place by a scalar */
+typedef void (*vector_scale_f)(eigen_real_t *vector,
+                               size_t length,
+                               double factor);
+
+/* @see VECTOR_is_close on vector.h */
+typedef bool_t (*vector_is_close_f)(const eigen_real_t *vector_a,
+                                    const eigen_real_t *vector_b,
+                                    size_t length,
+                                    double epsilon);
+
+/* @see VECTOR_scale_and_is_close on vector.h */
+typedef bool_t (*vector_scale_and_is_close_f)(eigen_real_t *vector,
+                                              const eigen_real_t *previous,
+                                              size_t length,
+                                              double factor,
+                                              double epsilon);
+
+
+/* Structs *******************************************************************/
+typedef struct vector_kernels_s {
+    vector_scalar_multiply_f scalar_multiply;
+    vector_scalar_multiply_with_s_f scalar_multiply_with_s;
+    vector_gather_multiply_with_s_f gather_multiply_with_s;
+    vector_count_common_bits_f count_common_bits;
+    vector_scale_f scale;
+    vector_is_close_f is_close;
+    vector_scale_and_is_close_f scale_and_is_close;
+} vector_kernels_t;
+
+
+/* Globals *******************************************************************/
+#ifdef VECTOR_KERNELS_X86
+extern const vector_kernels_t VECTOR_KERNELS_SSE2;
+extern const vector_kernels_t VECTOR_KERNELS_AVX2;
+extern const vector_kernels_t VECTOR_KERNELS_AVX512;
+#endif /* VECTOR_KERNELS_X86 */
+
+
+#endif /* __VECTOR_KERNELS_H__ */
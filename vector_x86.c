@@ -0,0 +1,1192 @@
+/**
+ * @file vector_x86.c
+ * @purpose SSE2, AVX2 and AVX-512 implementations of the vector kernels.
+ *          Every function is built for its own instruction set, and is only
+ *          called if VECTOR_init found that the CPU supports it
+ */
+
+/* Includes ******************************************************************/
+#include <stddef.h>
+#include <stdint.h>
+#include <math.h>
+
+#include "common.h"
+#include "sign_vector.h"
+#include "vector_kernels.h"
+
+#ifdef VECTOR_KERNELS_X86
+#include <immintrin.h>
+
+
+/* Constants *****************************************************************/
+/* The IEEE-754 sign bit of a double */
+#define VECTOR_X86_SIGN_BIT (UINT64_C(0x8000000000000000))
+
+/* Doubles per register */
+#define VECTOR_X86_SSE2_WIDTH (2)
+#define VECTOR_X86_AVX2_WIDTH (4)
+#define VECTOR_X86_AVX512_WIDTH (8)
+
+/* Floats per register */
+#define VECTOR_X86_SSE2_FLOAT_WIDTH (4)
+#define VECTOR_X86_AVX2_FLOAT_WIDTH (8)
+#define VECTOR_X86_AVX512_FLOAT_WIDTH (16)
+
+
+/* Macros ********************************************************************/
+#define VECTOR_X86_SSE2 __attribute__((target("sse2")))
+#define VECTOR_X86_AVX2 __attribute__((target("avx2")))
+#define VECTOR_X86_AVX512 __attribute__((target("avx512f")))
+/* Every AVX2 CPU has POPCNT */
+#define VECTOR_X86_POPCNT __attribute__((target("popcnt")))
+
+/* The bits of the s-vector's word that belong to the j'th lanes group */
+#define VECTOR_X86_SIGN_BITS(word, j, width) \
+    ((size_t)(((word) >> (j)) & ((1 << (width)) - 1)))
+
+
+/* Globals *******************************************************************/
+/* Sign masks of 2 and 4 lanes, indexed by their s-vector bits. XOR-ing a
+ * lane with its mask multiplies it by its s-value */
+static const uint64_t vector_x86_signs2[4][2] = {
+    {0, 0},
+    {VECTOR_X86_SIGN_BIT, 0},
+    {0, VECTOR_X86_SIGN_BIT},
+    {VECTOR_X86_SIGN_BIT, VECTOR_X86_SIGN_BIT},
+};
+
+static const uint64_t vector_x86_signs4[16][4] = {
+    {0, 0, 0, 0},
+    {VECTOR_X86_SIGN_BIT, 0, 0, 0},
+    {0, VECTOR_X86_SIGN_BIT, 0, 0},
+    {VECTOR_X86_SIGN_BIT, VECTOR_X86_SIGN_BIT, 0, 0},
+    {0, 0, VECTOR_X86_SIGN_BIT, 0},
+    {VECTOR_X86_SIGN_BIT, 0, VECTOR_X86_SIGN_BIT, 0},
+    {0, VECTOR_X86_SIGN_BIT, VECTOR_X86_SIGN_BIT, 0},
+    {VECTOR_X86_SIGN_BIT, VECTOR_X86_SIGN_BIT, VECTOR_X86_SIGN_BIT, 0},
+    {0, 0, 0, VECTOR_X86_SIGN_BIT},
+    {VECTOR_X86_SIGN_BIT, 0, 0, VECTOR_X86_SIGN_BIT},
+    {0, VECTOR_X86_SIGN_BIT, 0, VECTOR_X86_SIGN_BIT},
+    {VECTOR_X86_SIGN_BIT, VECTOR_X86_SIGN_BIT, 0, VECTOR_X86_SIGN_BIT},
+    {0, 0, VECTOR_X86_SIGN_BIT, VECTOR_X86_SIGN_BIT},
+    {VECTOR_X86_SIGN_BIT, 0, VECTOR_X86_SIGN_BIT, VECTOR_X86_SIGN_BIT},
+    {0, VECTOR_X86_SIGN_BIT, VECTOR_X86_SIGN_BIT, VECTOR_X86_SIGN_BIT},
+    {VECTOR_X86_SIGN_BIT, VECTOR_X86_SIGN_BIT, VECTOR_X86_SIGN_BIT,
+     VECTOR_X86_SIGN_BIT},
+};
+
+
+/* Functions Declarations ****************************************************/
+/**
+ * @purpose Sum the lanes of a register
+ */
+static VECTOR_X86_SSE2 double
+vector_x86_sse2_sum(__m128d value);
+
+static VECTOR_X86_AVX2 double
+vector_x86_avx2_sum(__m256d value);
+
+/* SSE2 kernels: @see vector_kernels_t */
+static VECTOR_X86_SSE2 double
+vector_x86_sse2_scalar_multiply(const eigen_real_t *l1,
+                                const eigen_real_t *l2,
+                                size_t n);
+
+static VECTOR_X86_SSE2 double
+vector_x86_sse2_scalar_multiply_with_s(const double *l1,
+                                       const sign_word_t *s,
+                                       size_t n);
+
+static VECTOR_X86_SSE2 double
+vector_x86_sse2_gather_multiply_with_s(const double *values,
+                                       const int *indexes,
+                                       const sign_word_t *s,
+                                       size_t n);
+
+static VECTOR_X86_SSE2 size_t
+vector_x86_sse2_count_common_bits(const sign_word_t *bits1,
+                                  const sign_word_t *bits2,
+                                  size_t words);
+
+static VECTOR_X86_SSE2 void
+vector_x86_sse2_scale(eigen_real_t *vector, size_t length, double factor);
+
+static VECTOR_X86_SSE2 bool_t
+vector_x86_sse2_is_close(const eigen_real_t *vector_a,
+                         const eigen_real_t *vector_b,
+                         size_t length,
+                         double epsilon);
+
+static VECTOR_X86_SSE2 bool_t
+vector_x86_sse2_scale_and_is_close(eigen_real_t *vector,
+                                   const eigen_real_t *previous,
+                                   size_t length,
+                                   double factor,
+                                   double epsilon);
+
+/* AVX2 kernels: @see vector_kernels_t */
+static VECTOR_X86_AVX2 double
+vector_x86_avx2_scalar_multiply(const eigen_real_t *l1,
+                                const eigen_real_t *l2,
+                                size_t n);
+
+static VECTOR_X86_AVX2 double
+vector_x86_avx2_scalar_multiply_with_s(const double *l1,
+                                       const sign_word_t *s,
+                                       size_t n);
+
+static VECTOR_X86_AVX2 double
+vector_x86_avx2_gather_multiply_with_s(const double *values,
+                                       const int *indexes,
+                                       const sign_word_t *s,
+                                       size_t n);
+
+/* The AVX2 and AVX-512 tables count bits with the POPCNT instruction */
+static VECTOR_X86_POPCNT size_t
+vector_x86_popcnt_count_common_bits(const sign_word_t *bits1,
+                                    const sign_word_t *bits2,
+                                    size_t words);
+
+static VECTOR_X86_AVX2 void
+vector_x86_avx2_scale(eigen_real_t *vector, size_t length, double factor);
+
+static VECTOR_X86_AVX2 bool_t
+vector_x86_avx2_is_close(const eigen_real_t *vector_a,
+                         const eigen_real_t *vector_b,
+                         size_t length,
+                         double epsilon);
+
+static VECTOR_X86_AVX2 bool_t
+vector_x86_avx2_scale_and_is_close(eigen_real_t *vector,
+                                   const eigen_real_t *previous,
+                                   size_t length,
+                                   double factor,
+                                   double epsilon);
+
+/* AVX-512 kernels: @see vector_kernels_t */
+static VECTOR_X86_AVX512 double
+vector_x86_avx512_scalar_multiply(const eigen_real_t *l1,
+                                  const eigen_real_t *l2,
+                                  size_t n);
+
+static VECTOR_X86_AVX512 double
+vector_x86_avx512_scalar_multiply_with_s(const double *l1,
+                                         const sign_word_t *s,
+                                         size_t n);
+
+static VECTOR_X86_AVX512 double
+vector_x86_avx512_gather_multiply_with_s(const double *values,
+                                         const int *indexes,
+                                         const sign_word_t *s,
+                                         size_t n);
+
+static VECTOR_X86_AVX512 void
+vector_x86_avx512_scale(eigen_real_t *vector, size_t length, double factor);
+
+static VECTOR_X86_AVX512 bool_t
+vector_x86_avx512_is_close(const eigen_real_t *vector_a,
+                           const eigen_real_t *vector_b,
+                           size_t length,
+                           double epsilon);
+
+static VECTOR_X86_AVX512 bool_t
+vector_x86_avx512_scale_and_is_close(eigen_real_t *vector,
+                                     const eigen_real_t *previous,
+                                     size_t length,
+                                     double factor,
+                                     double epsilon);
+
+
+/* Kernels Tables ************************************************************/
+const vector_kernels_t VECTOR_KERNELS_SSE2 = {
+    .scalar_multiply = vector_x86_sse2_scalar_multiply,
+    .scalar_multiply_with_s = vector_x86_sse2_scalar_multiply_with_s,
+    .gather_multiply_with_s = vector_x86_sse2_gather_multiply_with_s,
+    .count_common_bits = vector_x86_sse2_count_common_bits,
+    .scale = vector_x86_sse2_scale,
+    .is_close = vector_x86_sse2_is_close,
+    .scale_and_is_close = vector_x86_sse2_scale_and_is_close,
+};
+
+const vector_kernels_t VECTOR_KERNELS_AVX2 = {
+    .scalar_multiply = vector_x86_avx2_scalar_multiply,
+    .scalar_multiply_with_s = vector_x86_avx2_scalar_multiply_with_s,
+    .gather_multiply_with_s = vector_x86_avx2_gather_multiply_with_s,
+    .count_common_bits = vector_x86_popcnt_count_common_bits,
+    .scale = vector_x86_avx2_scale,
+    .is_close = vector_x86_avx2_is_close,
+    .scale_and_is_close = vector_x86_avx2_scale_and_is_close,
+};
+
+const vector_kernels_t VECTOR_KERNELS_AVX512 = {
+    .scalar_multiply = vector_x86_avx512_scalar_multiply,
+    .scalar_multiply_with_s = vector_x86_avx512_scalar_multiply_with_s,
+    .gather_multiply_with_s = vector_x86_avx512_gather_multiply_with_s,
+    .count_common_bits = vector_x86_popcnt_count_common_bits,
+    .scale = vector_x86_avx512_scale,
+    .is_close = vector_x86_avx512_is_close,
+    .scale_and_is_close = vector_x86_avx512_scale_and_is_close,
+};
+
+
+/* Functions *****************************************************************/
+/* SSE2 **********************************************************************/
+static VECTOR_X86_SSE2 double
+vector_x86_sse2_sum(__m128d value)
+{
+    return _mm_cvtsd_f64(_mm_add_sd(value, _mm_unpackhi_pd(value, value)));
+}
+
+#if !EIGEN_SINGLE_PRECISION
+static VECTOR_X86_SSE2 double
+vector_x86_sse2_scalar_multiply(const double *l1, const double *l2, size_t n)
+{
+    __m128d sum = _mm_setzero_pd();
+    double result = 0.0;
+    size_t i = 0;
+
+    for ( ; i + VECTOR_X86_SSE2_WIDTH <= n ; i += VECTOR_X86_SSE2_WIDTH) {
+        sum = _mm_add_pd(sum, _mm_mul_pd(_mm_loadu_pd(&l1[i]),
+                                         _mm_loadu_pd(&l2[i])));
+    }
+    result = vector_x86_sse2_sum(sum);
+
+    for ( ; i < n ; ++i) {
+        result += l1[i] * l2[i];
+    }
+
+    return result;
+}
+#else /* EIGEN_SINGLE_PRECISION */
+
+static VECTOR_X86_SSE2 double
+vector_x86_sse2_scalar_multiply(const eigen_real_t *l1,
+                                const eigen_real_t *l2,
+                                size_t n)
+{
+    __m128d sum = _mm_setzero_pd();
+    double result = 0.0;
+    size_t i = 0;
+
+    /* The floats are widened, so the products are summed as doubles */
+    for ( ; i + VECTOR_X86_SSE2_WIDTH <= n ; i += VECTOR_X86_SSE2_WIDTH) {
+        sum = _mm_add_pd(sum, _mm_mul_pd(
+            _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64((const __m128i *)&l1[i]))),
+            _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64((const __m128i *)&l2[i])))));
+    }
+    result = vector_x86_sse2_sum(sum);
+
+    for ( ; i < n ; ++i) {
+        result += (double)l1[i] * l2[i];
+    }
+
+    return result;
+}
+#endif /* EIGEN_SINGLE_PRECISION */
+
+static VECTOR_X86_SSE2 double
+vector_x86_sse2_scalar_multiply_with_s(const double *l1,
+                                       const sign_word_t *s,
+                                       size_t n)
+{
+    __m128d sum = _mm_setzero_pd();
+    __m128d signs;
+    sign_word_t word = 0;
+    double result = 0.0;
+    size_t i = 0;
+    size_t j = 0;
+
+    /* 1. Whole words of signs */
+    for ( ; i + SIGN_WORD_BITS <= n ; i += SIGN_WORD_BITS) {
+        word = s[i / SIGN_WORD_BITS];
+        for (j = 0 ; j < SIGN_WORD_BITS ; j += VECTOR_X86_SSE2_WIDTH) {
+            signs = _mm_castsi128_pd(_mm_loadu_si128((const __m128i *)
+                vector_x86_signs2[VECTOR_X86_SIGN_BITS(word,
+                                                       j,
+                                                       VECTOR_X86_SSE2_WIDTH)]));
+            sum = _mm_add_pd(sum, _mm_xor_pd(_mm_loadu_pd(&l1[i + j]), signs));
+        }
+    }
+    result = vector_x86_sse2_sum(sum);
+
+    /* 2. The last partial word */
+    for ( ; i < n ; ++i) {
+        result += l1[i] * SIGN_VECTOR_VALUE(s, i);
+    }
+
+    return result;
+}
+
+static VECTOR_X86_SSE2 double
+vector_x86_sse2_gather_multiply_with_s(const double *values,
+                                       const int *indexes,
+                                       const sign_word_t *s,
+                                       size_t n)
+{
+    __m128d sum = _mm_setzero_pd();
+    __m128d gathered;
+    __m128d signs;
+    sign_word_t word = 0;
+    double result = 0.0;
+    size_t i = 0;
+    size_t j = 0;
+
+    /* 1. Whole words of signs */
+    for ( ; i + SIGN_WORD_BITS <= n ; i += SIGN_WORD_BITS) {
+        word = s[i / SIGN_WORD_BITS];
+        for (j = 0 ; j < SIGN_WORD_BITS ; j += VECTOR_X86_SSE2_WIDTH) {
+            gathered = _mm_set_pd(values[indexes[i + j + 1]],
+                                  values[indexes[i + j]]);
+            signs = _mm_castsi128_pd(_mm_loadu_si128((const __m128i *)
+                vector_x86_signs2[VECTOR_X86_SIGN_BITS(word,
+                                                       j,
+                                                       VECTOR_X86_SSE2_WIDTH)]));
+            sum = _mm_add_pd(sum, _mm_xor_pd(gathered, signs));
+        }
+    }
+    result = vector_x86_sse2_sum(sum);
+
+    /* 2. The last partial word */
+    for ( ; i < n ; ++i) {
+        result += values[indexes[i]] * SIGN_VECTOR_VALUE(s, i);
+    }
+
+    return result;
+}
+
+static VECTOR_X86_SSE2 size_t
+vector_x86_sse2_count_common_bits(const sign_word_t *bits1,
+                                  const sign_word_t *bits2,
+                                  size_t words)
+{
+    const __m128i ones = _mm_set1_epi8(0x55);
+    const __m128i pairs = _mm_set1_epi8(0x33);
+    const __m128i nibbles = _mm_set1_epi8(0x0f);
+    __m128i sum = _mm_setzero_si128();
+    __m128i word;
+    uint64_t sums[2] = {0, 0};
+    size_t i = 0;
+
+    /* Count the bits of each byte in parallel, then sum the bytes */
+    for ( ; i < words ; i += 2) {
+        if (i + 1 < words) {
+            word = _mm_and_si128(_mm_loadu_si128((const __m128i *)&bits1[i]),
+                                 _mm_loadu_si128((const __m128i *)&bits2[i]));
+        } else {
+            word = _mm_set_epi64x(0, (long long)(bits1[i] & bits2[i]));
+        }
+        word = _mm_sub_epi64(word,
+                             _mm_and_si128(_mm_srli_epi64(word, 1), ones));
+        word = _mm_add_epi64(_mm_and_si128(word, pairs),
+                             _mm_and_si128(_mm_srli_epi64(word, 2), pairs));
+        word = _mm_and_si128(_mm_add_epi64(word, _mm_srli_epi64(word, 4)),
+                             nibbles);
+        sum = _mm_add_epi64(sum, _mm_sad_epu8(word, _mm_setzero_si128()));
+    }
+    _mm_storeu_si128((__m128i *)sums, sum);
+
+    return (size_t)(sums[0] + sums[1]);
+}
+
+#if !EIGEN_SINGLE_PRECISION
+static VECTOR_X86_SSE2 void
+vector_x86_sse2_scale(double *vector, size_t length, double factor)
+{
+    __m128d factors = _mm_set1_pd(factor);
+    size_t i = 0;
+
+    for ( ; i + VECTOR_X86_SSE2_WIDTH <= length ; i += VECTOR_X86_SSE2_WIDTH) {
+        _mm_storeu_pd(&vector[i], _mm_mul_pd(_mm_loadu_pd(&vector[i]), factors));
+    }
+
+    for ( ; i < length ; ++i) {
+        vector[i] *= factor;
+    }
+}
+
+static VECTOR_X86_SSE2 bool_t
+vector_x86_sse2_is_close(const double *vector_a,
+                         const double *vector_b,
+                         size_t length,
+                         double epsilon)
+{
+    const __m128d abs_mask = _mm_castsi128_pd(_mm_set1_epi64x(INT64_MAX));
+    const __m128d epsilons = _mm_set1_pd(epsilon);
+    __m128d difference;
+    bool_t result = TRUE;
+    size_t i = 0;
+
+    for ( ; i + VECTOR_X86_SSE2_WIDTH <= length ; i += VECTOR_X86_SSE2_WIDTH) {
+        difference = _mm_and_pd(_mm_sub_pd(_mm_loadu_pd(&vector_a[i]),
+                                           _mm_loadu_pd(&vector_b[i])),
+                                abs_mask);
+        if (0 != _mm_movemask_pd(_mm_cmpge_pd(difference, epsilons))) {
+            result = FALSE;
+            goto l_cleanup;
+        }
+    }
+
+    for ( ; i < length ; ++i) {
+        if (fabs(vector_a[i] - vector_b[i]) >= epsilon) {
+            result = FALSE;
+            goto l_cleanup;
+        }
+    }
+
+l_cleanup:
+
+    return result;
+}
+
+
+static VECTOR_X86_SSE2 bool_t
+vector_x86_sse2_scale_and_is_close(double *vector,
+                                   const double *previous,
+                                   size_t length,
+                                   double factor,
+                                   double epsilon)
+{
+    const __m128d abs_mask = _mm_castsi128_pd(_mm_set1_epi64x(INT64_MAX));
+    const __m128d epsilons = _mm_set1_pd(epsilon);
+    const __m128d factors = _mm_set1_pd(factor);
+    __m128d scaled;
+    __m128d far = _mm_setzero_pd();
+    bool_t result = TRUE;
+    size_t i = 0;
+
+    for ( ; i + VECTOR_X86_SSE2_WIDTH <= length ; i += VECTOR_X86_SSE2_WIDTH) {
+        scaled = _mm_mul_pd(_mm_loadu_pd(&vector[i]), factors);
+        _mm_storeu_pd(&vector[i], scaled);
+        far = _mm_or_pd(far, _mm_cmpge_pd(
+            _mm_and_pd(_mm_sub_pd(scaled, _mm_loadu_pd(&previous[i])), abs_mask),
+            epsilons));
+    }
+    result = (0 == _mm_movemask_pd(far));
+
+    for ( ; i < length ; ++i) {
+        vector[i] *= factor;
+        result &= !(fabs(vector[i] - previous[i]) >= epsilon);
+    }
+
+    return result;
+}
+#else /* EIGEN_SINGLE_PRECISION */
+
+static VECTOR_X86_SSE2 void
+vector_x86_sse2_scale(eigen_real_t *vector, size_t length, double factor)
+{
+    const float single_factor = (float)factor;
+    __m128 factors = _mm_set1_ps(single_factor);
+    size_t i = 0;
+
+    for ( ; i + VECTOR_X86_SSE2_FLOAT_WIDTH <= length ;
+            i += VECTOR_X86_SSE2_FLOAT_WIDTH) {
+        _mm_storeu_ps(&vector[i], _mm_mul_ps(_mm_loadu_ps(&vector[i]), factors));
+    }
+
+    for ( ; i < length ; ++i) {
+        vector[i] *= single_factor;
+    }
+}
+
+static VECTOR_X86_SSE2 bool_t
+vector_x86_sse2_is_close(const eigen_real_t *vector_a,
+                         const eigen_real_t *vector_b,
+                         size_t length,
+                         double epsilon)
+{
+    const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(INT32_MAX));
+    const __m128 epsilons = _mm_set1_ps((float)epsilon);
+    __m128 difference;
+    bool_t result = TRUE;
+    size_t i = 0;
+
+    for ( ; i + VECTOR_X86_SSE2_FLOAT_WIDTH <= length ;
+            i += VECTOR_X86_SSE2_FLOAT_WIDTH) {
+        difference = _mm_and_ps(_mm_sub_ps(_mm_loadu_ps(&vector_a[i]),
+                                           _mm_loadu_ps(&vector_b[i])),
+                                abs_mask);
+        if (0 != _mm_movemask_ps(_mm_cmpge_ps(difference, epsilons))) {
+            result = FALSE;
+            goto l_cleanup;
+        }
+    }
+
+    for ( ; i < length ; ++i) {
+        if (fabs(vector_a[i] - vector_b[i]) >= epsilon) {
+            result = FALSE;
+            goto l_cleanup;
+        }
+    }
+
+l_cleanup:
+
+    return result;
+}
+
+static VECTOR_X86_SSE2 bool_t
+vector_x86_sse2_scale_and_is_close(eigen_real_t *vector,
+                                   const eigen_real_t *previous,
+                                   size_t length,
+                                   double factor,
+                                   double epsilon)
+{
+    const float single_factor = (float)factor;
+    const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(INT32_MAX));
+    const __m128 epsilons = _mm_set1_ps((float)epsilon);
+    const __m128 factors = _mm_set1_ps(single_factor);
+    __m128 scaled;
+    __m128 far = _mm_setzero_ps();
+    bool_t result = TRUE;
+    size_t i = 0;
+
+    for ( ; i + VECTOR_X86_SSE2_FLOAT_WIDTH <= length ;
+            i += VECTOR_X86_SSE2_FLOAT_WIDTH) {
+        scaled = _mm_mul_ps(_mm_loadu_ps(&vector[i]), factors);
+        _mm_storeu_ps(&vector[i], scaled);
+        far = _mm_or_ps(far, _mm_cmpge_ps(
+            _mm_and_ps(_mm_sub_ps(scaled, _mm_loadu_ps(&previous[i])), abs_mask),
+            epsilons));
+    }
+    result = (0 == _mm_movemask_ps(far));
+
+    for ( ; i < length ; ++i) {
+        vector[i] *= single_factor;
+        result &= !(fabs(vector[i] - previous[i]) >= epsilon);
+    }
+
+    return result;
+}
+#endif /* EIGEN_SINGLE_PRECISION */
+
+
+/* AVX2 **********************************************************************/
+static VECTOR_X86_AVX2 double
+vector_x86_avx2_sum(__m256d value)
+{
+    __m128d half = _mm_add_pd(_mm256_castpd256_pd128(value),
+                              _mm256_extractf128_pd(value, 1));
+
+    return _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+}
+
+#if !EIGEN_SINGLE_PRECISION
+static VECTOR_X86_AVX2 double
+vector_x86_avx2_scalar_multiply(const double *l1, const double *l2, size_t n)
+{
+    __m256d sum = _mm256_setzero_pd();
+    double result = 0.0;
+    size_t i = 0;
+
+    for ( ; i + VECTOR_X86_AVX2_WIDTH <= n ; i += VECTOR_X86_AVX2_WIDTH) {
+        sum = _mm256_add_pd(sum, _mm256_mul_pd(_mm256_loadu_pd(&l1[i]),
+                                               _mm256_loadu_pd(&l2[i])));
+    }
+    result = vector_x86_avx2_sum(sum);
+
+    for ( ; i < n ; ++i) {
+        result += l1[i] * l2[i];
+    }
+
+    return result;
+}
+#else /* EIGEN_SINGLE_PRECISION */
+
+static VECTOR_X86_AVX2 double
+vector_x86_avx2_scalar_multiply(const eigen_real_t *l1,
+                                const eigen_real_t *l2,
+                                size_t n)
+{
+    __m256d sum = _mm256_setzero_pd();
+    double result = 0.0;
+    size_t i = 0;
+
+    /* The floats are widened, so the products are summed as doubles */
+    for ( ; i + VECTOR_X86_AVX2_WIDTH <= n ; i += VECTOR_X86_AVX2_WIDTH) {
+        sum = _mm256_add_pd(sum,
+                            _mm256_mul_pd(_mm256_cvtps_pd(_mm_loadu_ps(&l1[i])),
+                                          _mm256_cvtps_pd(_mm_loadu_ps(&l2[i]))));
+    }
+    result = vector_x86_avx2_sum(sum);
+
+    for ( ; i < n ; ++i) {
+        result += (double)l1[i] * l2[i];
+    }
+
+    return result;
+}
+#endif /* EIGEN_SINGLE_PRECISION */
+
+static VECTOR_X86_AVX2 double
+vector_x86_avx2_scalar_multiply_with_s(const double *l1,
+                                       const sign_word_t *s,
+                                       size_t n)
+{
+    __m256d sum = _mm256_setzero_pd();
+    __m256d signs;
+    sign_word_t word = 0;
+    double result = 0.0;
+    size_t i = 0;
+    size_t j = 0;
+
+    /* 1. Whole words of signs */
+    for ( ; i + SIGN_WORD_BITS <= n ; i += SIGN_WORD_BITS) {
+        word = s[i / SIGN_WORD_BITS];
+        for (j = 0 ; j < SIGN_WORD_BITS ; j += VECTOR_X86_AVX2_WIDTH) {
+            signs = _mm256_castsi256_pd(_mm256_loadu_si256((const __m256i *)
+                vector_x86_signs4[VECTOR_X86_SIGN_BITS(word,
+                                                       j,
+                                                       VECTOR_X86_AVX2_WIDTH)]));
+            sum = _mm256_add_pd(sum, _mm256_xor_pd(_mm256_loadu_pd(&l1[i + j]),
+                                                   signs));
+        }
+    }
+    result = vector_x86_avx2_sum(sum);
+
+    /* 2. The last partial word */
+    for ( ; i < n ; ++i) {
+        result += l1[i] * SIGN_VECTOR_VALUE(s, i);
+    }
+
+    return result;
+}
+
+static VECTOR_X86_AVX2 double
+vector_x86_avx2_gather_multiply_with_s(const double *values,
+                                       const int *indexes,
+                                       const sign_word_t *s,
+                                       size_t n)
+{
+    __m256d sum = _mm256_setzero_pd();
+    __m256d gathered;
+    __m256d signs;
+    sign_word_t word = 0;
+    double result = 0.0;
+    size_t i = 0;
+    size_t j = 0;
+
+    /* 1. Whole words of signs */
+    for ( ; i + SIGN_WORD_BITS <= n ; i += SIGN_WORD_BITS) {
+        word = s[i / SIGN_WORD_BITS];
+        for (j = 0 ; j < SIGN_WORD_BITS ; j += VECTOR_X86_AVX2_WIDTH) {
+            gathered = _mm256_i32gather_pd(
+                values,
+                _mm_loadu_si128((const __m128i *)&indexes[i + j]),
+                sizeof(*values));
+            signs = _mm256_castsi256_pd(_mm256_loadu_si256((const __m256i *)
+                vector_x86_signs4[VECTOR_X86_SIGN_BITS(word,
+                                                       j,
+                                                       VECTOR_X86_AVX2_WIDTH)]));
+            sum = _mm256_add_pd(sum, _mm256_xor_pd(gathered, signs));
+        }
+    }
+    result = vector_x86_avx2_sum(sum);
+
+    /* 2. The last partial word */
+    for ( ; i < n ; ++i) {
+        result += values[indexes[i]] * SIGN_VECTOR_VALUE(s, i);
+    }
+
+    return result;
+}
+
+static VECTOR_X86_POPCNT size_t
+vector_x86_popcnt_count_common_bits(const sign_word_t *bits1,
+                                    const sign_word_t *bits2,
+                                    size_t words)
+{
+    size_t count = 0;
+    size_t i = 0;
+
+    for (i = 0 ; i < words ; ++i) {
+        count += (size_t)__builtin_popcountll(bits1[i] & bits2[i]);
+    }
+
+    return count;
+}
+
+#if !EIGEN_SINGLE_PRECISION
+static VECTOR_X86_AVX2 void
+vector_x86_avx2_scale(double *vector, size_t length, double factor)
+{
+    __m256d factors = _mm256_set1_pd(factor);
+    size_t i = 0;
+
+    for ( ; i + VECTOR_X86_AVX2_WIDTH <= length ; i += VECTOR_X86_AVX2_WIDTH) {
+        _mm256_storeu_pd(&vector[i],
+                         _mm256_mul_pd(_mm256_loadu_pd(&vector[i]), factors));
+    }
+
+    for ( ; i < length ; ++i) {
+        vector[i] *= factor;
+    }
+}
+
+static VECTOR_X86_AVX2 bool_t
+vector_x86_avx2_is_close(const double *vector_a,
+                         const double *vector_b,
+                         size_t length,
+                         double epsilon)
+{
+    const __m256d abs_mask = _mm256_castsi256_pd(_mm256_set1_epi64x(INT64_MAX));
+    const __m256d epsilons = _mm256_set1_pd(epsilon);
+    __m256d difference;
+    bool_t result = TRUE;
+    size_t i = 0;
+
+    for ( ; i + VECTOR_X86_AVX2_WIDTH <= length ; i += VECTOR_X86_AVX2_WIDTH) {
+        difference = _mm256_and_pd(_mm256_sub_pd(_mm256_loadu_pd(&vector_a[i]),
+                                                 _mm256_loadu_pd(&vector_b[i])),
+                                   abs_mask);
+        if (0 != _mm256_movemask_pd(_mm256_cmp_pd(difference,
+                                                  epsilons,
+                                                  _CMP_GE_OQ))) {
+            result = FALSE;
+            goto l_cleanup;
+        }
+    }
+
+    for ( ; i < length ; ++i) {
+        if (fabs(vector_a[i] - vector_b[i]) >= epsilon) {
+            result = FALSE;
+            goto l_cleanup;
+        }
+    }
+
+l_cleanup:
+
+    return result;
+}
+
+
+static VECTOR_X86_AVX2 bool_t
+vector_x86_avx2_scale_and_is_close(double *vector,
+                                   const double *previous,
+                                   size_t length,
+                                   double factor,
+                                   double epsilon)
+{
+    const __m256d abs_mask = _mm256_castsi256_pd(_mm256_set1_epi64x(INT64_MAX));
+    const __m256d epsilons = _mm256_set1_pd(epsilon);
+    const __m256d factors = _mm256_set1_pd(factor);
+    __m256d scaled;
+    __m256d far = _mm256_setzero_pd();
+    bool_t result = TRUE;
+    size_t i = 0;
+
+    for ( ; i + VECTOR_X86_AVX2_WIDTH <= length ; i += VECTOR_X86_AVX2_WIDTH) {
+        scaled = _mm256_mul_pd(_mm256_loadu_pd(&vector[i]), factors);
+        _mm256_storeu_pd(&vector[i], scaled);
+        far = _mm256_or_pd(far, _mm256_cmp_pd(
+            _mm256_and_pd(_mm256_sub_pd(scaled, _mm256_loadu_pd(&previous[i])),
+                          abs_mask),
+            epsilons,
+            _CMP_GE_OQ));
+    }
+    result = (0 == _mm256_movemask_pd(far));
+
+    for ( ; i < length ; ++i) {
+        vector[i] *= factor;
+        result &= !(fabs(vector[i] - previous[i]) >= epsilon);
+    }
+
+    return result;
+}
+#else /* EIGEN_SINGLE_PRECISION */
+
+static VECTOR_X86_AVX2 void
+vector_x86_avx2_scale(eigen_real_t *vector, size_t length, double factor)
+{
+    const float single_factor = (float)factor;
+    __m256 factors = _mm256_set1_ps(single_factor);
+    size_t i = 0;
+
+    for ( ; i + VECTOR_X86_AVX2_FLOAT_WIDTH <= length ;
+            i += VECTOR_X86_AVX2_FLOAT_WIDTH) {
+        _mm256_storeu_ps(&vector[i],
+                         _mm256_mul_ps(_mm256_loadu_ps(&vector[i]), factors));
+    }
+
+    for ( ; i < length ; ++i) {
+        vector[i] *= single_factor;
+    }
+}
+
+static VECTOR_X86_AVX2 bool_t
+vector_x86_avx2_is_close(const eigen_real_t *vector_a,
+                         const eigen_real_t *vector_b,
+                         size_t length,
+                         double epsilon)
+{
+    const __m256 abs_mask = _mm256_castsi256_ps(_mm256_set1_epi32(INT32_MAX));
+    const __m256 epsilons = _mm256_set1_ps((float)epsilon);
+    __m256 difference;
+    bool_t result = TRUE;
+    size_t i = 0;
+
+    for ( ; i + VECTOR_X86_AVX2_FLOAT_WIDTH <= length ;
+            i += VECTOR_X86_AVX2_FLOAT_WIDTH) {
+        difference = _mm256_and_ps(_mm256_sub_ps(_mm256_loadu_ps(&vector_a[i]),
+                                                 _mm256_loadu_ps(&vector_b[i])),
+                                   abs_mask);
+        if (0 != _mm256_movemask_ps(_mm256_cmp_ps(difference,
+                                                  epsilons,
+                                                  _CMP_GE_OQ))) {
+            result = FALSE;
+            goto l_cleanup;
+        }
+    }
+
+    for ( ; i < length ; ++i) {
+        if (fabs(vector_a[i] - vector_b[i]) >= epsilon) {
+            result = FALSE;
+            goto l_cleanup;
+        }
+    }
+
+l_cleanup:
+
+    return result;
+}
+
+static VECTOR_X86_AVX2 bool_t
+vector_x86_avx2_scale_and_is_close(eigen_real_t *vector,
+                                   const eigen_real_t *previous,
+                                   size_t length,
+                                   double factor,
+                                   double epsilon)
+{
+    const float single_factor = (float)factor;
+    const __m256 abs_mask = _mm256_castsi256_ps(_mm256_set1_epi32(INT32_MAX));
+    const __m256 epsilons = _mm256_set1_ps((float)epsilon);
+    const __m256 factors = _mm256_set1_ps(single_factor);
+    __m256 scaled;
+    __m256 far = _mm256_setzero_ps();
+    bool_t result = TRUE;
+    size_t i = 0;
+
+    for ( ; i + VECTOR_X86_AVX2_FLOAT_WIDTH <= length ;
+            i += VECTOR_X86_AVX2_FLOAT_WIDTH) {
+        scaled = _mm256_mul_ps(_mm256_loadu_ps(&vector[i]), factors);
+        _mm256_storeu_ps(&vector[i], scaled);
+        far = _mm256_or_ps(far, _mm256_cmp_ps(
+            _mm256_and_ps(_mm256_sub_ps(scaled, _mm256_loadu_ps(&previous[i])),
+                          abs_mask),
+            epsilons,
+            _CMP_GE_OQ));
+    }
+    result = (0 == _mm256_movemask_ps(far));
+
+    for ( ; i < length ; ++i) {
+        vector[i] *= single_factor;
+        result &= !(fabs(vector[i] - previous[i]) >= epsilon);
+    }
+
+    return result;
+}
+#endif /* EIGEN_SINGLE_PRECISION */
+
+
+/* AVX-512 *******************************************************************/
+#if !EIGEN_SINGLE_PRECISION
+static VECTOR_X86_AVX512 double
+vector_x86_avx512_scalar_multiply(const double *l1, const double *l2, size_t n)
+{
+    __m512d sum = _mm512_setzero_pd();
+    double result = 0.0;
+    size_t i = 0;
+
+    for ( ; i + VECTOR_X86_AVX512_WIDTH <= n ; i += VECTOR_X86_AVX512_WIDTH) {
+        sum = _mm512_fmadd_pd(_mm512_loadu_pd(&l1[i]),
+                              _mm512_loadu_pd(&l2[i]),
+                              sum);
+    }
+    result = _mm512_reduce_add_pd(sum);
+
+    for ( ; i < n ; ++i) {
+        result += l1[i] * l2[i];
+    }
+
+    return result;
+}
+#else /* EIGEN_SINGLE_PRECISION */
+
+static VECTOR_X86_AVX512 double
+vector_x86_avx512_scalar_multiply(const eigen_real_t *l1,
+                                  const eigen_real_t *l2,
+                                  size_t n)
+{
+    __m512d sum = _mm512_setzero_pd();
+    double result = 0.0;
+    size_t i = 0;
+
+    /* The floats are widened, so the products are summed as doubles */
+    for ( ; i + VECTOR_X86_AVX512_WIDTH <= n ; i += VECTOR_X86_AVX512_WIDTH) {
+        sum = _mm512_fmadd_pd(_mm512_cvtps_pd(_mm256_loadu_ps(&l1[i])),
+                              _mm512_cvtps_pd(_mm256_loadu_ps(&l2[i])),
+                              sum);
+    }
+    result = _mm512_reduce_add_pd(sum);
+
+    for ( ; i < n ; ++i) {
+        result += (double)l1[i] * l2[i];
+    }
+
+    return result;
+}
+#endif /* EIGEN_SINGLE_PRECISION */
+
+static VECTOR_X86_AVX512 double
+vector_x86_avx512_scalar_multiply_with_s(const double *l1,
+                                         const sign_word_t *s,
+                                         size_t n)
+{
+    const __m512d zero = _mm512_setzero_pd();
+    __m512d sum = _mm512_setzero_pd();
+    __m512d loaded;
+    __mmask8 negatives = 0;
+    sign_word_t word = 0;
+    double result = 0.0;
+    size_t i = 0;
+    size_t j = 0;
+
+    /* 1. Whole words of signs: their bytes are the lanes' negation masks */
+    for ( ; i + SIGN_WORD_BITS <= n ; i += SIGN_WORD_BITS) {
+        word = s[i / SIGN_WORD_BITS];
+        for (j = 0 ; j < SIGN_WORD_BITS ; j += VECTOR_X86_AVX512_WIDTH) {
+            negatives = (__mmask8)VECTOR_X86_SIGN_BITS(word,
+                                                       j,
+                                                       VECTOR_X86_AVX512_WIDTH);
+            loaded = _mm512_loadu_pd(&l1[i + j]);
+            sum = _mm512_add_pd(sum, _mm512_mask_sub_pd(loaded,
+                                                        negatives,
+                                                        zero,
+                                                        loaded));
+        }
+    }
+    result = _mm512_reduce_add_pd(sum);
+
+    /* 2. The last partial word */
+    for ( ; i < n ; ++i) {
+        result += l1[i] * SIGN_VECTOR_VALUE(s, i);
+    }
+
+    return result;
+}
+
+static VECTOR_X86_AVX512 double
+vector_x86_avx512_gather_multiply_with_s(const double *values,
+                                         const int *indexes,
+                                         const sign_word_t *s,
+                                         size_t n)
+{
+    const __m512d zero = _mm512_setzero_pd();
+    __m512d sum = _mm512_setzero_pd();
+    __m512d gathered;
+    __mmask8 negatives = 0;
+    sign_word_t word = 0;
+    double result = 0.0;
+    size_t i = 0;
+    size_t j = 0;
+
+    /* 1. Whole words of signs: their bytes are the lanes' negation masks */
+    for ( ; i + SIGN_WORD_BITS <= n ; i += SIGN_WORD_BITS) {
+        word = s[i / SIGN_WORD_BITS];
+        for (j = 0 ; j < SIGN_WORD_BITS ; j += VECTOR_X86_AVX512_WIDTH) {
+            negatives = (__mmask8)VECTOR_X86_SIGN_BITS(word,
+                                                       j,
+                                                       VECTOR_X86_AVX512_WIDTH);
+            gathered = _mm512_i32gather_pd(
+                _mm256_loadu_si256((const __m256i *)&indexes[i + j]),
+                values,
+                sizeof(*values));
+            sum = _mm512_add_pd(sum, _mm512_mask_sub_pd(gathered,
+                                                        negatives,
+                                                        zero,
+                                                        gathered));
+        }
+    }
+    result = _mm512_reduce_add_pd(sum);
+
+    /* 2. The last partial word */
+    for ( ; i < n ; ++i) {
+        result += values[indexes[i]] * SIGN_VECTOR_VALUE(s, i);
+    }
+
+    return result;
+}
+
+#if !EIGEN_SINGLE_PRECISION
+static VECTOR_X86_AVX512 void
+vector_x86_avx512_scale(double *vector, size_t length, double factor)
+{
+    __m512d factors = _mm512_set1_pd(factor);
+    size_t i = 0;
+
+    for ( ; i + VECTOR_X86_AVX512_WIDTH <= length ; i += VECTOR_X86_AVX512_WIDTH) {
+        _mm512_storeu_pd(&vector[i],
+                         _mm512_mul_pd(_mm512_loadu_pd(&vector[i]), factors));
+    }
+
+    for ( ; i < length ; ++i) {
+        vector[i] *= factor;
+    }
+}
+
+static VECTOR_X86_AVX512 bool_t
+vector_x86_avx512_is_close(const double *vector_a,
+                           const double *vector_b,
+                           size_t length,
+                           double epsilon)
+{
+    const __m512d epsilons = _mm512_set1_pd(epsilon);
+    __m512d difference;
+    bool_t result = TRUE;
+    size_t i = 0;
+
+    for ( ; i + VECTOR_X86_AVX512_WIDTH <= length ; i += VECTOR_X86_AVX512_WIDTH) {
+        difference = _mm512_abs_pd(_mm512_sub_pd(_mm512_loadu_pd(&vector_a[i]),
+                                                 _mm512_loadu_pd(&vector_b[i])));
+        if (0 != _mm512_cmp_pd_mask(difference, epsilons, _CMP_GE_OQ)) {
+            result = FALSE;
+            goto l_cleanup;
+        }
+    }
+
+    for ( ; i < length ; ++i) {
+        if (fabs(vector_a[i] - vector_b[i]) >= epsilon) {
+            result = FALSE;
+            goto l_cleanup;
+        }
+    }
+
+l_cleanup:
+
+    return result;
+}
+
+static VECTOR_X86_AVX512 bool_t
+vector_x86_avx512_scale_and_is_close(double *vector,
+                                     const double *previous,
+                                     size_t length,
+                                     double factor,
+                                     double epsilon)
+{
+    const __m512d epsilons = _mm512_set1_pd(epsilon);
+    const __m512d factors = _mm512_set1_pd(factor);
+    __m512d scaled;
+    __mmask8 far = 0;
+    bool_t result = TRUE;
+    size_t i = 0;
+
+    for ( ; i + VECTOR_X86_AVX512_WIDTH <= length ; i += VECTOR_X86_AVX512_WIDTH) {
+        scaled = _mm512_mul_pd(_mm512_loadu_pd(&vector[i]), factors);
+        _mm512_storeu_pd(&vector[i], scaled);
+        far |= _mm512_cmp_pd_mask(
+            _mm512_abs_pd(_mm512_sub_pd(scaled, _mm512_loadu_pd(&previous[i]))),
+            epsilons,
+            _CMP_GE_OQ);
+    }
+    result = (0 == far);
+
+    for ( ; i < length ; ++i) {
+        vector[i] *= factor;
+        result &= !(fabs(vector[i] - previous[i]) >= epsilon);
+    }
+
+    return result;
+}
+#else /* EIGEN_SINGLE_PRECISION */
+
+static VECTOR_X86_AVX512 void
+vector_x86_avx512_scale(eigen_real_t *vector, size_t length, double factor)
+{
+    const float single_factor = (float)factor;
+    __m512 factors = _mm512_set1_ps(single_factor);
+    size_t i = 0;
+
+    for ( ; i + VECTOR_X86_AVX512_FLOAT_WIDTH <= length ;
+            i += VECTOR_X86_AVX512_FLOAT_WIDTH) {
+        _mm512_storeu_ps(&vector[i],
+                         _mm512_mul_ps(_mm512_loadu_ps(&vector[i]), factors));
+    }
+
+    for ( ; i < length ; ++i) {
+        vector[i] *= single_factor;
+    }
+}
+
+static VECTOR_X86_AVX512 bool_t
+vector_x86_avx512_is_close(const eigen_real_t *vector_a,
+                           const eigen_real_t *vector_b,
+                           size_t length,
+                           double epsilon)
+{
+    const __m512 epsilons = _mm512_set1_ps((float)epsilon);
+    __m512 difference;
+    bool_t result = TRUE;
+    size_t i = 0;
+
+    for ( ; i + VECTOR_X86_AVX512_FLOAT_WIDTH <= length ;
+            i += VECTOR_X86_AVX512_FLOAT_WIDTH) {
+        difference = _mm512_abs_ps(_mm512_sub_ps(_mm512_loadu_ps(&vector_a[i]),
+                                                 _mm512_loadu_ps(&vector_b[i])));
+        if (0 != _mm512_cmp_ps_mask(difference, epsilons, _CMP_GE_OQ)) {
+            result = FALSE;
+            goto l_cleanup;
+        }
+    }
+
+    for ( ; i < length ; ++i) {
+        if (fabs(vector_a[i] - vector_b[i]) >= epsilon) {
+            result = FALSE;
+            goto l_cleanup;
+        }
+    }
+
+l_cleanup:
+
+    return result;
+}
+
+static VECTOR_X86_AVX512 bool_t
+vector_x86_avx512_scale_and_is_close(eigen_real_t *vector,
+                                     const eigen_real_t *previous,
+                                     size_t length,
+                                     double factor,
+                                     double epsilon)
+{
+    const float single_factor = (float)factor;
+    const __m512 epsilons = _mm512_set1_ps((float)epsilon);
+    const __m512 factors = _mm512_set1_ps(single_factor);
+    __m512 scaled;
+    __mmask16 far = 0;
+    bool_t result = TRUE;
+    size_t i = 0;
+
+    for ( ; i + VECTOR_X86_AVX512_FLOAT_WIDTH <= length ;
+            i += VECTOR_X86_AVX512_FLOAT_WIDTH) {
+        scaled = _mm512_mul_ps(_mm512_loadu_ps(&vector[i]), factors);
+        _mm512_storeu_ps(&vector[i], scaled);
+        far |= _mm512_cmp_ps_mask(
+            _mm512_abs_ps(_mm512_sub_ps(scaled, _mm512_loadu_ps(&previous[i]))),
+            epsilons,
+            _CMP_GE_OQ);
+    }
+    result = (0 == far);
+
+    for ( ; i < length ; ++i) {
+        vector[i] *= single_factor;
+        result &= !(fabs(vector[i] - previous[i]) >= epsilon);
+    }
+
+    return result;
+}
+#endif /* EIGEN_SINGLE_PRECISION */
+
+#else /* VECTOR_KERNELS_X86 */
+
+/* ISO C forbids an empty translation unit */
+typedef int vector_x86_unsupported_t;
+
+#endif /* VECTOR_KERNELS_X86 */